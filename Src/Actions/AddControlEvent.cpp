@@ -72,7 +72,7 @@ void AddControlEvent::undo()
     }
     else
     {
-        ptr_vector<ControllerEvent>& control_events = m_visitor->getControlEventVector();
+        ptr_vector<ControllerEvent>& control_events = m_visitor->getControlEventVector(m_controller);
         
         const int controlEventsAmount = control_events.size();
         for (int n=0; n<controlEventsAmount; n++)
@@ -357,4 +357,44 @@ namespace TestAddControlEvent
         delete seq;
     }
     
+    // ---------------------------------------------------------------------------------------------------------
+    
+    UNIT_TEST(TestOtherLanesKept)
+    {
+        Sequence* seq = new Sequence(NULL, NULL, NULL, NULL, false);
+        
+        Track* t = new Track(seq);
+        
+        // make a factory sequence to work from
+        {
+            OwnerPtr<Sequence::Import> import(seq->startImport());
+            t->addControlEvent_import(0,   64,  0);
+            t->addControlEvent_import(100, 127, 1);
+            t->addControlEvent_import(200, 64,  0);
+            t->addControlEvent_import(300, 0,   1);
+        }
+        require(t->getControllerEventAmount(1) == 2, "sanity check"); // sanity check on the way...
+        
+        seq->addTrack(t);
+        
+        // only the lanes of the edited controllers are gathered again
+        seq->getTrack(0)->action(new AddControlEvent(150, 100, 0));
+        seq->getTrack(0)->action(new AddControlEvent(150, 100, 7));
+        
+        require(t->getControllerEventAmount(0) == 3, "the lane of the edited controller was updated");
+        require(t->getControllerEventAmount(7) == 1, "the lane of a new controller was created");
+        require(t->getControllerEventAmount(1) == 2, "the lane of another controller was kept");
+        require(t->getControllerEventAt(150, 0) != NULL, "the added event can be found in its lane");
+        require(t->getControllerEventAt(300, 1) != NULL, "events of other controllers can still be found");
+        
+        seq->undo();
+        seq->undo();
+        
+        require(t->getControllerEventAmount(0) == 2, "undo updated the lane of the edited controller");
+        require(t->getControllerEventAmount(7) == 0, "undo updated the lane of the new controller");
+        require(t->getControllerEventAmount(1) == 2, "undo kept the lane of another controller");
+        
+        delete seq;
+    }
+    
 }
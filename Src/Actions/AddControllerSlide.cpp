@@ -54,7 +54,7 @@ void AddControllerSlide::undo()
     
     if (m_controller != PSEUDO_CONTROLLER_TEMPO)
     {
-        ptr_vector<ControllerEvent>& control_events = m_visitor->getControlEventVector();
+        ptr_vector<ControllerEvent>& control_events = m_visitor->getControlEventVector(m_controller);
         
         while ((current_event = relocator.getNextControlEvent()) and current_event != NULL)
         {
@@ -134,11 +134,12 @@ void AddControllerSlide::perform()
     if (m_controller == PSEUDO_CONTROLLER_TEMPO)
     {
         vector = &m_track->getSequence()->m_tempo_events;
+        m_track->getSequence()->markTempoEdited();
     }
     else
     {
         // controller and pitch bend events
-        vector = &m_visitor->getControlEventVector();
+        vector = &m_visitor->getControlEventVector(m_controller);
     }
     
     /*
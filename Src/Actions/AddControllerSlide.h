@@ -48,6 +48,12 @@ namespace AriaMaestosa
             
             
             virtual ~AddControllerSlide();
+            
+            virtual long getMemoryUsage() const
+            {
+                return EditAction::getMemoryUsage() + relocator.getMemoryUsage() +
+                       vectorMemoryUsage(removedControlEvents);
+            }
         };
         
     }
@@ -82,6 +82,7 @@ void AddNote::perform()
     const int len = md->getTotalTickAmount();
     
     const bool success = m_track->addNote( tmp_note );
+    markEditedNotes(m_start_tick, m_end_tick);
     
     if (success)
     {
@@ -50,6 +50,13 @@ namespace AriaMaestosa
             AddNote(const int pitchID, const int startTick, const int endTick, const int volume,
                     bool select = true, const int string=-1);
             virtual ~AddNote() {}
+            
+            virtual long getMemoryUsage() const
+            {
+                return EditAction::getMemoryUsage() + relocator.getMemoryUsage();
+            }
+            
+            virtual NoteRelocator* getNoteRelocator() { return &relocator; }
 
             virtual void perform();
             virtual void undo();
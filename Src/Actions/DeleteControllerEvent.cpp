@@ -84,10 +84,10 @@ void DeleteControllerEvent::perform()
     ASSERT(m_track != NULL);
     
 
-    ptr_vector<ControllerEvent>& ctrls = m_visitor->getControlEventVector();
-    
     ControllerEditor* editor = m_track->getGraphics()->getControllerEditor();
     const int type = editor->getCurrentControllerType();
+    
+    ptr_vector<ControllerEvent>& ctrls = m_visitor->getControlEventVector(type);
 
     m_id_controller = type;
     
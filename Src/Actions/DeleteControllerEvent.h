@@ -47,6 +47,11 @@ namespace AriaMaestosa
             void perform();
             void undo();
             virtual ~DeleteControllerEvent();
+            
+            virtual long getMemoryUsage() const
+            {
+                return EditAction::getMemoryUsage() + vectorMemoryUsage(removedControlEvents);
+            }
         };
         
         
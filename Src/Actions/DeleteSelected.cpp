@@ -96,15 +96,17 @@ void DeleteSelected::perform()
 {
     ASSERT(m_track != NULL);
     
+    markEditedNotes(0, -1);
+    
     // FIXME: controllers need an exceptional treatment
     if (dynamic_cast<ControllerEditor*>(m_editor) != NULL)
     {
-        ptr_vector<ControllerEvent>& ctrls = m_visitor->getControlEventVector();
-        
         ControllerEditor* editor = m_track->getGraphics()->getControllerEditor();
         int selBegin   = editor->getSelectionBegin();
         int selEnd     = editor->getSelectionEnd();
         const int type = editor->getCurrentControllerType();
+        
+        ptr_vector<ControllerEvent>& ctrls = m_visitor->getControlEventVector(type);
 
         m_provider_type = type;
         
@@ -180,6 +182,7 @@ void DeleteSelected::perform()
             }
             
             //notes.erase(n);
+            markEditedNotes(notes[n].getTick(), notes[n].getEndTick());
             removedNotes.push_back( notes.get(n) );
             notes.remove(n);
             
@@ -48,6 +48,12 @@ namespace AriaMaestosa
             void perform();
             void undo();
             virtual ~DeleteSelected();
+            
+            virtual long getMemoryUsage() const
+            {
+                return EditAction::getMemoryUsage() + vectorMemoryUsage(removedNotes) +
+                       vectorMemoryUsage(removedControlEvents);
+            }
         };
         
         
@@ -45,6 +45,18 @@ DeleteTrack::~DeleteTrack()
 
 // --------------------------------------------------------------------------------------------------------
 
+long DeleteTrack::getMemoryUsage() const
+{
+    if (m_removed_track == NULL) return EditAction::getMemoryUsage();
+    
+    // the whole track is kept, notes and controller events being the bulk of it
+    return EditAction::getMemoryUsage() + sizeof(Track) +
+           m_removed_track->getNoteAmount()*(sizeof(Note) + sizeof(Note*)) +
+           m_removed_track->getControllerEventAmount()*(sizeof(ControllerEvent) + sizeof(ControllerEvent*));
+}
+
+// --------------------------------------------------------------------------------------------------------
+
 void DeleteTrack::undo()
 {
     ASSERT(m_removed_track != NULL)
@@ -41,6 +41,8 @@ namespace AriaMaestosa
         public:
             DeleteTrack(Sequence* whichSequence);
             virtual ~DeleteTrack();
+            
+            virtual long getMemoryUsage() const;
 
             void perform();
             void undo();
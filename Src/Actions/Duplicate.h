@@ -49,6 +49,13 @@ namespace AriaMaestosa
             void moveEvent(Action::MoveNotes* event);
             
             virtual ~Duplicate();
+            
+            virtual long getMemoryUsage() const
+            {
+                return EditAction::getMemoryUsage() + relocator.getMemoryUsage();
+            }
+            
+            virtual NoteRelocator* getNoteRelocator() { return &relocator; }
         };
     }
 }
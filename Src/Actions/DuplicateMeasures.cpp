@@ -25,8 +25,6 @@
 #include "Midi/Track.h"
 #include "UnitTest.h"
 
-#include <map>
-
 using namespace AriaMaestosa;
 using namespace AriaMaestosa::Action;
 
@@ -38,6 +36,9 @@ DuplicateMeasures::DuplicateMeasures(int fromMeasure, int toMeasure) :
 {
     m_fromMeasure = fromMeasure;
     m_toMeasure = toMeasure;
+    m_afterTick = 0;
+    m_stopDuplicatingAtTick = 0;
+    m_amountInTicks = 0;
 }
 
 // --------------------------------------------------------------------------------------------------------
@@ -71,6 +72,10 @@ void DuplicateMeasures::perform()
     
     const int stopDuplicatingAtTick = md->firstTickInMeasure(m_toMeasure);
     
+    m_amountInTicks         = amountInTicks;
+    m_afterTick             = afterTick;
+    m_stopDuplicatingAtTick = stopDuplicatingAtTick;
+    
     {
         ScopedMeasureTransaction tr(md->startTransaction());
         
@@ -79,57 +84,13 @@ void DuplicateMeasures::perform()
         
         tr->setMeasureAmount( md->getMeasureAmount() + amount );
     
-        std::vector<Note> notesToDuplicate;
-        std::map<Track*, std::vector<ControllerEvent> > controllerEventsToDuplicate;
         std::vector<ControllerEvent> tempoEventsToDuplicate;
         
         // move all notes that are after given start tick by the necessary amount
         const int trackAmount = m_sequence->getTrackAmount();
-        for (int t=0; t<trackAmount; t++)
-        {
-            Track* track = m_sequence->getTrack(t);
-            
-            // ----------------- note events -----------------
-            const int noteAmount = track->getNoteAmount();
-            for (int n=0; n<noteAmount; n++)
-            {
-                Note* note = track->getNote(n);
-                if (note->getTick() > afterTick)
-                {
-                    if (note->getTick() < stopDuplicatingAtTick)
-                    {
-                        // duplicate
-                        notesToDuplicate.push_back(Note(track, note->getPitchID(), note->getTick(),
-                                                        note->getEndTick(), note->getVolume(),
-                                                        note->getString()));
-                    }
-                    
-                    note->setTick(note->getTick() + amountInTicks);
-                    note->setEndTick(note->getEndTick() + amountInTicks);
-                    
-                }
-            }
-            
-            // ----------------- control events -----------------
-            OwnerPtr<Track::TrackVisitor> tvisitor(m_visitor->getNewTrackVisitor(t));
-            ptr_vector<ControllerEvent>& ctrl = tvisitor->getControlEventVector();
-            
-            const int controlAmount = ctrl.size();
-            for (int n=0; n<controlAmount; n++)
-            {
-                if (ctrl[n].getTick() > afterTick)
-                {
-                    if (ctrl[n].getTick() < stopDuplicatingAtTick)
-                    {
-                        controllerEventsToDuplicate[track].push_back(ControllerEvent(ctrl[n].getController(),
-                                                                                     ctrl[n].getTick(),
-                                                                                     ctrl[n].getValue()));
-                    }
-                    
-                    ctrl[n].setTick( ctrl[n].getTick() + amountInTicks );
-                }
-            }
-        }
+        m_notesToDuplicate.resize(trackAmount);
+        m_controllerEventsToDuplicate.resize(trackAmount);
+        performOnAllTracks();
         
         // ----------------- move tempo events -----------------
         const int tempo_event_amount = m_sequence->getTempoEventAmount();
@@ -173,25 +134,28 @@ void DuplicateMeasures::perform()
             }//next
         }//endif
         
-        for (size_t n = 0; n < notesToDuplicate.size(); n++)
-        {
-            notesToDuplicate[n].getParent()->addNote_import(notesToDuplicate[n].getPitchID(),
-                                                            notesToDuplicate[n].getTick(),
-                                                            notesToDuplicate[n].getEndTick(), 
-                                                            notesToDuplicate[n].getVolume(),
-                                                            notesToDuplicate[n].getString());
-        }
-        
-        for (std::map<Track*, std::vector<ControllerEvent> >::iterator it = controllerEventsToDuplicate.begin();
-             it != controllerEventsToDuplicate.end();
-             it++)
+        for (int t=0; t<trackAmount; t++)
         {
-            for (size_t n = 0; n < it->second.size(); n++)
+            std::vector<Note>& notesToDuplicate = m_notesToDuplicate[t];
+            for (size_t n = 0; n < notesToDuplicate.size(); n++)
             {
-                ControllerEvent& evt = it->second[n];
-                it->first->addControlEvent_import(evt.getTick(), evt.getValue(), evt.getController());
+                notesToDuplicate[n].getParent()->addNote_import(notesToDuplicate[n].getPitchID(),
+                                                                notesToDuplicate[n].getTick(),
+                                                                notesToDuplicate[n].getEndTick(), 
+                                                                notesToDuplicate[n].getVolume(),
+                                                                notesToDuplicate[n].getString());
+            }
+            
+            Track* track = m_sequence->getTrack(t);
+            std::vector<ControllerEvent>& eventsToDuplicate = m_controllerEventsToDuplicate[t];
+            for (size_t n = 0; n < eventsToDuplicate.size(); n++)
+            {
+                ControllerEvent& evt = eventsToDuplicate[n];
+                track->addControlEvent_import(evt.getTick(), evt.getValue(), evt.getController());
             }
         }
+        m_notesToDuplicate.clear();
+        m_controllerEventsToDuplicate.clear();
         
         for (size_t n = 0; n < tempoEventsToDuplicate.size(); n++)
         {
@@ -213,4 +177,53 @@ void DuplicateMeasures::perform()
     
 }
 
+// --------------------------------------------------------------------------------------------------------
+
+void DuplicateMeasures::performOnTrack(const int trackID)
+{
+    Track* track = m_sequence->getTrack(trackID);
+    std::vector<Note>& notesToDuplicate = m_notesToDuplicate[trackID];
+    std::vector<ControllerEvent>& eventsToDuplicate = m_controllerEventsToDuplicate[trackID];
+    
+    // ----------------- note events -----------------
+    const int noteAmount = track->getNoteAmount();
+    for (int n=0; n<noteAmount; n++)
+    {
+        Note* note = track->getNote(n);
+        if (note->getTick() > m_afterTick)
+        {
+            if (note->getTick() < m_stopDuplicatingAtTick)
+            {
+                // duplicate
+                notesToDuplicate.push_back(Note(track, note->getPitchID(), note->getTick(),
+                                                note->getEndTick(), note->getVolume(),
+                                                note->getString()));
+            }
+            
+            note->setTick(note->getTick() + m_amountInTicks);
+            note->setEndTick(note->getEndTick() + m_amountInTicks);
+            
+        }
+    }
+    
+    // ----------------- control events -----------------
+    OwnerPtr<Track::TrackVisitor> tvisitor(m_visitor->getNewTrackVisitor(trackID));
+    ptr_vector<ControllerEvent>& ctrl = tvisitor->getControlEventVector();
+    
+    const int controlAmount = ctrl.size();
+    for (int n=0; n<controlAmount; n++)
+    {
+        if (ctrl[n].getTick() > m_afterTick)
+        {
+            if (ctrl[n].getTick() < m_stopDuplicatingAtTick)
+            {
+                eventsToDuplicate.push_back(ControllerEvent(ctrl[n].getController(), ctrl[n].getTick(),
+                                                            ctrl[n].getValue()));
+            }
+            
+            ctrl[n].setTick( ctrl[n].getTick() + m_amountInTicks );
+        }
+    }
+}
+
 
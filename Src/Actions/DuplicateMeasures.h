@@ -36,6 +36,18 @@ namespace AriaMaestosa
             int m_fromMeasure;
             int m_toMeasure;
             
+            /** ticks used by performOnTrack; set by perform() */
+            int m_afterTick;
+            int m_stopDuplicatingAtTick;
+            int m_amountInTicks;
+            
+            /** copies of the events to duplicate, per track; only used while performing */
+            std::vector< std::vector<Note> > m_notesToDuplicate;
+            std::vector< std::vector<ControllerEvent> > m_controllerEventsToDuplicate;
+            
+        protected:
+            virtual void performOnTrack(const int trackID);
+            
         public:
             DuplicateMeasures(int fromMeasure, int toMeasure);
             void perform();
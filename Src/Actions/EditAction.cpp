@@ -17,8 +17,10 @@
 #include "Actions/EditAction.h"
 #include "Midi/Track.h"
 #include "Midi/ControllerEvent.h"
+#include "WorkerPool.h"
 
 //#include "GUI/GraphicalTrack.h"
+#include <algorithm>
 #include <vector>
 
 using namespace AriaMaestosa;
@@ -28,7 +30,14 @@ using namespace AriaMaestosa::Action;
 
 EditAction::EditAction(wxString name) : m_name(name)
 {
-    
+    m_accounted_memory = 0;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+long EditAction::getMemoryUsage() const
+{
+    return sizeof(*this) + m_name.length()*sizeof(wxChar);
 }
 
 
@@ -36,6 +45,45 @@ EditAction::EditAction(wxString name) : m_name(name)
 
 SingleTrackAction::SingleTrackAction(wxString name) : EditAction(name)
 {
+    m_edited_notes_known = false;
+    m_edited_from_tick   = 0;
+    m_edited_to_tick     = -1;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void SingleTrackAction::markEditedNotes(const int fromTick, const int toTick)
+{
+    m_edited_notes_known = true;
+    if (toTick < fromTick) return;
+    
+    if (m_edited_to_tick < m_edited_from_tick)
+    {
+        m_edited_from_tick = fromTick;
+        m_edited_to_tick   = toTick;
+    }
+    else
+    {
+        m_edited_from_tick = std::min(m_edited_from_tick, fromTick);
+        m_edited_to_tick   = std::max(m_edited_to_tick,   toTick);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+bool SingleTrackAction::getEditedNoteTicks(const Track* track, int* fromTick, int* toTick) const
+{
+    // other tracks are left untouched
+    if (track != m_track)
+    {
+        *fromTick = 0;
+        *toTick   = -1;
+        return true;
+    }
+    
+    *fromTick = m_edited_from_tick;
+    *toTick   = m_edited_to_tick;
+    return m_edited_notes_known;
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -65,6 +113,40 @@ void MultiTrackAction::setParentSequence(Sequence* parent, SequenceVisitor* visi
     m_visitor  = visitor;
 }
 
+// ----------------------------------------------------------------------------------------------------
+
+/** Runs the per-track part of a MultiTrackAction, one task per track */
+class MultiTrackAction::TrackTask : public IParallelTask
+{
+    MultiTrackAction* m_action;
+    bool m_undo;
+    
+public:
+    TrackTask(MultiTrackAction* action, const bool undo) : m_action(action), m_undo(undo) {}
+    
+    virtual void runTask(const int id)
+    {
+        if (m_undo) m_action->undoOnTrack(id);
+        else        m_action->performOnTrack(id);
+    }
+};
+
+// ----------------------------------------------------------------------------------------------------
+
+void MultiTrackAction::performOnAllTracks()
+{
+    TrackTask task(this, false);
+    WorkerPool::getInstance()->run(&task, m_sequence->getTrackAmount());
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void MultiTrackAction::undoOnAllTracks()
+{
+    TrackTask task(this, true);
+    WorkerPool::getInstance()->run(&task, m_sequence->getTrackAmount());
+}
+
 
 // ----------------------------------------------------------------------------------------------------
 // ----------------------------------------------------------------------------------------------------
@@ -76,11 +158,29 @@ void NoteRelocator::setParent(Track* t)
 
 // ----------------------------------------------------------------------------------------------------
 
+NoteRelocator::NoteRelocator()
+{
+    m_list          = new NoteList();
+    m_list->m_users = 1;
+    m_track         = NULL;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+void NoteRelocator::release()
+{
+    m_list->m_users--;
+    if (m_list->m_users == 0) delete m_list;
+    m_list = NULL;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
 void NoteRelocator::prepareToRelocate()
 {
     m_id                      = 0;
     m_noteamount_in_track     = m_track->getNoteAmount();
-    m_noteamount_in_relocator = notes.size();
+    m_noteamount_in_relocator = m_list->m_notes.size();
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -90,27 +190,57 @@ Note* NoteRelocator::getNextNote()
     if (m_id >= m_noteamount_in_relocator) return NULL;
     
     m_id++;
-    return notes.get(m_id - 1);
+    return m_list->m_notes[m_id - 1];
 }
 
 // ----------------------------------------------------------------------------------------------------
 
 void NoteRelocator::rememberNote(Note& n)
 {
-    notes.push_back(&n);
+    rememberNote(&n);
 }
 
 // ----------------------------------------------------------------------------------------------------
 
 void NoteRelocator::rememberNote(Note* n)
 {
-    notes.push_back(n);
+    if (m_list->m_users > 1)
+    {
+        // copy on write
+        NoteList* copy = new NoteList();
+        copy->m_notes  = m_list->m_notes;
+        copy->m_users  = 1;
+        release();
+        m_list = copy;
+    }
+    m_list->m_notes.push_back(n);
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+long NoteRelocator::getMemoryUsage() const
+{
+    return (sizeof(NoteList) + m_list->m_notes.capacity()*sizeof(Note*)) / m_list->m_users;
+}
+
+// ----------------------------------------------------------------------------------------------------
+
+bool NoteRelocator::shareNotesWith(NoteRelocator& other)
+{
+    if (m_list == other.m_list) return true;
+    if (m_list->m_notes != other.m_list->m_notes) return false;
+    
+    release();
+    m_list = other.m_list;
+    m_list->m_users++;
+    return true;
 }
 
 // ----------------------------------------------------------------------------------------------------
 
 NoteRelocator::~NoteRelocator()
 {
+    release();
 }
 
 
@@ -128,7 +258,7 @@ void ControlEventRelocator::setParent(Track* t, Track::TrackVisitor* visitor)
 void ControlEventRelocator::prepareToRelocate()
 {
     m_id                  = 0;
-    m_amount_in_track     = m_visitor->getControlEventVector().size();
+    m_amount_in_track     = m_track->getControllerEventAmount();
     m_amount_in_relocator = events.size();
 }
 
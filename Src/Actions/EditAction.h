@@ -25,6 +25,8 @@
 #include "Midi/Track.h"
 #include "Utils.h"
 
+#include <vector>
+
 /**
   * @defgroup actions
   */
@@ -50,18 +52,45 @@ namespace AriaMaestosa
      */
     class NoteRelocator
     {
+        /**
+          * The remembered notes. Consecutive actions on the same selection remember the same notes,
+          * so the undo stack lets them share one list (see shareNotesWith); it is copied on write.
+          */
+        struct NoteList
+        {
+            std::vector<Note*> m_notes;
+            int m_users;
+        };
+        
+        NoteList* m_list;
+        
         int m_id;
         
         int m_noteamount_in_track, m_noteamount_in_relocator;
         Track* m_track;
         
+        void release();
+        
+        // relocators are owned by their action and never copied
+        NoteRelocator(const NoteRelocator&);
+        NoteRelocator& operator=(const NoteRelocator&);
+        
     public:
         
+        NoteRelocator();
         void rememberNote(Note& n);
         void rememberNote(Note* n);
         ~NoteRelocator();
         
-        ptr_vector<Note, REF> notes;
+        /** @return approximate memory used to remember notes, in bytes; a shared list is split between its users */
+        long getMemoryUsage() const;
+        
+        /**
+          * If 'other' remembers exactly the same notes, drop this relocator's list and use the one of 'other'.
+          * @return whether the list is now shared
+          */
+        bool shareNotesWith(NoteRelocator& other);
+        
         void setParent(Track* t);
         void prepareToRelocate();
         
@@ -83,6 +112,9 @@ namespace AriaMaestosa
         
         ptr_vector<ControllerEvent, REF> events;
         
+        /** @return approximate memory used to remember events, in bytes */
+        long getMemoryUsage() const { return events.size()*sizeof(ControllerEvent*); }
+        
         void setParent(Track* t, Track::TrackVisitor* visitor);
         void prepareToRelocate();
         
@@ -97,6 +129,20 @@ namespace AriaMaestosa
     namespace Action
     {
         
+        /** @return approximate memory (in bytes) used by a vector an action keeps to be able to undo */
+        template<typename T>
+        long vectorMemoryUsage(const std::vector<T>& v)
+        {
+            return v.capacity()*sizeof(T);
+        }
+        
+        /** @return approximate memory (in bytes) used by objects an action owns to be able to undo */
+        template<typename T>
+        long vectorMemoryUsage(const ptr_vector<T, HOLD>& v)
+        {
+            return v.size()*(sizeof(T) + sizeof(T*));
+        }
+        
         /**
          * @brief the base for all undoable actions
          *
@@ -112,6 +158,10 @@ namespace AriaMaestosa
         class EditAction
         {
             wxString m_name;
+            
+            /** memory usage last added to the undo stack's running total for this action */
+            long m_accounted_memory;
+            friend class AriaMaestosa::Sequence;
 
         public:
             LEAK_CHECK();
@@ -123,6 +173,24 @@ namespace AriaMaestosa
             /** Some actions may not be undoable at any time */
             virtual bool canUndoNow() { return true; }
             
+            /**
+              * @return approximate memory (in bytes) kept by this action to be able to undo it.
+              *         Sequence drops the oldest actions when the undo stack grows past its budget, so
+              *         actions that keep notes or events around must account for them.
+              */
+            virtual long getMemoryUsage() const;
+            
+            /** @return the relocator this action remembers its notes with, if any (lets the undo stack share it) */
+            virtual NoteRelocator* getNoteRelocator() { return NULL; }
+            
+            /**
+              * @brief Get the ticks covered by the notes of 'track' this action changed, both before and
+              *        after the change, so that caches derived from the notes can update only that range
+              * @return false if the action doesn't know (then the whole track must be considered changed).
+              *         When no note of the track changed, 'toTick' is smaller than 'fromTick'.
+              */
+            virtual bool getEditedNoteTicks(const Track* track, int* fromTick, int* toTick) const { return false; }
+            
             virtual ~EditAction() {}
             
             wxString getName() const { return m_name; }
@@ -137,6 +205,16 @@ namespace AriaMaestosa
             Track* m_track;
             OwnerPtr<Track::TrackVisitor> m_visitor;
             
+            /**
+              * Subclasses call this from perform() for the notes they change, so getEditedNoteTicks can
+              * report them; an empty range (toTick < fromTick) tells that no note is changed.
+              */
+            void markEditedNotes(const int fromTick, const int toTick);
+            
+        private:
+            bool m_edited_notes_known;
+            int  m_edited_from_tick, m_edited_to_tick;
+            
         public:
             
             SingleTrackAction(wxString name);
@@ -146,16 +224,41 @@ namespace AriaMaestosa
             virtual void undo() = 0;
             
             void setParentTrack(Track* parent, Track::TrackVisitor* visitor);
+            
+            virtual bool getEditedNoteTicks(const Track* track, int* fromTick, int* toTick) const;
         };
         
         /**
           * @brief an EditAction that modifies several tracks
+          *
+          * Work that only concerns the notes and controller events of one track can be put in
+          * performOnTrack/undoOnTrack; performOnAllTracks/undoOnAllTracks then run it for every
+          * track, spread over the WorkerPool.
           */
         class MultiTrackAction : public EditAction
         {
+            class TrackTask;
+            friend class TrackTask;
+            
         protected:
             Sequence* m_sequence;
             OwnerPtr<SequenceVisitor> m_visitor;
+            
+            /**
+              * Part of perform() that only touches track 'trackID'. May run on any thread, concurrently
+              * for different tracks, so it must not modify the sequence or its measure data; keep undo
+              * information in per-track slots allocated before calling performOnAllTracks.
+              */
+            virtual void performOnTrack(const int trackID) {}
+            
+            /** Part of undo() that only touches track 'trackID'; same rules as performOnTrack */
+            virtual void undoOnTrack(const int trackID) {}
+            
+            /** Calls performOnTrack for every track of the sequence, returns once all are done */
+            void performOnAllTracks();
+            
+            /** Calls undoOnTrack for every track of the sequence, returns once all are done */
+            void undoOnAllTracks();
 
         public:
             
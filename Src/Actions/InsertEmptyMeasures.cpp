@@ -36,6 +36,8 @@ InsertEmptyMeasures::InsertEmptyMeasures(int measureID, int amount) :
 {
     m_measure_ID = measureID;
     m_amount = amount;
+    m_after_tick = 0;
+    m_amount_in_ticks = 0;
 }
 
 // --------------------------------------------------------------------------------------------------------
@@ -65,6 +67,8 @@ void InsertEmptyMeasures::perform()
     // convert measures into midi ticks
     const int amountInTicks = m_amount * md->measureLengthInTicks(m_measure_ID);
     const int afterTick = md->firstTickInMeasure(m_measure_ID) - 1;
+    m_amount_in_ticks = amountInTicks;
+    m_after_tick      = afterTick;
     
     {
         ScopedMeasureTransaction tr(md->startTransaction());
@@ -72,39 +76,7 @@ void InsertEmptyMeasures::perform()
         tr->setMeasureAmount( md->getMeasureAmount() + m_amount );
     
         // move all notes that are after given start tick by the necessary amount
-        const int trackAmount = m_sequence->getTrackAmount();
-        for (int t=0; t<trackAmount; t++)
-        {
-            Track* track = m_sequence->getTrack(t);
-            
-            // ----------------- move note events -----------------
-            const int noteAmount = track->getNoteAmount();
-            for (int n=0; n<noteAmount; n++)
-            {
-                Note* note = track->getNote(n);
-                if (note->getTick() > afterTick)
-                {
-                    note->setTick(note->getTick() + amountInTicks);
-                    note->setEndTick(note->getEndTick() + amountInTicks);
-                }
-            }
-            // ----------------- move control events -----------------
-            
-            OwnerPtr<Track::TrackVisitor> tvisitor(m_visitor->getNewTrackVisitor(t));
-            ptr_vector<ControllerEvent>& ctrl = tvisitor->getControlEventVector();
-            
-            const int controlAmount = ctrl.size();
-            for (int n=0; n<controlAmount; n++)
-            {
-                if (ctrl[n].getTick() > afterTick)
-                {
-                    ctrl[n].setTick( ctrl[n].getTick() + amountInTicks );
-                }
-            }
-            
-            track->reorderNoteVector();
-            track->reorderNoteOffVector();
-        }
+        performOnAllTracks();
         
         // ----------------- move tempo events -----------------
         const int tempo_event_amount = m_sequence->getTempoEventAmount();
@@ -158,6 +130,41 @@ void InsertEmptyMeasures::perform()
     
 }
 
+// --------------------------------------------------------------------------------------------------------
+
+void InsertEmptyMeasures::performOnTrack(const int trackID)
+{
+    Track* track = m_sequence->getTrack(trackID);
+    
+    // ----------------- move note events -----------------
+    const int noteAmount = track->getNoteAmount();
+    for (int n=0; n<noteAmount; n++)
+    {
+        Note* note = track->getNote(n);
+        if (note->getTick() > m_after_tick)
+        {
+            note->setTick(note->getTick() + m_amount_in_ticks);
+            note->setEndTick(note->getEndTick() + m_amount_in_ticks);
+        }
+    }
+    // ----------------- move control events -----------------
+    
+    OwnerPtr<Track::TrackVisitor> tvisitor(m_visitor->getNewTrackVisitor(trackID));
+    ptr_vector<ControllerEvent>& ctrl = tvisitor->getControlEventVector();
+    
+    const int controlAmount = ctrl.size();
+    for (int n=0; n<controlAmount; n++)
+    {
+        if (ctrl[n].getTick() > m_after_tick)
+        {
+            ctrl[n].setTick( ctrl[n].getTick() + m_amount_in_ticks );
+        }
+    }
+    
+    track->reorderNoteVector();
+    track->reorderNoteOffVector();
+}
+
 // ----------------------------------------------------------------------------------------------------------
 // ----------------------------------------------------------------------------------------------------------
 
@@ -35,6 +35,13 @@ namespace AriaMaestosa
             int m_measure_ID;
             int m_amount;
             
+            /** events after this tick are moved by m_amount_in_ticks; set by perform() */
+            int m_after_tick;
+            int m_amount_in_ticks;
+            
+        protected:
+            virtual void performOnTrack(const int trackID);
+            
         public:
             InsertEmptyMeasures(int measureID, int amount);
             void perform();
@@ -15,6 +15,7 @@
  */
 
 #include <wx/intl.h>
+#include <cstdlib>
 
 #include "Actions/MoveNotes.h"
 #include "Actions/EditAction.h"
@@ -101,6 +102,7 @@ void MoveNotes::perform()
     ASSERT(m_note_ID != ALL_NOTES); // not supported in this function (not needed)
 
     int last_tick = -1;
+    markEditedNotes(0, -1);
 
     if (m_note_ID == SELECTED_NOTES)
     {
@@ -113,7 +115,7 @@ void MoveNotes::perform()
             if (not notes[n].isSelected()) continue;
 
             doMoveOneNote(n);
-            
+            markEditedNotes(notes[n].getTick() - std::abs(m_relativeX), notes[n].getEndTick() + std::abs(m_relativeX));
             
             if (notes[n].getEndTick() > last_tick) last_tick = notes[n].getEndTick();
                      
@@ -132,6 +134,8 @@ void MoveNotes::perform()
         ASSERT_E(m_note_ID,<,notes.size());
 
         doMoveOneNote(m_note_ID);
+        markEditedNotes(notes[m_note_ID].getTick() - std::abs(m_relativeX),
+                        notes[m_note_ID].getEndTick() + std::abs(m_relativeX));
         
         last_tick = notes[m_note_ID].getEndTick();
         
@@ -69,6 +69,15 @@ namespace AriaMaestosa
             void doMoveOneNote(const int noteid);
             
             virtual ~MoveNotes();
+            
+            virtual long getMemoryUsage() const
+            {
+                return EditAction::getMemoryUsage() + relocator.getMemoryUsage() +
+                       vectorMemoryUsage(undo_pitch) + vectorMemoryUsage(undo_fret) +
+                       vectorMemoryUsage(undo_string);
+            }
+            
+            virtual NoteRelocator* getNoteRelocator() { return &relocator; }
         };
     }
 }
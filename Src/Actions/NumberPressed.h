@@ -43,6 +43,13 @@ namespace AriaMaestosa
             void perform();
             void undo();
             virtual ~NumberPressed();
+            
+            virtual long getMemoryUsage() const
+            {
+                return EditAction::getMemoryUsage() + relocator.getMemoryUsage();
+            }
+            
+            virtual NoteRelocator* getNoteRelocator() { return &relocator; }
         };
         
     }
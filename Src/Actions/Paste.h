@@ -46,6 +46,13 @@ namespace AriaMaestosa
             void perform();
             void undo();
             virtual ~Paste();
+            
+            virtual long getMemoryUsage() const
+            {
+                return EditAction::getMemoryUsage() + relocator.getMemoryUsage();
+            }
+            
+            virtual NoteRelocator* getNoteRelocator() { return &relocator; }
         };
     }
 }
@@ -41,6 +41,14 @@ namespace AriaMaestosa
             void perform();
             void undo();
             virtual ~RearrangeNotes();
+            
+            virtual long getMemoryUsage() const
+            {
+                return EditAction::getMemoryUsage() + relocator.getMemoryUsage() + vectorMemoryUsage(fret) +
+                       vectorMemoryUsage(string);
+            }
+            
+            virtual NoteRelocator* getNoteRelocator() { return &relocator; }
         };
         
     }
@@ -41,6 +41,16 @@ Record::~Record()
 
 // ----------------------------------------------------------------------------------------------------------
 
+long Record::getMemoryUsage() const
+{
+    long total = EditAction::getMemoryUsage();
+    const int count = m_actions.size();
+    for (int n=0; n<count; n++) total += m_actions[n].getMemoryUsage();
+    return total;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
 void Record::undo()
 {
     for (int n=m_actions.size() - 1; n >= 0; n--)
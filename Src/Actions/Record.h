@@ -47,6 +47,8 @@ namespace AriaMaestosa
             virtual bool canUndoNow();
             
             virtual ~Record();
+            
+            virtual long getMemoryUsage() const;
         };
         
     }
@@ -39,6 +39,8 @@ RemoveMeasures::RemoveMeasures(int from_measure, int to_measure) :
 {
     m_from_measure = from_measure;
     m_to_measure = to_measure;
+    m_from_tick = 0;
+    m_to_tick = 0;
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -49,41 +51,112 @@ RemoveMeasures::~RemoveMeasures()
 
 // ----------------------------------------------------------------------------------------------------------
 
-RemoveMeasures::RemovedTrackPart::~RemovedTrackPart()
+long RemoveMeasures::getMemoryUsage() const
 {
+    long total = EditAction::getMemoryUsage() + vectorMemoryUsage(removedTempoEvents) +
+                 vectorMemoryUsage(removedTextEvents) + vectorMemoryUsage(timeSigChangesBackup);
+    
+    const int count = removedTrackParts.size();
+    for (int n=0; n<count; n++)
+    {
+        total += sizeof(RemovedTrackPart) + vectorMemoryUsage(removedTrackParts[n].removedNotes) +
+                 vectorMemoryUsage(removedTrackParts[n].removedControlEvents);
+    }
+    return total;
 }
 
 // ----------------------------------------------------------------------------------------------------------
 
-void RemoveMeasures::undo()
+void RemoveMeasures::performOnTrack(const int trackID)
 {
-    Action::InsertEmptyMeasures opposite_action(m_from_measure, (m_to_measure - m_from_measure));
-    opposite_action.setParentSequence( m_sequence, m_visitor->clone() );
-    opposite_action.perform();
+    const int fromTick = m_from_tick;
+    const int toTick   = m_to_tick;
+    const int amountInTicks = toTick - fromTick - 1;
+    
+    RemovedTrackPart* removedBits = removedTrackParts.get(trackID);
+    Track* track = removedBits->track;
+    
+    OwnerPtr<Track::TrackVisitor> tvisitor(m_visitor->getNewTrackVisitor(trackID));
+    ptr_vector<Note>& notes = tvisitor->getNotesVector();
     
-    const int rmtrackamount = removedTrackParts.size();
-    for (int rm=0; rm<rmtrackamount; rm++)
+    // ------------------------ erase/move notes ------------------------
+    const int amount_n = notes.size();
+    for (int n=0; n<amount_n; n++)
     {
-        RemovedTrackPart* removedBits = removedTrackParts.get(rm);
+        Note* note = notes.get(n);
         
-        // add removed notes again
-        const int n_amount = removedBits->removedNotes.size();
-        for (int n=0; n<n_amount; n++)
+        // note is an area that is removed. remove it.
+        if (note->getTick() > fromTick and note->getTick() < toTick)
         {
-            removedBits->track->addNote( removedBits->removedNotes.get(n) );
+            removedBits->removedNotes.push_back(note);
+            track->markNoteToBeRemoved(n);
         }
-        // we are using the notes again, so make sure it won't delete them
-        removedBits->removedNotes.clearWithoutDeleting();
-        
-        // add removed control events again
-        const int c_amount = removedBits->removedControlEvents.size();
-        for (int n=0; n<c_amount; n++)
+        // note is in after the removed area. move it back by necessary amound
+        else if (notes[n].getTick() >= toTick)
         {
-            removedBits->track->addControlEvent( removedBits->removedControlEvents.get(n) );
+            note->setTick( note->getTick() - amountInTicks);
+            note->setEndTick( note->getEndTick() - amountInTicks);
         }
-        // we are using the events again, so make sure it won't delete them
-        removedBits->removedControlEvents.clearWithoutDeleting();
     }
+    track->removeMarkedNotes();
+    
+    // ------------------------ erase/move control events ------------------------
+    
+    ptr_vector<ControllerEvent>& ctrl = tvisitor->getControlEventVector();
+    
+    std::map<int, wxFloat64> latest_value_by_controller;
+    
+    const int c_amount = ctrl.size();
+    for (int n=0; n<c_amount; n++)
+    {
+        // delete all controller events located in the area to be deleted
+        if (ctrl[n].getTick() > fromTick and ctrl[n].getTick() < toTick)
+        {
+            latest_value_by_controller[ctrl[n].getController()] = ctrl[n].getValue();
+            removedBits->removedControlEvents.push_back( ctrl.get(n) );
+            ctrl.markToBeRemoved(n);
+        }
+        // move all controller events that are after given start tick by the necessary amount
+        else if (ctrl[n].getTick() >= toTick)
+        {
+            ctrl[n].setTick(ctrl[n].getTick() - amountInTicks);
+        }
+    }
+    ctrl.removeMarked();
+    
+    // if needed, insert a new event at the end of the deleted section with the latest value
+    // the controller had. This part is not undoable since the additional event doesn't hurt.
+    for (std::map<int, wxFloat64>::iterator it = latest_value_by_controller.begin();
+         it != latest_value_by_controller.end(); it++)
+    {
+         if (track->getControllerEventAt(toTick - amountInTicks, it->first) == NULL)
+         {
+             wxFloat64 previousVal;
+             track->addControlEvent(new ControllerEvent(it->first, toTick - amountInTicks, it->second),
+                                    &previousVal);
+         }
+    }
+    
+    track->reorderNoteVector();
+    track->reorderNoteOffVector();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+RemoveMeasures::RemovedTrackPart::~RemovedTrackPart()
+{
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void RemoveMeasures::undo()
+{
+    Action::InsertEmptyMeasures opposite_action(m_from_measure, (m_to_measure - m_from_measure));
+    opposite_action.setParentSequence( m_sequence, m_visitor->clone() );
+    opposite_action.perform();
+    
+    ASSERT_E(removedTrackParts.size(), ==, m_sequence->getTrackAmount());
+    undoOnAllTracks();
     
     // add removed tempo events again
     const int s_amount = removedTempoEvents.size();
@@ -124,6 +197,31 @@ void RemoveMeasures::undo()
 
 // ----------------------------------------------------------------------------------------------------------
 
+void RemoveMeasures::undoOnTrack(const int trackID)
+{
+    RemovedTrackPart* removedBits = removedTrackParts.get(trackID);
+    
+    // add removed notes again
+    const int n_amount = removedBits->removedNotes.size();
+    for (int n=0; n<n_amount; n++)
+    {
+        removedBits->track->addNote( removedBits->removedNotes.get(n) );
+    }
+    // we are using the notes again, so make sure it won't delete them
+    removedBits->removedNotes.clearWithoutDeleting();
+    
+    // add removed control events again
+    const int c_amount = removedBits->removedControlEvents.size();
+    for (int n=0; n<c_amount; n++)
+    {
+        removedBits->track->addControlEvent( removedBits->removedControlEvents.get(n) );
+    }
+    // we are using the events again, so make sure it won't delete them
+    removedBits->removedControlEvents.clearWithoutDeleting();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
 void RemoveMeasures::perform()
 {
     
@@ -134,84 +232,22 @@ void RemoveMeasures::perform()
     // find the range of ticks that need to be removed (convert measure IDs to midi ticks)
     const int fromTick = md->firstTickInMeasure(m_from_measure) - 1;
     const int toTick   = md->firstTickInMeasure(m_to_measure);
+    m_from_tick = fromTick;
+    m_to_tick   = toTick;
     
     // find the amount of ticks that will be removed. This will be used to move back notes located
     // after the area that is removed.
     const int amountInTicks = toTick - fromTick - 1;
     
+    // undo information is gathered per track, so the tracks can be processed in parallel
     const int trackAmount = m_sequence->getTrackAmount();
     for (int t=0; t<trackAmount; t++)
     {
         RemovedTrackPart* removedBits = new RemovedTrackPart();
+        removedBits->track = m_sequence->getTrack(t);
         removedTrackParts.push_back( removedBits );
-        
-        Track* track = m_sequence->getTrack(t);
-        removedBits->track = track;
-        
-        OwnerPtr<Track::TrackVisitor> tvisitor(m_visitor->getNewTrackVisitor(t));
-        ptr_vector<Note>& notes = tvisitor->getNotesVector();
-        
-        // ------------------------ erase/move notes ------------------------
-        const int amount_n = notes.size();
-        for (int n=0; n<amount_n; n++)
-        {
-            Note* note = notes.get(n);
-            
-            // note is an area that is removed. remove it.
-            if (note->getTick() > fromTick and note->getTick() < toTick)
-            {
-                removedBits->removedNotes.push_back(note);
-                track->markNoteToBeRemoved(n);
-            }
-            // note is in after the removed area. move it back by necessary amound
-            else if (notes[n].getTick() >= toTick)
-            {
-                note->setTick( note->getTick() - amountInTicks);
-                note->setEndTick( note->getEndTick() - amountInTicks);
-            }
-        }
-        track->removeMarkedNotes();
-        
-        // ------------------------ erase/move control events ------------------------
-        
-        ptr_vector<ControllerEvent>& ctrl = tvisitor->getControlEventVector();
-        
-        std::map<int, wxFloat64> latest_value_by_controller;
-        
-        const int c_amount = ctrl.size();
-        for (int n=0; n<c_amount; n++)
-        {
-            // delete all controller events located in the area to be deleted
-            if (ctrl[n].getTick() > fromTick and ctrl[n].getTick() < toTick)
-            {
-                latest_value_by_controller[ctrl[n].getController()] = ctrl[n].getValue();
-                removedBits->removedControlEvents.push_back( ctrl.get(n) );
-                ctrl.markToBeRemoved(n);
-            }
-            // move all controller events that are after given start tick by the necessary amount
-            else if (ctrl[n].getTick() >= toTick)
-            {
-                ctrl[n].setTick(ctrl[n].getTick() - amountInTicks);
-            }
-        }
-        ctrl.removeMarked();
-        
-        // if needed, insert a new event at the end of the deleted section with the latest value
-        // the controller had. This part is not undoable since the additional event doesn't hurt.
-        for (std::map<int, wxFloat64>::iterator it = latest_value_by_controller.begin();
-             it != latest_value_by_controller.end(); it++)
-        {
-             if (track->getControllerEventAt(toTick - amountInTicks, it->first) == NULL)
-             {
-                 wxFloat64 previousVal;
-                 track->addControlEvent(new ControllerEvent(it->first, toTick - amountInTicks, it->second),
-                                        &previousVal);
-             }
-        }
-        
-        track->reorderNoteVector();
-        track->reorderNoteOffVector();
     }
+    performOnAllTracks();
     
     
     // ------------------------ erase/move tempo events ------------------------
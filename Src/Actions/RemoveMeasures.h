@@ -46,15 +46,26 @@ namespace AriaMaestosa
             friend class AriaMaestosa::Track;
             int m_from_measure, m_to_measure;
             
+            /** range of ticks removed, as computed by perform() */
+            int m_from_tick, m_to_tick;
+            
+            /** one per track, in track order */
             ptr_vector<RemovedTrackPart> removedTrackParts;
             ptr_vector<ControllerEvent> removedTempoEvents;
             ptr_vector<TextEvent> removedTextEvents;
             std::vector<TimeSigChange> timeSigChangesBackup;
+            
+        protected:
+            virtual void performOnTrack(const int trackID);
+            virtual void undoOnTrack(const int trackID);
+            
         public:
             RemoveMeasures(int from_measure, int to_measure);
             void perform();
             void undo();
             virtual ~RemoveMeasures();
+            
+            virtual long getMemoryUsage() const;
         };
         
         
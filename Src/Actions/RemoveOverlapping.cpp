@@ -16,17 +16,38 @@
 
 #include "Actions/RemoveOverlapping.h"
 #include "Actions/EditAction.h"
+#include "Midi/Sequence.h"
 #include "Midi/Track.h"
 #include "Midi/Note.h"
 #include "AriaCore.h"
 
+#include "UnitTest.h"
+#include "UnitTestUtils.h"
+
 #include <wx/intl.h>
-#include <wx/utils.h>
+#include <wx/stopwatch.h>
 
-#include <algorithm>
+#include <iostream>
+#include <map>
+#include <set>
 
 using namespace AriaMaestosa::Action;
 
+namespace
+{
+    /** what the sweep remembers about the notes of one pitch that come later in the track */
+    struct PitchSweep
+    {
+        /** earliest start tick of a later note of positive length, or -1 if there is none */
+        int m_first_start;
+        
+        /** earliest start tick of a later zero-length note, or -1 if there is none */
+        int m_first_empty;
+        
+        PitchSweep() : m_first_start(-1), m_first_empty(-1) {}
+    };
+}
+
 
 RemoveOverlapping::RemoveOverlapping() :
     //I18N: (undoable) action name
@@ -52,51 +73,157 @@ void RemoveOverlapping::undo()
 void RemoveOverlapping::perform()
 {
     ASSERT(m_track != NULL);
-    wxBeginBusyCursor();
     
     ptr_vector<Note>& notes = m_visitor->getNotesVector();
     const int noteAmount = notes.size();
     
-    // compare all notes to see if they match
-    for (int n1=0; n1<noteAmount; n1++)
+    // A note is removed when a note of the same pitch that comes after it in the (tick-sorted) vector
+    // overlaps it, so that of overlapping notes only the last one stays. Since all later notes start
+    // at or after the current one, sweeping backwards it is enough to remember, per pitch, the earliest
+    // start of the notes seen so far : they overlap the current note if that start is before its end.
+    // Zero-length notes only overlap zero-length notes on the same tick.
+    std::map<int, PitchSweep> sweep;
+    std::vector<bool> removed(noteAmount, false);
+    
+    for (int n=noteAmount-1; n>=0; n--)
     {
+        ASSERT(n == 0 or notes[n-1].getTick() <= notes[n].getTick());
         
-        for (int n2=0; n2<noteAmount; n2++)
-        {
-            
-            if (n1 == n2) continue; // don't compare a note with itself
-            if (notes.isMarked(n1)) continue; // skip notes already removed
-            if (notes.isMarked(n2)) continue; // skip notes already removed
-            
-            // both notes have the same pitch, they are candidates for overlapping
-            if (notes[n1].getPitchID() == notes[n2].getPitchID())
-            {
-                const int from = std::min(notes[n1].getTick(), notes[n2].getTick());
-                const int to = std::max(notes[n1].getEndTick(), notes[n2].getEndTick());
-                // total length of both notes
-                const int length =  (notes[n1].getEndTick() - notes[n1].getTick()) +
-                (notes[n2].getEndTick() - notes[n2].getTick());
-                
-                // if difference between beginning of first note and ending of second note is smaller than their lengths, then the notes overlap
-                // if they both begin at the same tick they also overlap
-                if ( (to - from < length) or (to - from == 0) )
-                {
-                    removedNotes.push_back(&notes[n1]);
-                    m_track->markNoteToBeRemoved(n1);
-                }
-                
-                
-            }// end if pitches match
-            
-        }//next n2
+        const int start = notes[n].getTick();
+        const int end   = notes[n].getEndTick();
+        PitchSweep& later = sweep[notes[n].getPitchID()];
         
-    }//next n1
+        if (end > start)
+        {
+            removed[n] = (later.m_first_start != -1 and later.m_first_start < end);
+            later.m_first_start = start;
+        }
+        else
+        {
+            removed[n] = (later.m_first_empty == start);
+            later.m_first_empty = start;
+        }
+    }
     
-    m_track->removeMarkedNotes();
-    wxEndBusyCursor();
+    std::set<Note*> removedSet;
+    for (int n=0; n<noteAmount; n++)
+    {
+        if (not removed[n]) continue;
+        removedNotes.push_back(notes.get(n));
+        removedSet.insert(notes.get(n));
+        notes.markToBeRemoved(n);
+    }
+    
+    if (removedSet.empty()) return;
     
-    Display::render();
+    // also remove the corresponding note off events, in a single pass
+    ptr_vector<Note, REF>& noteOff = m_visitor->getNoteOffVector();
+    const int noteOffAmount = noteOff.size();
+    for (int n=0; n<noteOffAmount; n++)
+    {
+        if (removedSet.find(noteOff.get(n)) != removedSet.end()) noteOff.markToBeRemoved(n);
+    }
     
+    m_track->removeMarkedNotes();
 }
 
+// ----------------------------------------------------------------------------------------------------------
+// ----------------------------------------------------------------------------------------------------------
 
+using namespace AriaMaestosa;
+
+namespace TestRemoveOverlapping
+{
+    
+    UNIT_TEST(TestRemove)
+    {
+        Sequence* seq = new Sequence(NULL, NULL, NULL, NULL, false);
+        
+        TestSequenceProvider provider(seq);
+        AriaMaestosa::setCurrentSequenceProvider(&provider);
+        
+        Track* t = new Track(seq);
+        
+        // make a factory sequence to work from
+        {
+            OwnerPtr<Sequence::Import> import(seq->startImport());
+            t->addNote_import(60 /* pitch */, 0   /* start */, 100 /* end */, 127 /* volume */, -1);
+            t->addNote_import(62 /* pitch */, 0   /* start */, 400 /* end */, 127 /* volume */, -1);
+            t->addNote_import(64 /* pitch */, 0   /* start */, 100 /* end */, 127 /* volume */, -1);
+            t->addNote_import(60 /* pitch */, 50  /* start */, 150 /* end */, 127 /* volume */, -1);
+            t->addNote_import(62 /* pitch */, 100 /* start */, 200 /* end */, 127 /* volume */, -1);
+            t->addNote_import(60 /* pitch */, 200 /* start */, 300 /* end */, 127 /* volume */, -1);
+            t->addNote_import(60 /* pitch */, 300 /* start */, 400 /* end */, 127 /* volume */, -1);
+        }
+        require(t->getNoteAmount() == 7, "sanity check"); // sanity check on the way...
+        
+        seq->addTrack(t);
+        
+        // test the action
+        t->action(new RemoveOverlapping());
+        
+        // of overlapping notes the last one stays; notes that merely touch are not overlapping
+        require(t->getNoteAmount() == 5, "overlapping notes were removed");
+        require(t->getNote(0)->getPitchID() == 64,  "other pitches are not affected");
+        require(t->getNote(1)->getTick()    == 50,  "the first of two overlapping notes was removed");
+        require(t->getNote(2)->getTick()    == 100, "a note containing a later note was removed");
+        require(t->getNote(2)->getPitchID() == 62,  "a note containing a later note was removed");
+        require(t->getNote(3)->getTick()    == 200, "adjacent notes were kept");
+        require(t->getNote(4)->getTick()    == 300, "adjacent notes were kept");
+        
+        require(t->getNoteOffVector().size() == 5, "Note off vector was decreased");
+        require(t->getNoteOffVector()[0].getEndTick() == 100, "Note off vector is properly ordered");
+        require(t->getNoteOffVector()[1].getEndTick() == 150, "Note off vector is properly ordered");
+        require(t->getNoteOffVector()[4].getEndTick() == 400, "Note off vector is properly ordered");
+        
+        // Now test undo
+        seq->undo();
+        
+        require(t->getNoteAmount() == 7, "the number of events was restored on undo");
+        require(t->getNoteOffVector().size() == 7, "Note off vector was restored on undo");
+        require(t->getNote(0)->getTick() == 0 and t->getNote(2)->getTick() == 0, "events were properly ordered");
+        require(t->getNote(6)->getTick() == 300, "events were properly ordered");
+        
+        delete seq;
+    }
+    
+    // ----------------------------------------------------------------------------------------------------------
+    
+    UNIT_TEST(BenchmarkRemoveOverlapping)
+    {
+        // what a large drum import looks like : a few pitches, each hit lasting longer than the gap to the next
+        const int PITCH_COUNT = 16;
+        const int HITS        = 2000;
+        
+        Sequence* seq = new Sequence(NULL, NULL, NULL, NULL, false);
+        
+        TestSequenceProvider provider(seq);
+        AriaMaestosa::setCurrentSequenceProvider(&provider);
+        
+        Track* t = new Track(seq);
+        {
+            OwnerPtr<Sequence::Import> import(seq->startImport());
+            for (int hit=0; hit<HITS; hit++)
+            {
+                for (int pitch=0; pitch<PITCH_COUNT; pitch++)
+                {
+                    t->addNote_import(36 + pitch, hit*60, hit*60 + 120, 100, -1);
+                }
+            }
+        }
+        seq->addTrack(t);
+        require(t->getNoteAmount() == PITCH_COUNT*HITS, "sanity check");
+        
+        wxStopWatch timer;
+        t->action(new RemoveOverlapping());
+        const long elapsed = timer.Time();
+        
+        require(t->getNoteAmount() == PITCH_COUNT, "only the last hit of each pitch stays");
+        require(t->getNoteOffVector().size() == PITCH_COUNT, "Note off vector was decreased");
+        
+        std::cout << "[BenchmarkRemoveOverlapping] " << PITCH_COUNT*HITS << " notes processed in "
+                  << elapsed << " ms\n";
+        
+        delete seq;
+    }
+}
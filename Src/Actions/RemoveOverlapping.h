@@ -41,6 +41,11 @@ namespace AriaMaestosa
             void perform();
             void undo();
             virtual ~RemoveOverlapping();
+            
+            virtual long getMemoryUsage() const
+            {
+                return EditAction::getMemoryUsage() + vectorMemoryUsage(removedNotes);
+            }
         };
         
     }
@@ -21,6 +21,7 @@
 #include "Midi/Track.h"
 
 #include <wx/intl.h>
+#include <cstdlib>
 
 using namespace AriaMaestosa::Action;
 
@@ -67,6 +68,7 @@ void ResizeNotes::perform()
     ptr_vector<Note>& notes = m_visitor->getNotesVector();
     
     int last_tick = -1;
+    markEditedNotes(0, -1);
     
     if (m_note_ID == SELECTED_NOTES)
     {        
@@ -77,6 +79,7 @@ void ResizeNotes::perform()
             
             notes[n].resize(m_relative_width);
             relocator.rememberNote(notes[n]);
+            markEditedNotes(notes[n].getTick(), notes[n].getEndTick() + std::abs(m_relative_width));
             
             if (notes[n].getEndTick() > last_tick) last_tick = notes[n].getEndTick();
             
@@ -99,6 +102,7 @@ void ResizeNotes::perform()
         
         last_tick = notes[m_note_ID].getEndTick();
         relocator.rememberNote(notes[m_note_ID]);
+        markEditedNotes(notes[m_note_ID].getTick(), last_tick + std::abs(m_relative_width));
     }
     
     MeasureData* md = m_track->getSequence()->getMeasureData();
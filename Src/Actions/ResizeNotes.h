@@ -41,6 +41,13 @@ namespace AriaMaestosa
             void perform();
             void undo();
             virtual ~ResizeNotes();
+            
+            virtual long getMemoryUsage() const
+            {
+                return EditAction::getMemoryUsage() + relocator.getMemoryUsage();
+            }
+            
+            virtual NoteRelocator* getNoteRelocator() { return &relocator; }
         };
         
     }
@@ -17,11 +17,14 @@
 #include "Actions/ScaleTrack.h"
 #include "Actions/ScaleSong.h"
 #include "Actions/EditAction.h"
+#include "Midi/MeasureData.h"
 #include "Midi/Track.h"
 #include "Midi/Sequence.h"
 
 #include <wx/intl.h>
 
+#include <algorithm>
+
 using namespace AriaMaestosa::Action;
 
 
@@ -37,6 +40,14 @@ ScaleSong::~ScaleSong()
 {
 }
 
+long ScaleSong::getMemoryUsage() const
+{
+    long total = EditAction::getMemoryUsage();
+    const int count = actions.size();
+    for (int n=0; n<count; n++) total += actions[n].getMemoryUsage();
+    return total;
+}
+
 void ScaleSong::perform()
 {
     const int trackAmount = m_sequence->getTrackAmount();
@@ -45,17 +56,35 @@ void ScaleSong::perform()
         Action::ScaleTrack* action = new Action::ScaleTrack(m_factor, m_relative_to, false);
         
         action->setParentTrack(m_sequence->getTrack(t), m_visitor->getNewTrackVisitor(t));
-        action->perform();
         actions.push_back(action);
     }
+    
+    m_last_ticks.assign(trackAmount, -1);
+    performOnAllTracks();
+    
+    // extending the song is left out of the per-track part, since all tracks share it
+    const int last_tick = (trackAmount > 0 ? *std::max_element(m_last_ticks.begin(), m_last_ticks.end()) : -1);
+    m_last_ticks.clear();
+    
+    MeasureData* md = m_sequence->getMeasureData();
+    if (last_tick > md->getTotalTickAmount())
+    {
+        md->extendToTick(last_tick);
+    }
+}
+
+void ScaleSong::performOnTrack(const int trackID)
+{
+    m_last_ticks[trackID] = actions[trackID].scaleNotes();
 }
 
 void ScaleSong::undo()
 {
-    const int amount = actions.size();
-    for (int a=0; a<amount; a++)
-    {
-        actions[a].undo();
-    }
+    undoOnAllTracks();
+}
+
+void ScaleSong::undoOnTrack(const int trackID)
+{
+    actions[trackID].undo();
 }
 
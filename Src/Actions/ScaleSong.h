@@ -35,14 +35,24 @@ namespace AriaMaestosa
             float m_factor;
             int m_relative_to;
             
+            /** one per track, in track order */
             ptr_vector<ScaleTrack> actions;
             
+            /** last tick of the scaled notes of each track, filled by performOnTrack */
+            std::vector<int> m_last_ticks;
+            
+        protected:
+            virtual void performOnTrack(const int trackID);
+            virtual void undoOnTrack(const int trackID);
+            
         public:
             
             ScaleSong(float factor, int relative_to);
             void perform();
             void undo();
             virtual ~ScaleSong();
+            
+            virtual long getMemoryUsage() const;
         };
         
     }
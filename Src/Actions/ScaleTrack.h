@@ -44,8 +44,24 @@ namespace AriaMaestosa
             
             ScaleTrack(float factor, int relative_to, bool selectionOnly);
             void perform();
+            
+            /**
+              * Does what perform() does, except extending the song to fit the scaled notes; since only
+              * the track is touched, it may be called concurrently for different tracks.
+              * @return the last tick of the scaled notes, or -1 if there are none
+              */
+            int scaleNotes();
+            
             void undo();
             virtual ~ScaleTrack();
+            
+            virtual long getMemoryUsage() const
+            {
+                return EditAction::getMemoryUsage() + relocator.getMemoryUsage() +
+                       vectorMemoryUsage(m_note_start) + vectorMemoryUsage(m_note_end);
+            }
+            
+            virtual NoteRelocator* getNoteRelocator() { return &relocator; }
         };
         
     }
@@ -44,6 +44,14 @@ namespace AriaMaestosa
             void perform();
             void undo();
             virtual ~SetAccidentalSign();
+            
+            virtual long getMemoryUsage() const
+            {
+                return EditAction::getMemoryUsage() + relocator.getMemoryUsage() +
+                       vectorMemoryUsage(m_original_signs) + vectorMemoryUsage(m_pitch);
+            }
+            
+            virtual NoteRelocator* getNoteRelocator() { return &relocator; }
         };
     }
 }
@@ -53,6 +53,14 @@ namespace AriaMaestosa
             void perform();
             void undo();
             virtual ~SetNoteVolume();
+            
+            virtual long getMemoryUsage() const
+            {
+                return EditAction::getMemoryUsage() + relocator.getMemoryUsage() +
+                       vectorMemoryUsage(m_volumes);
+            }
+            
+            virtual NoteRelocator* getNoteRelocator() { return &relocator; }
         };
         
     }
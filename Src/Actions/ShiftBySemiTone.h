@@ -44,6 +44,13 @@ namespace AriaMaestosa
             void perform();
             void undo();
             virtual ~ShiftBySemiTone();
+            
+            virtual long getMemoryUsage() const
+            {
+                return EditAction::getMemoryUsage() + m_relocator.getMemoryUsage();
+            }
+            
+            virtual NoteRelocator* getNoteRelocator() { return &m_relocator; }
         };
         
         
@@ -44,6 +44,14 @@ namespace AriaMaestosa
             
             ShiftFrets(const int amount, const int noteID);
             virtual ~ShiftFrets() {}
+            
+            virtual long getMemoryUsage() const
+            {
+                return EditAction::getMemoryUsage() + relocator.getMemoryUsage() +
+                       vectorMemoryUsage(m_frets) + vectorMemoryUsage(m_strings);
+            }
+            
+            virtual NoteRelocator* getNoteRelocator() { return &relocator; }
 
             void perform();
             void undo();
@@ -47,6 +47,14 @@ namespace AriaMaestosa
             void perform();
             void undo();
             virtual ~ShiftString();
+            
+            virtual long getMemoryUsage() const
+            {
+                return EditAction::getMemoryUsage() + m_relocator.getMemoryUsage() +
+                       vectorMemoryUsage(m_frets) + vectorMemoryUsage(m_strings);
+            }
+            
+            virtual NoteRelocator* getNoteRelocator() { return &m_relocator; }
         };
     }
 }
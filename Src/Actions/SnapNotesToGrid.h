@@ -43,6 +43,14 @@ namespace AriaMaestosa
             void perform();
             void undo();
             virtual ~SnapNotesToGrid();
+            
+            virtual long getMemoryUsage() const
+            {
+                return EditAction::getMemoryUsage() + relocator.getMemoryUsage() +
+                       vectorMemoryUsage(note_start) + vectorMemoryUsage(note_end);
+            }
+            
+            virtual NoteRelocator* getNoteRelocator() { return &relocator; }
         };
         
     }
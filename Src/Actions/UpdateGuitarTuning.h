@@ -46,6 +46,15 @@ namespace AriaMaestosa
             void perform();
             void undo();
             virtual ~UpdateGuitarTuning();
+            
+            virtual long getMemoryUsage() const
+            {
+                return EditAction::getMemoryUsage() + relocator.getMemoryUsage() +
+                       vectorMemoryUsage(frets) + vectorMemoryUsage(strings) +
+                       vectorMemoryUsage(previous_tuning);
+            }
+            
+            virtual NoteRelocator* getNoteRelocator() { return &relocator; }
         };
         
         
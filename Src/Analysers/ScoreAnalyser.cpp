@@ -20,7 +20,11 @@
 #include "Editors/ScoreEditor.h"
 #include "Midi/MeasureData.h"
 #include "Midi/Sequence.h"
+#include "UnitTest.h"
+#include "UnitTestUtils.h"
+#include "WorkerPool.h"
 
+#include <algorithm>
 #include <cmath>
 #include <math.h>
 
@@ -413,6 +417,19 @@ void NoteRenderInfo::setY(const int newY)
 ScoreAnalyser::ScoreAnalyser(Editor* parent, int stemPivot)
 {
     m_editor = parent;
+    m_sequence = parent->getSequence();
+    m_stem_pivot = stemPivot;
+
+    stem_height = 5.2;
+    min_stem_height = 4.5;
+}
+
+// -----------------------------------------------------------------------------------------------------------
+
+ScoreAnalyser::ScoreAnalyser(Sequence* sequence, int stemPivot)
+{
+    m_editor = NULL;
+    m_sequence = sequence;
     m_stem_pivot = stemPivot;
 
     stem_height = 5.2;
@@ -430,8 +447,7 @@ void ScoreAnalyser::addToVector( NoteRenderInfo& renderInfo )
 
 void ScoreAnalyser::addToVector( NoteRenderInfo& renderInfo, const bool recursion )
 {
-    Sequence* seq = m_editor->getSequence();
-    MeasureData* md = seq->getMeasureData();
+    MeasureData* md = m_sequence->getMeasureData();
 
     // check if note lasts more than one measure. If so we need to divide it in 2.
     if (renderInfo.m_measure_end > renderInfo.m_measure_begin) 
@@ -475,7 +491,7 @@ void ScoreAnalyser::addToVector( NoteRenderInfo& renderInfo, const bool recursio
     
     // find how to draw notes. how many flags, dotted, triplet, etc.
     // if note duration is unknown it will be split 
-    const int beat = seq->ticksPerQuarterNote();
+    const int beat = m_sequence->ticksPerQuarterNote();
     const float relativeLength = renderInfo.getTickLength() / (float)(beat*4);
     
     renderInfo.m_stem_type = (stemUp(renderInfo.getLevel()) ? STEM_UP : STEM_DOWN);
@@ -604,13 +620,90 @@ void ScoreAnalyser::analyseNoteInfo()
 
 // -----------------------------------------------------------------------------------------------------------
 
-ScoreAnalyser* ScoreAnalyser::getSubset(const int fromTick, const int toTick) const
+ScoreAnalyser* ScoreAnalyser::getEmptyCopy() const
 {
     ScoreAnalyser* out = new ScoreAnalyser();
     out->m_editor        = m_editor;
+    out->m_sequence      = m_sequence;
     out->m_stem_pivot    = m_stem_pivot;
     out->min_stem_height = min_stem_height;
     out->stem_height     = stem_height;
+    return out;
+}
+
+// -----------------------------------------------------------------------------------------------------------
+
+namespace AriaMaestosa
+{
+    bool startsInEarlierMeasure(const NoteRenderInfo& a, const NoteRenderInfo& b)
+    {
+        return a.m_measure_begin < b.m_measure_begin;
+    }
+
+    /** Analyses batches of consecutive measures, each in its own ScoreAnalyser */
+    class MeasureBatchAnalysis : public IParallelTask
+    {
+    public:
+        ptr_vector<ScoreAnalyser> m_batches;
+
+        virtual void runTask(const int id)
+        {
+            m_batches[id].analyseNoteInfo();
+        }
+    };
+}
+
+void ScoreAnalyser::analyseNoteInfoByMeasure()
+{
+    // don't bother splitting work that is over in no time
+    const int MIN_NOTES_PER_BATCH = 64;
+
+    const int noteCount = m_note_render_info.size();
+    const int batchSize = std::max(MIN_NOTES_PER_BATCH,
+                                   noteCount / (WorkerPool::getInstance()->getThreadCount()*4));
+    if (noteCount <= batchSize)
+    {
+        analyseNoteInfo();
+        return;
+    }
+
+    std::stable_sort(m_note_render_info.begin(), m_note_render_info.end(), startsInEarlierMeasure);
+
+    // cut batches at measure bars only
+    MeasureBatchAnalysis task;
+    int from = 0;
+    while (from < noteCount)
+    {
+        int to = std::min(noteCount, from + batchSize);
+        while (to < noteCount and
+               m_note_render_info[to].m_measure_begin == m_note_render_info[to - 1].m_measure_begin)
+        {
+            to++;
+        }
+
+        ScoreAnalyser* batch = getEmptyCopy();
+        batch->m_note_render_info.assign(m_note_render_info.begin() + from, m_note_render_info.begin() + to);
+        task.m_batches.push_back(batch);
+        from = to;
+    }
+
+    WorkerPool::getInstance()->run(&task, task.m_batches.size());
+
+    // merge in batch order, so the result does not depend on scheduling
+    m_note_render_info.clear();
+    const int batchCount = task.m_batches.size();
+    for (int n=0; n<batchCount; n++)
+    {
+        const SortableVector<NoteRenderInfo>& notes = task.m_batches[n].m_note_render_info;
+        m_note_render_info.insert(m_note_render_info.end(), notes.begin(), notes.end());
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------
+
+ScoreAnalyser* ScoreAnalyser::getSubset(const int fromTick, const int toTick) const
+{
+    ScoreAnalyser* out = getEmptyCopy();
         
     // Copy only the note render infos that fit the specified tick range
     // TODO: are the note render infos sorted by tick? If so this could be made faster
@@ -668,9 +761,25 @@ void ScoreAnalyser::putInTimeOrder()
 
 // -----------------------------------------------------------------------------------------------------------
 
+namespace AriaMaestosa
+{
+    bool startsBeforeTick(const NoteRenderInfo& note, const int tick)
+    {
+        return note.getTick() < tick;
+    }
+}
+
+int ScoreAnalyser::findFirstNoteFrom(const int tick) const
+{
+    return std::lower_bound(m_note_render_info.begin(), m_note_render_info.end(), tick, startsBeforeTick) -
+           m_note_render_info.begin();
+}
+
+// -----------------------------------------------------------------------------------------------------------
+
 void ScoreAnalyser::findAndMergeChords()
 {
-    const int beatLen = m_editor->getSequence()->ticksPerQuarterNote();
+    const int beatLen = m_sequence->ticksPerQuarterNote();
     
     /*
      * start by merging notes playing at the same time (chords)
@@ -820,7 +929,7 @@ const bool VERBOSE_ABOUT_TRIPLETS = false;
 void ScoreAnalyser::processTriplets()
 {
     const int visibleNoteAmount = m_note_render_info.size();
-    const int beatLen = m_editor->getSequence()->ticksPerQuarterNote();
+    const int beatLen = m_sequence->ticksPerQuarterNote();
     
     for (int i=0; i<visibleNoteAmount; i++)
     {
@@ -996,8 +1105,11 @@ void ScoreAnalyser::processTriplets()
 
 void ScoreAnalyser::processNoteBeam()
 {
+    // beams are placed through the score editor
+    if (m_editor == NULL) return;
+    
     const int visibleNoteAmount = m_note_render_info.size();
-    const int beatLen = m_editor->getSequence()->ticksPerQuarterNote();
+    const int beatLen = m_sequence->ticksPerQuarterNote();
     
     // beaming
     // all beam information is stored in the first note of the serie.
@@ -1067,3 +1179,96 @@ void ScoreAnalyser::processNoteBeam()
 }
     
 // -----------------------------------------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------------------------------------
+
+namespace
+{
+    bool isBeforeInTimeThenLevel(const NoteRenderInfo& a, const NoteRenderInfo& b)
+    {
+        if (a.getTick() != b.getTick()) return a.getTick() < b.getTick();
+        return a.getLevel() < b.getLevel();
+    }
+}
+
+UNIT_TEST( TestAnalysisByMeasureMatchesSequential )
+{
+    Sequence* seq = new Sequence(NULL, NULL, NULL, NULL, false);
+    
+    TestSequenceProvider provider(seq);
+    AriaMaestosa::setCurrentSequenceProvider(&provider);
+    
+    const int measureCount = 40;
+    MeasureData* md = seq->getMeasureData();
+    {
+        ScopedMeasureTransaction tr(md->startTransaction());
+        tr->setMeasureAmount(measureCount);
+    }
+    
+    // in each measure : a chord, a quarter note, then a triplet or a half note; enough notes to be
+    // split in several batches
+    const int beat = seq->ticksPerQuarterNote();
+    ScoreAnalyser sequential(seq, 30);
+    for (int m=0; m<measureCount; m++)
+    {
+        const int tick = md->firstTickInMeasure(m);
+        NoteRenderInfo notes[] =
+        {
+            NoteRenderInfo(tick,          20,       beat, PITCH_SIGN_NONE, false, 60, m, m),
+            NoteRenderInfo(tick,          24,       beat, PITCH_SIGN_NONE, false, 64, m, m),
+            NoteRenderInfo(tick + beat,   25 + m%5, beat, PITCH_SIGN_NONE, false, 62, m, m),
+        };
+        for (int n=0; n<3; n++) sequential.addToVector(notes[n]);
+        
+        if (m % 2 == 0)
+        {
+            for (int n=0; n<3; n++)
+            {
+                NoteRenderInfo triplet(tick + 2*beat + n*beat*2/3, 22 + n, beat*2/3, PITCH_SIGN_NONE, false, 65,
+                                       m, m);
+                sequential.addToVector(triplet);
+            }
+        }
+        else
+        {
+            NoteRenderInfo half(tick + 2*beat, 32, beat*2, PITCH_SIGN_NONE, false, 55, m, m);
+            sequential.addToVector(half);
+        }
+    }
+    
+    ScoreAnalyser* parallel = sequential.getEmptyCopy();
+    parallel->m_note_render_info = sequential.m_note_render_info;
+    
+    sequential.analyseNoteInfo();
+    parallel->analyseNoteInfoByMeasure();
+    
+    // notes without stems may be ordered differently, the analysis of each note must not
+    std::vector<NoteRenderInfo> expected(sequential.m_note_render_info.begin(),
+                                         sequential.m_note_render_info.end());
+    std::vector<NoteRenderInfo> actual(parallel->m_note_render_info.begin(), parallel->m_note_render_info.end());
+    std::stable_sort(expected.begin(), expected.end(), isBeforeInTimeThenLevel);
+    std::stable_sort(actual.begin(), actual.end(), isBeforeInTimeThenLevel);
+    
+    require_e(actual.size(), ==, expected.size(), "the same notes come out");
+    for (unsigned int n=0; n<expected.size(); n++)
+    {
+        require_e(actual[n].getTick(),      ==, expected[n].getTick(),      "the same notes come out");
+        require_e(actual[n].getLevel(),     ==, expected[n].getLevel(),     "the same notes come out");
+        require_e(actual[n].m_stem_type,    ==, expected[n].m_stem_type,    "stems are the same");
+        require_e(actual[n].m_draw_stem,    ==, expected[n].m_draw_stem,    "stems are the same");
+        require_e(actual[n].m_chord,        ==, expected[n].m_chord,        "chords are the same");
+        require_e(actual[n].m_min_chord_level, ==, expected[n].m_min_chord_level, "chords are the same");
+        require_e(actual[n].m_max_chord_level, ==, expected[n].m_max_chord_level, "chords are the same");
+        require_e(actual[n].m_triplet,      ==, expected[n].m_triplet,      "triplets are the same");
+        require_e(actual[n].m_draw_triplet_sign, ==, expected[n].m_draw_triplet_sign, "triplets are the same");
+        require_e(actual[n].m_triplet_arc_tick_start, ==, expected[n].m_triplet_arc_tick_start,
+                  "triplets are the same");
+        require_e(actual[n].m_triplet_arc_tick_end, ==, expected[n].m_triplet_arc_tick_end,
+                  "triplets are the same");
+        require_e(actual[n].m_flag_amount,  ==, expected[n].m_flag_amount,  "flags are the same");
+        require_e(actual[n].m_dotted,       ==, expected[n].m_dotted,       "dots are the same");
+    }
+    
+    delete parallel;
+    delete seq;
+}
@@ -37,6 +37,7 @@ namespace AriaMaestosa
 {
     class MeasureData;
     class Editor;
+    class Sequence;
     
     enum STEM
     {
@@ -52,7 +53,8 @@ namespace AriaMaestosa
       * A vector of these objects is created inthe first rendering pass.
       * This vector contains one of these for each visible note. This vector is then analysed and used in the
       * next rendering passes. The object starts with a few info fields, passed in the constructors, and builds/tweaks
-      * the others as needed in the next passes. The vector is destroyed and recreated with each render.
+      * the others as needed in the next passes. The score editor keeps the results per measure
+      * (see ScoreAnalysisCache) and only recreates them for measures that changed.
       *
       * A few utility methods will ease setting some variables, but they are usually changed directly from code.
       * @ingroup analysers
@@ -237,8 +239,9 @@ namespace AriaMaestosa
     {
         friend class BeamGroup;
         
-        // REMEMBER: on adding new members, don't forget to update the cloning code in 'getSubset'
+        // REMEMBER: on adding new members, don't forget to update the cloning code in 'getEmptyCopy'
         Editor* m_editor;
+        Sequence* m_sequence;
         int m_stem_pivot;
         
         float stem_height;
@@ -255,6 +258,9 @@ namespace AriaMaestosa
         
         ScoreAnalyser(Editor* parent, int stemPivot);
         
+        /** For analyses made without an editor, e.g. in unit tests; notes are then not beamed */
+        ScoreAnalyser(Sequence* sequence, int stemPivot);
+        
         virtual ~ScoreAnalyser() {}
         
         /**
@@ -263,6 +269,12 @@ namespace AriaMaestosa
          */
         ScoreAnalyser* getSubset(const int fromTick, const int toTick) const;
         
+        /**
+         * @return a new, empty ScoreAnalyser with the same settings as this one
+         * @note   The returned pointer must be freed.
+         */
+        ScoreAnalyser* getEmptyCopy() const;
+        
         float getStemTo(NoteRenderInfo& note);
         
         /** @brief call when you're done rendering the current frame, to prepare to render the next */
@@ -284,6 +296,14 @@ namespace AriaMaestosa
          */
         void analyseNoteInfo();
         
+        /**
+         * @brief same as 'analyseNoteInfo', but analyses groups of measures concurrently on the WorkerPool
+         *
+         * Since notes are split at measure bars and no step of the analysis crosses them, the result is
+         * the same; notes end up grouped by measure, in measure order.
+         */
+        void analyseNoteInfoByMeasure();
+        
         /** @brief set the level below which the stem is up, and above which it is down */
         void setStemPivot(const int level);
         
@@ -296,6 +316,13 @@ namespace AriaMaestosa
          */
         void putInTimeOrder();
         
+        /**
+         * @return the index of the first note that starts at or after the given tick, or the number of notes
+         *         if there is none
+         * @pre    notes are in time order ('doneAdding' or 'putInTimeOrder' was called)
+         */
+        int findFirstNoteFrom(const int tick) const;
+        
         /** Get whether a note at the given level should have its stem up (if false, then down) */
         bool stemUp(const int level) const { return level >= m_stem_pivot; }
         
@@ -0,0 +1,309 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "Analysers/ScoreAnalysisCache.h"
+
+#include "Midi/MeasureData.h"
+#include "Midi/Sequence.h"
+#include "UnitTest.h"
+#include "UnitTestUtils.h"
+#include "WorkerPool.h"
+
+namespace AriaMaestosa
+{
+    /** Analyses one clef of one measure per task, each with its own scratch analyser */
+    class MeasureAnalysisTask : public IParallelTask
+    {
+    public:
+        const ScoreAnalysisCache* m_cache;
+        std::vector<ScoreAnalysisCache::MeasureAnalysis*> m_analyses;
+        std::vector<int> m_measures;
+        ptr_vector<ScoreAnalyser> m_scratch[SCORE_CLEF_COUNT];
+
+        virtual void runTask(const int id)
+        {
+            const int clef = id % SCORE_CLEF_COUNT;
+            const int item = id / SCORE_CLEF_COUNT;
+            m_cache->analyseMeasure(*m_analyses[item], m_measures[item], clef, m_scratch[clef].get(item));
+        }
+    };
+}
+
+using namespace AriaMaestosa;
+
+// -----------------------------------------------------------------------------------------------------------
+
+ScoreAnalysisCache::ScoreAnalysisCache(const Track* track)
+{
+    m_track = track;
+    m_used  = true;
+    m_analysed_count = 0;
+}
+
+// -----------------------------------------------------------------------------------------------------------
+
+bool ScoreAnalysisCache::hasSameLayout(const MeasureAnalysis& analysis, const int measure,
+                                       const MeasureData* md) const
+{
+    return analysis.m_first_tick == md->firstTickInMeasure(measure) and
+           analysis.m_last_tick  == md->lastTickInMeasure(measure)  and
+           analysis.m_num        == md->getTimeSigNumerator(measure) and
+           analysis.m_denom      == md->getTimeSigDenominator(measure);
+}
+
+// -----------------------------------------------------------------------------------------------------------
+
+unsigned int ScoreAnalysisCache::fingerprint(const int measure) const
+{
+    // FNV-1a over everything addToVector looks at, for the notes that overlap this measure
+    unsigned int hash = 2166136261u;
+
+    for (int clef=0; clef<SCORE_CLEF_COUNT; clef++)
+    {
+        const std::vector<NoteRenderInfo>& input = m_input[clef];
+        const int count = input.size();
+
+        hash = (hash ^ (unsigned int)clef) * 16777619u;
+        for (int n=0; n<count; n++)
+        {
+            const NoteRenderInfo& note = input[n];
+            if (note.m_measure_begin > measure or note.m_measure_end < measure) continue;
+
+            const int fields[] = { note.getTick(), note.getTickLength(), note.getLevel(), note.m_sign,
+                                   note.m_selected, note.m_pitch };
+            for (int f=0; f<6; f++) hash = (hash ^ (unsigned int)fields[f]) * 16777619u;
+        }
+    }
+    return hash;
+}
+
+// -----------------------------------------------------------------------------------------------------------
+
+void ScoreAnalysisCache::analyseMeasure(MeasureAnalysis& analysis, const int measure, const int clef,
+                                        ScoreAnalyser* analyser) const
+{
+    // notes that started in an earlier measure are split by addToVector; keep only our part
+    analyser->clearAndPrepare();
+    const int count = m_input[clef].size();
+    for (int n=0; n<count; n++)
+    {
+        if (m_input[clef][n].m_measure_begin > measure or m_input[clef][n].m_measure_end < measure) continue;
+
+        NoteRenderInfo note = m_input[clef][n];
+        analyser->addToVector(note);
+    }
+    analyser->doneAdding();
+
+    std::vector<NoteRenderInfo>& notes = analysis.m_notes[clef];
+    notes.clear();
+    const int added = analyser->m_note_render_info.size();
+    for (int n=0; n<added; n++)
+    {
+        if (analyser->m_note_render_info[n].m_measure_begin == measure)
+        {
+            notes.push_back(analyser->m_note_render_info[n]);
+        }
+    }
+
+    analyser->clearAndPrepare();
+    analyser->m_note_render_info.insert(analyser->m_note_render_info.end(), notes.begin(), notes.end());
+    analyser->analyseNoteInfo();
+
+    analysis.m_analysed[clef].assign(analyser->m_note_render_info.begin(),
+                                     analyser->m_note_render_info.end());
+}
+
+// -----------------------------------------------------------------------------------------------------------
+
+bool ScoreAnalysisCache::isUpToDate(const int firstMeasure, const int lastMeasure,
+                                    const unsigned int generation, const unsigned int settings,
+                                    const MeasureData* md) const
+{
+    for (int measure=firstMeasure; measure<=lastMeasure; measure++)
+    {
+        std::map<int, MeasureAnalysis>::const_iterator it = m_measures.find(measure);
+        if (it == m_measures.end()) return false;
+
+        const MeasureAnalysis& analysis = it->second;
+        if (analysis.m_generation != generation or analysis.m_settings != settings) return false;
+        if (not hasSameLayout(analysis, measure, md)) return false;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------
+
+void ScoreAnalysisCache::clearInput()
+{
+    for (int clef=0; clef<SCORE_CLEF_COUNT; clef++) m_input[clef].clear();
+}
+
+// -----------------------------------------------------------------------------------------------------------
+
+void ScoreAnalysisCache::addInput(const ScoreClef clef, const NoteRenderInfo& note)
+{
+    m_input[clef].push_back(note);
+}
+
+// -----------------------------------------------------------------------------------------------------------
+
+void ScoreAnalysisCache::update(const int firstMeasure, const int lastMeasure, const unsigned int generation,
+                                const unsigned int settings, const MeasureData* md, ScoreAnalyser* analysers[])
+{
+    MeasureAnalysisTask task;
+    task.m_cache = this;
+
+    // measures were removed; what is kept past the end would never be used or checked again
+    m_measures.erase(m_measures.lower_bound(md->getMeasureAmount()), m_measures.end());
+
+    for (int measure=firstMeasure; measure<=lastMeasure; measure++)
+    {
+        const unsigned int hash = fingerprint(measure);
+
+        std::map<int, MeasureAnalysis>::iterator it = m_measures.find(measure);
+        if (it != m_measures.end() and (it->second.m_settings != settings or it->second.m_fingerprint != hash or
+                                        not hasSameLayout(it->second, measure, md)))
+        {
+            // the measure was edited, or another one took its place; keep nothing from before
+            m_measures.erase(it);
+            it = m_measures.end();
+        }
+        const bool known = (it != m_measures.end());
+
+        MeasureAnalysis& analysis = m_measures[measure];
+
+        if (not known)
+        {
+            m_analysed_count++;
+            analysis.m_settings    = settings;
+            analysis.m_fingerprint = hash;
+            analysis.m_first_tick  = md->firstTickInMeasure(measure);
+            analysis.m_last_tick   = md->lastTickInMeasure(measure);
+            analysis.m_num         = md->getTimeSigNumerator(measure);
+            analysis.m_denom       = md->getTimeSigDenominator(measure);
+
+            task.m_analyses.push_back(&analysis);
+            task.m_measures.push_back(measure);
+            for (int clef=0; clef<SCORE_CLEF_COUNT; clef++)
+            {
+                task.m_scratch[clef].push_back(analysers[clef]->getEmptyCopy());
+            }
+        }
+
+        analysis.m_generation = generation;
+    }
+
+    // each task only writes to its own measure and clef, std::map elements don't move
+    WorkerPool::getInstance()->run(&task, task.m_measures.size()*SCORE_CLEF_COUNT);
+}
+
+// -----------------------------------------------------------------------------------------------------------
+
+void ScoreAnalysisCache::fill(const ScoreClef clef, const int firstMeasure, const int lastMeasure,
+                              const bool analysed, ScoreAnalyser* target) const
+{
+    target->clearAndPrepare();
+
+    for (int measure=firstMeasure; measure<=lastMeasure; measure++)
+    {
+        std::map<int, MeasureAnalysis>::const_iterator it = m_measures.find(measure);
+        if (it == m_measures.end()) continue;
+
+        const std::vector<NoteRenderInfo>& notes = (analysed ? it->second.m_analysed[clef] :
+                                                               it->second.m_notes[clef]);
+        target->m_note_render_info.insert(target->m_note_render_info.end(), notes.begin(), notes.end());
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------
+
+namespace
+{
+    /** Gives the cache a quarter note on each beat of the first 'measures' measures, with a higher one in
+      * 'raisedMeasure' */
+    void giveQuarterNotes(ScoreAnalysisCache& cache, MeasureData* md, const int measures, const int raisedMeasure)
+    {
+        const int beat = md->getSequence()->ticksPerQuarterNote();
+
+        cache.clearInput();
+        for (int measure=0; measure<measures; measure++)
+        {
+            const int level = (measure == raisedMeasure ? 20 : 27);
+            for (int n=0; n<4; n++)
+            {
+                const int tick = md->firstTickInMeasure(measure) + n*beat;
+                cache.addInput(SCORE_G_CLEF, NoteRenderInfo(tick, level, beat, PITCH_SIGN_NONE, false, 60,
+                                                            measure, measure));
+            }
+        }
+    }
+}
+
+UNIT_TEST( TestScoreAnalysisCacheHitsAndMisses )
+{
+    Sequence* seq = new Sequence(NULL, NULL, NULL, NULL, false);
+
+    TestSequenceProvider provider(seq);
+    AriaMaestosa::setCurrentSequenceProvider(&provider);
+
+    MeasureData* md = seq->getMeasureData();
+    {
+        ScopedMeasureTransaction tr(md->startTransaction());
+        tr->setMeasureAmount(8);
+    }
+
+    ScoreAnalyser gClef(seq, 30);
+    ScoreAnalyser fClef(seq, 30);
+    ScoreAnalyser* analysers[] = { &gClef, &fClef };
+
+    ScoreAnalysisCache cache(NULL);
+
+    giveQuarterNotes(cache, md, 8, -1);
+    cache.update(0, 7, 1 /* generation */, 0 /* settings */, md, analysers);
+    require_e(cache.getAnalysedMeasureCount(), ==, 8, "every measure is analysed the first time");
+    require(cache.isUpToDate(0, 7, 1, 0, md), "the analysis is known for the generation it was made for");
+    require(not cache.isUpToDate(0, 7, 2, 0, md), "a new generation needs the notes to be checked");
+
+    // the track changed, but not these measures
+    cache.update(0, 7, 2, 0, md, analysers);
+    require_e(cache.getAnalysedMeasureCount(), ==, 8, "measures with the same notes are not analysed again");
+
+    giveQuarterNotes(cache, md, 8, 3);
+    cache.update(0, 7, 3, 0, md, analysers);
+    require_e(cache.getAnalysedMeasureCount(), ==, 9, "only the edited measure is analysed again");
+
+    ScoreAnalyser result(seq, 30);
+    cache.fill(SCORE_G_CLEF, 3, 3, true, &result);
+    require_e(result.m_note_render_info.size(), ==, 4u, "the edited measure has its notes");
+    require_e(result.m_note_render_info[0].getLevel(), ==, 20, "the edited measure has its new notes");
+
+    cache.update(0, 7, 4, 1, md, analysers);
+    require_e(cache.getAnalysedMeasureCount(), ==, 17, "a change of settings invalidates every measure");
+
+    // measures removed at the end are forgotten
+    {
+        ScopedMeasureTransaction tr(md->startTransaction());
+        tr->setMeasureAmount(4);
+    }
+    giveQuarterNotes(cache, md, 4, 3);
+    cache.update(0, 3, 5, 1, md, analysers);
+    require_e(cache.getAnalysedMeasureCount(), ==, 17, "the measures left are still known");
+
+    cache.fill(SCORE_G_CLEF, 0, 7, false, &result);
+    require_e(result.m_note_render_info.size(), ==, 16u, "nothing is kept for the measures removed");
+
+    delete seq;
+}
@@ -0,0 +1,140 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __SCORE_ANALYSIS_CACHE_H__
+#define __SCORE_ANALYSIS_CACHE_H__
+
+#include "Analysers/ScoreAnalyser.h"
+#include "Utils.h"
+
+#include <map>
+#include <vector>
+
+namespace AriaMaestosa
+{
+    class MeasureData;
+    class Track;
+
+    enum ScoreClef
+    {
+        SCORE_G_CLEF = 0,
+        SCORE_F_CLEF = 1,
+        SCORE_CLEF_COUNT = 2
+    };
+
+    /**
+      * @brief Keeps the results of ScoreAnalyser for the measures of one track, so they are not
+      *        recomputed every frame
+      *
+      * Since notes are split at measure bars and chords, triplets and beams never cross them, every
+      * measure can be analysed on its own. Each cached measure remembers the edit generation of the
+      * track it was last checked against; when the track changes, the notes given to the cache for
+      * a measure are compared (through a fingerprint) with those it was analysed from, so only the
+      * measures that were actually touched are analysed again.
+      *
+      * @ingroup analysers
+      */
+    class ScoreAnalysisCache
+    {
+        struct MeasureAnalysis
+        {
+            unsigned int m_generation;
+            unsigned int m_settings;
+            unsigned int m_fingerprint;
+
+            /** layout of the measure the analysis was made for; time signature changes invalidate it */
+            int m_first_tick, m_last_tick;
+            int m_num, m_denom;
+
+            /** notes as they come out of ScoreAnalyser::addToVector, i.e. before analyseNoteInfo */
+            std::vector<NoteRenderInfo> m_notes[SCORE_CLEF_COUNT];
+
+            /** notes after analyseNoteInfo */
+            std::vector<NoteRenderInfo> m_analysed[SCORE_CLEF_COUNT];
+        };
+
+        const Track* m_track;
+
+        std::map<int, MeasureAnalysis> m_measures;
+
+        /** notes given through addInput since the last call to clearInput */
+        std::vector<NoteRenderInfo> m_input[SCORE_CLEF_COUNT];
+
+        bool m_used;
+
+        /** how many measures were analysed (counting both clefs once) since the cache was created */
+        int m_analysed_count;
+
+        bool hasSameLayout(const MeasureAnalysis& analysis, const int measure, const MeasureData* md) const;
+
+        unsigned int fingerprint(const int measure) const;
+
+        friend class MeasureAnalysisTask;
+
+        /** Analyses one clef of one measure; may run on any thread */
+        void analyseMeasure(MeasureAnalysis& analysis, const int measure, const int clef,
+                            ScoreAnalyser* analyser) const;
+
+    public:
+        LEAK_CHECK();
+
+        ScoreAnalysisCache(const Track* track);
+
+        const Track* getTrack() const { return m_track; }
+
+        int getAnalysedMeasureCount() const { return m_analysed_count; }
+
+        /** Used by owners to find caches of tracks that are no longer displayed */
+        bool isUsed() const        { return m_used; }
+        void setUsed(const bool used) { m_used = used; }
+
+        /**
+          * @return whether the analysis of all measures in [firstMeasure, lastMeasure] is known for the
+          *         given generation and settings; if it is, there is no need to give the notes with addInput
+          * @param settings  any value that changes when analysis settings do (key, octave shift, ...)
+          */
+        bool isUpToDate(const int firstMeasure, const int lastMeasure, const unsigned int generation,
+                        const unsigned int settings, const MeasureData* md) const;
+
+        void clearInput();
+
+        /** Gives a visible note, as it would be passed to ScoreAnalyser::addToVector. Add notes in time order. */
+        void addInput(const ScoreClef clef, const NoteRenderInfo& note);
+
+        /**
+          * @brief Brings the analysis of [firstMeasure, lastMeasure] up to date with the notes given
+          *        through addInput, re-analysing only measures whose notes, layout or settings changed
+          *
+          * Measures past the end of the song are forgotten.
+          *
+          * Measures and clefs that need to be analysed are spread over the WorkerPool.
+          *
+          * @param analysers  analysers (one per clef, with the appropriate stem pivot) whose settings are used
+          */
+        void update(const int firstMeasure, const int lastMeasure, const unsigned int generation,
+                    const unsigned int settings, const MeasureData* md, ScoreAnalyser* analysers[]);
+
+        /**
+          * @brief Fills 'target' with the cached notes of the given clef over [firstMeasure, lastMeasure]
+          * @param analysed  whether to get the notes after analyseNoteInfo, or as they were before
+          */
+        void fill(const ScoreClef clef, const int firstMeasure, const int lastMeasure, const bool analysed,
+                  ScoreAnalyser* target) const;
+    };
+
+}
+
+#endif
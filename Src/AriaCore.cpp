@@ -50,11 +50,6 @@ namespace AriaMaestosa
             mainPane = pane;
         }
         
-        void activateRenderLoop(bool on)
-        {
-            wxGetApp().activateRenderLoop(on);
-        }
-                
         TuningPicker* getTuningPicker()
         {
             return getMainFrame()->getTuningPicker();
@@ -138,6 +133,14 @@ namespace AriaMaestosa
         {
             return mainPane->getHeight();
         }
+        float getScaleFactor()
+        {
+#if wxCHECK_VERSION(2,9,5)
+            return mainPane->GetContentScaleFactor();
+#else
+            return 1.0f;
+#endif
+        }
         bool isMouseDown()
         {
             return mainPane->isMouseDown();
@@ -75,7 +75,6 @@ namespace AriaMaestosa
     
     namespace Core
     {
-        void activateRenderLoop(bool on);
         void setMainPane(MainPane* pane);
         
         PlayDuringEditMode playDuringEdit();
@@ -97,6 +96,10 @@ namespace AriaMaestosa
         void render();
         int getWidth();
         int getHeight();
+
+        /** @return physical pixels per logical pixel of the main pane (e.g. 2 on hi-DPI displays) */
+        float getScaleFactor();
+
         bool isMouseDown();
         bool isSelectLessPressed();
         bool isSelectMorePressed();
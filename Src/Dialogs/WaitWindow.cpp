@@ -152,7 +152,8 @@ namespace AriaMaestosa
         
         void setProgress(int progress)
         {
-            waitWindow->setProgress( progress );
+            // layout code reports progress even when there is no window, e.g. on --export-score
+            if (waitWindow != NULL) waitWindow->setProgress( progress );
         }
         
         void hide()
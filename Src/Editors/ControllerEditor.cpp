@@ -294,8 +294,14 @@ void ControllerEditor::renderEvents()
 
     const int currentController = m_controller_choice->getControllerID();
 
-    const int eventAmount = m_track->getControllerEventAmount(currentController == PSEUDO_CONTROLLER_LYRICS,
-                                                              Track::isTempoController(currentController) );
+    const bool inLane = (currentController != PSEUDO_CONTROLLER_LYRICS and
+                         not Track::isTempoController(currentController));
+    
+    // tempo and lyrics are stored in the sequence, other controllers have their own lane in the track
+    const std::vector<ControllerEvent*>* lane = (inLane ? &m_track->getControllerLane(currentController) : NULL);
+    const int eventAmount = (inLane ? (int)lane->size() :
+                             m_track->getControllerEventAmount(currentController == PSEUDO_CONTROLLER_LYRICS,
+                                                               Track::isTempoController(currentController)));
     
     if (currentController == PSEUDO_CONTROLLER_LYRICS or
         currentController == PSEUDO_CONTROLLER_INSTRUMENT_CHANGE or
@@ -307,9 +313,25 @@ void ControllerEditor::renderEvents()
     const int x_scroll = m_gsequence->getXScrollInPixels();
     int eventsOfThisType = 0;
     
-    for (int n=0; n<eventAmount; n++)
+    // skip the events scrolled out on the left (keeping the last one, from which a line is drawn); labels
+    // of instrument changes may be visible up to 200 pixels after their event
+    int firstEvent = 0;
+    if (inLane)
+    {
+        int to = eventAmount;
+        while (firstEvent < to)
+        {
+            const int middle = (firstEvent + to)/2;
+            const int xloc = ControllerEditor::getPositionInPixels((*lane)[middle]->getTick(), m_gsequence);
+            if (xloc - x_scroll <= Editor::getEditorXStart() - 200) firstEvent = middle + 1;
+            else                                                    to = middle;
+        }
+        firstEvent = std::max(0, firstEvent - 1);
+    }
+    
+    for (int n=firstEvent; n<eventAmount; n++)
     {        
-        tmp = m_track->getControllerEvent(n, currentController);
+        tmp = (inLane ? (*lane)[n] : m_track->getControllerEvent(n, currentController));
         if (tmp->getController() != currentController) continue; // only draw events of this controller
         eventsOfThisType++;
         
@@ -953,13 +975,13 @@ void ControllerEditor::rightClick(RelativeXCoord x, const int y)
         {
             const int instruments_y = (area_from_y + area_to_y + area_to_y)/3;
             
-            const int eventAmount = m_track->getControllerEventAmount();
+            const std::vector<ControllerEvent*>& lane =
+                    m_track->getControllerLane(PSEUDO_CONTROLLER_INSTRUMENT_CHANGE);
+            const int eventAmount = lane.size();
             ControllerEvent* eventToDelete = NULL;
             for (int n=0; n<eventAmount; n++)
             {     
-                ControllerEvent* evt = m_track->getControllerEvent(n, PSEUDO_CONTROLLER_INSTRUMENT_CHANGE);
-                
-                if (evt->getController() != PSEUDO_CONTROLLER_INSTRUMENT_CHANGE) continue;
+                ControllerEvent* evt = lane[n];
                 
                 const int xloc = ControllerEditor::getPositionInPixels(evt->getTick(), m_gsequence);
 
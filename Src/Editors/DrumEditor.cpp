@@ -27,6 +27,7 @@
 #include "GUI/GraphicalSequence.h"
 #include "GUI/GraphicalTrack.h"
 #include "GUI/ImageProvider.h"
+#include "GUI/NoteSummaryPyramid.h"
 #include "Midi/Players/PlatformMidiManager.h"
 #include "Midi/Track.h"
 #include "Midi/Sequence.h"
@@ -905,8 +906,52 @@ void DrumEditor::render(RelativeXCoord mousex_current, int mousey_current,
     const int mouse_y1 = std::min(mousey_current, mousey_initial);
     const int mouse_y2 = std::max(mousey_current, mousey_initial);
     
+    // when zoomed out so much that notes are sub-pixel, draw per-column summaries instead of individual notes
+    NoteSummaryPyramid* summaries = m_graphical_track->getNoteSummary();
+    const bool useSummary = summaries->shouldUseAtZoom(m_gsequence->getZoom());
+    if (useSummary)
+    {
+        const float zoom    = m_gsequence->getZoom();
+        const int   xscroll = m_gsequence->getXScrollInPixels();
+        
+        int sliceTicks;
+        const std::vector<NoteSummary>& slices = summaries->getLevelForZoom(zoom, &sliceTicks);
+        const int sliceCount = slices.size();
+        
+        // getYForDrum walks the drum list, so resolve each key only once per frame
+        int drumYForKey[128];
+        for (int key=0; key<128; key++)
+        {
+            drumYForKey[key] = (m_midi_key_to_vector_ID[key] == -1 ? -1 : getYForDrum(m_midi_key_to_vector_ID[key]));
+        }
+        
+        AriaRender::color(0.35f, 0.35f, 0.35f);
+        
+        for (int slice=std::max(0, (int)(xscroll/zoom) / sliceTicks); slice<sliceCount; slice++)
+        {
+            const int x1 = (int)(slice*sliceTicks*zoom) - xscroll + Editor::getEditorXStart();
+            if (x1 > m_width) break;
+            
+            const NoteSummary& summary = slices[slice];
+            if (summary.isEmpty()) continue;
+            
+            const int x2 = std::max(x1 + 1, (int)((slice + 1)*sliceTicks*zoom) - xscroll + Editor::getEditorXStart());
+            
+            const int to = std::min(127, (int)summary.m_max_pitch);
+            for (int pitch=summary.m_min_pitch; pitch<=to; pitch++)
+            {
+                if (not summary.hasPitch(pitch)) continue;
+                
+                const int drumy = drumYForKey[pitch];
+                if (drumy == -1 or drumy + Y_STEP < getEditorYStart() or drumy > getYEnd()) continue;
+                
+                AriaRender::rect(x1, drumy, x2, drumy+Y_STEP);
+            }
+        }
+    }
+    
     const int noteAmount = m_track->getNoteAmount();
-    for (int n=0; n<noteAmount; n++)
+    for (int n=0; n<(useSummary ? 0 : noteAmount); n++)
     {
         const int drumx = m_graphical_track->getNoteStartInPixels(n) - m_gsequence->getXScrollInPixels() +
                           Editor::getEditorXStart();
@@ -147,32 +147,32 @@ void Editor::drawVerticalMeasureLines(const int from_y, const int to_y)
     const int startMeasure  = mb->measureAtPixel(Editor::getEditorXStart());
     const int measureAmount = md->getMeasureAmount();
     
-    float mx;
-    float beatLength;
+    // beats are placed from their tick, so rounding does not add up across measures
+    const float zoom      = m_gsequence->getZoom();
+    const int   startTick = md->firstTickInMeasure(startMeasure);
+    const float startX    = mb->firstPixelInMeasure(startMeasure);
+    
+    float mx = startX;
+    float beatLength = 0;
     int beatCount;
     int beat;
 
-
-    mx = mb->firstPixelInMeasure(startMeasure);
-    
     for (int m=startMeasure; m<measureAmount; m++)
     {
-        beatLength = (float)(m_sequence->ticksPerQuarterNote() 
-                            * m_gsequence->getZoom()
-                            * md->getBeatSize(m));
+        beatLength = md->beatLengthInTicks(m) * zoom;
                                     
-        beatCount = md->getBeatCount(m)-1;
-        mx += beatLength;
+        beatCount = md->getBeatCount(m);
         
         // draw pale lines
         setPaleLineColor();
-        for (beat=0 ; beat<beatCount ; beat++)
+        for (beat=1 ; beat<beatCount ; beat++)
         {
+            mx = startX + (md->firstTickInBeat(m, beat) - startTick)*zoom;
             AriaRender::line( (int)round(mx), from_y, (int)round(mx), to_y);
-            mx+=beatLength;
         }
         
         // draw strong line
+        mx = startX + (md->firstTickInBeat(m, beatCount) - startTick)*zoom;
         setStrongLineColor();
         AriaRender::line((int)round(mx), from_y, (int)round(mx), to_y);
         
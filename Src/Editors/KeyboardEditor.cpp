@@ -31,6 +31,7 @@
 #include "GUI/GraphicalTrack.h"
 #include "GUI/ImageProvider.h"
 #include "GUI/MainFrame.h"
+#include "GUI/NoteSummaryPyramid.h"
 #include "Midi/Players/PlatformMidiManager.h"
 #include "Midi/Sequence.h"
 #include "Midi/Track.h"
@@ -190,18 +191,22 @@ NoteSearchResult KeyboardEditor::noteAt(RelativeXCoord x, const int y, int& note
 {
     const int x_edit = x.getRelativeTo(EDITOR);
 
-    const int noteAmount = m_track->getNoteAmount();
+    const NoteHotData& hot = m_track->getNoteHotData();
+    const float zoom = m_gsequence->getZoom();
+    const int xscroll = m_gsequence->getXScrollInPixels();
+
+    const int noteAmount = hot.size();
     for (int n=0; n<noteAmount; n++)
     {
-        const int x1 = m_graphical_track->getNoteStartInPixels(n) - m_gsequence->getXScrollInPixels();
-        const int x2 = m_graphical_track->getNoteEndInPixels(n)   - m_gsequence->getXScrollInPixels();
-        const int y1 = m_track->getNotePitchID(n)*m_y_step + getEditorYStart() - getYScrollInPixels();
+        const int x1 = (int)((float)hot.m_start[n] * zoom) - xscroll;
+        const int x2 = (int)((float)hot.m_end[n]   * zoom) - xscroll;
+        const int y1 = hot.m_pitch[n]*m_y_step + getEditorYStart() - getYScrollInPixels();
 
         if (x_edit > x1 and x_edit < x2 and y > y1 and y < y1+12)
         {
             noteID = n;
 
-            if (m_track->isNoteSelected(n) and not Display::isSelectLessPressed())
+            if (hot.m_selected[n] and not Display::isSelectLessPressed())
             {
                 // clicked on a selected note
                 return FOUND_SELECTED_NOTE;
@@ -229,23 +234,25 @@ void KeyboardEditor::selectNotesInRect(RelativeXCoord& mousex_current, int mouse
     const int mouse_y_max = std::max( mousey_current, mousey_initial );
     const int xscroll = m_gsequence->getXScrollInPixels();
     
-    const int count = m_track->getNoteAmount();
+    const float zoom = m_gsequence->getZoom();
+    
+    // decide for all notes first, since selecting notes invalidates the track's hot data
+    const NoteHotData& hot = m_track->getNoteHotData();
+    const int count = hot.size();
+    std::vector<unsigned char> inside(count);
     for (int n=0; n<count; n++)
     {
-        int x1        = m_graphical_track->getNoteStartInPixels(n);
-        int x2        = m_graphical_track->getNoteEndInPixels(n);
-        int from_note = m_track->getNotePitchID(n);
-        const int y   = levelToY(from_note);
+        const int x1 = (int)((float)hot.m_start[n] * zoom);
+        const int x2 = (int)((float)hot.m_end[n]   * zoom);
+        const int y  = levelToY(hot.m_pitch[n]);
 
-        if (x1 > mouse_x_min + xscroll and x2 < mouse_x_max + xscroll and
-            y + m_y_step/2 > mouse_y_min and y + m_y_step/2 < mouse_y_max )
-        {
-            m_graphical_track->selectNote(n, true);
-        }
-        else
-        {
-            m_graphical_track->selectNote(n, false);
-        }
+        inside[n] = (x1 > mouse_x_min + xscroll and x2 < mouse_x_max + xscroll and
+                     y + m_y_step/2 > mouse_y_min and y + m_y_step/2 < mouse_y_max);
+    }
+    
+    for (int n=0; n<count; n++)
+    {
+        m_graphical_track->selectNote(n, inside[n] != 0);
     }//next
 
 }
@@ -491,6 +498,12 @@ void KeyboardEditor::render(RelativeXCoord mousex_current, int mousey_current,
             const int noteAmount = otherTrack->getNoteAmount();
             
             ariaColor = pickColor(colorIndex);
+            
+            if (otherGTrack->getNoteSummary()->shouldUseAtZoom(m_gsequence->getZoom()))
+            {
+                renderNoteSummary(otherGTrack, ariaColor);
+                continue;
+            }
         
             // render the notes
             for (int n=0; n<noteAmount; n++)
@@ -534,20 +547,41 @@ void KeyboardEditor::render(RelativeXCoord mousex_current, int mousey_current,
     const int mouse_y_min = std::min(mousey_current, mousey_initial);
     const int mouse_y_max = std::max(mousey_current, mousey_initial);
 
-    const int noteAmount = m_track->getNoteAmount();
-    for (int n=0; n<noteAmount; n++)
+    // when zoomed out so much that notes are sub-pixel, draw summaries instead of individual notes
+    const bool useSummary = m_graphical_track->getNoteSummary()->shouldUseAtZoom(m_gsequence->getZoom());
+    if (useSummary)
+    {
+        ariaColor.set(0.35f, 0.35f, 0.35f, 1.0f);
+        renderNoteSummary(m_graphical_track, ariaColor);
+    }
+    
+    const NoteHotData& hot = m_track->getNoteHotData();
+    const float zoom = m_gsequence->getZoom();
+
+    // only look at notes around the visible area (with some margin, the exact test is done below)
+    std::vector<int> visibleNotes;
+    if (not useSummary)
     {
+        hot.findNotesInRange((int)((pscroll - 2)/zoom) - 1, (int)((pscroll + m_width + 2)/zoom) + 2,
+                             visibleNotes);
+    }
+
+    const int visibleAmount = visibleNotes.size();
+    for (int v=0; v<visibleAmount; v++)
+    {
+        const int n = visibleNotes[v];
+        
         int x;
-        const int x1 = m_graphical_track->getNoteStartInPixels(n) - pscroll;
-        const int x2 = m_graphical_track->getNoteEndInPixels(n)   - pscroll;
+        const int x1 = (int)((float)hot.m_start[n] * zoom) - pscroll;
+        const int x2 = (int)((float)hot.m_end[n]   * zoom) - pscroll;
 
         // don't draw notes that won't be visible
         if (x2 < 0)       continue;
         if (x1 > m_width) break;
 
-        const int pitch = m_track->getNotePitchID(n);
+        const int pitch = hot.m_pitch[n];
         const int level = pitch;
-        float volume    = m_track->getNoteVolume(n)/127.0;
+        float volume    = hot.m_volume[n]/127.0;
 
         const int y1 = levelToY(level);
         const int y2 = levelToY(level+1);
@@ -561,7 +595,7 @@ void KeyboardEditor::render(RelativeXCoord mousex_current, int mousey_current,
         {
             ariaColor.set(0.94f, 1.0f, 0.0f, 1.0f);
         }
-        else if (m_track->isNoteSelected(n) and focus)
+        else if (hot.m_selected[n] and focus)
         {
             ariaColor.set((1-volume)*1, (1-(volume/2))*1, 0, 1.0f);
         }
@@ -602,7 +636,6 @@ void KeyboardEditor::render(RelativeXCoord mousex_current, int mousey_current,
         {
             // -------- Add note (preview)
             const int tscroll = m_gsequence->getXScrollInMidiTicks();
-            const float zoom = m_gsequence->getZoom();
             
             const int tick1 = m_track->snapMidiTickToGrid(mousex_initial.getRelativeTo(MIDI), true);
             const int len = mousex_current.getRelativeTo(MIDI) - mousex_initial.getRelativeTo(MIDI);
@@ -746,6 +779,46 @@ void KeyboardEditor::render(RelativeXCoord mousex_current, int mousey_current,
 
 // -----------------------------------------------------------------------------------------------------------
 
+void KeyboardEditor::renderNoteSummary(GraphicalTrack* gtrack, const AriaColor& color)
+{
+    const float zoom    = m_gsequence->getZoom();
+    const int   xscroll = m_gsequence->getXScrollInPixels();
+    
+    int sliceTicks;
+    const std::vector<NoteSummary>& slices = gtrack->getNoteSummary()->getLevelForZoom(zoom, &sliceTicks);
+    const int sliceCount = slices.size();
+    
+    const int yscroll    = getYScrollInPixels();
+    const int firstLevel = yscroll/m_y_step;
+    const int lastLevel  = std::min(NOTE_SUMMARY_PITCH_COUNT - 1,
+                                    (yscroll + getYEnd() - getEditorYStart())/m_y_step);
+    
+    const int firstSlice = std::max(0, (int)(xscroll/zoom) / sliceTicks);
+    
+    AriaRender::primitives();
+    applyColor(color);
+    
+    for (int slice=firstSlice; slice<sliceCount; slice++)
+    {
+        const int x1 = (int)(slice*sliceTicks*zoom) - xscroll + getEditorXStart();
+        if (x1 > getXEnd()) break;
+        
+        const NoteSummary& summary = slices[slice];
+        if (summary.isEmpty()) continue;
+        
+        const int x2 = std::max(x1 + 1, (int)((slice + 1)*sliceTicks*zoom) - xscroll + getEditorXStart());
+        
+        const int from = std::max(firstLevel, (int)summary.m_min_pitch);
+        const int to   = std::min(lastLevel,  (int)summary.m_max_pitch);
+        for (int pitch=from; pitch<=to; pitch++)
+        {
+            if (summary.hasPitch(pitch)) AriaRender::rect(x1, levelToY(pitch), x2, levelToY(pitch+1));
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------
+
 wxString KeyboardEditor::getNoteName(int pitchID, bool addOctave)
 {
     wxString noteName;
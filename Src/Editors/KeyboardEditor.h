@@ -125,6 +125,9 @@ namespace AriaMaestosa
         void checkCursor(RelativeXCoord x, int y);
         NoteSearchResult flownOverNoteAt(RelativeXCoord x, const int y, int& noteID);
         
+        /** Draws the notes of a track as per-column summaries, for zoom levels where notes are sub-pixel */
+        void renderNoteSummary(GraphicalTrack* gtrack, const AriaColor& color);
+        
     };
 
 }
@@ -18,12 +18,14 @@
 #include "Actions/AddNote.h"
 #include "Actions/ShiftBySemiTone.h"
 #include "Analysers/ScoreAnalyser.h"
+#include "Analysers/ScoreAnalysisCache.h"
 #include "Editors/ScoreEditor.h"
 #include "Editors/RelativeXCoord.h"
 #include "GUI/ImageProvider.h"
 #include "GUI/GraphicalSequence.h"
 #include "GUI/GraphicalTrack.h"
 #include "GUI/MainFrame.h"
+#include "GUI/NoteSummaryPyramid.h"
 #include "Midi/Sequence.h"
 #include "Midi/Track.h"
 #include "Midi/MeasureData.h"
@@ -89,6 +91,7 @@ ScoreMidiConverter::ScoreMidiConverter(GraphicalSequence* parent)
     m_going_in_sharps = false;
     m_going_in_flats = false;
     m_octave_shift = 0;
+    m_generation = 0;
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -127,6 +130,7 @@ PitchSign ScoreMidiConverter::getKeySigSharpnessSignForLevel(const unsigned int
 void ScoreMidiConverter::setOctaveShift(int octaves)
 {
     m_octave_shift = octaves;
+    m_generation++;
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -313,6 +317,7 @@ int ScoreMidiConverter::levelToNote7(const unsigned int level) const
 
 void ScoreMidiConverter::updateConversionData()
 {
+    m_generation++;
 
     // FIXME - mess
 
@@ -944,8 +949,10 @@ void ScoreEditor::render(RelativeXCoord mousex_current, int mousey_current,
     const int mxc = (mouseValid ? mousex_current.getRelativeTo(WINDOW) : -1);
     const int mxi = (mouseValid ? mousex_initial.getRelativeTo(WINDOW) : -1);
     
-    ctx.first_x_to_consider = mb->firstPixelInMeasure( mb->measureAtPixel(0) ) + 1;
-    ctx.last_x_to_consider  = mb->lastPixelInMeasure( mb->measureAtPixel(m_width + 15) );
+    ctx.first_measure = mb->measureAtPixel(0);
+    ctx.last_measure  = mb->measureAtPixel(m_width + 15);
+    ctx.first_x_to_consider = mb->firstPixelInMeasure( ctx.first_measure ) + 1;
+    ctx.last_x_to_consider  = mb->lastPixelInMeasure( ctx.last_measure );
     ctx.mouse_x1 = std::min(mxc, mxi) ;
     ctx.mouse_x2 = std::max(mxc, mxi) ;
     ctx.mouse_y1 = std::min(mousey_current, mousey_initial);
@@ -969,6 +976,13 @@ void ScoreEditor::render(RelativeXCoord mousex_current, int mousey_current,
 
     ariaColor.set(0.0f, 0.0f, 0.0f, 1.0f);
     renderTrack(m_track, ctx, focus, true, renderSilences, ariaColor);
+    
+    // forget the analysis of tracks that are no longer displayed
+    for (int n=m_analysis_caches.size()-1; n>=0; n--)
+    {
+        if (m_analysis_caches[n].isUsed()) m_analysis_caches[n].setUsed(false);
+        else                               m_analysis_caches.erase(n);
+    }
   
 
     AriaRender::lineWidth(1);
@@ -1244,8 +1258,24 @@ void ScoreEditor::renderTrack(Track* track, const TrackRenderContext& ctx, bool
     GraphicalTrack* otherGTrack = m_gsequence->getGraphicsFor(track);
     ASSERT(otherGTrack != NULL);
     
-    m_g_clef_analyser->clearAndPrepare();
-    m_f_clef_analyser->clearAndPrepare();
+    // when notes are sub-pixel, running the score analysers is pointless; draw the summary instead
+    if (otherGTrack->getNoteSummary()->shouldUseAtZoom(m_gsequence->getZoom()))
+    {
+        renderTrackSummary(otherGTrack, baseColor);
+        return;
+    }
+    
+    // the score analysis of visible measures is cached; notes only need to be gathered when the
+    // track changed since it was made, and only measures whose notes changed are analysed again
+    MeasureData* md = m_sequence->getMeasureData();
+    ScoreAnalysisCache* cache = getAnalysisCache(track);
+    // selected notes are drawn from the analysis too; both counters only grow, so their sum changes
+    // whenever either does
+    const unsigned int generation = track->getEditGeneration() + track->getSelectionGeneration();
+    const unsigned int settings   = m_converter->getGeneration()*31 + m_sequence->ticksPerQuarterNote();
+    const bool gatherNotes = m_musical_notation_enabled and
+                             not cache->isUpToDate(ctx.first_measure, ctx.last_measure, generation, settings, md);
+    if (gatherNotes) cache->clearInput();
     
     // render pass 1. draw linear notation if relevant, gather information and do initial rendering for
     // musical notation
@@ -1339,10 +1369,8 @@ void ScoreEditor::renderTrack(Track* track, const TrackRenderContext& ctx, bool
             }
         }// end if linear
 
-        if (m_musical_notation_enabled)
+        if (gatherNotes)
         {
-            MeasureData* md = m_sequence->getMeasureData();
-            
             // build visible notes vector with initial info in it
             NoteRenderInfo currentNote = NoteRenderInfo::factory(tick, noteLevel, noteLength, note_sign,
                                                                  enableSelection and track->isNoteSelected(n),
@@ -1351,22 +1379,22 @@ void ScoreEditor::renderTrack(Track* track, const TrackRenderContext& ctx, bool
             // add note to either G clef score or F clef score
             if (m_g_clef and not m_f_clef)
             {
-                m_g_clef_analyser->addToVector(currentNote);
+                cache->addInput(SCORE_G_CLEF, currentNote);
             }
             else if (m_f_clef and not m_g_clef)
             {
-                m_f_clef_analyser->addToVector(currentNote);
+                cache->addInput(SCORE_F_CLEF, currentNote);
             }
             else if (m_f_clef and m_g_clef)
             {
                 const int middleC = m_converter->getScoreCenterCLevel();
                 if (noteLevel < middleC)
                 {
-                    m_g_clef_analyser->addToVector(currentNote);
+                    cache->addInput(SCORE_G_CLEF, currentNote);
                 }
                 else if (noteLevel > middleC)
                 {
-                    m_f_clef_analyser->addToVector(currentNote);
+                    cache->addInput(SCORE_F_CLEF, currentNote);
                 }
                 else
                 {
@@ -1381,12 +1409,12 @@ void ScoreEditor::renderTrack(Track* track, const TrackRenderContext& ctx, bool
                     {
                         const int checkNoteLevel = m_converter->noteToLevel( track->getNote(check_note), (PitchSign*)NULL );
                         
-                        if (checkNoteLevel > middleC)  m_f_clef_analyser->addToVector(currentNote);
-                        else                           m_g_clef_analyser->addToVector(currentNote);
+                        if (checkNoteLevel > middleC)  cache->addInput(SCORE_F_CLEF, currentNote);
+                        else                           cache->addInput(SCORE_G_CLEF, currentNote);
                     }
                     else
                     {
-                        m_g_clef_analyser->addToVector(currentNote);
+                        cache->addInput(SCORE_G_CLEF, currentNote);
                     }
                     
                 } // end if note on middle C
@@ -1394,14 +1422,11 @@ void ScoreEditor::renderTrack(Track* track, const TrackRenderContext& ctx, bool
         } // end if musical notation enabled
     } // next note
     
-    
-    if (m_g_clef)
-    {
-        m_g_clef_analyser->doneAdding();
-    }
-    if (m_f_clef)
+    if (gatherNotes)
     {
-        m_f_clef_analyser->doneAdding();
+        ScoreAnalyser* analysers[SCORE_CLEF_COUNT] = { m_g_clef_analyser, m_f_clef_analyser };
+        cache->update(ctx.first_measure, ctx.last_measure, generation, settings, md, analysers);
+        cache->clearInput();
     }
     
     // render musical notation if enabled
@@ -1412,7 +1437,7 @@ void ScoreEditor::renderTrack(Track* track, const TrackRenderContext& ctx, bool
             const int silences_y = getEditorYStart() +
                                    Y_STEP_HEIGHT*(m_converter->getScoreCenterCLevel()-8) -
                                    getYScrollInPixels() + 1;
-            renderScore(m_g_clef_analyser, silences_y, renderSilences, baseColor);
+            renderScore(m_g_clef_analyser, cache, SCORE_G_CLEF, ctx, silences_y, renderSilences, baseColor);
         }
 
         if (m_f_clef)
@@ -1420,17 +1445,85 @@ void ScoreEditor::renderTrack(Track* track, const TrackRenderContext& ctx, bool
             const int silences_y = getEditorYStart() +
                                    Y_STEP_HEIGHT*(m_converter->getScoreCenterCLevel()+4) -
                                   getYScrollInPixels() + 1;
-            renderScore(m_f_clef_analyser, silences_y, renderSilences, baseColor);
+            renderScore(m_f_clef_analyser, cache, SCORE_F_CLEF, ctx, silences_y, renderSilences, baseColor);
         }
     }
 }
 
+// ----------------------------------------------------------------------------------------------------------
+
+ScoreAnalysisCache* ScoreEditor::getAnalysisCache(const Track* track)
+{
+    const int count = m_analysis_caches.size();
+    for (int n=0; n<count; n++)
+    {
+        if (m_analysis_caches[n].getTrack() == track)
+        {
+            m_analysis_caches[n].setUsed(true);
+            return m_analysis_caches.get(n);
+        }
+    }
+    
+    ScoreAnalysisCache* cache = new ScoreAnalysisCache(track);
+    m_analysis_caches.push_back(cache);
+    return cache;
+}
+
 
 // ----------------------------------------------------------------------------------------------------------
 
-void ScoreEditor::renderScore(ScoreAnalyser* analyser, const int silences_y, 
-            bool renderSilences, const AriaColor& baseColor)
+void ScoreEditor::renderTrackSummary(GraphicalTrack* gtrack, const AriaColor& baseColor)
 {
+    const float zoom    = m_gsequence->getZoom();
+    const int   xscroll = m_gsequence->getXScrollInPixels();
+    const int   yscroll = getYScrollInPixels();
+    
+    int sliceTicks;
+    const std::vector<NoteSummary>& slices = gtrack->getNoteSummary()->getLevelForZoom(zoom, &sliceTicks);
+    const int sliceCount = slices.size();
+    
+    AriaRender::primitives();
+    AriaRender::color(baseColor.r, baseColor.g, baseColor.b, baseColor.a);
+    
+    for (int slice=std::max(0, (int)(xscroll/zoom) / sliceTicks); slice<sliceCount; slice++)
+    {
+        const int x1 = (int)(slice*sliceTicks*zoom) - xscroll + Editor::getEditorXStart();
+        if (x1 > m_width) break;
+        
+        const NoteSummary& summary = slices[slice];
+        if (summary.isEmpty()) continue;
+        
+        const int x2 = std::max(x1 + 1, (int)((slice + 1)*sliceTicks*zoom) - xscroll + Editor::getEditorXStart());
+        
+        // a slice is drawn as a single bar covering the range of levels its notes occupy
+        int minLevel = -1;
+        int maxLevel = -1;
+        const int to = std::min(127, (int)summary.m_max_pitch);
+        for (int pitch=summary.m_min_pitch; pitch<=to; pitch++)
+        {
+            if (not summary.hasPitch(pitch)) continue;
+            
+            const int level = m_converter->noteToLevel(NULL, pitch);
+            if (level == -1) continue;
+            
+            if (minLevel == -1 or level < minLevel) minLevel = level;
+            if (maxLevel == -1 or level > maxLevel) maxLevel = level;
+        }
+        if (minLevel == -1) continue;
+        
+        AriaRender::rect(x1, minLevel*Y_STEP_HEIGHT + getEditorYStart() - yscroll,
+                         x2, (maxLevel + 1)*Y_STEP_HEIGHT + getEditorYStart() - yscroll);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void ScoreEditor::renderScore(ScoreAnalyser* analyser, const ScoreAnalysisCache* cache, const int clef,
+                              const TrackRenderContext& ctx, const int silences_y,
+                              bool renderSilences, const AriaColor& baseColor)
+{
+    cache->fill((ScoreClef)clef, ctx.first_measure, ctx.last_measure, false, analyser);
+    
     int visibleNoteAmount = analyser->getNoteCount();
     
     // first note rendering pass
@@ -1453,8 +1546,8 @@ void ScoreEditor::renderScore(ScoreAnalyser* analyser, const int silences_y,
 
     // ------------------------- second note rendering pass -------------------
 
-    // analyse notes to know how to build the score
-    analyser->analyseNoteInfo();
+    // notes were already analysed (see ScoreAnalysisCache), fetch the results
+    cache->fill((ScoreClef)clef, ctx.first_measure, ctx.last_measure, true, analyser);
 
     // triplet signs, tied notes, flags and beams
     visibleNoteAmount = analyser->m_note_render_info.size();
@@ -36,6 +36,7 @@ namespace AriaMaestosa
     class Note;
     class Track;
     class ScoreAnalyser;
+    class ScoreAnalysisCache;
     
     const int sign_dist = 5;
     
@@ -78,6 +79,8 @@ namespace AriaMaestosa
         int mouse_x2;
         int mouse_y1;
         int mouse_y2;
+        int first_measure;
+        int last_measure;
     };
     
     
@@ -117,6 +120,9 @@ namespace AriaMaestosa
         
         GraphicalSequence* m_sequence;
         
+        /** incremented whenever conversion settings (key, octave shift) change */
+        unsigned int m_generation;
+        
     public:
         
         LEAK_CHECK();
@@ -134,6 +140,9 @@ namespace AriaMaestosa
         int  getScoreCenterCLevel() const;
         int  getOctaveShift() const { return m_octave_shift; }
         
+        /** @return a counter that changes whenever the results of conversions may change */
+        unsigned int getGeneration() const { return m_generation; }
+        
         /** @return what sign should appear next to the key for this note? (FLAT, SHARP or PITCH_SIGN_NONE) */
         PitchSign getKeySigSharpnessSignForLevel(const unsigned int level) const;
         
@@ -178,6 +187,11 @@ namespace AriaMaestosa
         OwnerPtr<ScoreAnalyser>  m_g_clef_analyser;
         OwnerPtr<ScoreAnalyser>  m_f_clef_analyser;
         
+        /** analysis results of the displayed tracks (this one and background tracks), per measure */
+        ptr_vector<ScoreAnalysisCache> m_analysis_caches;
+        
+        ScoreAnalysisCache* getAnalysisCache(const Track* track);
+        
         bool m_musical_notation_enabled;
         bool m_linear_notation_enabled;
         
@@ -185,8 +199,9 @@ namespace AriaMaestosa
         int m_clicked_note;
         
         /** helper method for rendering */
-        void renderScore(ScoreAnalyser* analyser, const int silences_y, 
-                        bool renderSilences, const AriaColor& baseColor);
+        void renderScore(ScoreAnalyser* analyser, const ScoreAnalysisCache* cache, const int clef,
+                         const TrackRenderContext& ctx, const int silences_y,
+                         bool renderSilences, const AriaColor& baseColor);
         
         /** helper method for rendering */
         void renderNote_pass1(NoteRenderInfo& renderInfo, const AriaColor& baseColor);
@@ -199,6 +214,9 @@ namespace AriaMaestosa
                         bool focus, bool enableSelection, bool renderSilences,
                         const AriaColor& baseColor);
         
+        /** Renders a track as per-column note ranges, for zoom levels where individual notes are sub-pixel */
+        void renderTrackSummary(GraphicalTrack* gtrack, const AriaColor& baseColor);
+        
     public:
         
         ScoreEditor(GraphicalTrack* track);
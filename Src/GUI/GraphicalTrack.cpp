@@ -35,6 +35,7 @@
 #include "GUI/ImageProvider.h"
 #include "GUI/MainFrame.h"
 #include "GUI/MainPane.h"
+#include "GUI/NoteSummaryPyramid.h"
 #include "IO/IOUtils.h"
 #include "Midi/DrumChoice.h"
 #include "Midi/InstrumentChoice.h"
@@ -388,6 +389,7 @@ GraphicalTrack::GraphicalTrack(Track* track, GraphicalSequence* seq, MagneticGri
     m_gsequence = seq;
     m_track = track;
     m_focused_editor = KEYBOARD;
+    m_note_summary = new NoteSummaryPyramid(track);
     
     m_name_renderer.setMaxWidth(120);
     m_name_renderer.setFont( getTrackNameFont() );
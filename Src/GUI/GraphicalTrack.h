@@ -38,6 +38,7 @@ namespace AriaMaestosa
     class Track;
     class MagneticGrid;
     class KeyboardEditor;
+    class NoteSummaryPyramid;
     class ControllerEditor;
     class GuitarEditor;
     class DrumEditor;
@@ -96,6 +97,9 @@ namespace AriaMaestosa
         OwnerPtr<ControllerEditor>  m_controller_editor;
         OwnerPtr<ScoreEditor>       m_score_editor     ;
         
+        /** Level-of-detail summaries of the notes of this track, for zoomed-out rendering */
+        OwnerPtr<NoteSummaryPyramid> m_note_summary;
+        
         bool m_dragging_resize;
         
         
@@ -170,6 +174,9 @@ namespace AriaMaestosa
               ScoreEditor*    getScoreEditor   ()       { return m_score_editor;      }
         const ScoreEditor*    getScoreEditor   () const { return m_score_editor;      }
 
+        /** @brief Get the level-of-detail summaries of the notes of this track (for zoomed-out rendering) */
+        NoteSummaryPyramid* getNoteSummary() { return m_note_summary; }
+        
         Editor* getEditorAt(const int y, Editor** next=NULL);
         Editor* getEditorFor(NotationType type)
         {
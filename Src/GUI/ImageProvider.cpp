@@ -16,8 +16,13 @@
 
 #include "Renderers/ImageBase.h"
 #include "Renderers/Drawable.h"
+#include "AriaCore.h"
 #include "Utils.h"
 
+#ifdef RENDERER_OPENGL
+#include "Renderers/GLTextureAtlas.h"
+#endif
+
 #include <wx/string.h>
 
 #define _DECLARE_IMAGES_
@@ -34,6 +39,11 @@ namespace AriaMaestosa
 
         void loadImages()
         {
+#ifdef RENDERER_OPENGL
+            // all skin images are packed in a single texture, at the resolution of the display
+            TextureAtlas::beginPacking( Display::getScaleFactor() );
+#endif
+
             // scrollbar
 #if defined(__WXMSW__)
             sbArrowImg      = new Image(wxT("sb_arrow_win.png"));
@@ -139,6 +149,10 @@ namespace AriaMaestosa
             menu_help      = new Drawable(wxT("help.png"));
             menu_exit      = new Drawable(wxT("exit.png"));
 
+#ifdef RENDERER_OPENGL
+            TextureAtlas::pack();
+#endif
+
             images_loaded = true;
         }
 
@@ -222,6 +236,10 @@ namespace AriaMaestosa
             delete menu_configure;
             delete menu_help;
             delete menu_exit;
+
+#ifdef RENDERER_OPENGL
+            TextureAtlas::release();
+#endif
         }
 
         bool imagesLoaded()
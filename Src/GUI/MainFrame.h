@@ -191,6 +191,7 @@ namespace AriaMaestosa
         MENU_SETTINGS_CHANNEL_MANUAL,
         MENU_SETTINGS_METRONOME,
         MENU_SETTINGS_PLAYTRHOUGH,
+        MENU_SETTINGS_RECORD_ON_FIRST_NOTE,
 
         MENU_TRACK_ADD,
         MENU_TRACK_DUP,
@@ -364,6 +365,7 @@ namespace AriaMaestosa
 
         wxMenuItem* m_metronome;
         wxMenuItem* m_playthrough;
+        wxMenuItem* m_record_on_first_note;
 
         wxPanel*         m_notification_panel;
         wxStaticText*    m_notification_text;
@@ -531,6 +533,7 @@ namespace AriaMaestosa
         void menuEvent_expandedMeasuresSelected(wxCommandEvent& evt);
         void menuEvent_metronome(wxCommandEvent& evt);
         void menuEvent_playthrough(wxCommandEvent& evt);
+        void menuEvent_recordOnFirstNote(wxCommandEvent& evt);
         void menuEvent_outputDevice(wxCommandEvent& evt);
         void menuEvent_inputDevice(wxCommandEvent& evt);
 
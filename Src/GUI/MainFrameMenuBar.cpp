@@ -285,6 +285,10 @@ void MainFrame::initMenuBar()
                                                           _("&Playthrough when recording"),
                                                           MainFrame::menuEvent_playthrough );
 
+    m_record_on_first_note = m_settings_menu->QUICK_ADD_CHECK_MENU(MENU_SETTINGS_RECORD_ON_FIRST_NOTE,
+                                                                   _("&Wait for first note to record"),
+                                                                   MainFrame::menuEvent_recordOnFirstNote );
+
 
     m_settings_menu->QUICK_ADD_MENU(wxID_PREFERENCES, _("&Preferences..."),
                                     MainFrame::menuEvent_preferences);
@@ -296,6 +300,7 @@ void MainFrame::initMenuBar()
     else                               {ASSERT(false);}
 
     m_playthrough->Check( PlatformMidiManager::get()->isPlayThrough() );
+    m_record_on_first_note->Check( PlatformMidiManager::get()->isRecordOnFirstNote() );
 
     m_menu_bar->Append(m_settings_menu,  _("&Settings"));
 
@@ -960,6 +965,7 @@ void MainFrame::menuEvent_scale(wxCommandEvent& evt)
 void MainFrame::menuEvent_removeOverlapping(wxCommandEvent& evt)
 {
     getCurrentSequence()->getCurrentTrack()->action( new Action::RemoveOverlapping() );
+    Display::render();
 }
 
 
@@ -1279,6 +1285,13 @@ void MainFrame::menuEvent_playthrough(wxCommandEvent& evt)
     PlatformMidiManager::get()->setPlayThrough( m_playthrough->IsChecked() );
 }
 
+// -----------------------------------------------------------------------------------------------------------
+
+void MainFrame::menuEvent_recordOnFirstNote(wxCommandEvent& evt)
+{
+    PlatformMidiManager::get()->setRecordOnFirstNote( m_record_on_first_note->IsChecked() );
+}
+
 // ----------------------------------------------------------------------------------------------------------
 // ---------------------------------------- OUTPUT MENU EVENTS ----------------------------------------------
 // ----------------------------------------------------------------------------------------------------------
@@ -20,6 +20,7 @@
 
 #include <iostream>
 #include <cmath>
+#include <algorithm>
 
 #include "Actions/EditAction.h"
 #include "Actions/ResizeNotes.h"
@@ -95,6 +96,12 @@ namespace AriaMaestosa
     /** By how many pixels does a step horizontally with the mouse wheel move scrolling */
     const int WHEEL_X_SPEED = 25;
 
+    /** Interval between two updates of the playback cursor, in milliseconds (roughly the display refresh rate) */
+    const int PLAYBACK_FRAME_MS = 16;
+
+    /** How many pixels around the playback cursor to invalidate (the line is 2 pixels wide) */
+    const int PLAYHEAD_STRIP_MARGIN = 3;
+
     
     int tab_width = 145;
 
@@ -132,6 +139,30 @@ namespace AriaMaestosa
             Start(10);
         }
     };
+
+    // =======================================================================================================
+    // =======================================================================================================
+    class PlaybackTimer : public wxTimer
+    {
+        MainPane* main_pane;
+
+    public:
+
+        PlaybackTimer(MainPane* parent) : wxTimer()
+        {
+            main_pane = parent;
+        }
+
+        void Notify()
+        {
+            main_pane->playbackRenderLoop();
+        }
+
+        void start()
+        {
+            Start(PLAYBACK_FRAME_MS);
+        }
+    };
 }
 
 // ===========================================================================================================
@@ -175,6 +206,8 @@ MainPane::MainPane(wxWindow* parent, int* args) :
     m_right_arrow = false;
 
     m_mouse_down_timer = new MouseDownTimer(this);
+    m_playback_timer   = new PlaybackTimer(this);
+    m_last_playhead_x  = -1;
 
     m_scroll_to_playback_position = false;
     
@@ -240,11 +273,9 @@ void MainPane::resized(wxSizeEvent& evt)
 
 void MainPane::paintEvent(wxPaintEvent& evt)
 {
-    #ifdef RENDERER_OPENGL
-    wxPaintDC mydc(this); // OpenGL handles double-buffering on its own
-    #else
-    wxAutoBufferedPaintDC mydc(this);
-    #endif
+    // no wxAutoBufferedPaintDC needed : OpenGL handles double-buffering on its own, and the
+    // software renderer composes the frame off-screen and blits it once
+    wxPaintDC mydc(this);
     
     
     if (not m_is_visible) return;
@@ -734,6 +765,8 @@ bool MainPane::do_render()
     AriaRender::lineWidth(2);
     AriaRender::color(0.8, 0, 0);
 
+    m_last_playhead_x = -1;
+    
     if (tick.getRelativeTo(WINDOW) < XStart) // current tick is before the visible area
     {
         if (playing)
@@ -770,6 +803,7 @@ bool MainPane::do_render()
 
         // red line in measure bar
         const int tick_x = tick.getRelativeTo(WINDOW);
+        if (playing) m_last_playhead_x = tick_x;
         AriaRender::line(tick_x, MEASURE_BAR_Y + 1,
                          tick_x, MEASURE_BAR_Y + 20);
         
@@ -1535,7 +1569,8 @@ void MainPane::enterPlayLoop()
     Sequence* seq = getMainFrame()->getCurrentSequence();
     m_follow_playback_time = seq->getMeasureData()->defaultMeasureLengthInTicks();
     m_last_tick = -1;
-    Core::activateRenderLoop(true);
+    m_last_playhead_x = -1;
+    m_playback_timer->start();
 }
 
 // -----------------------------------------------------------------------------------------------------------
@@ -1547,9 +1582,10 @@ void MainPane::exitPlayLoop()
     if (midi->isRecording()) midi->stopRecording();
     midi->stop();
     
+    m_playback_timer->Stop();
     getMainFrame()->toolsExitPlaybackMode();
-    Core::activateRenderLoop(false);
     setCurrentTick( -1 );
+    m_last_playhead_x = -1;
     Refresh();
 }
 
@@ -1557,66 +1593,95 @@ void MainPane::exitPlayLoop()
 
 void MainPane::playbackRenderLoop()
 {
-    const int currentTick = PlatformMidiManager::get()->trackPlaybackProgression();
+    PlatformMidiManager* midi = PlatformMidiManager::get();
+    const int progression = midi->trackPlaybackProgression();
 
     // check if song is over
-    if (currentTick == -1 or not PlatformMidiManager::get()->isPlaying())
+    if (progression == -1 or not midi->isPlaying())
     {
-        if (not PlatformMidiManager::get()->isRecording())
+        if (not midi->isRecording())
         {
             exitPlayLoop();
             return;
         }
     }
     
+    // the coarse progression is only updated on events; for smooth motion of the cursor, prefer the
+    // fine-grained tick, which the sequencer thread keeps up to date
+    const int accurateTick = midi->getAccurateTick();
+    const int currentTick  = std::max(progression, accurateTick);
+    
     GraphicalSequence* gseq = getMainFrame()->getCurrentGraphicalSequence();
     Sequence* seq = gseq->getModel();
     const int startTick = seq->getPlaybackStartTick();
     
     // only draw if it has changed
-    if (m_last_tick != startTick + currentTick)
+    if (m_last_tick == startTick + currentTick) return;
+    
+    bool scrolled = false;
+    
+    // if user has clicked on a little red arrow
+    if (m_scroll_to_playback_position)
     {
+        m_scroll_to_playback_position=false;
+        const int x_scroll_in_pixels = (int)( (startTick + currentTick) * gseq->getZoom() );
+        gseq->setXScrollInPixels(x_scroll_in_pixels);
+        DisplayFrame::updateHorizontalScrollbar( startTick + currentTick );
+        scrolled = true;
+    }
+    
+    // if follow playback is checked in the menu
+    if (seq->isFollowPlaybackEnabled())
+    {
+        RelativeXCoord tick(startTick + currentTick, MIDI, gseq);
+        const int current_pixel = tick.getRelativeTo(WINDOW);
         
-        // if user has clicked on a little red arrow
-        if (m_scroll_to_playback_position)
-        {
-            m_scroll_to_playback_position=false;
-            const int x_scroll_in_pixels = (int)( (startTick + currentTick) * gseq->getZoom() );
-            gseq->setXScrollInPixels(x_scroll_in_pixels);
-            DisplayFrame::updateHorizontalScrollbar( startTick + currentTick );
-        }
+        const int XStart = Editor::getEditorXStart();
+        const int XEnd = getWidth() - 50; // 50 is somewhat arbitrary
+        const int last_visible_measure = gseq->getMeasureBar()->measureAtPixel( XEnd );
+        const int current_measure = seq->getMeasureData()->measureAtTick(startTick + currentTick);
         
-        // if follow playback is checked in the menu
-        if (seq->isFollowPlaybackEnabled())
+        if (current_pixel < XStart or current_measure >= last_visible_measure)
         {
-            RelativeXCoord tick(startTick + currentTick, MIDI, gseq);
-            const int current_pixel = tick.getRelativeTo(WINDOW);
-            
-            //const float zoom = getCurrentSequence()->getZoom();
-            const int XStart = Editor::getEditorXStart();
-            const int XEnd = getWidth() - 50; // 50 is somewhat arbitrary
-            const int last_visible_measure = gseq->getMeasureBar()->measureAtPixel( XEnd );
-            const int current_measure = seq->getMeasureData()->measureAtTick(startTick + currentTick);
-            
-            if (current_pixel < XStart or current_measure >= last_visible_measure)
-            {
-                int new_scroll_in_pixels = (startTick + currentTick) * gseq->getZoom();
-                if (new_scroll_in_pixels < 0) new_scroll_in_pixels=0;
-                // FIXME(DESIGN) - the GUI should not be updated independently of the model
-                gseq->setXScrollInPixels(new_scroll_in_pixels);
-                DisplayFrame::updateHorizontalScrollbar( startTick + currentTick );
-            }
+            int new_scroll_in_pixels = (startTick + currentTick) * gseq->getZoom();
+            if (new_scroll_in_pixels < 0) new_scroll_in_pixels=0;
+            // FIXME(DESIGN) - the GUI should not be updated independently of the model
+            gseq->setXScrollInPixels(new_scroll_in_pixels);
+            DisplayFrame::updateHorizontalScrollbar( startTick + currentTick );
+            scrolled = true;
         }
-        
-        setCurrentTick( startTick + currentTick );
-        
-        RelativeXCoord tick(m_current_tick, MIDI, gseq);
+    }
+    
+    setCurrentTick( startTick + currentTick );
+    m_last_tick = startTick + currentTick;
+    
+    RelativeXCoord tick(m_current_tick, MIDI, gseq);
+    const int new_x  = tick.getRelativeTo(WINDOW);
+    const int XStart = Editor::getEditorXStart();
+    const int XEnd   = getWidth();
+    const bool visible     = (new_x >= XStart and new_x <= XEnd);
+    const bool was_visible = (m_last_playhead_x != -1);
+    
+    if (scrolled or visible != was_visible)
+    {
+        // the whole view moved, or the red arrows in the measure bar must be toggled
         Display::render();
-        m_last_tick = startTick + currentTick;
+        return;
     }
-
-    // FIXME - why pause the main thread, aren't there better ways?
-    wxMilliSleep(10);
+    
+    if (not visible)
+    {
+        // cursor is off-screen, only the arrows (and the time display) need to be refreshed
+        RefreshRect( wxRect(0, MEASURE_BAR_Y, XEnd, 20), false );
+        return;
+    }
+    
+    if (new_x == m_last_playhead_x) return;
+    
+    // only invalidate the strip between the previous cursor position and the new one
+    const int from_x = std::min(m_last_playhead_x, new_x) - PLAYHEAD_STRIP_MARGIN;
+    const int to_x   = std::max(m_last_playhead_x, new_x) + PLAYHEAD_STRIP_MARGIN;
+    RefreshRect( wxRect(from_x, 0, to_x - from_x, getHeight()), false );
 }
 
 // -----------------------------------------------------------------------------------------------------------
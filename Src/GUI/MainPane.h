@@ -39,6 +39,7 @@ namespace AriaMaestosa
     const int EXPANDED_MEASURE_BAR_H  = 40;
     
     class MouseDownTimer;
+    class PlaybackTimer;
     class MainFrame;
 
     /**
@@ -70,6 +71,9 @@ namespace AriaMaestosa
         /** To send events repeatedly when the mouse is held down */
         OwnerPtr<MouseDownTimer> m_mouse_down_timer;
 
+        /** Drives the playback cursor at display rate while a song is playing */
+        OwnerPtr<PlaybackTimer> m_playback_timer;
+
         /** Gives information about the location of the mouse in a drag */
         RelativeXCoord m_mouse_x_initial;
 
@@ -97,6 +101,9 @@ namespace AriaMaestosa
         int m_follow_playback_time;
         int m_last_tick;
 
+        /** x coordinate (in window space) where the playback cursor was last drawn, or -1 */
+        int m_last_playhead_x;
+
         bool m_scroll_to_playback_position;
 
         ClickArea m_click_area;
@@ -139,7 +146,11 @@ namespace AriaMaestosa
 
         void enterPlayLoop();
 
-        /** This method is called repeatedly during playback */
+        /**
+          * This method is called repeatedly during playback, by a timer on the main thread.
+          * It only invalidates the area covered by the playback cursor, unless follow-playback
+          * requires scrolling.
+          */
         void playbackRenderLoop();
 
         /** This is called when the song us playing. MainPane needs to know the current tick because when it renders
@@ -0,0 +1,296 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "GUI/NoteSummaryPyramid.h"
+#include "Actions/AddNote.h"
+#include "Actions/ResizeNotes.h"
+#include "Midi/Sequence.h"
+#include "Midi/Track.h"
+#include "UnitTest.h"
+#include "UnitTestUtils.h"
+
+#include <algorithm>
+
+using namespace AriaMaestosa;
+
+namespace AriaMaestosa
+{
+    /** Below this width (in pixels) of a sixteenth note, individual notes are no longer drawn */
+    const float LOD_MIN_SLICE_WIDTH = 2.0f;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+NoteSummaryPyramid::NoteSummaryPyramid(Track* track)
+{
+    m_track            = track;
+    m_generation       = 0;
+    m_built            = false;
+    m_base_slice_ticks = 1;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void NoteSummaryPyramid::update()
+{
+    const int sliceTicks = std::max(1, m_track->getSequence()->ticksPerQuarterNote() / 4);
+    
+    if (m_built and m_generation == m_track->getEditGeneration() and sliceTicks == m_base_slice_ticks)
+    {
+        return;
+    }
+    
+    const NoteHotData& notes = m_track->getNoteHotData();
+    
+    // only the slices over the edited notes need to be summarised again, unless the track got longer or shorter
+    int fromTick, toTick;
+    if (m_built and sliceTicks == m_base_slice_ticks and
+        notes.m_last_tick/sliceTicks + 1 == (int)m_levels[0].size() and
+        m_track->getEditedNoteTicks(m_generation, &fromTick, &toTick))
+    {
+        if (toTick >= fromTick) updateSlices(notes, std::max(0, fromTick)/sliceTicks, toTick/sliceTicks);
+    }
+    else
+    {
+        m_base_slice_ticks = sliceTicks;
+        rebuild(notes);
+    }
+    
+    m_generation = m_track->getEditGeneration();
+    m_built      = true;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+namespace
+{
+    /** @return index of the level 0 slice where summaries of the given note end */
+    int lastSliceOf(const NoteHotData& notes, const int n, const int sliceTicks)
+    {
+        return std::max(notes.m_start[n] / sliceTicks, (notes.m_end[n] - 1) / sliceTicks);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void NoteSummaryPyramid::rebuild(const NoteHotData& notes)
+{
+    m_levels.clear();
+    
+    const int noteAmount = notes.size();
+    
+    // ---- level 0 : each note is added to every slice it covers
+    m_levels.push_back( std::vector<NoteSummary>(notes.m_last_tick/m_base_slice_ticks + 1) );
+    std::vector<NoteSummary>& base = m_levels[0];
+    
+    for (int n=0; n<noteAmount; n++)
+    {
+        const int pitch = notes.m_pitch[n];
+        if (pitch >= NOTE_SUMMARY_PITCH_COUNT) continue;
+        
+        const int from = notes.m_start[n] / m_base_slice_ticks;
+        const int to   = lastSliceOf(notes, n, m_base_slice_ticks);
+        
+        for (int slice=from; slice<=to; slice++)
+        {
+            base[slice].addNote(pitch);
+        }
+    }
+    
+    // ---- coarser levels : merge slices two by two
+    while (m_levels[m_levels.size()-1].size() > 1)
+    {
+        const std::vector<NoteSummary>& finer = m_levels[m_levels.size()-1];
+        const int finerCount = finer.size();
+        
+        std::vector<NoteSummary> coarser( (finerCount + 1)/2 );
+        for (int n=0; n<finerCount; n++)
+        {
+            coarser[n/2].merge(finer[n]);
+        }
+        
+        m_levels.push_back(coarser);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void NoteSummaryPyramid::updateSlices(const NoteHotData& notes, int fromSlice, int toSlice)
+{
+    std::vector<NoteSummary>& base = m_levels[0];
+    toSlice = std::min(toSlice, (int)base.size() - 1);
+    
+    for (int slice=fromSlice; slice<=toSlice; slice++) base[slice] = NoteSummary();
+    
+    // notes ending at the first tick of the range are included too, for notes of length 0
+    std::vector<int> found;
+    notes.findNotesInRange(fromSlice*m_base_slice_ticks - 1, (toSlice + 1)*m_base_slice_ticks, found);
+    
+    const int foundCount = found.size();
+    for (int i=0; i<foundCount; i++)
+    {
+        const int n = found[i];
+        const int pitch = notes.m_pitch[n];
+        if (pitch >= NOTE_SUMMARY_PITCH_COUNT) continue;
+        
+        const int from = std::max(fromSlice, notes.m_start[n] / m_base_slice_ticks);
+        const int to   = std::min(toSlice,   lastSliceOf(notes, n, m_base_slice_ticks));
+        
+        for (int slice=from; slice<=to; slice++)
+        {
+            base[slice].addNote(pitch);
+        }
+    }
+    
+    // ---- coarser levels : merge again the slices above the ones that changed
+    for (unsigned int level=1; level<m_levels.size(); level++)
+    {
+        const std::vector<NoteSummary>& finer = m_levels[level - 1];
+        std::vector<NoteSummary>& coarser = m_levels[level];
+        const int finerCount = finer.size();
+        
+        fromSlice /= 2;
+        toSlice   /= 2;
+        for (int slice=fromSlice; slice<=toSlice; slice++)
+        {
+            coarser[slice] = finer[slice*2];
+            if (slice*2 + 1 < finerCount) coarser[slice].merge(finer[slice*2 + 1]);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+bool NoteSummaryPyramid::shouldUseAtZoom(const float zoom)
+{
+    const int sliceTicks = std::max(1, m_track->getSequence()->ticksPerQuarterNote() / 4);
+    return sliceTicks*zoom < LOD_MIN_SLICE_WIDTH;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+const std::vector<NoteSummary>& NoteSummaryPyramid::getLevelForZoom(const float zoom, int* slice_ticks)
+{
+    update();
+    
+    // pick the coarsest level whose slices are not wider than one pixel
+    int level = 0;
+    while (level + 1 < (int)m_levels.size() and (m_base_slice_ticks << (level + 1))*zoom <= 1.0f)
+    {
+        level++;
+    }
+    
+    *slice_ticks = (m_base_slice_ticks << level);
+    return m_levels[level];
+}
+
+// ----------------------------------------------------------------------------------------------------------
+// ----------------------------------------------------------------------------------------------------------
+
+namespace TestNoteSummaryPyramid
+{
+    using namespace AriaMaestosa::Action;
+    
+    /** @return whether both pyramids summarise the same notes, at every level */
+    bool sameLevels(NoteSummaryPyramid& a, NoteSummaryPyramid& b, const int baseSliceTicks)
+    {
+        for (int level=0; level<16; level++)
+        {
+            const float zoom = 1.0f / (baseSliceTicks << level);
+            int ticksA, ticksB;
+            const std::vector<NoteSummary>& levelA = a.getLevelForZoom(zoom, &ticksA);
+            const std::vector<NoteSummary>& levelB = b.getLevelForZoom(zoom, &ticksB);
+            
+            if (ticksA != ticksB or levelA.size() != levelB.size()) return false;
+            for (unsigned int n=0; n<levelA.size(); n++)
+            {
+                if (levelA[n].m_count     != levelB[n].m_count or
+                    levelA[n].m_min_pitch != levelB[n].m_min_pitch or
+                    levelA[n].m_max_pitch != levelB[n].m_max_pitch) return false;
+                
+                for (int w=0; w<NOTE_SUMMARY_MASK_WORDS; w++)
+                {
+                    if (levelA[n].m_pitch_mask[w] != levelB[n].m_pitch_mask[w]) return false;
+                }
+            }
+        }
+        return true;
+    }
+    
+    UNIT_TEST(TestIncrementalUpdate)
+    {
+        Sequence* seq = new Sequence(NULL, NULL, NULL, NULL, false);
+        
+        TestSequenceProvider provider(seq);
+        AriaMaestosa::setCurrentSequenceProvider(&provider);
+        
+        Track* t = new Track(seq);
+        {
+            OwnerPtr<Sequence::Import> import(seq->startImport());
+            for (int n=0; n<64; n++)
+            {
+                t->addNote_import(60 + n%12 /* pitch */, n*120 /* start */, n*120 + 300 /* end */,
+                                  100 /* volume */, -1);
+            }
+        }
+        seq->addTrack(t);
+        
+        const int sliceTicks = seq->ticksPerQuarterNote() / 4;
+        NoteSummaryPyramid pyramid(t);
+        int unused;
+        pyramid.getLevelForZoom(1.0f, &unused);
+        
+        // edits within the track update the slices they cover
+        const unsigned int beforeAdd = t->getEditGeneration();
+        t->action(new AddNote(30 /* pitch */, 2000 /* start */, 2500 /* end */, 100 /* volume */, -1));
+        int fromTick, toTick;
+        require(t->getEditedNoteTicks(beforeAdd, &fromTick, &toTick), "the action told which notes it changed");
+        require(fromTick == 2000 and toTick == 2500, "the action told which notes it changed");
+        {
+            NoteSummaryPyramid rebuilt(t);
+            require(sameLevels(pyramid, rebuilt, sliceTicks), "adding a note updated the summaries");
+        }
+        
+        t->action(new ResizeNotes(-200, 10));
+        {
+            NoteSummaryPyramid rebuilt(t);
+            require(sameLevels(pyramid, rebuilt, sliceTicks), "resizing a note updated the summaries");
+        }
+        
+        seq->undo();
+        seq->undo();
+        require(t->getEditedNoteTicks(beforeAdd, &fromTick, &toTick), "undoing tells which notes changed");
+        {
+            NoteSummaryPyramid rebuilt(t);
+            require(sameLevels(pyramid, rebuilt, sliceTicks), "undoing updated the summaries");
+        }
+        
+        // selecting notes does not change the summaries
+        const unsigned int generation = t->getEditGeneration();
+        t->selectNote(ALL_NOTES, true, true);
+        require(t->getEditGeneration() == generation, "selection is not an edit of the track's contents");
+        
+        // an edit that makes the track longer rebuilds it
+        t->action(new AddNote(30 /* pitch */, 9000 /* start */, 9500 /* end */, 100 /* volume */, -1));
+        {
+            NoteSummaryPyramid rebuilt(t);
+            require(sameLevels(pyramid, rebuilt, sliceTicks), "lengthening the track updated the summaries");
+        }
+        
+        delete seq;
+    }
+}
@@ -0,0 +1,146 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __NOTE_SUMMARY_PYRAMID_H__
+#define __NOTE_SUMMARY_PYRAMID_H__
+
+#include "Midi/NoteHotData.h"
+#include "Utils.h"
+#include <vector>
+
+namespace AriaMaestosa
+{
+    class Track;
+    
+    /** Amount of pitch IDs a NoteSummary can remember (pitch IDs go from 0 to 130) */
+    const int NOTE_SUMMARY_PITCH_COUNT = 131;
+    
+    /** Amount of 32-bit words needed to hold one bit per pitch ID */
+    const int NOTE_SUMMARY_MASK_WORDS = (NOTE_SUMMARY_PITCH_COUNT + 31) / 32;
+    
+    /**
+      * @brief Summary of all the notes found within a slice of time.
+      *
+      * Used to render zoomed-out views, where individual notes would be narrower than a pixel.
+      * @ingroup gui
+      */
+    struct NoteSummary
+    {
+        /** Amount of notes covering (at least partially) this slice of time */
+        int m_count;
+        
+        /** Smallest pitch ID among these notes (only meaningful when m_count > 0) */
+        short m_min_pitch;
+        
+        /** Biggest pitch ID among these notes (only meaningful when m_count > 0) */
+        short m_max_pitch;
+        
+        /** One bit per pitch ID, set if at least one note of this pitch covers this slice of time */
+        unsigned int m_pitch_mask[NOTE_SUMMARY_MASK_WORDS];
+        
+        NoteSummary()
+        {
+            m_count     = 0;
+            m_min_pitch = NOTE_SUMMARY_PITCH_COUNT;
+            m_max_pitch = -1;
+            for (int n=0; n<NOTE_SUMMARY_MASK_WORDS; n++) m_pitch_mask[n] = 0;
+        }
+        
+        void addNote(const int pitchID)
+        {
+            m_count++;
+            if (pitchID < m_min_pitch) m_min_pitch = pitchID;
+            if (pitchID > m_max_pitch) m_max_pitch = pitchID;
+            m_pitch_mask[pitchID >> 5] |= (1u << (pitchID & 31));
+        }
+        
+        void merge(const NoteSummary& other)
+        {
+            m_count += other.m_count;
+            if (other.m_min_pitch < m_min_pitch) m_min_pitch = other.m_min_pitch;
+            if (other.m_max_pitch > m_max_pitch) m_max_pitch = other.m_max_pitch;
+            for (int n=0; n<NOTE_SUMMARY_MASK_WORDS; n++) m_pitch_mask[n] |= other.m_pitch_mask[n];
+        }
+        
+        bool hasPitch(const int pitchID) const
+        {
+            return (m_pitch_mask[pitchID >> 5] & (1u << (pitchID & 31))) != 0;
+        }
+        
+        bool isEmpty() const { return m_count == 0; }
+    };
+    
+    /**
+      * @brief Level-of-detail cache of the notes of a track, used when rendering zoomed-out views.
+      *
+      * Level 0 splits the track in slices of a sixteenth note; each following level merges two
+      * slices of the previous level (much like the mipmaps of a texture). Editors then pick the
+      * coarsest level whose slices are still at most one pixel wide, so that rendering the visible
+      * area costs the same no matter how many notes the track contains.
+      *
+      * The pyramid is updated lazily, when the edit generation of the track has changed since the
+      * last update (see Track::getEditGeneration). When the track knows which ticks the notes changed
+      * by these edits covered (see Track::getEditedNoteTicks), only the slices over them are summarised
+      * again.
+      *
+      * @ingroup gui
+      */
+    class NoteSummaryPyramid
+    {
+        Track* m_track;
+        
+        /** Edit generation of the track when the pyramid was last built */
+        unsigned int m_generation;
+        
+        bool m_built;
+        
+        /** Width of the slices of level 0, in midi ticks */
+        int m_base_slice_ticks;
+        
+        std::vector< std::vector<NoteSummary> > m_levels;
+        
+        void rebuild(const NoteHotData& notes);
+        
+        /** Summarises again slices [fromSlice, toSlice] of level 0, and the slices above them */
+        void updateSlices(const NoteHotData& notes, int fromSlice, int toSlice);
+        
+        /** Make sure the pyramid reflects the current contents of the track */
+        void update();
+        
+    public:
+        LEAK_CHECK();
+        
+        NoteSummaryPyramid(Track* track);
+        
+        /**
+          * @param  zoom  The current zoom, in pixels per tick
+          * @return whether notes are so small at this zoom that summaries should be drawn
+          *         instead of individual notes
+          */
+        bool shouldUseAtZoom(const float zoom);
+        
+        /**
+          * @brief  Get the level of detail appropriate for rendering at the given zoom
+          * @param  zoom             The current zoom, in pixels per tick
+          * @param[out] slice_ticks  Width of the slices of the returned level, in midi ticks
+          * @return one summary per slice of time, the first one beginning at tick 0
+          */
+        const std::vector<NoteSummary>& getLevelForZoom(const float zoom, int* slice_ticks);
+    };
+    
+}
+
+#endif
@@ -31,6 +31,8 @@
 #include "LeakCheck.h"
 #include <iostream>
 
+#include <wx/thread.h>
+
 namespace AriaMaestosa
 {
     namespace MemoryLeaks
@@ -38,10 +40,19 @@ namespace AriaMaestosa
         
         std::set<MyObject*> g_all_objs;
         
+        /** watched objects may be created and deleted by worker threads (see WorkerPool) */
+        wxMutex& getMutex()
+        {
+            // created on first use, since watched objects may be constructed during static initialisation
+            static wxMutex mutex;
+            return mutex;
+        }
+        
         void addObj(MyObject* myObj)
         {
             //std::cout << "addObj " << myObj->file << " (" << myObj->line << ")" << std::endl;
             //g_all_objs.push_back(myObj);
+            wxMutexLocker lock(getMutex());
             g_all_objs.insert(myObj);
         }
         
@@ -49,7 +60,10 @@ namespace AriaMaestosa
         {
             //std::cout << "removeObj " << myObj->file << " (" << myObj->line << ")" << std::endl;
             //g_all_objs.remove(myObj);
-            g_all_objs.erase(myObj);
+            {
+                wxMutexLocker lock(getMutex());
+                g_all_objs.erase(myObj);
+            }
             delete myObj;
             //std::cout << "removeObj done" << std::endl;
         }
@@ -374,6 +374,39 @@ UNIT_TEST( MergeTest )
 
 // ----------------------------------------------------------------------------------------------------------
 
+int AriaMaestosa::getPlaybackChannels(Sequence* sequence)
+{
+    // same assignment as makeJDKMidiSequence and Track::addMidiEvents, counting muted and empty tracks too
+    const bool manual_mode = (sequence->getChannelManagementType() == CHANNEL_MANUAL);
+    
+    int channels = 0;
+    int channel  = 0;
+    
+    const int trackAmount = sequence->getTrackAmount();
+    for (int n=0; n<trackAmount; n++)
+    {
+        Track* track = sequence->getTrack(n);
+        if (track->isNotationTypeEnabled(DRUM))
+        {
+            channels |= (1 << 9);
+        }
+        else if (manual_mode)
+        {
+            channels |= (1 << track->getChannel());
+        }
+        else
+        {
+            if (channel > 15) return 0xFFFF; // too many tracks, all channels are used
+            channels |= (1 << channel);
+            channel++; if (channel==9) channel++;
+        }
+    }
+    
+    return channels;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
 bool AriaMaestosa::makeJDKMidiSequence(Sequence* sequence, jdksmidi::MIDIMultiTrack& tracks, bool selectionOnly,
                                        /*out*/int* songLengthInTicks, /*out*/int* startTick,
                                        /*out*/ int* numTracks, bool playing)
@@ -382,7 +415,6 @@ bool AriaMaestosa::makeJDKMidiSequence(Sequence* sequence, jdksmidi::MIDIMultiTr
     int channel     = 0;
     
     int substract_ticks;
-    const bool addMetronome = (sequence->playWithMetronome() and playing);
     
     tracks.SetClksPerBeat( sequence->ticksPerQuarterNote() );
     
@@ -812,103 +844,7 @@ bool AriaMaestosa::makeJDKMidiSequence(Sequence* sequence, jdksmidi::MIDIMultiTr
         
     }
     
-    // ---- Add metronome track if enabled
-    if (addMetronome)
-    {
-        const int beat = sequence->ticksPerQuarterNote();
-        
-        const int metronomeInstrument = 37; // 31 (stick), 56 (cowbell), 37 (side stick)
-        const int metronomeVolume = 127;
-        
-        // FIXME: if the user adds lots of tracks, just using the last track here may not be safe.
-        const int metronomeTrackId = sequence->getTrackAmount() + 1; //tracks.GetNumTracks() - 1;
-        jdksmidi::MIDITrack* metronomeTrack = tracks.GetTrack(metronomeTrackId);
-        
-        *numTracks = *numTracks + 1;
-        
-        // set track name
-        {
-            jdksmidi::MIDITimedBigMessage m;
-            m.SetText( 3 );
-            m.SetByte1( 3 );
-            
-            jdksmidi::MIDISystemExclusive sysex((unsigned char*)"Metronome",
-                                               strlen("Metronome")+1, strlen("Metronome")+1, false);
-            
-            m.CopySysEx( &sysex );
-            m.SetTime( 0 );
-            
-            if (not metronomeTrack->PutEvent( m ))
-            {
-                std::cout << "Error adding metronome track name event" << std::endl;
-                ASSERT(FALSE);
-            }
-        }
-        
-        // set maximum volume
-        {
-            jdksmidi::MIDITimedBigMessage m;
-            
-            m.SetTime( 0 );
-            m.SetControlChange( channel, 7, 127 );
-            
-            if (not metronomeTrack->PutEvent( m ))
-            {
-                std::cerr << "Error adding metronome track volume event" << std::endl;
-                ASSERT(false);
-            }
-        }
-        
-        // make sure we start on a beat
-        const int shift = (*startTick % beat);
-        
-        double timeBetweenMetronomeHits = beat;
-
-        // add the events
-        for (double tick = shift; tick <= *songLengthInTicks + past_end_time; tick += timeBetweenMetronomeHits)
-        {
-            int measure = sequence->getMeasureData()->measureAtTick((int)tick);
-            if (sequence->getMeasureData()->getTimeSigDenominator(measure) == 8)
-            {
-                if (sequence->getMeasureData()->getTimeSigNumerator(measure) % 3 == 0)
-                {
-                    timeBetweenMetronomeHits = beat*1.5;
-                }
-                else if (sequence->getMeasureData()->getTimeSigNumerator(measure) % 2 == 1)
-                {
-                    timeBetweenMetronomeHits = beat/2.0;
-                }
-            }
-            else
-            {
-                timeBetweenMetronomeHits = beat;
-            }
-        
-            jdksmidi::MIDITimedBigMessage m;
-            m.SetTime((int)tick);
-            m.SetNoteOn( 9 /* channel */, metronomeInstrument, metronomeVolume );
-            
-            if (not metronomeTrack->PutEvent( m ))
-            {
-                std::cerr << "Error adding metronome midi event!" << std::endl;
-            }
-            
-            //printf("%i vs %i\n", (int)tick, sequence->getMeasureData()->firstTickInMeasure(measure));
-            if (sequence->getMeasureData()->firstTickInMeasure(measure) == tick)
-            {
-                jdksmidi::MIDITimedBigMessage m2;
-                m2.SetTime((int)tick);
-                m2.SetNoteOn( 9 /* channel */, 81 /* triangle */, metronomeVolume );
-                
-                if (not metronomeTrack->PutEvent(m2))
-                {
-                    std::cerr << "Error adding metronome midi event!" << std::endl;
-                }
-            }
-            
-        }
-    }
-     
+    
     return true;
 }
 
@@ -963,78 +899,6 @@ float AriaMaestosa::convertBPMToTempoBend(float tempo)
 
 int AriaMaestosa::getTimeAtTick(int tick, const Sequence* seq)
 {
-    std::vector<float> tempos;
-    std::vector<int> duration;
-    
-    const int tempo_events_amount = seq->getTempoEventAmount();
-    //std::cout << "tempo_events_amount = " << tempo_events_amount << std::endl;
-    if (tempo_events_amount < 1 or (tempo_events_amount == 1 and seq->getTempoEvent(0)->getTick() == 0) )
-    {
-        tempos.push_back(seq->getTempo());
-        duration.push_back(tick);
-    }
-    else
-    {
-        // multiple tempo changes
-        
-        if (tick > seq->getTempoEvent(0)->getTick())
-        {
-            // from beginning to first event
-            tempos.push_back(seq->getTempo());
-            duration.push_back(seq->getTempoEvent(0)->getTick());
-            
-            //std::cout << "Firstly, " << (seq->tempoEvents[0].getTick()) << " ticks at " << seq->getTempo() << std::endl;
-            
-            // other events
-            int n;
-            for (n = 1; n<tempo_events_amount; n++)
-            {
-                if (seq->getTempoEvent(n)->getTick() > tick)
-                {
-                    // this tempo event is only partially used, remove what we had calculated and just to the next part
-                    tempos.pop_back();
-                    duration.pop_back();
-                    break;
-                }
-                else
-                {
-                    tempos.push_back( convertTempoBendToBPM(seq->getTempoEvent(n-1)->getValue()) );
-                    duration.push_back(seq->getTempoEvent(n)->getTick() - seq->getTempoEvent(n-1)->getTick());
-                }
-                //std::cout << (duration[duration.size()-1]) << " ticks at " << (tempos[tempos.size()-1]) << std::endl;
-            }
-            
-            if (seq->getTempoEvent(n-1)->getTick() <= tick)
-            {
-                // after last event
-                tempos.push_back( convertTempoBendToBPM(seq->getTempoEvent(n-1)->getValue()) );
-                duration.push_back( tick - seq->getTempoEvent(n-1)->getTick() );
-            }
-        }
-        else
-        {
-            // tick is before the first event!
-            tempos.push_back(seq->getTempo());
-            duration.push_back(tick);
-        }
-        
-        //std::cout << "Finally, " << (duration[duration.size()-1]) << " ticks at " << (tempos[tempos.size()-1]) << std::endl;
-    }
-    
-    
-    float song_duration = 0;
-    const int amount = tempos.size();
-    for (int n=0; n<amount; n++)
-    {
-        //printf("%i for %i\n", tempos[n], duration[n]);
-        
-        // std::cout << " -- adding " << (int)round( ((float)duration[n] * 60.0f ) / ((float)seq->ticksPerQuarterNote() * (float)tempos[n])) << std::endl;
-        song_duration += ((float)duration[n] * 60.0f ) / ((float)seq->ticksPerQuarterNote() * (float)tempos[n]);
-    }
-    
-    //wxString duration_label = wxString::Format(wxString(_("Song duration :")) + wxT("  %i:%.2i"), (int)(song_duration/60), song_duration%60);
-    //songLength->SetLabel(duration_label);
-    
-    return (int)round(song_duration);
+    return (int)round( seq->getTempoMap().getMicrosecondsAtTick(tick) / 1000000.0 );
 }
 
@@ -48,6 +48,14 @@ namespace AriaMaestosa
     bool makeJDKMidiSequence(Sequence* sequence, jdksmidi::MIDIMultiTrack& tracks, bool selectionOnly,
                              /*out*/int* songLengthInTicks, /*out*/int* startTick, /*out*/ int* numTracks, bool playing);
     
+    /**
+      * @brief find the MIDI channels makeJDKMidiSequence may give the tracks of a sequence, without
+      *        looking at their events
+      * @return a mask where bit n is set if channel n may be used
+      * @ingroup midi
+      */
+    int getPlaybackChannels(Sequence* sequence);
+    
     /**
       * @brief For use with the controller editor, when entering tempo bends
       * @ingroup midi
@@ -22,6 +22,8 @@
 #include "Midi/TimeSigChange.h"
 
 #include <iostream>
+#include "UnitTest.h"
+#include "UnitTestUtils.h"
 #include "irrXML/irrXML.h"
 
 using namespace AriaMaestosa;
@@ -247,11 +249,19 @@ int MeasureData::measureAtTick(int tick) const
             }
         }
         
-        // iterate through measures till we find the one at the given tick
+        // binary search for the last measure starting at or before the given tick (the last measure
+        // is handled below, like ticks past song end)
         const int amount = m_measure_info.size();
-        for (int n=0; n<amount-1; n++)
+        if (amount > 1 and m_measure_info[amount-1].tick > tick)
         {
-            if ( m_measure_info[n].tick <= tick and m_measure_info[n+1].tick > tick ) return n;
+            int from = 0, to = amount - 1; // answer is in [from, to)
+            while (to - from > 1)
+            {
+                const int middle = (from + to)/2;
+                if (m_measure_info[middle].tick <= tick) from = middle;
+                else                                     to   = middle;
+            }
+            return from;
         }
 
         // did not find this tick in our current measure set
@@ -336,6 +346,35 @@ int MeasureData::lastTickInMeasure(int id) const
     }
 }
 
+// ----------------------------------------------------------------------------------------------------------
+
+float MeasureData::beatLengthInTicks(const int measure) const
+{
+    // in constant mode, measure info is not kept up to date
+    if (not isMeasureLengthConstant() and measure < (int)m_measure_info.size())
+    {
+        return m_measure_info[measure].beatLengthInTicks;
+    }
+    return m_sequence->ticksPerQuarterNote() * getBeatSize(measure);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+int MeasureData::beatAtTick(const int tick, int* measure) const
+{
+    const int measureID = measureAtTick(tick);
+    if (measure != NULL) *measure = measureID;
+    
+    return (int)( (tick - firstTickInMeasure(measureID)) / beatLengthInTicks(measureID) );
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+int MeasureData::firstTickInBeat(const int measure, const int beat) const
+{
+    return firstTickInMeasure(measure) + (int)round( beat * beatLengthInTicks(measure) );
+}
+
 // ----------------------------------------------------------------------------------------------------------
 // ----------------------------------------------------------------------------------------------------------
 #if 0
@@ -343,41 +382,33 @@ int MeasureData::lastTickInMeasure(int id) const
 #pragma mark Time Signature Management
 #endif
 
-int MeasureData::getTimeSigNumerator(int measure) const
+int MeasureData::timeSigAtMeasure(const int measure) const
 {
-    if (measure != -1)
+    // time sig changes are kept in measure order, and the first one is at measure 0
+    int from = 0, to = m_time_sig_changes.size(); // answer is in [from, to)
+    while (to - from > 1)
     {
-        measure += 1;
-        const int timeSigChangeAmount = m_time_sig_changes.size();
-        for (int n=0; n<timeSigChangeAmount; n++)
-        {
-            if (m_time_sig_changes[n].getMeasure() >= measure) return m_time_sig_changes[n-1].getNum();
-        }
-        return m_time_sig_changes[timeSigChangeAmount-1].getNum();
+        const int middle = (from + to)/2;
+        if (m_time_sig_changes.getConst(middle)->getMeasure() <= measure) from = middle;
+        else                                                              to   = middle;
     }
-    else return m_time_sig_changes[m_selected_time_sig].getNum();
+    return from;
 }
 
 // ----------------------------------------------------------------------------------------------------------
 
-int MeasureData::getTimeSigDenominator(int measure) const
+int MeasureData::getTimeSigNumerator(int measure) const
 {
+    if (measure != -1) return m_time_sig_changes[timeSigAtMeasure(measure)].getNum();
+    else               return m_time_sig_changes[m_selected_time_sig].getNum();
+}
 
-    if (measure != -1)
-    {
-        measure+=1;
+// ----------------------------------------------------------------------------------------------------------
 
-        const int timeSigChangeAmount = m_time_sig_changes.size();
-        for (int n=0; n<timeSigChangeAmount; n++)
-        {
-            if (m_time_sig_changes[n].getMeasure() >= measure) return m_time_sig_changes[n-1].getDenom();
-        }
-        return m_time_sig_changes[timeSigChangeAmount-1].getDenom();
-    }
-    else
-    {
-        return m_time_sig_changes[m_selected_time_sig].getDenom();
-    }
+int MeasureData::getTimeSigDenominator(int measure) const
+{
+    if (measure != -1) return m_time_sig_changes[timeSigAtMeasure(measure)].getDenom();
+    else               return m_time_sig_changes[m_selected_time_sig].getDenom();
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -537,6 +568,9 @@ void MeasureData::updateMeasureInfo()
         // calculations and drawing
         m_measure_info[n].tick = (int)round( tick );
         //m_measure_info[n].pixel = (int)round( tick * zoom );
+        m_measure_info[n].beatLengthInTicks = ticksPerQuarterNote *
+                                              getBeatSize(m_time_sig_changes[timg_sig_event].getNum(),
+                                                          m_time_sig_changes[timg_sig_event].getDenom());
         tick += getMeasureLengthInTicks(m_time_sig_changes[timg_sig_event].getNum(),
                                         m_time_sig_changes[timg_sig_event].getDenom());
     }
@@ -888,3 +922,45 @@ float MeasureData::getBeatSize(int numerator, int denominator) const
     return 4.0/(float)denominator;
 }
 
+// ----------------------------------------------------------------------------------------------------------
+
+UNIT_TEST( TestTickLookupsWithTimeSigChanges )
+{
+    Sequence* seq = new Sequence(NULL, NULL, NULL, NULL, false);
+    
+    TestSequenceProvider provider(seq);
+    AriaMaestosa::setCurrentSequenceProvider(&provider);
+    
+    MeasureData* md = seq->getMeasureData();
+    {
+        ScopedMeasureTransaction tr(md->startTransaction());
+        tr->setExpandedMode(true);
+        tr->setMeasureAmount(40);
+        tr->addTimeSigChange(5,  3, 4);
+        tr->addTimeSigChange(17, 7, 8);
+        tr->addTimeSigChange(30, 4, 4);
+    }
+    require(not md->isMeasureLengthConstant(), "sanity check");
+    
+    require(md->getTimeSigNumerator(4)  == 4, "time sig before the first change");
+    require(md->getTimeSigNumerator(5)  == 3, "time sig at a change");
+    require(md->getTimeSigNumerator(29) == 7, "time sig just before a change");
+    require(md->getTimeSigNumerator(39) == 4, "time sig after the last change");
+    
+    // the last measure is looked up like ticks past song end, which gives the same answer
+    for (int m=0; m<md->getMeasureAmount(); m++)
+    {
+        const int first = md->firstTickInMeasure(m);
+        const int last  = md->lastTickInMeasure(m);
+        
+        require(md->measureAtTick(first)    == m, "first tick of each measure is found");
+        require(md->measureAtTick(last - 1) == m, "last tick of each measure is found");
+        
+        int measure = -1;
+        require(md->beatAtTick(first, &measure) == 0 and measure == m, "measures start on beat 0");
+        require(md->beatAtTick(last - 1) == md->getBeatCount(m) - 1, "measures end on their last beat");
+        require(md->firstTickInBeat(m, md->getBeatCount(m)) == last, "beats add up to the measure");
+    }
+    
+    delete seq;
+}
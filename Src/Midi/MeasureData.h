@@ -69,6 +69,7 @@ namespace AriaMaestosa
                 tick = 0;
                 // pixel = 0; widthInPixels=-1;
                 endTick=-1; widthInTicks=-1;
+                beatLengthInTicks=-1;
             }
             
             bool selected;
@@ -76,6 +77,9 @@ namespace AriaMaestosa
             //int pixel, endPixel;
             int widthInTicks;
             //int widthInPixels;
+            
+            /** length of a beat in this measure, filled with the tick positions in updateMeasureInfo */
+            float beatLengthInTicks;
         };
         
         /** contains one item for each measure in the sequence */
@@ -111,6 +115,9 @@ namespace AriaMaestosa
          */
         void  updateMeasureInfo();
         
+        /** @return the ID of the time signature change in effect at the given measure */
+        int   timeSigAtMeasure(const int measure) const;
+        
         void  setExpandedMode(bool expanded);
         void  setMeasureAmount(int measureAmount);
 
@@ -314,6 +321,18 @@ namespace AriaMaestosa
             return lastTickInMeasure(id) - firstTickInMeasure(id);
         }
         
+        /** @return the length of a beat in the given measure, cached by updateMeasureInfo */
+        float beatLengthInTicks(const int measure) const;
+        
+        /**
+          * @brief  Get the beat at the given tick, counted from 0 at the start of its measure
+          * @param[out] measure  if not NULL, receives the measure at the given tick
+          */
+        int   beatAtTick(const int tick, int* measure = NULL) const;
+        
+        /** @return the tick at which the given beat (counted from 0) of the given measure starts */
+        int   firstTickInBeat(const int measure, const int beat) const;
+        
         /** Extend the number of measures, if needed, to include the given tick in the song boundaries */
         void extendToTick(const int tick);
         
@@ -26,9 +26,165 @@
 #include "irrXML/irrXML.h"
 
 #include <iostream>
+#include <vector>
+
+#include <wx/thread.h>
 
 using namespace AriaMaestosa;
 
+namespace NotePool
+{
+    const int NOTES_PER_SLAB = 1024;
+    
+    /** storage for one note; free slots are chained together */
+    union Slot
+    {
+        Slot* m_next_free;
+        char  m_storage[sizeof(Note)];
+        
+        // only there for alignment
+        double m_align_double;
+        long long m_align_long;
+    };
+    
+    /**
+      * The GUI thread, which makes most notes, has a free list of its own that it uses without
+      * locking. Other threads (see WorkerPool) share a second one, under the mutex.
+      */
+    struct Pool
+    {
+        Slot* m_main_free;
+        
+        /** only touched with the mutex locked */
+        Slot* m_shared_free;
+        std::vector<Slot*> m_slabs;
+        wxMutex m_mutex;
+        
+        /** changed atomically */
+        volatile int m_live_notes;
+        
+        Pool() : m_main_free(NULL), m_shared_free(NULL), m_live_notes(0) {}
+    };
+    
+    /**
+      * The pool is never destroyed: notes owned by other static objects (e.g. the clipboard) can
+      * be deleted during exit, after the statics of this file are gone.
+      */
+    Pool& getPool()
+    {
+        static Pool* pool = new Pool();
+        return *pool;
+    }
+    
+    /** creates the pool during static initialisation, before any worker thread can race for it */
+    Pool& g_pool = getPool();
+    
+    /** @return a new slab, its slots chained in order so that successive notes are next to each other */
+    Slot* newSlab(Pool& pool)
+    {
+        Slot* slab = new Slot[NOTES_PER_SLAB];
+        for (int n=0; n<NOTES_PER_SLAB - 1; n++) slab[n].m_next_free = &slab[n + 1];
+        slab[NOTES_PER_SLAB - 1].m_next_free = NULL;
+        
+        wxMutexLocker lock(pool.m_mutex);
+        pool.m_slabs.push_back(slab);
+        return slab;
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void* Note::operator new(size_t size)
+{
+    using namespace NotePool;
+    
+    // should a class ever derive from Note, its instances don't fit in the slots
+    if (size != sizeof(Note)) return ::operator new(size);
+    
+    Pool& pool = getPool();
+    __sync_add_and_fetch(&pool.m_live_notes, 1);
+    
+    Slot* slot;
+    if (wxThread::IsMain())
+    {
+        if (pool.m_main_free == NULL)
+        {
+            // take back the slots freed by other threads, if any
+            {
+                wxMutexLocker lock(pool.m_mutex);
+                pool.m_main_free   = pool.m_shared_free;
+                pool.m_shared_free = NULL;
+            }
+            if (pool.m_main_free == NULL) pool.m_main_free = newSlab(pool);
+        }
+        
+        slot = pool.m_main_free;
+        pool.m_main_free = slot->m_next_free;
+    }
+    else
+    {
+        {
+            wxMutexLocker lock(pool.m_mutex);
+            slot = pool.m_shared_free;
+            if (slot != NULL) pool.m_shared_free = slot->m_next_free;
+        }
+        if (slot == NULL)
+        {
+            // keep the first slot of a new slab, share the others
+            slot = newSlab(pool);
+            
+            wxMutexLocker lock(pool.m_mutex);
+            slot[NOTES_PER_SLAB - 1].m_next_free = pool.m_shared_free;
+            pool.m_shared_free = slot->m_next_free;
+        }
+    }
+    return slot;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void Note::operator delete(void* ptr, size_t size)
+{
+    using namespace NotePool;
+    
+    if (ptr == NULL) return;
+    if (size != sizeof(Note))
+    {
+        ::operator delete(ptr);
+        return;
+    }
+    
+    Pool& pool = getPool();
+    Slot* slot = (Slot*)ptr;
+    
+    if (not wxThread::IsMain())
+    {
+        wxMutexLocker lock(pool.m_mutex);
+        slot->m_next_free  = pool.m_shared_free;
+        pool.m_shared_free = slot;
+        __sync_sub_and_fetch(&pool.m_live_notes, 1);
+        return;
+    }
+    
+    slot->m_next_free = pool.m_main_free;
+    pool.m_main_free  = slot;
+    
+    // once no note is left (e.g. all songs were closed), give the memory back
+    if (__sync_sub_and_fetch(&pool.m_live_notes, 1) == 0)
+    {
+        wxMutexLocker lock(pool.m_mutex);
+        
+        // other threads count their note before locking, so none of them is using a slot
+        if (pool.m_live_notes != 0) return;
+        
+        const int slabCount = pool.m_slabs.size();
+        for (int n=0; n<slabCount; n++) delete[] pool.m_slabs[n];
+        pool.m_slabs.clear();
+        pool.m_main_free   = NULL;
+        pool.m_shared_free = NULL;
+    }
+}
+
 Note::Note(Track* parent,
            const int pitchID_arg,
            const int startTick_arg,
@@ -547,3 +703,32 @@ UNIT_TEST( TestFindNotePitch )
 
 
 
+
+UNIT_TEST( TestNotePool )
+{
+    const int COUNT = NotePool::NOTES_PER_SLAB*3;
+    
+    std::vector<Note*> notes;
+    for (int n=0; n<COUNT; n++) notes.push_back(new Note(NULL, 60, n, n + 1, 100));
+    
+    int adjacent = 0;
+    for (int n=1; n<COUNT; n++)
+    {
+        require(notes[n] != notes[n-1], "Each note gets its own storage");
+        if ((char*)notes[n] - (char*)notes[n-1] == sizeof(NotePool::Slot)) adjacent++;
+    }
+    require(adjacent >= COUNT - 3, "Notes created one after the other are contiguous");
+    
+    for (int n=0; n<COUNT; n++)
+    {
+        require(notes[n]->getTick() == n and notes[n]->getEndTick() == n + 1, "Notes don't overlap in memory");
+    }
+    
+    // a freed slot is reused by the next note
+    Note* freed = notes[COUNT/2];
+    delete freed;
+    notes[COUNT/2] = new Note(NULL, 61, 0, 1, 100);
+    require(notes[COUNT/2] == freed, "Freed storage is reused");
+    
+    for (int n=0; n<COUNT; n++) delete notes[n];
+}
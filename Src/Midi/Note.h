@@ -20,6 +20,8 @@
 #include "Utils.h"
 #include <wx/intl.h>
 
+#include <cstddef>
+
 class wxFileOutputStream;
 
 // forward
@@ -167,6 +169,14 @@ namespace AriaMaestosa
         Note(Track* parent, const int pitchID=-1, const int startTick=-1, const int endTick=-1, const int volume=-1, const int string=-1, const int fret=-1); // guitar mode only
         ~Note();
         
+        /**
+          * Notes created with 'new' are taken from slabs of consecutive notes instead of being allocated
+          * one by one, so that notes created together (e.g. on import) are contiguous in memory.
+          * Like with regular allocation, a note keeps its address until it is deleted.
+          */
+        static void* operator new(size_t size);
+        static void  operator delete(void* ptr, size_t size);
+        
         void setParent(Track* parent);
         Track* getParent() { return m_track; }
         
@@ -0,0 +1,129 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "Midi/NoteHotData.h"
+#include "Midi/Note.h"
+
+#include "UnitTest.h"
+
+#include <algorithm>
+
+using namespace AriaMaestosa;
+
+namespace
+{
+    /** notes are tested by blocks of this size, so that blocks with no match are skipped cheaply */
+    const int BLOCK_SIZE = 16;
+}
+
+// -----------------------------------------------------------------------------------------------------------
+
+void NoteHotData::build(const ptr_vector<Note>& notes)
+{
+    const int count = notes.size();
+
+    m_start.resize(count);
+    m_end.resize(count);
+    m_pitch.resize(count);
+    m_volume.resize(count);
+    m_selected.resize(count);
+
+    m_last_tick = 0;
+    for (int n=0; n<count; n++)
+    {
+        const Note* note = notes.getConst(n);
+        m_start[n]    = note->getTick();
+        m_end[n]      = note->getEndTick();
+        m_pitch[n]    = (unsigned char)note->getPitchID();
+        m_volume[n]   = (unsigned char)note->getVolume();
+        m_selected[n] = (note->isSelected() ? 1 : 0);
+        if (m_end[n] > m_last_tick) m_last_tick = m_end[n];
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------
+
+void NoteHotData::updateSelection(const ptr_vector<Note>& notes)
+{
+    ASSERT_E(notes.size(), ==, (int)m_selected.size());
+
+    const int count = m_selected.size();
+    for (int n=0; n<count; n++)
+    {
+        m_selected[n] = (notes.getConst(n)->isSelected() ? 1 : 0);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------
+
+void NoteHotData::findNotesInRange(const int fromTick, const int toTick, std::vector<int>& out) const
+{
+    // only notes that start before 'toTick' can be in range; their ends however are in no particular order
+    const int last = std::lower_bound(m_start.begin(), m_start.end(), toTick) - m_start.begin();
+    const int* end = (last > 0 ? &m_end[0] : NULL);
+
+    int n = 0;
+    for (; n + BLOCK_SIZE <= last; n += BLOCK_SIZE)
+    {
+        int any = 0;
+        for (int i=0; i<BLOCK_SIZE; i++) any |= (end[n + i] > fromTick);
+        if (not any) continue;
+
+        for (int i=0; i<BLOCK_SIZE; i++)
+        {
+            if (end[n + i] > fromTick) out.push_back(n + i);
+        }
+    }
+    for (; n < last; n++)
+    {
+        if (end[n] > fromTick) out.push_back(n);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------
+
+namespace TestNoteHotData
+{
+    using namespace AriaMaestosa;
+
+    UNIT_TEST(TestFindNotesInRange)
+    {
+        ptr_vector<Note> notes;
+
+        // a long note, then short ones every 10 ticks, enough to span several blocks
+        notes.push_back(new Note(NULL, 60, 0, 1000, 80));
+        for (int n=0; n<50; n++)
+        {
+            notes.push_back(new Note(NULL, 40 + n%20, 10 + n*10, 15 + n*10, 100));
+        }
+
+        NoteHotData data;
+        data.build(notes);
+        require(data.size() == 51, "all notes are in the arrays");
+
+        std::vector<int> found;
+        data.findNotesInRange(300, 330, found);
+
+        std::vector<int> expected;
+        for (int n=0; n<notes.size(); n++)
+        {
+            if (notes[n].getEndTick() > 300 and notes[n].getTick() < 330) expected.push_back(n);
+        }
+
+        require(found == expected, "the notes found are those overlapping the range, in order");
+        require(found.size() == 4 and found[0] == 0, "the long note starting before the range is found");
+    }
+}
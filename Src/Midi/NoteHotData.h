@@ -0,0 +1,73 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __NOTE_HOT_DATA_H__
+#define __NOTE_HOT_DATA_H__
+
+#include "ptr_vector.h"
+#include "Utils.h"
+
+#include <vector>
+
+namespace AriaMaestosa
+{
+    class Note;
+
+    /**
+      * @brief The fields of a track's notes that rendering, selection and playback look at, stored
+      *        in parallel arrays (index n is note n of the track)
+      *
+      * Scans over many notes then go through a few contiguous arrays instead of one heap object per
+      * note. Loops over these arrays are kept simple (no early exits, no calls) so the compiler can
+      * vectorise them.
+      *
+      * @ingroup midi
+      */
+    class NoteHotData
+    {
+    public:
+        LEAK_CHECK();
+
+        /** sorted, since notes are kept in order of their start */
+        std::vector<int> m_start;
+        std::vector<int> m_end;
+        std::vector<unsigned char> m_pitch;
+        std::vector<unsigned char> m_volume;
+        std::vector<unsigned char> m_selected;
+
+        /** Biggest end tick among the notes (0 if there are none) */
+        int m_last_tick;
+
+        NoteHotData() { m_last_tick = 0; }
+
+        /** Replaces the contents with the fields of the given notes */
+        void build(const ptr_vector<Note>& notes);
+
+        /** Refreshes only 'm_selected', for when the notes were selected or deselected but not changed */
+        void updateSelection(const ptr_vector<Note>& notes);
+
+        int size() const { return m_start.size(); }
+
+        /**
+          * @brief Appends to 'out', in order, the IDs of notes that end after 'fromTick' and start
+          *        before 'toTick'
+          */
+        void findNotesInRange(const int fromTick, const int toTick, std::vector<int>& out) const;
+    };
+
+}
+
+#endif
@@ -227,6 +227,23 @@ void seq_pitch_bend(const int value, const int channel)
     snd_seq_drain_output(context_ref->sequencer);
 }
 
+void seq_sysex(const unsigned char* bytes, const int length)
+{
+    snd_seq_event_t event;
+
+    snd_seq_ev_clear(&event);
+
+    event.queue  = SND_SEQ_QUEUE_DIRECT;
+    event.source = context_ref->address;
+
+    snd_seq_ev_set_subs(&event);
+    snd_seq_ev_set_direct(&event);
+    snd_seq_ev_set_sysex(&event, length, (void*)bytes);
+
+    snd_seq_event_output_direct(context_ref->sequencer, &event);
+    snd_seq_drain_output(context_ref->sequencer);
+}
+
 
 }
 }
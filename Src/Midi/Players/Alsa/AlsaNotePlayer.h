@@ -35,6 +35,7 @@ class MidiContext;
         void seq_prog_change(const int instrumentID, const int channel);
         void seq_controlchange(const int controller, const int value, const int channel);
         void seq_pitch_bend(const int value, const int channel);
+        void seq_sysex(const unsigned char* bytes, const int length);
     }
 }
 
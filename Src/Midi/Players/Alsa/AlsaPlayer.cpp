@@ -175,6 +175,7 @@ class SequencerThread : public wxThread
 {
     jdksmidi::MIDIMultiTrack* jdkmidiseq;
     jdksmidi::MIDISequencer* jdksequencer;
+    AriaSequenceTimer* m_timer;
     int songLengthInTicks;
     bool selectionOnly;
     int m_start_tick;
@@ -185,11 +186,13 @@ public:
     {
         jdkmidiseq = NULL;
         jdksequencer = NULL;
+        m_timer = NULL;
         SequencerThread::selectionOnly = selectionOnly;
     }
     ~SequencerThread()
     {
         if (jdksequencer != NULL) delete jdksequencer;
+        if (m_timer != NULL) delete m_timer;
         if (jdkmidiseq != NULL) delete jdkmidiseq;
     }
 
@@ -206,6 +209,9 @@ public:
         //        " songLengthInTicks=" << songLengthInTicks << std::endl;
 
         jdksequencer = new jdksmidi::MIDISequencer(jdkmidiseq);
+
+        // on the main thread, so it gets a consistent copy of the tempo map
+        m_timer = new AriaSequenceTimer(g_sequence);
     }
 
     void go(int* startTick /* out */)
@@ -225,8 +231,7 @@ public:
 
     ExitCode Entry()
     {
-        AriaSequenceTimer timer(g_sequence);
-        timer.run(jdksequencer, songLengthInTicks);
+        m_timer->run(jdksequencer, songLengthInTicks, m_start_tick);
 
         must_stop = true;
         cleanup_after_playback();
@@ -648,6 +653,11 @@ public:
         AlsaPlayerStuff::seq_pitch_bend(value, channel);
     }
 
+    virtual void seq_sysex(const unsigned char* bytes, const int length)
+    {
+        AlsaPlayerStuff::seq_sysex(bytes, length);
+    }
+
 };
 
 class AlsaMidiManagerFactory : public PlatformMidiManagerFactory
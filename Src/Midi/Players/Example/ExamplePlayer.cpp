@@ -44,6 +44,7 @@ namespace AriaMaestosa
     {
         jdksmidi::MIDIMultiTrack* jdkmidiseq;
         jdksmidi::MIDISequencer* jdksequencer;
+        AriaSequenceTimer* m_timer;
         int songLengthInTicks;
         bool selectionOnly;
         int m_start_tick;
@@ -55,6 +56,7 @@ namespace AriaMaestosa
         {
                 jdkmidiseq = NULL;
                 jdksequencer = NULL;
+                m_timer = NULL;
                 SequencerThread::selectionOnly = selectionOnly;
                 SequencerThread::sequence = sequence;
         }
@@ -62,6 +64,7 @@ namespace AriaMaestosa
         {
             std::cout << "cleaning up sequencer" << std::endl;
             if(jdksequencer != NULL) delete jdksequencer;
+            if (m_timer != NULL) delete m_timer;
             if(jdkmidiseq != NULL) delete jdkmidiseq;
         }
 
@@ -78,6 +81,9 @@ namespace AriaMaestosa
             //        " songLengthInTicks=" << songLengthInTicks << std::endl;
 
             jdksequencer = new jdksmidi::MIDISequencer(jdkmidiseq);
+
+            // on the main thread, so it gets a consistent copy of the tempo map
+            m_timer = new AriaSequenceTimer(sequence);
         }
 
         void go(int* startTick /* out */)
@@ -97,8 +103,7 @@ namespace AriaMaestosa
 
         ExitCode Entry()
         {
-            AriaSequenceTimer timer(sequence);
-            timer.run(jdksequencer, songLengthInTicks);
+            m_timer->run(jdksequencer, songLengthInTicks, m_start_tick);
 
             playing = false;
             cleanup_after_playback();
@@ -242,6 +247,10 @@ namespace AriaMaestosa
         {
         }
 
+        virtual void seq_sysex(const unsigned char* bytes, const int length)
+        {
+        }
+
         // called repeatedly by the generic sequencer to tell
         // the midi player what is the current progression
         // the sequencer will call this with -1 as argument to indicate it exits.
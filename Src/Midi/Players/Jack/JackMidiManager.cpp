@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <memory>
+#include <vector>
 #include <exception>
 #include <cassert>
 #include <stdint.h>
@@ -16,6 +17,10 @@
 #include <jdksmidi/sequencer.h>
 #include "Midi/CommonMidiUtils.h"
 #include "Midi/Sequence.h"
+#include "Midi/MeasureData.h"
+#include "Midi/TempoMap.h"
+#include "Midi/Players/Metronome.h"
+#include "Midi/Players/MidiInputQueue.h"
 #include "Midi/Players/PlatformMidiManager.h"
 
 
@@ -36,6 +41,12 @@ struct ScopedLocker
 		pthread_mutex_t* m_mutex;
 };
 
+struct JackMetronomeClick
+{
+	double m_time; // ms since the start of the stream
+	unsigned char m_key;
+};
+
 class PrivateJackMidiPlayer
 {
 public:
@@ -53,7 +64,8 @@ public:
 		delete m_sequencer;
 	}
 
-	PrivateJackMidiPlayer(): m_playing(false), m_frame(0), m_sequencer(0)
+	PrivateJackMidiPlayer(): m_playing(false), m_frame(0), m_loop_length(0.0), m_loop_offset(0.0), m_sequencer(0),
+		m_next_click(0), m_metronome_sequence(0), m_live_input(0), m_live_channel(0), m_live_playthrough(false)
 	{
 		pthread_mutexattr_t mattr;
 		pthread_mutexattr_init(&mattr);
@@ -78,6 +90,12 @@ public:
 					);
 					if(m_port == 0)
 						throw std::exception();
+					// clicks get a port of their own, so they never share a channel with the song
+					m_metronome_port = jack_port_register(
+						m_jack, "metronome_out", JACK_DEFAULT_MIDI_TYPE, JackPortIsOutput, 0
+					);
+					if(m_metronome_port == 0)
+						throw std::exception();
 					if(jack_activate(m_jack) != 0)
 						throw std::exception();
 				}
@@ -100,13 +118,34 @@ public:
 		}
 	}
 
-	void play(jdksmidi::MIDIMultiTrack* tracks, uint64_t frame = 0)
+	// loopLengthMs: when > 0, playback restarts from the beginning after
+	// that many milliseconds, until stopped.
+	// clicks: metronome clicks of one iteration, in time order; they are only
+	// heard while metronomeSequence->playWithMetronome() is on, which is read
+	// live; their times and sounds are fixed until the next call. The vector is
+	// emptied.
+	void play(jdksmidi::MIDIMultiTrack* tracks, uint64_t frame = 0, double loopLengthMs = 0.0,
+	          std::vector<JackMetronomeClick>* clicks = 0,
+	          const AriaMaestosa::Sequence* metronomeSequence = 0)
 	{
+		if (clicks != 0 && !clicks->empty()) connectMetronomePort();
+
 		jdksmidi::MIDISequencer* tmp = new jdksmidi::MIDISequencer(tracks);
+		std::vector<JackMetronomeClick> tmpClicks;
+		if (clicks != 0) tmpClicks.swap(*clicks);
 		{
 			ScopedLocker lock(&m_mutex);
 			std::swap(tmp, m_sequencer);
+			m_clicks.swap(tmpClicks);
 			m_frame = frame;
+			m_loop_length = loopLengthMs;
+			m_loop_offset = frame * (1000.0 / jack_get_sample_rate(m_jack));
+			m_next_click = 0;
+			while (m_next_click < m_clicks.size() && m_clicks[m_next_click].m_time < m_loop_offset)
+			{
+				++m_next_click;
+			}
+			m_metronome_sequence = metronomeSequence;
 			m_playing = true;
 		}
 		delete tmp;
@@ -128,6 +167,17 @@ public:
 		}
 	}
 
+	// liveInput: messages received while recording, drained on every period
+	// whether playing or not; when playthrough is on, they are played on the
+	// given channel. Pass 0 before anything else may clear the queue.
+	void setLiveInput(AriaMaestosa::MidiInputQueue* liveInput, int channel, bool playthrough)
+	{
+		ScopedLocker lock(&m_mutex);
+		m_live_input = liveInput;
+		m_live_channel = channel;
+		m_live_playthrough = playthrough;
+	}
+
 	bool isPlaying()
 	{
 		ScopedLocker lock(&m_mutex);
@@ -142,50 +192,99 @@ public:
 	}
 	
 	private:
+		// connects the metronome port wherever the song port goes, unless the
+		// user already wired it up
+		void connectMetronomePort()
+		{
+			if (jack_port_connected(m_metronome_port) > 0) return;
+
+			const char** destinations = jack_port_get_connections(m_port);
+			if (destinations == 0) return;
+			for (int n = 0; destinations[n] != 0; n++)
+			{
+				jack_connect(m_jack, jack_port_name(m_metronome_port), destinations[n]);
+			}
+			jack_free(destinations);
+		}
+
 		static int handleJack(jack_nframes_t nFrame, void* selfv)
 		{
 			PrivateJackMidiPlayer* self = reinterpret_cast<PrivateJackMidiPlayer*>(selfv);
 			unsigned srate = jack_get_sample_rate(self->m_jack);
 			void* buf = jack_port_get_buffer(self->m_port, nFrame);
 			jack_midi_clear_buffer(buf);
+			void* clickBuf = jack_port_get_buffer(self->m_metronome_port, nFrame);
+			jack_midi_clear_buffer(clickBuf);
 
 			ScopedLocker lock(&self->m_mutex);
+			self->writeLiveInput(buf);
 			if (self->m_playing)
 			{
 				// [bgn, end)
 				double bgn = self->m_frame * (1000.0 / srate);
 				double end = (self->m_frame + nFrame) * (1000.0 / srate);
+				const bool looping = (self->m_loop_length > 0.0);
 
-				self->m_sequencer->GoToTimeMs(bgn);
-
-				float t;
-				while (self->m_sequencer->GetNextEventTimeMs(&t) && t < end)
+				// when the loop end falls within this period, the events of the next iteration
+				// are written right after it, at their exact frame, so there is no gap
+				while (true)
 				{
-					int trackId;
-					jdksmidi::MIDITimedBigMessage msg;
-					self->m_sequencer->GetNextEvent(&trackId, &msg);
+					const double loopEnd = self->m_loop_offset + self->m_loop_length;
+					self->m_sequencer->GoToTimeMs(bgn - self->m_loop_offset);
 
-					if (not msg.IsMetaEvent())
+					float t;
+					while (self->m_sequencer->GetNextEventTimeMs(&t) &&
+					       t + self->m_loop_offset < end &&
+					       (!looping || t + self->m_loop_offset < loopEnd))
 					{
-						unsigned l = msg.GetLength();
-						assert(l < 4);
-						uint8_t* ev = jack_midi_event_reserve(
-							buf, int(t * (srate / 1000.0)) - self->m_frame, l
-						);
-						ev[0] = msg.GetStatus();
-						if(l >= 2)
-						{
-							ev[1] = msg.GetByte1();
-						}
-						if(l >= 3)
+						// clicks and events must be written in time order
+						self->writeClicks(clickBuf, t, srate, nFrame);
+
+						int trackId;
+						jdksmidi::MIDITimedBigMessage msg;
+						self->m_sequencer->GetNextEvent(&trackId, &msg);
+
+						if (not msg.IsMetaEvent())
 						{
-							ev[2] = msg.GetByte2();
+							unsigned l = msg.GetLength();
+							assert(l < 4);
+							uint8_t* ev = self->reserveEvent(buf, t + self->m_loop_offset, srate, nFrame, l);
+							if (ev == 0) continue;
+							ev[0] = msg.GetStatus();
+							if(l >= 2)
+							{
+								ev[1] = msg.GetByte1();
+							}
+							if(l >= 3)
+							{
+								ev[2] = msg.GetByte2();
+							}
 						}
 					}
+
+					self->writeClicks(clickBuf, (looping ? std::min(end, loopEnd) : end) - self->m_loop_offset,
+					                  srate, nFrame);
+
+					if (!looping || loopEnd >= end) break;
+
+					// notes still held at the loop end would never receive their note off
+					for (int ch = 0; ch < 16; ++ch)
+					{
+						uint8_t* ev = self->reserveEvent(buf, loopEnd, srate, nFrame, 3);
+						if (ev == 0) break;
+						ev[0] = 0xB0 | ch;
+						ev[1] = 0x7B; // all notes off
+						ev[2] = 0;
+					}
+
+					self->m_loop_offset = loopEnd;
+					self->m_next_click = 0;
+					bgn = loopEnd;
 				}
 				self->m_frame += nFrame;
 
-				if(!self->m_sequencer->GetNextEventTimeMs(&t))
+				float t;
+				if(!looping && !self->m_sequencer->GetNextEventTimeMs(&t))
 				{
 					self->m_playing = false;
 					pthread_cond_signal(&self->m_finish);
@@ -195,11 +294,73 @@ public:
 			return 0;
 		}
 
+		// reserves room for an event at the given time, in ms since the start
+		// of playback; returns 0 when the buffer is full
+		uint8_t* reserveEvent(void* buf, double timeMs, unsigned srate, jack_nframes_t nFrame, size_t size)
+		{
+			int offset = int(timeMs * (srate / 1000.0)) - int(m_frame);
+			offset = std::max(0, std::min(offset, int(nFrame) - 1));
+			return jack_midi_event_reserve(buf, offset, size);
+		}
+
+		// plays the messages received since the last period at its start, like
+		// PlatformMidiManager::processLiveInput does for the generic sequencer
+		void writeLiveInput(void* buf)
+		{
+			if (m_live_input == 0) return;
+
+			AriaMaestosa::TimedMidiMessage message;
+			while (m_live_input->pop(&message))
+			{
+				if (!m_live_playthrough) continue;
+
+				const int messageType = message.m_bytes[0] & 0xF0;
+				if (messageType != 0x80 && messageType != 0x90 && messageType != 0xB0 && messageType != 0xE0)
+				{
+					continue;
+				}
+
+				uint8_t* ev = jack_midi_event_reserve(buf, 0, 3);
+				if (ev == 0) continue;
+				ev[0] = messageType | m_live_channel;
+				ev[1] = message.m_bytes[1];
+				ev[2] = message.m_bytes[2];
+			}
+		}
+
+		// writes the metronome clicks due before the given time, in ms since the
+		// start of the current iteration, to the metronome port buffer
+		void writeClicks(void* buf, double untilMs, unsigned srate, jack_nframes_t nFrame)
+		{
+			while (m_next_click < m_clicks.size() && m_clicks[m_next_click].m_time < untilMs)
+			{
+				const JackMetronomeClick& click = m_clicks[m_next_click++];
+
+				// read live, so that turning the metronome on or off is heard right away
+				if (m_metronome_sequence == 0 || !m_metronome_sequence->playWithMetronome()) continue;
+
+				uint8_t* ev = reserveEvent(buf, click.m_time + m_loop_offset, srate, nFrame, 3);
+				if (ev == 0) continue;
+				ev[0] = 0x99; // note on, drum channel of the metronome port
+				ev[1] = click.m_key;
+				ev[2] = 127;
+			}
+		}
+
 		jack_client_t* m_jack;
 		jack_port_t* m_port;
+		jack_port_t* m_metronome_port;
 		bool m_playing;
 		uint64_t m_frame;
+		double m_loop_length;  // ms, 0 when not looping
+		double m_loop_offset;  // ms at which the current iteration of the loop started
 		jdksmidi::MIDISequencer* m_sequencer;
+		std::vector<JackMetronomeClick> m_clicks;
+		size_t m_next_click;
+		const AriaMaestosa::Sequence* m_metronome_sequence;
+		AriaMaestosa::MidiInputQueue* m_live_input;
+		int m_live_channel;
+		bool m_live_playthrough;
 		pthread_mutex_t m_mutex;
 		pthread_cond_t m_finish;
 };
@@ -233,8 +394,51 @@ public:
         return out;
     }
     
+	/** @return the duration of one iteration of the loop, or 0 when not looping */
+	double getLoopLengthMs(Sequence* seq, int startTick, int songLengthInTicks)
+	{
+		if (not seq->isLoopEnabled()) return 0.0;
+
+		// the stream starts at startTick
+		const TempoMap& tempoMap = seq->getTempoMap();
+		return (tempoMap.getMicrosecondsAtTick(startTick + songLengthInTicks) -
+		        tempoMap.getMicrosecondsAtTick(startTick)) / 1000.0;
+	}
+
+	/** @return the metronome clicks of the stream, in time order; there is no
+	  * generic sequencer here to generate them as it plays */
+	std::vector<JackMetronomeClick> getMetronomeClicks(Sequence* seq, int startTick, int songLengthInTicks)
+	{
+		std::vector<JackMetronomeClick> clicks;
+
+		Metronome metronome(seq->getMeasureData(), startTick);
+		metronome.setSoundsFromPreferences();
+		metronome.reset(0);
+
+		const TempoMap& tempoMap = seq->getTempoMap();
+		const double startTime = tempoMap.getMicrosecondsAtTick(startTick);
+		for (int tick = metronome.getNextClickTick(); tick < songLengthInTicks;
+		     metronome.next(), tick = metronome.getNextClickTick())
+		{
+			JackMetronomeClick click;
+			click.m_time = (tempoMap.getMicrosecondsAtTick(startTick + tick) - startTime) / 1000.0;
+
+			int sounds[2];
+			metronome.getNextClickSounds(&sounds[0], &sounds[1]);
+			for (int n = 0; n < 2; ++n)
+			{
+				if (sounds[n] == -1) continue;
+				click.m_key = sounds[n];
+				clicks.push_back(click);
+			}
+		}
+		return clicks;
+	}
+
 	void resetSync()
 	{
+		player->setLiveInput(0, 0, false);
+
 		jdksmidi::MIDIMultiTrack tracks(1);
 		tracks.SetClksPerBeat(960);
 		for (int ch = 0; ch < 16; ++ch)
@@ -283,7 +487,14 @@ public:
 		int nTrack = -1;
 		tracks.reset(new jdksmidi::MIDIMultiTrack());
 		makeJDKMidiSequence(seq, *tracks, false, &len, startTick, &nTrack, true);
-		player->play(tracks.get());
+		std::vector<JackMetronomeClick> clicks = getMetronomeClicks(seq, *startTick, len);
+		player->play(tracks.get(), 0, getLoopLengthMs(seq, *startTick, len), &clicks, seq);
+
+		// there is no generic sequencer calling processLiveInput, the player drains the queue itself
+		if (isRecording()) player->setLiveInput(&m_live_queue, m_record_channel, m_playthrough);
+
+		// this player starts right away, even when recording was armed to wait for a note
+		setRecordTimeOrigin(MidiInputQueue::now());
 
         m_start_tick = *startTick;
 		return true;
@@ -297,7 +508,8 @@ public:
 		int nTrack = -1;
 		tracks.reset(new jdksmidi::MIDIMultiTrack());
 		makeJDKMidiSequence(seq, *tracks, true, &len, startTick, &nTrack, true);
-		player->play(tracks.get());
+		std::vector<JackMetronomeClick> clicks = getMetronomeClicks(seq, *startTick, len);
+		player->play(tracks.get(), 0, getLoopLengthMs(seq, *startTick, len), &clicks, seq);
 
         m_start_tick = *startTick;
         
@@ -940,5 +940,13 @@ home_setBank:
     return;
 }
 
+// ------------------------------------------------------------------------------------------------------
+
+void AudioUnitOutput::sysex(const unsigned char* bytes, const int length)
+{
+    OSStatus result = MusicDeviceSysEx(m_synth_unit, bytes, length);
+    if (result != 0) fprintf(stderr, "Error in MidiPlayer::sysex : %i\n", (int)result);
+}
+
 
 #endif
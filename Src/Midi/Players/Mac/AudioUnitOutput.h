@@ -49,6 +49,7 @@ public:
     void prog_change(const int instrument, const int channel);
     void controlchange(const int controller, const int value, const int channel);
     void pitch_bend(const int value, const int channel);
+    void sysex(const unsigned char* bytes, const int length);
 
 };
 
@@ -310,5 +310,23 @@ void CoreMidiOutput::pitch_bend(const int value, const int channel)
 
 // ------------------------------------------------------------------------------------------------------
 
+void CoreMidiOutput::sysex(const unsigned char* bytes, const int length)
+{
+    MIDITimeStamp timestamp = 0;   // 0 will mean play now. 
+    Byte buffer[1024];             // storage space for MIDI Packets (max 65536)
+    MIDIPacketList *packetlist = (MIDIPacketList*)buffer;
+    MIDIPacket *currentpacket = MIDIPacketListInit(packetlist);
+    
+    // a complete system exclusive message may be sent as a packet of its own
+    currentpacket = MIDIPacketListAdd(packetlist, sizeof(buffer), 
+                                      currentpacket, timestamp, length, bytes);
+    if (currentpacket == NULL) return;
+    
+    OSStatus result = MIDISend(m_port, selectedOutput, packetlist);
+    if (result != 0) fprintf(stderr, "MIDISend failed!!\n");
+}
+
+// ------------------------------------------------------------------------------------------------------
+
 #endif
 
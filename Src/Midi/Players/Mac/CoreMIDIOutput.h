@@ -57,6 +57,7 @@ public:
     virtual void prog_change(const int instrument, const int channel);
     virtual void controlchange(const int controller, const int value, const int channel);
     virtual void pitch_bend(const int value, const int channel);
+    virtual void sysex(const unsigned char* bytes, const int length);
 };
 
 #endif
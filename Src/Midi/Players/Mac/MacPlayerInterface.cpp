@@ -195,6 +195,7 @@ namespace AriaMaestosa
     {
         jdksmidi::MIDIMultiTrack* jdkmidiseq;
         jdksmidi::MIDISequencer* jdksequencer;
+        AriaSequenceTimer* m_timer;
         int songLengthInTicks;
         bool m_selection_only;
         int m_start_tick;
@@ -207,11 +208,13 @@ namespace AriaMaestosa
             m_sequence = seq;
             jdkmidiseq = NULL;
             jdksequencer = NULL;
+            m_timer = NULL;
             m_selection_only = selectionOnly;
         }
         ~SequencerThread()
         {
             if (jdksequencer != NULL) delete jdksequencer;
+            if (m_timer != NULL) delete m_timer;
             if (jdkmidiseq != NULL) delete jdkmidiseq;
         }
         
@@ -228,6 +231,9 @@ namespace AriaMaestosa
             //        " songLengthInTicks=" << songLengthInTicks << std::endl;
             
             jdksequencer = new jdksmidi::MIDISequencer(jdkmidiseq);
+
+            // on the main thread, so it gets a consistent copy of the tempo map
+            m_timer = new AriaSequenceTimer(m_sequence);
             
             g_current_tick = m_start_tick;
             g_current_accurate_tick = m_start_tick;
@@ -253,8 +259,7 @@ namespace AriaMaestosa
         
         ExitCode Entry()
         {
-            AriaSequenceTimer timer(m_sequence);
-            timer.run(jdksequencer, songLengthInTicks);
+            m_timer->run(jdksequencer, songLengthInTicks, m_start_tick);
             
             //must_stop = true;
             cleanup_after_playback();
@@ -442,6 +447,11 @@ namespace AriaMaestosa
             output->prog_change(instrument, channel);
         }
         
+        void seq_sysex(const unsigned char* bytes, const int length)
+        {
+            output->sysex(bytes, length);
+        }
+        
         virtual void stopNote()
         {
             output->stopNote();
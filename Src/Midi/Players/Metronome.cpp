@@ -0,0 +1,233 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "Midi/Players/Metronome.h"
+#include "Midi/MeasureData.h"
+#include "Midi/Sequence.h"
+#include "PreferencesData.h"
+#include "UnitTest.h"
+#include "UnitTestUtils.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace AriaMaestosa;
+
+namespace
+{
+    // drum keys for the choices of the metronome settings, in the order they are listed in
+    const int BEAT_SOUNDS[]      = { 37 /* side stick */, 31 /* sticks */, 56 /* cowbell */, 75 /* claves */,
+                                     76 /* high wood block */ };
+    const int DOWNBEAT_SOUNDS[]  = { -1, 81 /* open triangle */, 56 /* cowbell */, 76 /* high wood block */ };
+    const int HALF_BEAT_SOUNDS[] = { -1, 42 /* closed hi-hat */, 37 /* side stick */, 77 /* low wood block */ };
+
+    /** the size of the table is deduced from its declaration */
+    template<int COUNT>
+    int soundFromPreferences(const char* setting, const int (&sounds)[COUNT])
+    {
+        const int choice = PreferencesData::getInstance()->getIntValue(setting);
+        return sounds[(choice >= 0 and choice < COUNT) ? choice : 0];
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+Metronome::Metronome(const MeasureData* measureData, const int startTick)
+{
+    m_measure_data    = measureData;
+    m_start_tick      = startTick;
+    m_beat_sound      = BEAT_SOUNDS[0];
+    m_downbeat_sound  = DOWNBEAT_SOUNDS[1];
+    m_half_beat_sound = HALF_BEAT_SOUNDS[0];
+    m_measure         = 0;
+    m_half_beat       = 0;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void Metronome::setSounds(const int beat, const int downbeat, const int halfBeat)
+{
+    m_beat_sound      = beat;
+    m_downbeat_sound  = downbeat;
+    m_half_beat_sound = halfBeat;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void Metronome::setSoundsFromPreferences()
+{
+    setSounds(soundFromPreferences(SETTING_ID_METRONOME_SOUND,           BEAT_SOUNDS),
+              soundFromPreferences(SETTING_ID_METRONOME_DOWNBEAT_SOUND,  DOWNBEAT_SOUNDS),
+              soundFromPreferences(SETTING_ID_METRONOME_HALF_BEAT_SOUND, HALF_BEAT_SOUNDS));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+float Metronome::firstTickInMeasure(const int measure) const
+{
+    const int amount = m_measure_data->getMeasureAmount();
+    if (measure < amount) return m_measure_data->firstTickInMeasure(measure);
+
+    const int lastStart = m_measure_data->firstTickInMeasure(amount - 1);
+    const int lastEnd   = m_measure_data->lastTickInMeasure(amount - 1);
+    return lastEnd + (float)(measure - amount)*(lastEnd - lastStart);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+float Metronome::clickIntervalInTicks(const int measure) const
+{
+    // clicks follow the felt pulse, which is not always a MeasureData beat (e.g. the eighth in 6/8)
+    // click every dotted quarter in compound meters like 6/8, every eighth in meters like 7/8
+    if (m_measure_data->getTimeSigDenominator(measure) == 8)
+    {
+        const float eighth = m_measure_data->beatLengthInTicks(measure);
+        const int numerator = m_measure_data->getTimeSigNumerator(measure);
+        if (numerator % 3 == 0) return eighth*3.0f;
+        if (numerator % 2 == 1) return eighth;
+        return eighth*2.0f;
+    }
+    return m_measure_data->getSequence()->ticksPerQuarterNote();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+float Metronome::nextClickTick() const
+{
+    return firstTickInMeasure(m_measure) + m_half_beat*clickIntervalInTicks(m_measure)/2.0f;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void Metronome::advance()
+{
+    m_half_beat++;
+
+    // tolerate rounding, measures don't always start on a whole tick when the meter changes
+    if (nextClickTick() >= firstTickInMeasure(m_measure + 1) - 0.5f)
+    {
+        m_measure++;
+        m_half_beat = 0;
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void Metronome::reset(const int fromTick)
+{
+    const int tick = m_start_tick + fromTick;
+
+    m_measure = m_measure_data->measureAtTick(tick);
+
+    const float halfInterval = clickIntervalInTicks(m_measure)/2.0f;
+    m_half_beat = std::max(0, (int)std::ceil((tick - firstTickInMeasure(m_measure))/halfInterval - 0.01f));
+    if (nextClickTick() >= firstTickInMeasure(m_measure + 1) - 0.5f)
+    {
+        m_measure++;
+        m_half_beat = 0;
+    }
+
+    if (m_half_beat % 2 == 1 and m_half_beat_sound == -1) advance();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+int Metronome::getNextClickTick() const
+{
+    return (int)round(nextClickTick()) - m_start_tick;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void Metronome::getNextClickSounds(int* sound1, int* sound2) const
+{
+    *sound2 = -1;
+
+    if (m_half_beat % 2 == 1)
+    {
+        *sound1 = m_half_beat_sound;
+    }
+    else
+    {
+        *sound1 = m_beat_sound;
+        if (m_half_beat == 0) *sound2 = m_downbeat_sound;
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void Metronome::next()
+{
+    advance();
+    if (m_half_beat % 2 == 1 and m_half_beat_sound == -1) advance();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+UNIT_TEST( TestMetronomeClicks )
+{
+    Sequence* seq = new Sequence(NULL, NULL, NULL, NULL, false);
+
+    TestSequenceProvider provider(seq);
+    AriaMaestosa::setCurrentSequenceProvider(&provider);
+
+    const int beat = seq->ticksPerQuarterNote();
+
+    // 2/4, then 6/8 from measure 2
+    MeasureData* md = seq->getMeasureData();
+    {
+        ScopedMeasureTransaction tr(md->startTransaction());
+        tr->setExpandedMode(true);
+        tr->setMeasureAmount(4);
+        tr->addTimeSigChange(0, 2, 4); // there is already one at measure 0, it only gets selected
+        tr->setTimeSig(2, 4);
+        tr->addTimeSigChange(2, 6, 8);
+    }
+
+    Metronome metronome(md, 0);
+    metronome.setSounds(37, 81, -1);
+    metronome.reset(0);
+
+    const int expected[] = { 0, beat, 2*beat, 3*beat, 4*beat, 11*beat/2, 7*beat, 17*beat/2,
+                             10*beat, 23*beat/2 };
+    for (int n=0; n<10; n++)
+    {
+        require_e(metronome.getNextClickTick(), ==, expected[n], "clicks follow the time signatures");
+
+        int sound1, sound2;
+        metronome.getNextClickSounds(&sound1, &sound2);
+        require_e(sound1, ==, 37, "every click plays the beat sound");
+        require_e(sound2, ==, (n % 2 == 0 ? 81 : -1), "downbeats are accented, past the last measure too");
+
+        metronome.next();
+    }
+
+    // with half beats, and starting playback mid-song
+    Metronome halves(md, beat);
+    halves.setSounds(37, -1, 42);
+    halves.reset(0);
+    require_e(halves.getNextClickTick(), ==, 0, "ticks are counted from the start of playback");
+    halves.next();
+    require_e(halves.getNextClickTick(), ==, beat/2, "half beats are heard when they have a sound");
+    int sound1, sound2;
+    halves.getNextClickSounds(&sound1, &sound2);
+    require_e(sound1, ==, 42, "half beats have their own sound");
+
+    halves.reset(beat/4);
+    require_e(halves.getNextClickTick(), ==, beat/2, "reset moves to the first click at or after a tick");
+
+    delete seq;
+}
@@ -0,0 +1,87 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __METRONOME_H__
+#define __METRONOME_H__
+
+#include "Utils.h"
+
+namespace AriaMaestosa
+{
+    class MeasureData;
+
+    /**
+      * @brief Works out when the metronome clicks, and with which sounds, from the time signatures
+      *
+      * Clicks are walked one after the other, straight from MeasureData, so nothing needs to be
+      * generated before playback and turning the metronome on or off takes effect immediately.
+      * Past the last measure (e.g. while recording), the last measure keeps repeating.
+      *
+      * @ingroup midi.players
+      */
+    class Metronome
+    {
+        const MeasureData* m_measure_data;
+
+        /** tick at which playback starts; all ticks given and returned are relative to it */
+        int m_start_tick;
+
+        /** drum keys, -1 for none */
+        int m_beat_sound;
+        int m_downbeat_sound;
+        int m_half_beat_sound;
+
+        /** the next click is the given half beat of the given measure */
+        int m_measure;
+        int m_half_beat;
+
+        float firstTickInMeasure(const int measure) const;
+        float clickIntervalInTicks(const int measure) const;
+        float nextClickTick() const;
+
+        /** Moves to the following half beat, whether it is heard or not */
+        void advance();
+
+    public:
+        LEAK_CHECK();
+
+        Metronome(const MeasureData* measureData, const int startTick);
+
+        /** Sets the drum keys to play (-1 for none). Downbeats get both the beat and downbeat sounds. */
+        void setSounds(const int beat, const int downbeat, const int halfBeat);
+
+        /** Sets the drum keys chosen in the preferences */
+        void setSoundsFromPreferences();
+
+        /** Moves to the first click at or after the given tick */
+        void reset(const int fromTick);
+
+        /** @return the tick of the next click */
+        int getNextClickTick() const;
+
+        /**
+          * @brief Gives the drum keys to play for the next click
+          * @param[out] sound2  set to -1 when there is only one sound to play
+          */
+        void getNextClickSounds(int* sound1, int* sound2) const;
+
+        /** Moves to the click after the next one */
+        void next();
+    };
+
+}
+
+#endif
@@ -0,0 +1,154 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <wx/defs.h>
+
+#include "Midi/Players/MidiInputQueue.h"
+#include "UnitTest.h"
+
+#if defined(__WXMSW__)
+#include <windows.h>
+#elif defined(__WXMAC__)
+#include <mach/mach_time.h>
+#else
+#include <time.h>
+#endif
+
+using namespace AriaMaestosa;
+
+namespace
+{
+    /** Makes sure writes before the barrier are visible to other threads before writes after it */
+    inline void memoryBarrier()
+    {
+#if defined(__WXMSW__)
+        MemoryBarrier();
+#else
+        __sync_synchronize();
+#endif
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+MidiInputQueue::MidiInputQueue()
+{
+    m_read    = 0;
+    m_write   = 0;
+    m_dropped = 0;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+bool MidiInputQueue::push(const TimedMidiMessage& message)
+{
+    const unsigned int write = m_write;
+    if (write - m_read >= (unsigned int)CAPACITY)
+    {
+        m_dropped = m_dropped + 1;
+        return false;
+    }
+
+    m_messages[write & (CAPACITY - 1)] = message;
+
+    // the message must be complete before the consumer can see it
+    memoryBarrier();
+    m_write = write + 1;
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+bool MidiInputQueue::pop(TimedMidiMessage* out)
+{
+    const unsigned int read = m_read;
+    if (read == m_write) return false;
+
+    memoryBarrier();
+    *out = m_messages[read & (CAPACITY - 1)];
+
+    // the slot must be read before the producer can reuse it
+    memoryBarrier();
+    m_read = read + 1;
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void MidiInputQueue::clear()
+{
+    m_read = m_write;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+double MidiInputQueue::now()
+{
+#if defined(__WXMSW__)
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1000000.0 / (double)frequency.QuadPart;
+#elif defined(__WXMAC__)
+    static mach_timebase_info_data_t timebase = { 0, 0 };
+    if (timebase.denom == 0) mach_timebase_info(&timebase);
+    return (double)mach_absolute_time() * timebase.numer / timebase.denom / 1000.0;
+#else
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec * 1000000.0 + time.tv_nsec / 1000.0;
+#endif
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+UNIT_TEST( TestMidiInputQueue )
+{
+    MidiInputQueue* queue = new MidiInputQueue();
+    TimedMidiMessage message;
+    message.m_bytes[0] = 0x90;
+    message.m_bytes[1] = 60;
+    message.m_bytes[2] = 100;
+
+    // go around the buffer a few times, with a varying number of messages in it
+    int pushed = 0, popped = 0;
+    for (int round=0; round<50; round++)
+    {
+        for (int n=0; n<round*37; n++)
+        {
+            message.m_time = pushed;
+            if (not queue->push(message)) break;
+            pushed++;
+        }
+
+        require(pushed - popped <= 1024, "the queue never holds more than its capacity");
+
+        TimedMidiMessage out;
+        for (int n=0; n<round*29 and queue->pop(&out); n++)
+        {
+            require_e((int)out.m_time, ==, popped, "messages come out in the order they went in");
+            require_e((int)out.m_bytes[1], ==, 60, "messages come out intact");
+            popped++;
+        }
+    }
+
+    TimedMidiMessage out;
+    while (queue->pop(&out)) popped++;
+    require_e(popped, ==, pushed, "every message that was accepted comes out");
+    require(queue->getDroppedCount() > 0, "messages pushed to a full queue are counted");
+
+    delete queue;
+}
@@ -0,0 +1,78 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __MIDI_INPUT_QUEUE_H__
+#define __MIDI_INPUT_QUEUE_H__
+
+namespace AriaMaestosa
+{
+
+    /** @brief A three-byte MIDI message, stamped with the time it was received at */
+    struct TimedMidiMessage
+    {
+        /** in microseconds, as given by MidiInputQueue::now() */
+        double m_time;
+
+        unsigned char m_bytes[3];
+    };
+
+    /**
+      * @brief Passes MIDI messages from one thread to another without locking
+      *
+      * There must be a single thread pushing and a single thread popping, so that the MIDI
+      * input thread never waits on the GUI or on the sequencer. When the queue is full, new
+      * messages are dropped and counted, to be reported from another thread.
+      *
+      * @ingroup midi.players
+      */
+    class MidiInputQueue
+    {
+        /** must be a power of two */
+        enum { CAPACITY = 1024 };
+
+        TimedMidiMessage m_messages[CAPACITY];
+
+        /** free-running counters; only the producer writes m_write, only the consumer writes m_read */
+        volatile unsigned int m_read;
+        volatile unsigned int m_write;
+
+        /** only the producer writes it, so it needs no lock either */
+        volatile unsigned int m_dropped;
+
+    public:
+
+        MidiInputQueue();
+
+        /** @return false if the queue is full and the message was dropped */
+        bool push(const TimedMidiMessage& message);
+
+        /** @return false if the queue is empty */
+        bool pop(TimedMidiMessage* out);
+
+        /** @return how many messages were dropped so far because the queue was full; may be called
+          *         from any thread */
+        unsigned int getDroppedCount() const { return m_dropped; }
+
+        /** Drops all messages; only call while no thread is pushing or popping */
+        void clear();
+
+        /** @return the time in microseconds, from a monotonic high resolution clock */
+        static double now();
+    };
+
+}
+
+#endif
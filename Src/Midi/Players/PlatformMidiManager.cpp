@@ -20,6 +20,9 @@
 #include "Actions/AddControlEvent.h"
 #include "Actions/Record.h"
 #include "Midi/Players/PlatformMidiManager.h"
+#include "Midi/Sequence.h"
+#include "Midi/TempoMap.h"
+#include "Midi/Track.h"
 #include "PreferencesData.h"
 #include "ptr_vector.h"
 #include "Utils.h"
@@ -33,13 +36,42 @@ using namespace AriaMaestosa;
 ptr_vector<PlatformMidiManagerFactory, REF>* g_all_midi_managers = NULL;
 PlatformMidiManager* g_manager = NULL;
 
+namespace
+{
+    /** how long before the first note of an armed recording received messages are still recorded */
+    const double PRE_ROLL_MICROSECONDS = 1000000.0;
+    
+    /** Sends the GS message that makes a channel play drums (or notes again) */
+    void sendGSRhythmPart(PlatformMidiManager* manager, const int channel, const bool rhythm)
+    {
+        // GS numbers parts 1-9 and 11-16 from 1 to 15, part 10 is 0
+        const unsigned char part = (channel == 9 ? 0 : (channel < 9 ? channel + 1 : channel));
+        unsigned char message[] = { 0xF0, 0x41 /* Roland */, 0x10 /* device */, 0x42 /* GS */, 0x12 /* DT1 */,
+                                    0x40, (unsigned char)(0x10 | part), 0x15 /* use for rhythm part */,
+                                    (unsigned char)(rhythm ? 1 : 0), 0 /* checksum */, 0xF7 };
+        
+        int sum = 0;
+        for (int n=5; n<9; n++) sum += message[n];
+        message[9] = (128 - sum % 128) % 128;
+        
+        manager->seq_sysex(message, sizeof(message));
+    }
+}
+
 // ----------------------------------------------------------------------------------------------------------
 
 PlatformMidiManager::PlatformMidiManager()
 {
     m_recording = false;
     m_record_action = NULL;
+    m_record_channel = 0;
+    m_record_time_origin = -1;
+    m_reported_record_drops = 0;
+    m_reported_live_drops = 0;
     m_playthrough = PreferencesData::getInstance()->getBoolValue(SETTING_ID_PLAYTHROUGH, true);
+    m_record_on_first_note = PreferencesData::getInstance()->getBoolValue(SETTING_ID_RECORD_ON_FIRST_NOTE, false);
+    m_record_armed = false;
+    m_metronome_channel = 9;
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -144,137 +176,250 @@ wxArrayString PlatformMidiManager::getInputChoices()
 void PlatformMidiManager::recordCallback(double deltatime, std::vector<unsigned char> *message,
                                          void *userData)
 {
-    // ---- this function is invoked from a thread!!
+    // ---- this function is invoked from a thread!! Stamp the message and leave the rest to
+    //      processRecordQueue and processLiveInput, without waiting on anything.
     
     PlatformMidiManager* self = (PlatformMidiManager*)userData;
     
     ASSERT( MAGIC_NUMBER_OK_FOR(*self) );
     
-    // self->m_open_notes
-    unsigned int nBytes = message->size();
+    if (message->size() < 3) return;
     
-    if (nBytes >= 3)
+    TimedMidiMessage timed;
+    timed.m_time = MidiInputQueue::now();
+    timed.m_bytes[0] = message->at(0);
+    timed.m_bytes[1] = message->at(1);
+    timed.m_bytes[2] = message->at(2);
+    
+    // when full, the queues count what they drop; printing here could block this thread
+    self->m_record_queue.push(timed);
+    self->m_live_queue.push(timed);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void PlatformMidiManager::reportDroppedMessages()
+{
+    const unsigned int recordDrops = m_record_queue.getDroppedCount();
+    if (recordDrops != m_reported_record_drops)
     {
-        int messageType = message->at(0) & 0xF0;
-        int channel = message->at(0) & 0x0F;
-        int value = message->at(1);
-        int value2 = message->at(2);
-        
-        //printf("message %x on channel %i = %i %i\n", messageType, channel, value, value2);
-        
-        int now_tick = self->m_start_tick + self->getAccurateTick();
+        fprintf(stderr, "[PlatformMidiManager] record queue is full, dropped %u MIDI message(s)\n",
+                recordDrops - m_reported_record_drops);
+        m_reported_record_drops = recordDrops;
+    }
+    
+    const unsigned int liveDrops = m_live_queue.getDroppedCount();
+    if (liveDrops != m_reported_live_drops)
+    {
+        fprintf(stderr, "[PlatformMidiManager] playthrough queue is full, dropped %u MIDI message(s)\n",
+                liveDrops - m_reported_live_drops);
+        m_reported_live_drops = liveDrops;
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void PlatformMidiManager::seq_metronome_setup(int usedChannels)
+{
+    // notes played through while recording use the channel of the record target
+    if (m_recording) usedChannels |= (1 << m_record_channel);
+    
+    m_metronome_channel = 9;
+    if ((usedChannels & (1 << 9)) == 0) return;
+    
+    for (int channel=15; channel>=0; channel--)
+    {
+        if ((usedChannels & (1 << channel)) != 0) continue;
         
-        switch (messageType)
+        m_metronome_channel = channel;
+        sendGSRhythmPart(this, channel, true);
+        seq_controlchange(0, 120, channel);  // bank select MSB : GM2 rhythm bank
+        seq_controlchange(32, 0, channel);   // bank select LSB
+        seq_prog_change(0, channel);         // standard kit
+        seq_controlchange(7, 127, channel);  // full volume
+        return;
+    }
+    
+    // no channel is free, share the drum channel with the song
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void PlatformMidiManager::seq_metronome_release()
+{
+    if (m_metronome_channel == 9) return;
+    
+    // back to the melodic bank, songs only send program changes
+    sendGSRhythmPart(this, m_metronome_channel, false);
+    seq_controlchange(0, 0, m_metronome_channel);
+    seq_controlchange(32, 0, m_metronome_channel);
+    seq_prog_change(0, m_metronome_channel);
+    m_metronome_channel = 9;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void PlatformMidiManager::setRecordTimeOrigin(const double time)
+{
+    wxMutexLocker lock(m_record_time_origin_lock);
+    m_record_time_origin = time;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+int PlatformMidiManager::recordTimeToTick(const double time)
+{
+    const TempoMap& tempoMap = m_record_target->getSequence()->getTempoMap();
+    const double startTime = tempoMap.getMicrosecondsAtTick(m_start_tick);
+    
+    double origin;
+    {
+        wxMutexLocker lock(m_record_time_origin_lock);
+        if (m_record_time_origin < 0)
         {
-            case 0x90: // NOTE ON
-            case 0x80: // NOTE OFF
-                if (messageType == 0x90 and value2 > 0)
-                {
-                    // Note On
-                    
-                    //printf("NOTE ON on channel %i; note : %i velocity : %i\n", channel, value, value2);
-                    
-                    // FIXME: we are in a thread, not all players may be thread-safe!!
-                    if (self->m_playthrough) self->seq_note_on(value, value2, self->m_record_target->getChannel());
-                    
-                    NoteInfo n = {now_tick, value2};
-                    self->m_open_notes[value] = n;
-                }
-                else
-                {
-                    // Note off
-                    
-                    //printf("NOTE OFF on channel %i; note : %i velocity : %i\n", channel, value, value2);
-                    
-                    // FIXME: we are in a thread, not all players may be thread-safe!!
-                    if (self->m_playthrough) self->seq_note_off(value, self->m_record_target->getChannel());
-                    
-                    if (self->m_open_notes.find(value) != self->m_open_notes.end())
-                    {
-                        NoteInfo n = self->m_open_notes[value];
-                        self->m_open_notes.erase(value);
-                        
-                        if (self->m_record_action != NULL)
-                        {
-                            wxMutexLocker lock(self->m_record_action_queue_lock);
-                            int channel = self->m_record_target->getChannel();
-                            // TODO: remove 131 - value old crap
-                            self->m_record_action_queue.push_back(new Action::AddNote((channel == 9 ? value : 131 - value),
-                                                                                      n.m_note_on_tick,
-                                                                                      now_tick,
-                                                                                      n.m_velocity,
-                                                                                      false));
-                        }
-                    }
-                }
-                break;
-                
-            case 0xC0:
-                //printf("PROGRAM CHANGE on channel %i; instrument : %i\n", channel, value);
-                break;
-                
-            case 0xE0:
-            {
-                float val = ControllerEvent::fromPitchBendValue((value | (value2 << 7)) - 8192);
-                
-                // FIXME: when is m_record_action null?
-                if (self->m_record_action != NULL)
-                {
-                    wxMutexLocker lock(self->m_record_action_queue_lock);
-                    self->m_record_action_queue.push_back(new Action::AddControlEvent(now_tick, val,
-                                                                                      PSEUDO_CONTROLLER_PITCH_BEND));
-                }
-                
-                // FIXME: we are in a thread, not all players may be thread-safe!!
-                if (self->m_playthrough) self->seq_pitch_bend((value | (value2 << 7)) - 8192,
-                                                              self->m_record_target->getChannel());
+            // the player does not use the generic sequencer, estimate from its progression
+            m_record_time_origin = MidiInputQueue::now() -
+                                   (tempoMap.getMicrosecondsAtTick(m_start_tick + getAccurateTick()) - startTime);
+        }
+        origin = m_record_time_origin;
+    }
+    
+    const int tick = tempoMap.getTickAtMicroseconds(startTime + time - origin);
+    return (tick < 0 ? 0 : tick);
+}
 
-                break;
+// ----------------------------------------------------------------------------------------------------------
+
+void PlatformMidiManager::recordMessage(const TimedMidiMessage& message)
+{
+    int messageType = message.m_bytes[0] & 0xF0;
+    int channel = message.m_bytes[0] & 0x0F;
+    int value = message.m_bytes[1];
+    int value2 = message.m_bytes[2];
+    
+    //printf("message %x on channel %i = %i %i\n", messageType, channel, value, value2);
+    
+    const int now_tick = recordTimeToTick(message.m_time);
+    
+    switch (messageType)
+    {
+        case 0x90: // NOTE ON
+        case 0x80: // NOTE OFF
+            if (messageType == 0x90 and value2 > 0)
+            {
+                NoteInfo n = {now_tick, value2};
+                m_open_notes[value] = n;
             }
-            case 0xB0:
-                if (self->m_record_action != NULL)
-                {
-                    wxMutexLocker lock(self->m_record_action_queue_lock);
-                    self->m_record_action_queue.push_back(new Action::AddControlEvent(now_tick,
-                                                                                      127 - value2 /* value */,
-                                                                                      value /* controller ID */));
-                }
+            else if (m_open_notes.find(value) != m_open_notes.end())
+            {
+                NoteInfo n = m_open_notes[value];
+                m_open_notes.erase(value);
                 
-                // FIXME: we are in a thread, not all players may be thread-safe!!
-                if (self->m_playthrough) self->seq_controlchange(value, value2,
-                                                                 self->m_record_target->getChannel());
+                // TODO: remove 131 - value old crap
+                m_record_action->action(new Action::AddNote((m_record_channel == 9 ? value : 131 - value),
+                                                            n.m_note_on_tick,
+                                                            now_tick,
+                                                            n.m_velocity,
+                                                            false));
+            }
+            break;
+            
+        case 0xC0:
+            //printf("PROGRAM CHANGE on channel %i; instrument : %i\n", channel, value);
+            break;
+            
+        case 0xE0:
+        {
+            float val = ControllerEvent::fromPitchBendValue((value | (value2 << 7)) - 8192);
+            m_record_action->action(new Action::AddControlEvent(now_tick, val, PSEUDO_CONTROLLER_PITCH_BEND));
+            break;
+        }
+        case 0xB0:
+            m_record_action->action(new Action::AddControlEvent(now_tick,
+                                                                127 - value2 /* value */,
+                                                                value /* controller ID */));
+            break;
+            
+        default:
+            printf("UNKNOWN EVENT %x on channel %i; value : %i %i\n", messageType, channel, value, value2);
+    }
+}
 
-                
-                break;
-                
-            default:
-                printf("UNKNOWN EVENT %x on channel %i; value : %i %i\n", messageType, channel, value, value2);
+// ----------------------------------------------------------------------------------------------------------
 
+void PlatformMidiManager::processRecordQueue()
+{
+    // FIXME: when is m_record_action null?
+    if (m_record_action == NULL) return;
+    
+    reportDroppedMessages();
+    
+    double origin;
+    {
+        wxMutexLocker lock(m_record_time_origin_lock);
+        origin = m_record_time_origin;
+    }
+    
+    TimedMidiMessage message;
+    if (m_record_armed and origin < 0)
+    {
+        // the first note was not received yet, only keep what may fall in the pre-roll
+        while (m_record_queue.pop(&message)) m_pre_roll.push_back(message);
+        while (not m_pre_roll.empty() and
+               m_pre_roll.back().m_time - m_pre_roll.front().m_time > PRE_ROLL_MICROSECONDS)
+        {
+            m_pre_roll.pop_front();
         }
+        return;
     }
     
-    /*
-    for ( unsigned int i=0; i<nBytes; i++ )
-        std::cout << "Byte " << i << " = " << (int)message->at(i) << ", ";
-    if ( nBytes > 0 )
-        std::cout << "stamp = " << deltatime << std::endl;
-     */
+    while (not m_pre_roll.empty())
+    {
+        if (m_pre_roll.front().m_time >= origin - PRE_ROLL_MICROSECONDS) recordMessage(m_pre_roll.front());
+        m_pre_roll.pop_front();
+    }
+    
+    while (m_record_queue.pop(&message))
+    {
+        recordMessage(message);
+    }
 }
 
 // ----------------------------------------------------------------------------------------------------------
 
-void PlatformMidiManager::processRecordQueue()
+double PlatformMidiManager::processLiveInput()
 {
-    if (m_record_action == NULL) return;
+    double firstNoteTime = -1;
     
-    // FIXME: this is a thread, and Sequence/Track are NOT thread-safe!!
-    wxMutexLocker lock(m_record_action_queue_lock);
-    const int count = m_record_action_queue.size();
-    for (int n=0; n<count; n++)
+    TimedMidiMessage message;
+    while (m_live_queue.pop(&message))
     {
-        m_record_action->action(m_record_action_queue.get(n));
+        const int messageType = message.m_bytes[0] & 0xF0;
+        const int value = message.m_bytes[1];
+        const int value2 = message.m_bytes[2];
+        
+        if (messageType == 0x90 and value2 > 0 and firstNoteTime < 0) firstNoteTime = message.m_time;
+        if (not m_playthrough) continue;
+        
+        switch (messageType)
+        {
+            case 0x90: // NOTE ON
+            case 0x80: // NOTE OFF
+                if (messageType == 0x90 and value2 > 0) seq_note_on(value, value2, m_record_channel);
+                else                                    seq_note_off(value, m_record_channel);
+                break;
+                
+            case 0xE0:
+                seq_pitch_bend((value | (value2 << 7)) - 8192, m_record_channel);
+                break;
+                
+            case 0xB0:
+                seq_controlchange(value, value2, m_record_channel);
+                break;
+        }
     }
-    m_record_action_queue.clearWithoutDeleting();
+    
+    return firstNoteTime;
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -322,6 +467,13 @@ bool PlatformMidiManager::startRecording(wxString outputPort, Track* target)
     
     m_recording = true;
     m_record_action = new Action::Record();
+    m_record_channel = m_record_target->getChannel();
+    m_record_queue.clear();
+    m_live_queue.clear();
+    m_pre_roll.clear();
+    m_open_notes.clear();
+    m_record_armed = m_record_on_first_note;
+    setRecordTimeOrigin(-1);
     
     // add the action to the action stack so it can be undone
     m_record_target->action(m_record_action);
@@ -367,9 +519,8 @@ void PlatformMidiManager::stopRecording()
     
     processRecordQueue();
     
-    // it's supposed to have been emptied already but who knows...
-    if (m_record_action_queue.size() > 0) fprintf(stderr, "Why is m_record_action_queue not empty??\n");
-    m_record_action_queue.clearWithoutDeleting();
+    // the record action grew while recording; account for it in the undo memory budget
+    m_record_target->getSequence()->trimUndoStack();
     
     delete m_midi_input;
     m_midi_input = NULL;
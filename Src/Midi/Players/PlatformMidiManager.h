@@ -22,8 +22,10 @@
 #include <wx/arrstr.h>
 #include <wx/thread.h>
 #include <map>
+#include <deque>
 
 #include "Actions/EditAction.h"
+#include "Midi/Players/MidiInputQueue.h"
 #include "ptr_vector.h"
 #include "Utils.h"
 
@@ -55,7 +57,8 @@ namespace AriaMaestosa
      * @li The second is to use the MIDI sequencer provided with Aria (Midi/Players/Sequencer), which builds upon
      *     the simple sequencer provided by libjdkmidi. Simply create a libjdkmidi sequencer (makeJDKMidiSequence
      *     in Midi/CommonMidiUtils can be used to get a jdkmidi sequence, which can be fed to a jdkmidi sequencer),
-     *     then create an object of AriaSequenceTimer type, giving it the jdkmidi sequence object.
+     *     then create an object of AriaSequenceTimer type from the main thread, and give it the jdkmidi sequence
+     *     object when running it.
      *     This object, when run it (and you will want to run it in a thread in order not the block the GUI during
      *     playback), will call the various PlatformMidiManager::get()->seq_* functions (which must be implemented for
      *     anything to happen)
@@ -72,7 +75,7 @@ namespace AriaMaestosa
             int m_velocity;
         };
         
-        /** Used when recording. Key is the midi note ID. */
+        /** Used when recording, from the main thread only. Key is the midi note ID. */
         std::map<int, NoteInfo> m_open_notes;
         
         PlatformMidiManager();
@@ -82,18 +85,52 @@ namespace AriaMaestosa
         /** Track where notes go when recording */
         Track* m_record_target;
         
-        /** rtmidi callback function */
+        /** Channel of the record target, kept here so the MIDI input thread never reads the track */
+        int m_record_channel;
+        
+        /** rtmidi callback function; only timestamps messages and queues them */
         static void recordCallback( double deltatime, std::vector< unsigned char > *message, void *userData );
+        
+        /** Messages received while recording, waiting for processRecordQueue */
+        MidiInputQueue m_record_queue;
+        
+        /** Messages received while recording, waiting for processLiveInput (or the Jack player, which drains it itself) */
+        MidiInputQueue m_live_queue;
+        
+        /** Drop counts of the queues that were already reported, see reportDroppedMessages */
+        unsigned int m_reported_record_drops;
+        unsigned int m_reported_live_drops;
+        
+        /** Reports, from the main thread, messages the input thread had to drop */
+        void reportDroppedMessages();
+        
+        /** While an armed recording waits for its first note, the last messages received */
+        std::deque<TimedMidiMessage> m_pre_roll;
+        
+        /** Time (see MidiInputQueue::now) at which the first tick of the song was played, -1 if unknown */
+        double m_record_time_origin;
+        
+        wxMutex m_record_time_origin_lock;
+        
+        /** @return the tick that was playing when a message stamped with the given time arrived */
+        int recordTimeToTick(const double time);
+        
+        void recordMessage(const TimedMidiMessage& message);
 
         /** Whether to play new notes while recording */
         bool m_playthrough;
         
+        /** Whether recordings wait for the first note received to start */
+        bool m_record_on_first_note;
+        
+        /** Whether the current recording waits (or waited) for its first note */
+        bool m_record_armed;
+        
         /** Used while recording */
         Action::Record* m_record_action;
         
-        ptr_vector<Action::SingleTrackAction> m_record_action_queue;
-        
-        wxMutex m_record_action_queue_lock;
+        /** Channel the generic sequencer plays metronome clicks on, see seq_metronome_setup */
+        int m_metronome_channel;
         
     public:
         
@@ -210,6 +247,23 @@ namespace AriaMaestosa
           */
         void processRecordQueue();
         
+        /** Sends the messages received since the last call to the seq_* functions, if playing through.
+          * Called by the generic sequencer from its own thread; the MIDI record thread never calls them.
+          * @return the time the first note on among these messages arrived at, -1 if there was none
+          */
+        double processLiveInput();
+        
+        /** Called by the generic sequencer when it starts playing, with the MidiInputQueue::now() time
+          * its first tick corresponds to, so that recorded messages can be placed exactly. When it is
+          * never called, the time origin is estimated from getAccurateTick.
+          */
+        void setRecordTimeOrigin(const double time);
+        
+        /** Whether the current recording only starts with the first note received. The generic
+          * sequencer then waits for that note (see processLiveInput) before playing.
+          */
+        bool isRecordArmed() const { return m_record_armed; }
+        
         virtual bool audioExportSetup() { return true; }
         
         // ---------- non-native sequencer interface ---------
@@ -219,6 +273,28 @@ namespace AriaMaestosa
         virtual void seq_controlchange(const int controller, const int value, const int channel) { }
         virtual void seq_pitch_bend   (const int value, const int channel)                       { }
         
+        /** @brief send a complete system exclusive message, 'bytes' starting with 0xF0 and ending with 0xF7 */
+        virtual void seq_sysex        (const unsigned char* bytes, const int length)             { }
+        
+        /**
+          * @brief called by the generic sequencer before it plays anything, to choose where metronome clicks go
+          * @param usedChannels  bit n is set if the song may use channel n
+          * @note  By default, clicks go to the drum channel if the song leaves it free. Otherwise they go to
+          *        another free channel, made a rhythm channel (GM2 rhythm bank, and GS rhythm part for synths
+          *        that only follow GS) so that it plays drum sounds too; the song's drum kit, volume and notes
+          *        then never affect the clicks. Override to send clicks to an output of their own.
+          */
+        virtual void seq_metronome_setup(int usedChannels);
+        
+        /** @brief called by the generic sequencer once it is done, to undo what seq_metronome_setup did */
+        virtual void seq_metronome_release();
+        
+        /** @brief called by the generic sequencer for each metronome click, which is not part of the song */
+        virtual void seq_metronome_click(const int drumKey, const int volume)
+        {
+            seq_note_on(drumKey, volume, m_metronome_channel);
+        }
+        
         /**
           * @brief called repeatedly by the generic sequencer to tell the midi player what is the current
           *        progression. the sequencer will call this with -1 as argument to indicate it exits.
@@ -245,6 +321,12 @@ namespace AriaMaestosa
         
         /** Set whether tp play through when recording */
         void setPlayThrough(bool playthrough) { m_playthrough = playthrough; }
+        
+        /** Get whether recordings wait for the first note received to start */
+        bool isRecordOnFirstNote() const { return m_record_on_first_note; }
+        
+        /** Set whether recordings wait for the first note received to start (applies to the next one) */
+        void setRecordOnFirstNote(bool onFirstNote) { m_record_on_first_note = onFirstNote; }
     };
     
     /**
@@ -14,13 +14,19 @@
  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <algorithm>
+
 #include <wx/thread.h>
 
 #include "GUI/MainFrame.h"
 #include "Midi/Players/Sequencer.h"
 #include "Midi/CommonMidiUtils.h"
 #include "Midi/Sequence.h"
+#include "Midi/Players/Metronome.h"
+#include "Midi/Players/MidiInputQueue.h"
 #include "Midi/Players/PlatformMidiManager.h"
+#include "Midi/MeasureData.h"
+#include "PreferencesData.h"
 
 #include "jdksmidi/world.h"
 #include "jdksmidi/multitrack.h"
@@ -136,9 +142,10 @@ typedef DummyTimer BasicTimer;
 
 #endif
 
-AriaSequenceTimer::AriaSequenceTimer(Sequence* seq)
+AriaSequenceTimer::AriaSequenceTimer(Sequence* seq) : m_tempo_map(seq->getTempoMap())
 {
     m_seq = seq;
+    m_used_channels = getPlaybackChannels(seq);
 }
 
 BasicTimer* timer = NULL;
@@ -149,6 +156,14 @@ void cleanup_sequencer()
     timer = NULL;
 }
 
+void allNotesOff()
+{
+    for (int c=0; c<16; c++)
+    {
+        PlatformMidiManager::get()->seq_controlchange(0x7B /* all notes off */, 0, c);
+    }
+}
+
 int count = 0;
 
 class ReentrencyGuard
@@ -169,7 +184,70 @@ public:
     }
 };
 
-void AriaSequenceTimer::run(jdksmidi::MIDISequencer* jdksequencer, const int songLengthInTicks)
+/** Gives metronome clicks a channel of their own while the sequencer runs */
+class MetronomeChannelGuard
+{
+public:
+    
+    MetronomeChannelGuard(const int usedChannels)
+    {
+        PlatformMidiManager::get()->seq_metronome_setup(usedChannels);
+    }
+    ~MetronomeChannelGuard()
+    {
+        PlatformMidiManager::get()->seq_metronome_release();
+    }
+};
+
+bool AriaSequenceTimer::countIn(const int startTick, const int lengthInTicks, const double ticksPerMillis,
+                                const double origin)
+{
+    Metronome metronome(m_seq->getMeasureData(), startTick);
+    metronome.setSoundsFromPreferences();
+    metronome.reset(0);
+    
+    const double count_in_start = origin - lengthInTicks / ticksPerMillis * 1000.0;
+    
+    while (true)
+    {
+        const int click_tick = metronome.getNextClickTick();
+        const double next_time = (click_tick < lengthInTicks ? count_in_start + click_tick / ticksPerMillis * 1000.0
+                                                             : origin);
+        
+        while (MidiInputQueue::now() < next_time)
+        {
+            if (not PlatformMidiManager::get()->seq_must_continue() and
+                not PlatformMidiManager::get()->isRecording())
+            {
+                return false;
+            }
+            
+            PlatformMidiManager::get()->processLiveInput();
+            wxThread::Sleep(1);
+        }
+        
+        if (click_tick >= lengthInTicks) return true;
+        
+        int sound1, sound2;
+        metronome.getNextClickSounds(&sound1, &sound2);
+        if (sound1 != -1) PlatformMidiManager::get()->seq_metronome_click(sound1, 127);
+        if (sound2 != -1) PlatformMidiManager::get()->seq_metronome_click(sound2, 127);
+        metronome.next();
+    }
+}
+
+double AriaSequenceTimer::streamTickToMillis(const int tick) const
+{
+    return (m_tempo_map.getMicrosecondsAtTick(m_stream_start_tick + tick) - m_stream_start_micros) / 1000.0;
+}
+
+int AriaSequenceTimer::millisToStreamTick(const double millis) const
+{
+    return m_tempo_map.getTickAtMicroseconds(m_stream_start_micros + millis*1000.0) - m_stream_start_tick;
+}
+
+void AriaSequenceTimer::run(jdksmidi::MIDISequencer* jdksequencer, const int songLengthInTicks,
+                            const int startTick)
 {
     // Added because I suspect invalid reentrency is the cause of bug #113
     ReentrencyGuard guard;
@@ -184,16 +262,26 @@ void AriaSequenceTimer::run(jdksmidi::MIDISequencer* jdksequencer, const int son
 
     //std::cout << "trying to play " << seq->suggestFileName().mb_str() << std::endl;
 
+    // metronome clicks go to a channel the song does not use
+    MetronomeChannelGuard metronome_channel(m_used_channels);
+    
     jdksequencer->GoToTimeMs( 0 );
 
-    int bpm = m_seq->getTempo();
-    const int beatlen = m_seq->ticksPerQuarterNote();
-
-    double ticks_per_millis = (double)bpm * (double)beatlen / (double)60000.0;
-
-    //std::cout << "bpm = " << bpm << " beatlen=" << beatlen << " ticks_per_millis=" << ticks_per_millis << std::endl;
-
-    float next_event_time = 0;
+    // the stream starts at 'startTick' of the song; event times come from the tempo map, not from
+    // the tempo events of the stream
+    m_stream_start_tick   = startTick;
+    m_stream_start_micros = m_tempo_map.getMicrosecondsAtTick(startTick);
+    
+    double next_event_time = 0;
+    
+    // time (in the same timeline as next_event_time) at which the iteration whose events are being
+    // sent started, and at which the one being heard started; they differ once the next iteration of
+    // a loop was queued ahead
+    double iteration_start_time = 0;
+    double playing_iteration_start_time = 0;
+    
+    // when the next iteration of a loop was queued ahead, time at which the current one ends; -1 otherwise
+    double loop_end_time = -1;
 
     jdksmidi::MIDITimedBigMessage ev;
     int ev_track;
@@ -210,24 +298,114 @@ void AriaSequenceTimer::run(jdksmidi::MIDISequencer* jdksequencer, const int son
     
     long previous_tick = tick;
     
-    next_event_time = tick / ticks_per_millis;
+    next_event_time = streamTickToMillis(tick);
+    
+    // the metronome clicks belong to the iteration being heard
+    Metronome metronome(m_seq->getMeasureData(), startTick);
+    metronome.setSoundsFromPreferences();
+    metronome.reset(0);
+    
+    // an armed recording, and the song with it, only starts with the first note received
+    double start_time = -1;
+    if (PlatformMidiManager::get()->isRecording() and PlatformMidiManager::get()->isRecordArmed())
+    {
+        while (start_time < 0)
+        {
+            if (not PlatformMidiManager::get()->seq_must_continue() and
+                not PlatformMidiManager::get()->isRecording())
+            {
+                cleanup_sequencer();
+                return;
+            }
+            
+            start_time = PlatformMidiManager::get()->processLiveInput();
+            if (start_time < 0) wxThread::Sleep(1);
+        }
+    }
+    else if (PlatformMidiManager::get()->isRecording())
+    {
+        // otherwise a few measures of clicks may precede the recording
+        const int count_in_measures = PreferencesData::getInstance()->getIntValue(SETTING_ID_COUNT_IN);
+        if (count_in_measures > 0)
+        {
+            MeasureData* md = m_seq->getMeasureData();
+            const int count_in_ticks = count_in_measures*md->measureLengthInTicks(md->measureAtTick(startTick));
+            
+            // the count-in precedes the song, at the tempo it starts with
+            const double ticks_per_millis = m_tempo_map.getTempoAtTick(startTick) *
+                                            m_seq->ticksPerQuarterNote() / 60000.0;
+            
+            // the song start is known ahead, so notes played during the count-in are placed right
+            start_time = MidiInputQueue::now() + count_in_ticks / ticks_per_millis * 1000.0;
+            PlatformMidiManager::get()->setRecordTimeOrigin(start_time);
+            
+            if (not countIn(startTick, count_in_ticks, ticks_per_millis, start_time))
+            {
+                cleanup_sequencer();
+                return;
+            }
+        }
+    }
     
     timer = new BasicTimer();
     timer->reset_and_start();
     
-    long total_millis = 0;
-    long last_millis = 0;
+    const double now = MidiInputQueue::now();
+    if (start_time < 0) start_time = now;
+    PlatformMidiManager::get()->setRecordTimeOrigin(start_time);
     
-    int next_metronome_beat = -1;
-    int played_metronome_tick = -1;
+    // when triggered by a note, the song starts at the time that note arrived, a little while ago already
+    const long start_millis = (long)((now - start_time) / 1000.0);
+    
+    long total_millis = start_millis;
+    long last_millis = 0;
     
     int next_beat = 0;
     
     while (PlatformMidiManager::get()->seq_must_continue() or PlatformMidiManager::get()->isRecording())
     {
-        // process all events that need to be done by the current tick
-        while (next_event_time <= total_millis)
+        PlatformMidiManager::get()->processLiveInput();
+        
+        // process all events (and metronome clicks) that need to be done by the current tick
+        while (true)
         {
+            // clicks due before the next event; while the next iteration of a loop is queued, only
+            // those of the iteration that is still playing
+            const double click_limit = std::min((double)total_millis, next_event_time);
+            while (true)
+            {
+                const int click_tick = metronome.getNextClickTick();
+                if (loop_end_time >= 0 and click_tick >= songLengthInTicks) break;
+                
+                const double click_time = playing_iteration_start_time +
+                                          streamTickToMillis(click_tick);
+                if (click_time > click_limit) break;
+                
+                // read live, so that turning the metronome on or off is heard right away
+                if (m_seq->playWithMetronome())
+                {
+                    int sound1, sound2;
+                    metronome.getNextClickSounds(&sound1, &sound2);
+                    if (sound1 != -1) PlatformMidiManager::get()->seq_metronome_click(sound1, 127);
+                    if (sound2 != -1) PlatformMidiManager::get()->seq_metronome_click(sound2, 127);
+                }
+                metronome.next();
+            }
+            
+            if (loop_end_time >= 0 and loop_end_time <= total_millis)
+            {
+                // notes still held at the loop end would never receive their note off
+                allNotesOff();
+                
+                playing_iteration_start_time = loop_end_time;
+                metronome.reset(0);
+                
+                loop_end_time = -1;
+                continue;
+            }
+            
+            if (next_event_time > total_millis) break;
+            
             if (not jdksequencer->GetNextEvent( &ev_track, &ev ))
             {
                 if (not PlatformMidiManager::get()->isRecording() and not m_seq->isLoopEnabled())
@@ -236,30 +414,10 @@ void AriaSequenceTimer::run(jdksmidi::MIDISequencer* jdksequencer, const int son
                     cleanup_sequencer();
                     return;
                 }
-                else
-                {
-                    Sequence* sequence = getMainFrame()->getCurrentSequence();
-                    if (sequence->playWithMetronome())
-                    {
-                        // past the end of the song in record mode. Play metronome
-                        const int beat = sequence->ticksPerQuarterNote();
-                        int metronome_beat = tick - (tick % beat);
-                        if (next_metronome_beat == -1 or metronome_beat > next_metronome_beat)
-                        {
-                            next_metronome_beat = metronome_beat;
-                        }
-                        
-                        const int metronomeInstrument = 37; // 31 (stick), 56 (cowbell), 37 (side stick)
-                        const int metronomeVolume = 127;
-                        
-                        
-                        if ((int)tick >= next_metronome_beat and next_metronome_beat != played_metronome_tick)
-                        {
-                            PlatformMidiManager::get()->seq_note_on(metronomeInstrument, metronomeVolume, 9);
-                            played_metronome_tick = next_metronome_beat;
-                        }
-                    }
-                }
+                
+                // past the end of the song; keep going, the metronome included, without replaying
+                // the last event
+                ev.SetNoOp();
             }
             const int channel = ev.GetChannel();
 
@@ -290,12 +448,7 @@ void AriaSequenceTimer::run(jdksmidi::MIDISequencer* jdksequencer, const int son
                 const int instrument = ev.GetPGValue();
                 PlatformMidiManager::get()->seq_prog_change(instrument, channel);
             }
-            else if (ev.IsTempo())
-            {
-                //std::cout << "tempo event" << std::endl;
-                const int event_bpm = ev.GetTempo32()/32;
-                ticks_per_millis = (double)event_bpm * (double)beatlen / (double)60000.0;
-            }
+            // tempo events need no handling, event times already come from the tempo map
             /*
             else if ( ev.IsPolyPressure() )
                 std::cout << "poly pressure" << std::endl;
@@ -322,12 +475,17 @@ void AriaSequenceTimer::run(jdksmidi::MIDISequencer* jdksequencer, const int son
             if (not jdksequencer->GetNextEventTime(&tick))
             {
                 // if recording, continue as long as user doesn't press stop.
-                // if looping, continue until the loop point, wherever it may be
-                if (PlatformMidiManager::get()->isRecording() or m_seq->isLoopEnabled())
+                // if looping, the next iteration gets queued below
+                if (PlatformMidiManager::get()->isRecording())
                 {
                     Sequence* seq = getMainFrame()->getCurrentSequence();
                     tick = previous_tick + seq->ticksPerQuarterNote();
                 }
+                else if (m_seq->isLoopEnabled())
+                {
+                    // nothing left before the loop end, so restart right away
+                    tick = std::max(previous_tick, (long)songLengthInTicks);
+                }
                 else
                 {
                     cleanup_sequencer();
@@ -337,62 +495,50 @@ void AriaSequenceTimer::run(jdksmidi::MIDISequencer* jdksequencer, const int son
             
             if ((long)tick < (long) previous_tick) continue; // something wrong about time order...
             
-            if (previous_tick >= (long)songLengthInTicks)
+            // looping when recording makes no sense
+            const bool looping = (m_seq->isLoopEnabled() and not PlatformMidiManager::get()->isRecording());
+            
+            if (looping and (long)tick >= (long)songLengthInTicks)
             {
-                // looping when recording makes no sense
-                if (m_seq->isLoopEnabled() and not PlatformMidiManager::get()->isRecording())
+                // look ahead : the next event lies past the loop end, so queue the first events of the
+                // next iteration now, at the exact time the loop ends. The timer keeps running, so no
+                // time is lost between iterations, however long we sleep.
+                PlatformMidiManager::get()->seq_notify_current_tick(previous_tick);
+                
+                loop_end_time = iteration_start_time +
+                                streamTickToMillis(std::max(previous_tick, (long)songLengthInTicks));
+                
+                jdksequencer->GoToTimeMs( 0 );
+                if (not jdksequencer->GetNextEventTime(&tick))
                 {
-                    tick = 0;
-                    previous_tick = 0;
-                    
-                    jdksequencer->GoToTimeMs( 0 );
-                    if (not jdksequencer->GetNextEventTime(&tick))
-                    {
-                        std::cerr << "[AriaSequenceTimer] failed to get first event time, returning (did you try to play en empty sequence?)" << std::endl;
-                        cleanup_sequencer();
-                        return;
-                    }
-                    
-                    //jdksequencer->ResetAllTracks();
-                    
-                    previous_tick = tick;
-                    
-                    next_event_time = tick / ticks_per_millis;
-                    
-                    timer->reset();
-                    
-                    total_millis = 0;
-                    last_millis = 0;
-                    
-                    next_metronome_beat = -1;
-                    played_metronome_tick = -1;
-                    
-                    next_beat = 0;
-                    
-                    // all notes off on all channels
-                    for (int n = 0; n < 16; n++)
-                    {
-                        PlatformMidiManager::get()->seq_controlchange(0x7B /* all notes off */, 0, n);
-                    }
+                    std::cerr << "[AriaSequenceTimer] failed to get first event time, returning (did you try to play en empty sequence?)" << std::endl;
+                    cleanup_sequencer();
+                    return;
                 }
-                else
+                
+                iteration_start_time = loop_end_time;
+                
+                previous_tick = 0;
+                next_event_time = iteration_start_time + streamTickToMillis(tick);
+                
+                next_beat = 0;
+                continue;
+            }
+            
+            if (not looping and previous_tick >= (long)songLengthInTicks)
+            {
+                PlatformMidiManager::get()->seq_notify_current_tick(-1);
+                if (not PlatformMidiManager::get()->isRecording())
                 {
-                    PlatformMidiManager::get()->seq_notify_current_tick(-1);
-                    if (not PlatformMidiManager::get()->isRecording())
-                    {
-                        std::cout << "done, thread will exit" << std::endl;
-                        cleanup_sequencer();
-                        return;
-                    }
+                    std::cout << "done, thread will exit" << std::endl;
+                    cleanup_sequencer();
+                    return;
                 }
             }
 
             PlatformMidiManager::get()->seq_notify_current_tick(previous_tick);
 
-            //std::cout << "next_event_time was " << next_event_time << " adding " <<
-            //((tick - previous_tick) / ticks_per_millis) << " tick=" << tick <<
-            //" previous_tick=" << previous_tick << "ticks_per_millis=" << ticks_per_millis << std::endl;
-            next_event_time += (tick - previous_tick) / ticks_per_millis;
+            next_event_time = iteration_start_time + streamTickToMillis(tick);
 
             /*
             static int i = 0;
@@ -405,21 +551,26 @@ void AriaSequenceTimer::run(jdksmidi::MIDISequencer* jdksequencer, const int son
 
         }
         
-        wxThread::Sleep(10);
+        // while recording, wake up more often so that notes played through are heard without delay
+        wxThread::Sleep(PlatformMidiManager::get()->isRecording() ? 1 : 10);
         
         
         last_millis = total_millis;
         assert(timer != NULL);
-        const int delta = (timer->get_elapsed_millis() - last_millis);
+        const int delta = (timer->get_elapsed_millis() + start_millis - last_millis);
         
         total_millis += delta;
         
-        // FIXME; this will not play well with tempo changes
-        PlatformMidiManager::get()->seq_notify_accurate_current_tick(total_millis*ticks_per_millis);
+        int accurate_tick = millisToStreamTick(total_millis - playing_iteration_start_time);
+        if (loop_end_time < 0 and accurate_tick < previous_tick)
+        {
+            accurate_tick = previous_tick;
+        }
+        PlatformMidiManager::get()->seq_notify_accurate_current_tick(accurate_tick);
         
         if (PlatformMidiManager::get()->isRecording())
         {
-            const int extend_tick = total_millis*ticks_per_millis;
+            const int extend_tick = millisToStreamTick(total_millis);
             if (extend_tick >= next_beat)
             {
                 wxCommandEvent evt(wxEVT_EXTEND_TICK, wxID_ANY);
@@ -432,10 +583,7 @@ void AriaSequenceTimer::run(jdksmidi::MIDISequencer* jdksequencer, const int son
         }
     }
     
-    for (int c=0; c<16; c++)
-    {
-        PlatformMidiManager::get()->seq_controlchange(123 /* all notes off */, 0, c);
-    }
+    allNotesOff();
     
     cleanup_sequencer();
 }
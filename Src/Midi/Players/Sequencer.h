@@ -17,6 +17,8 @@
 #ifndef __ARIA_SEQUENCER_H__
 #define __ARIA_SEQUENCER_H__
 
+#include "Midi/TempoMap.h"
+
 namespace jdksmidi{ class MIDISequencer; }
 
 namespace AriaMaestosa
@@ -28,10 +30,44 @@ namespace AriaMaestosa
     {
         Sequence* m_seq;
         
+        /** Copy of the sequence's tempo map taken on the main thread, all timing of the playback is based on it */
+        TempoMap m_tempo_map;
+        
+        /** Channels the song may play on, see getPlaybackChannels */
+        int m_used_channels;
+        
+        /** Tick of the song at which the stream being played starts, and the time of that tick */
+        int    m_stream_start_tick;
+        double m_stream_start_micros;
+        
+        /** @return time of a tick of the stream, in milliseconds since the stream start */
+        double streamTickToMillis(const int tick) const;
+        
+        /** @return tick of the stream played at the given time, in milliseconds since the stream start */
+        int    millisToStreamTick(const double millis) const;
+        
+        /**
+          * Plays the metronome clicks of the count-in that precedes a recording, whether the metronome
+          * is on or not, then waits for the song to start
+          * @param origin  time (see MidiInputQueue::now) at which the song starts, right after the count-in
+          * @return false if recording was stopped during the count-in
+          */
+        bool countIn(const int startTick, const int lengthInTicks, const double ticksPerMillis,
+                     const double origin);
+        
     public:
 
+        /** To be created from the main thread, before the thread that will call 'run' is started */
         AriaSequenceTimer(Sequence* seq);
-        void run(jdksmidi::MIDISequencer* jdksequencer, const int songLengthInTicks);
+
+        /**
+          * Plays the stream from its beginning. There is no seeking within a running stream: playing from
+          * elsewhere (e.g. resuming after pause) stops and builds a new stream starting there, with the
+          * controller state at that point chased at its start (see Track::addMidiEvents).
+          * @param startTick  tick of the song at which the stream given to the sequencer starts,
+          *                   so that the metronome follows the song's time signatures
+          */
+        void run(jdksmidi::MIDISequencer* jdksequencer, const int songLengthInTicks, const int startTick);
     };
 
 }
@@ -105,6 +105,7 @@ namespace AriaMaestosa
     {
         jdksmidi::MIDIMultiTrack* jdkmidiseq;
         jdksmidi::MIDISequencer* jdksequencer;
+        AriaSequenceTimer* m_timer;
         int songLengthInTicks;
         bool selectionOnly;
         int m_start_tick;
@@ -116,12 +117,14 @@ namespace AriaMaestosa
         {
             jdkmidiseq = NULL;
             jdksequencer = NULL;
+            m_timer = NULL;
             SequencerThread::selectionOnly = selectionOnly;
             SequencerThread::sequence = sequence;
         }
         ~SequencerThread()
         {
             if (jdksequencer != NULL) delete jdksequencer;
+            if (m_timer != NULL) delete m_timer;
             if (jdkmidiseq != NULL) delete jdkmidiseq;
         }
         
@@ -138,6 +141,9 @@ namespace AriaMaestosa
             //        " songLengthInTicks=" << songLengthInTicks << std::endl;
             
             jdksequencer = new jdksmidi::MIDISequencer(jdkmidiseq);
+
+            // on the main thread, so it gets a consistent copy of the tempo map
+            m_timer = new AriaSequenceTimer(sequence);
         }
         
         void go(int* startTick /* out */)
@@ -157,8 +163,7 @@ namespace AriaMaestosa
         
         ExitCode Entry()
         {
-            AriaSequenceTimer timer(sequence);
-            timer.run(jdksequencer, songLengthInTicks);
+            m_timer->run(jdksequencer, songLengthInTicks, m_start_tick);
             
             playing = false;
             cleanup_after_playback();
@@ -497,6 +502,23 @@ namespace AriaMaestosa
             ::midiOutShortMsg(m_hOutMidiDevice, dwMsg);
         }
         
+        virtual void seq_sysex(const unsigned char* bytes, const int length)
+        {
+            MIDIHDR header;
+            memset(&header, 0, sizeof(MIDIHDR));
+            header.lpData         = (LPSTR)bytes;
+            header.dwBufferLength = length;
+            
+            if (::midiOutPrepareHeader(m_hOutMidiDevice, &header, sizeof(MIDIHDR)) != MMSYSERR_NOERROR) return;
+            ::midiOutLongMsg(m_hOutMidiDevice, &header, sizeof(MIDIHDR));
+            
+            // the buffer belongs to the caller, wait until it was sent
+            while (::midiOutUnprepareHeader(m_hOutMidiDevice, &header, sizeof(MIDIHDR)) == MIDIERR_STILLPLAYING)
+            {
+                Sleep(1);
+            }
+        }
+        
         // called repeatedly by the generic sequencer to tell
         // the midi player what is the current progression
         // the sequencer will call this with -1 as argument to indicate it exits.
@@ -21,9 +21,11 @@ const int CURRENT_FILE_VERSION = 4;
 
 #include "AriaCore.h"
 
+#include "Actions/AddNote.h"
 #include "Actions/EditAction.h"
 #include "Actions/Paste.h"
 #include "Actions/Record.h"
+#include "Actions/ResizeNotes.h"
 #include "Actions/ScaleTrack.h"
 #include "Actions/ScaleSong.h"
 #include "Actions/SnapNotesToGrid.h"
@@ -38,11 +40,14 @@ const int CURRENT_FILE_VERSION = 4;
 #include "Midi/Track.h"
 #include "GUI/GraphicalTrack.h"
 #include "PreferencesData.h"
+#include "UnitTest.h"
+#include "UnitTestUtils.h"
 #include "Utils.h"
 
 #include <wx/intl.h>
 #include <wx/utils.h>
 #include <wx/msgdlg.h>
+#include <wx/thread.h>
 #include "irrXML/irrXML.h"
 
 using namespace AriaMaestosa;
@@ -56,6 +61,7 @@ Sequence::Sequence(IPlaybackModeListener* playbackListener, IActionStackListener
     m_quarterNoteResolution     = 960;
     currentTrack                = 0;
     m_tempo                     = 120;
+    m_tempo_map_dirty           = true;
     m_importing                 = false;
     m_loop_enabled              = false;
     m_follow_playback           = PreferencesData::getInstance()->getBoolValue("followPlayback", false);
@@ -66,6 +72,8 @@ Sequence::Sequence(IPlaybackModeListener* playbackListener, IActionStackListener
     m_playback_start_tick       = 0;
     m_default_key_type          = KEY_TYPE_C;
     m_default_key_symbol_amount = 0;
+    m_undo_memory               = 0;
+    m_undo_memory_budget        = PreferencesData::getInstance()->getIntValue(SETTING_ID_UNDO_MEMORY_BUDGET)*1024L*1024L;
     
     m_sequence_filename     = new Model<wxString>( _("Untitled") );
     channelManagement = CHANNEL_AUTO;
@@ -182,6 +190,7 @@ void Sequence::setChannelManagementType(ChannelManagementType type)
 void Sequence::setTicksPerQuarterNote(int res)
 {
     m_quarterNoteResolution = res;
+    m_tempo_map_dirty = true;
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -251,27 +260,29 @@ void Sequence::scale(float factor,
 void Sequence::setTempo(int tmp)
 {
     m_tempo = tmp;
+    m_tempo_map_dirty = true;
 }
 
 // ----------------------------------------------------------------------------------------------------------
 
 float Sequence::getTempoAtTick(const int tick) const
 {
-    float outTempo = getTempo();
+    return getTempoMap().getTempoAtTick(tick);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+const TempoMap& Sequence::getTempoMap() const
+{
+    // players on other threads work from a copy, taken when they start
+    ASSERT(wxThread::IsMain());
     
-    const int amount = m_tempo_events.size();
-    for (int n=0; n<amount; n++)
+    if (m_tempo_map_dirty)
     {
-        if (m_tempo_events[n].getTick() <= tick)
-        {
-            outTempo = convertTempoBendToBPM(m_tempo_events[n].getValue());
-        }
-        else
-        {
-            break;
-        }
+        m_tempo_map.build(m_tempo, m_tempo_events, m_quarterNoteResolution);
+        m_tempo_map_dirty = false;
     }
-    return outTempo;
+    return m_tempo_map;
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -288,6 +299,7 @@ void Sequence::addTempoEvent(ControllerEvent* evt, wxFloat64* previousValue)
 void Sequence::addTempoEvent_import( ControllerEvent* evt )
 {
     m_tempo_events.push_back(evt);
+    m_tempo_map_dirty = true;
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -298,6 +310,7 @@ void Sequence::addTempoEvent_import( ControllerEvent* evt )
 void Sequence::sortTempoEvents()
 {
     m_tempo_events.insertionSort();
+    m_tempo_map_dirty = true;
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -471,6 +484,10 @@ void Sequence::action( Action::MultiTrackAction* actionObj)
     addToUndoStack( actionObj );
     actionObj->setParentSequence(this, new SequenceVisitor(this));
     actionObj->perform();
+    trimUndoStack();
+    
+    const int trackAmount = tracks.size();
+    for (int n=0; n<trackAmount; n++) tracks[n].markEdited();
     
     if (m_action_stack_listener != NULL) m_action_stack_listener->onActionStackChanged();
     
@@ -481,25 +498,78 @@ void Sequence::action( Action::MultiTrackAction* actionObj)
 
 void Sequence::addToUndoStack( Action::EditAction* actionObj )
 {
+    addToUndoStack(actionObj, PlatformMidiManager::get()->isRecording());
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void Sequence::addToUndoStack( Action::EditAction* actionObj, const bool recording )
+{
+    actionObj->m_accounted_memory = 0;
     undoStack.push_back(actionObj);
 
-    if (PlatformMidiManager::get()->isRecording() and
-        dynamic_cast<Action::Record*>(actionObj) == NULL and
-        undoStack.size() >= 2)
+    if (recording and dynamic_cast<Action::Record*>(actionObj) == NULL and undoStack.size() >= 2)
     {
         // special case when recording : the "record" action must stay at the top of the stack until
         // recording is completed
         undoStack.swap(undoStack.size() - 1, undoStack.size() - 2);
     }
     
-    // remove old actions from undo stack, to not take memory uselessly
-    if (undoStack.size() > 8) undoStack.erase(0);
-    
     if (m_action_stack_listener != NULL) m_action_stack_listener->onActionStackChanged();
 }
 
 // ----------------------------------------------------------------------------------------------------------
 
+void Sequence::accountUndoMemory(const int id)
+{
+    Action::EditAction& action = undoStack[id];
+    const long usage = action.getMemoryUsage();
+    m_undo_memory += usage - action.m_accounted_memory;
+    action.m_accounted_memory = usage;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void Sequence::trimUndoStack()
+{
+    const int count = undoStack.size();
+    if (count == 0) return;
+    
+    // the action just performed is one of the top two (it goes below the "record" action while
+    // recording, and the record action grows as it goes)
+    if (count >= 2)
+    {
+        // consecutive actions on the same selection remember the same notes, keep them only once
+        NoteRelocator* newer = undoStack[count - 1].getNoteRelocator();
+        NoteRelocator* older = undoStack[count - 2].getNoteRelocator();
+        if (newer != NULL and older != NULL) newer->shareNotesWith(*older);
+        
+        accountUndoMemory(count - 2);
+    }
+    accountUndoMemory(count - 1);
+    
+    // remove old actions from undo stack once the undo information they keep exceeds the memory
+    // budget. The two newest are always kept (one may be the "record" action that must stay on the
+    // stack). The whole prefix is erased at once.
+    int dropped = 0;
+    while (count - dropped > 2 and m_undo_memory > m_undo_memory_budget)
+    {
+        m_undo_memory -= undoStack[dropped].m_accounted_memory;
+        dropped++;
+    }
+    
+    if (dropped > 0)
+    {
+        undoStack.erase(0, dropped);
+        
+        // the oldest kept action may have shared its notes with an erased one
+        accountUndoMemory(0);
+        if (m_action_stack_listener != NULL) m_action_stack_listener->onActionStackChanged();
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
 void Sequence::undo()
 {
     if (undoStack.size() < 1)
@@ -516,8 +586,29 @@ void Sequence::undo()
         return;
     }
     
+    const int trackAmount = tracks.size();
+    std::vector<unsigned int> generations(trackAmount);
+    for (int n=0; n<trackAmount; n++) generations[n] = tracks[n].getEditGeneration();
+    
     lastAction->undo();
+    
+    // undoing changes the notes the action changed, as far as the action knows which ones they were
+    int fromTick, toTick;
+    for (int n=0; n<trackAmount; n++)
+    {
+        if (lastAction->getEditedNoteTicks(tracks.get(n), &fromTick, &toTick))
+        {
+            tracks[n].markEdited(generations[n], fromTick, toTick);
+        }
+        else
+        {
+            tracks[n].markEdited();
+        }
+    }
+    
+    m_undo_memory -= lastAction->m_accounted_memory;
     undoStack.erase( undoStack.size() - 1 );
+    if (undoStack.size() > 0) accountUndoMemory(undoStack.size() - 1);
 
     if (m_seq_data_listener != NULL) m_seq_data_listener->onSequenceDataChanged();
     
@@ -541,6 +632,7 @@ wxString Sequence::getTopActionName() const
 void Sequence::clearUndoStack()
 {
     undoStack.clearAndDeleteAll();
+    m_undo_memory = 0;
     if (m_action_stack_listener != NULL) m_action_stack_listener->onActionStackChanged();
 }
 
@@ -895,6 +987,7 @@ bool Sequence::readFromFile(irr::io::IrrXMLReader* xml, GraphicalSequence* gseq)
             m_tempo = 120;
             std::cerr << "Missing info from file: main tempo" << std::endl;
         }
+        m_tempo_map_dirty = true;
         
         const char* fileFormatVersion = xml->getAttributeValue("fileFormatVersion");
         int fileversion = -1;
@@ -1215,3 +1308,114 @@ bool Sequence::invariant()
     }
     return true;
 }
+
+// ----------------------------------------------------------------------------------------------------------
+// ----------------------------------------------------------------------------------------------------------
+
+namespace TestSequence
+{
+    using namespace AriaMaestosa::Action;
+    
+    UNIT_TEST(TestUndoMemoryBudget)
+    {
+        Sequence* seq = new Sequence(NULL, NULL, NULL, NULL, false);
+        
+        TestSequenceProvider provider(seq);
+        AriaMaestosa::setCurrentSequenceProvider(&provider);
+        
+        Track* t = new Track(seq);
+        {
+            OwnerPtr<Sequence::Import> import(seq->startImport());
+            t->addNote_import(100 /* pitch */, 0   /* start */, 100 /* end */, 127 /* volume */, -1);
+            t->addNote_import(101 /* pitch */, 101 /* start */, 200 /* end */, 127 /* volume */, -1);
+            t->addNote_import(102 /* pitch */, 201 /* start */, 300 /* end */, 127 /* volume */, -1);
+            t->addNote_import(103 /* pitch */, 301 /* start */, 400 /* end */, 127 /* volume */, -1);
+        }
+        seq->addTrack(t);
+        seq->setUndoMemoryBudget(1024L*1024L*1024L);
+        
+        // the running total follows the actions pushed on the stack
+        long oneAction = 0;
+        for (int n=0; n<10; n++)
+        {
+            t->action(new AddNote(104 /* pitch */, 500 + n*100 /* start */, 590 + n*100 /* end */,
+                                  127 /* volume */, -1));
+            if (n == 0) oneAction = seq->getLatestAction()->getMemoryUsage();
+            
+            require(seq->getUndoStackSize() == n + 1, "actions are kept while under budget");
+            require(seq->getUndoMemoryUsage() == oneAction*(n + 1), "the running total is correct");
+        }
+        
+        // once past the budget, the oldest actions are dropped
+        seq->setUndoMemoryBudget(oneAction*3);
+        t->action(new AddNote(104 /* pitch */, 1500 /* start */, 1590 /* end */, 127 /* volume */, -1));
+        require(seq->getUndoStackSize() == 3, "oldest actions were dropped");
+        require(seq->getUndoMemoryUsage() == oneAction*3, "dropped actions were removed from the total");
+        require(t->getNoteAmount() == 15, "dropping undo information does not touch the track");
+        
+        seq->undo();
+        require(seq->getUndoStackSize() == 2, "undone action was removed");
+        require(seq->getUndoMemoryUsage() == oneAction*2, "undone action was removed from the total");
+        require(t->getNoteAmount() == 14, "undo still works on the remaining actions");
+        
+        // the two newest actions are always kept
+        seq->setUndoMemoryBudget(0);
+        t->action(new AddNote(104 /* pitch */, 1500 /* start */, 1590 /* end */, 127 /* volume */, -1));
+        require(seq->getUndoStackSize() == 2, "the two newest actions are kept whatever the budget");
+        
+        // while recording, the record action stays on top of the stack, also when evicting
+        Record* record = new Record();
+        seq->addToUndoStack(record, true);
+        seq->trimUndoStack();
+        AddNote* other = new AddNote(104 /* pitch */, 1600 /* start */, 1690 /* end */, 127 /* volume */, -1);
+        seq->addToUndoStack(other, true);
+        require(seq->getLatestAction() == record, "the record action stays on top");
+        seq->trimUndoStack();
+        require(seq->getUndoStackSize() == 2, "oldest actions were dropped");
+        require(seq->getLatestAction() == record, "the record action was not evicted");
+        
+        seq->clearUndoStack();
+        require(seq->getUndoMemoryUsage() == 0, "the total is reset with the stack");
+        
+        delete seq;
+    }
+    
+    // ----------------------------------------------------------------------------------------------------------
+    
+    UNIT_TEST(TestUndoSharesNotes)
+    {
+        Sequence* seq = new Sequence(NULL, NULL, NULL, NULL, false);
+        
+        TestSequenceProvider provider(seq);
+        AriaMaestosa::setCurrentSequenceProvider(&provider);
+        
+        Track* t = new Track(seq);
+        {
+            OwnerPtr<Sequence::Import> import(seq->startImport());
+            t->addNote_import(100 /* pitch */, 0   /* start */, 100 /* end */, 127 /* volume */, -1);
+            t->addNote_import(101 /* pitch */, 101 /* start */, 200 /* end */, 127 /* volume */, -1);
+            t->addNote_import(102 /* pitch */, 201 /* start */, 300 /* end */, 127 /* volume */, -1);
+            t->addNote_import(103 /* pitch */, 301 /* start */, 400 /* end */, 127 /* volume */, -1);
+        }
+        seq->addTrack(t);
+        seq->setUndoMemoryBudget(1024L*1024L*1024L);
+        
+        t->selectNote(ALL_NOTES, true, true);
+        
+        t->action(new ResizeNotes(10, SELECTED_NOTES));
+        const long first = seq->getUndoMemoryUsage();
+        
+        // the second action remembers the same notes, and shares them with the first
+        t->action(new ResizeNotes(10, SELECTED_NOTES));
+        require(seq->getUndoMemoryUsage() < first*2, "the remembered notes are shared");
+        
+        seq->undo();
+        require(seq->getUndoMemoryUsage() == first, "the first action owns its notes again");
+        
+        seq->undo();
+        require(t->getNote(0)->getEndTick() == 100, "both actions were undone");
+        require(t->getNote(3)->getEndTick() == 400, "both actions were undone");
+        
+        delete seq;
+    }
+}
@@ -28,6 +28,7 @@ namespace irr { namespace io {
 
 #include "AriaCore.h"
 #include "Actions/EditAction.h"
+#include "Midi/TempoMap.h"
 #include "Midi/Track.h"
 #include "ptr_vector.h"
 #include "Utils.h"
@@ -123,6 +124,15 @@ namespace AriaMaestosa
         ChannelManagementType channelManagement;
 
         ptr_vector<Action::EditAction> undoStack;
+        
+        /** Sum of the memory accounted for the actions in undoStack, in bytes */
+        long m_undo_memory;
+        
+        /** Once m_undo_memory is past this many bytes, the oldest actions are dropped from undoStack */
+        long m_undo_memory_budget;
+        
+        /** Updates m_undo_memory with the current memory usage of undoStack[id] */
+        void accountUndoMemory(const int id);
 
         IPlaybackModeListener* m_playback_listener;
         
@@ -148,6 +158,13 @@ namespace AriaMaestosa
         
         ptr_vector<ControllerEvent> m_tempo_events;
         ptr_vector<TextEvent>       m_text_events;
+        
+        /**
+          * Built from 'm_tempo' and 'm_tempo_events' when first needed after 'm_tempo_map_dirty' was set;
+          * both are only touched from the main thread. Whatever changes tempo events sets the flag.
+          */
+        mutable TempoMap m_tempo_map;
+        mutable bool     m_tempo_map_dirty;
 
         /** this object is to be modified by MainFrame, to remember where to save this sequence */
         wxString m_filepath;
@@ -230,6 +247,28 @@ namespace AriaMaestosa
         /** @brief you do not need to call this yourself, Track::action and Sequence::action do. */
         void addToUndoStack( Action::EditAction* action );
         
+        /**
+          * @brief same, but says whether a recording is in progress: the "record" action then stays
+          *        at the top of the stack, and other actions are placed below it
+          */
+        void addToUndoStack( Action::EditAction* action, const bool recording );
+        
+        /**
+          * @brief you do not need to call this yourself either, Track::action and Sequence::action do
+          *        once the new action was performed : accounts for the memory it keeps, lets it share
+          *        notes with the previous action, and drops the oldest actions past the memory budget
+          */
+        void trimUndoStack();
+        
+        /** @brief set the undo memory budget in bytes (by default it is taken from the preferences) */
+        void setUndoMemoryBudget(const long bytes) { m_undo_memory_budget = bytes; }
+        
+        /** @return approximate memory (in bytes) used by the actions on the undo stack */
+        long getUndoMemoryUsage() const { return m_undo_memory; }
+        
+        /** @return amount of actions on the undo stack */
+        int getUndoStackSize() const { return undoStack.size(); }
+        
         Action::EditAction* getLatestAction()
         {
             if (undoStack.size() == 0) return NULL;
@@ -319,6 +358,16 @@ namespace AriaMaestosa
         /** @return the tempo at any tick (not necessarily a tick where there is a tempo change event) */
         float getTempoAtTick(const int tick) const;
         
+        /**
+          * @brief  get the object converting between ticks and time in this sequence
+          * @note   the returned object is only valid until the tempo is modified. Main thread only;
+          *         players copy it when playback starts and use their copy from their own thread.
+          */
+        const TempoMap& getTempoMap() const;
+        
+        /** @brief Notify that tempo events were modified outside of the methods that already do so */
+        void  markTempoEdited() { m_tempo_map_dirty = true; }
+        
         void  addTempoEvent(ControllerEvent* evt, wxFloat64* previousValue);
         void sortTempoEvents();
         void sortTextEvents();
@@ -327,9 +376,17 @@ namespace AriaMaestosa
         
         int                    getTempoEventAmount() const { return m_tempo_events.size();  }
         const ControllerEvent* getTempoEvent(int id) const { return m_tempo_events.getConst(id); }
-        void eraseTempoEvent(int id) { m_tempo_events.erase(id); }
-        void setTempoEventValue(int id, int newValue) { m_tempo_events[id].setValue(newValue); }
-        void setTempoEventTick (int id, int newTick)  { m_tempo_events[id].setTick(newTick);  }
+        void eraseTempoEvent(int id) { m_tempo_events.erase(id); m_tempo_map_dirty = true; }
+        void setTempoEventValue(int id, int newValue)
+        {
+            m_tempo_events[id].setValue(newValue);
+            m_tempo_map_dirty = true;
+        }
+        void setTempoEventTick (int id, int newTick)
+        {
+            m_tempo_events[id].setTick(newTick);
+            m_tempo_map_dirty = true;
+        }
         ControllerEvent* getTempoEventAt(int tick);
 
         /** @return Returns the old value there was, if any, before this new event replaces it.*/
@@ -350,9 +407,10 @@ namespace AriaMaestosa
         {
             ControllerEvent* evt = m_tempo_events.get(id);
             m_tempo_events.markToBeRemoved(id);
+            m_tempo_map_dirty = true;
             return evt;
         }
-        void removeMarkedTempoEvents()        { m_tempo_events.removeMarked();      }
+        void removeMarkedTempoEvents()        { m_tempo_events.removeMarked(); m_tempo_map_dirty = true; }
 
         TextEvent* extractTextEvent(int id)
         {
@@ -0,0 +1,143 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "Midi/TempoMap.h"
+#include "Midi/CommonMidiUtils.h"
+#include "Midi/ControllerEvent.h"
+
+#include "UnitTest.h"
+
+#include <cmath>
+
+using namespace AriaMaestosa;
+
+// -----------------------------------------------------------------------------------------------------------
+
+TempoMap::TempoMap()
+{
+    build(120, ptr_vector<ControllerEvent>(), 960);
+}
+
+// -----------------------------------------------------------------------------------------------------------
+
+void TempoMap::build(const float tempo, const ptr_vector<ControllerEvent>& tempoEvents,
+                     const int ticksPerQuarterNote)
+{
+    m_segments.clear();
+
+    Segment first;
+    first.m_tick                  = 0;
+    first.m_tempo                 = tempo;
+    first.m_microseconds          = 0;
+    first.m_microseconds_per_tick = 60000000.0 / (tempo * ticksPerQuarterNote);
+    m_segments.push_back(first);
+
+    const int count = tempoEvents.size();
+    for (int n=0; n<count; n++)
+    {
+        const Segment& previous = m_segments[m_segments.size() - 1];
+        const ControllerEvent* evt = tempoEvents.getConst(n);
+
+        // an event at the same tick as the previous one replaces it, like in Sequence::getTempoAtTick
+        Segment segment;
+        segment.m_tick                  = evt->getTick();
+        segment.m_tempo                 = convertTempoBendToBPM(evt->getValue());
+        segment.m_microseconds          = previous.m_microseconds +
+                                          (segment.m_tick - previous.m_tick)*previous.m_microseconds_per_tick;
+        segment.m_microseconds_per_tick = 60000000.0 / (segment.m_tempo * ticksPerQuarterNote);
+        m_segments.push_back(segment);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------
+
+int TempoMap::segmentAtTick(const int tick) const
+{
+    // last segment starting at or before 'tick' (ticks before song start use the first segment)
+    int from = 0, to = m_segments.size(); // answer is in [from, to)
+    while (to - from > 1)
+    {
+        const int middle = (from + to)/2;
+        if (m_segments[middle].m_tick <= tick) from = middle;
+        else                                   to   = middle;
+    }
+    return from;
+}
+
+// -----------------------------------------------------------------------------------------------------------
+
+int TempoMap::segmentAtTime(const double microseconds) const
+{
+    int from = 0, to = m_segments.size(); // answer is in [from, to)
+    while (to - from > 1)
+    {
+        const int middle = (from + to)/2;
+        if (m_segments[middle].m_microseconds <= microseconds) from = middle;
+        else                                                   to   = middle;
+    }
+    return from;
+}
+
+// -----------------------------------------------------------------------------------------------------------
+
+float TempoMap::getTempoAtTick(const int tick) const
+{
+    return m_segments[segmentAtTick(tick)].m_tempo;
+}
+
+// -----------------------------------------------------------------------------------------------------------
+
+double TempoMap::getMicrosecondsAtTick(const int tick) const
+{
+    const Segment& segment = m_segments[segmentAtTick(tick)];
+    return segment.m_microseconds + (tick - segment.m_tick)*segment.m_microseconds_per_tick;
+}
+
+// -----------------------------------------------------------------------------------------------------------
+
+int TempoMap::getTickAtMicroseconds(const double microseconds) const
+{
+    const Segment& segment = m_segments[segmentAtTime(microseconds)];
+    return segment.m_tick + (int)floor((microseconds - segment.m_microseconds) / segment.m_microseconds_per_tick);
+}
+
+// -----------------------------------------------------------------------------------------------------------
+
+UNIT_TEST( TestTempoMap )
+{
+    // 120 BPM, then 60 BPM from tick 960, then 240 BPM from tick 2880 (960 ticks per quarter note)
+    ptr_vector<ControllerEvent> events;
+    events.push_back(new ControllerEvent(PSEUDO_CONTROLLER_TEMPO, 960,  convertBPMToTempoBend(60)));
+    events.push_back(new ControllerEvent(PSEUDO_CONTROLLER_TEMPO, 2880, convertBPMToTempoBend(240)));
+
+    TempoMap map;
+    map.build(120, events, 960);
+
+    require(fabs(map.getTempoAtTick(959)  - 120) < 0.5, "tempo before the first change");
+    require(fabs(map.getTempoAtTick(960)  - 60)  < 0.5, "tempo at a change");
+    require(fabs(map.getTempoAtTick(5000) - 240) < 0.5, "tempo after the last change");
+
+    // half a second, then two seconds, then a quarter second per beat
+    require(fabs(map.getMicrosecondsAtTick(960)  - 500000)  < 10000, "time through one segment");
+    require(fabs(map.getMicrosecondsAtTick(2880) - 4500000) < 10000, "time through two segments");
+    require(fabs(map.getMicrosecondsAtTick(3840) - 4750000) < 10000, "time after the last change");
+
+    for (int tick=0; tick<6000; tick += 7)
+    {
+        require_e(map.getTickAtMicroseconds(map.getMicrosecondsAtTick(tick) + 1), ==, tick,
+                  "time to tick is the inverse of tick to time");
+    }
+}
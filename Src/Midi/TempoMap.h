@@ -0,0 +1,79 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __TEMPO_MAP_H__
+#define __TEMPO_MAP_H__
+
+#include "ptr_vector.h"
+#include "Utils.h"
+
+#include <vector>
+
+namespace AriaMaestosa
+{
+    class ControllerEvent;
+
+    /**
+      * @brief Converts between ticks and time in a song with tempo changes
+      *
+      * The song is split in segments of constant tempo, each knowing the time (in microseconds) at
+      * which it starts, so that conversions in either direction are a binary search.
+      * Obtain it from Sequence::getTempoMap(), which rebuilds it after the tempo was edited. Once built it
+      * is never modified, so a copy can be handed to a player thread.
+      *
+      * @ingroup midi
+      */
+    class TempoMap
+    {
+        struct Segment
+        {
+            int    m_tick;
+            float  m_tempo;
+            double m_microseconds;
+            double m_microseconds_per_tick;
+        };
+
+        /** in tick order; the first one starts at tick 0 */
+        std::vector<Segment> m_segments;
+
+        int segmentAtTick(const int tick) const;
+        int segmentAtTime(const double microseconds) const;
+
+    public:
+        LEAK_CHECK();
+
+        TempoMap();
+
+        /**
+          * @param tempo        tempo at the start of the song, in beats per minute
+          * @param tempoEvents  tempo changes, in tick order
+          */
+        void build(const float tempo, const ptr_vector<ControllerEvent>& tempoEvents,
+                   const int ticksPerQuarterNote);
+
+        /** @return the tempo (in beats per minute) at any tick */
+        float  getTempoAtTick(const int tick) const;
+
+        /** @return the time elapsed between song start and the given tick */
+        double getMicrosecondsAtTick(const int tick) const;
+
+        /** @return the tick played at the given time after song start */
+        int    getTickAtMicroseconds(const double microseconds) const;
+    };
+
+}
+
+#endif
@@ -35,6 +35,7 @@
 #include "Midi/MeasureData.h"
 #include "PreferencesData.h"
 
+#include <algorithm>
 #include <iostream>
 
 #include "jdksmidi/world.h"
@@ -97,6 +98,20 @@ Track::Track(Sequence* sequence)
     m_next_drumkit_listener = NULL;
     m_default_volume = 80;
     m_sequence = sequence;
+    m_edit_generation = 0;
+    m_selection_generation = 0;
+    m_control_lanes_dirty = true;
+    for (int n=0; n<EDITED_NOTE_TICKS_HISTORY; n++)
+    {
+        m_edited_note_ticks[n].m_since      = 0;
+        m_edited_note_ticks[n].m_generation = 0;
+        m_edited_note_ticks[n].m_from_tick  = 0;
+        m_edited_note_ticks[n].m_to_tick    = -1;
+    }
+    m_edited_note_ticks_next = 0;
+    m_note_hot_data_generation = 0;
+    m_note_hot_data_selection_generation = 0;
+    m_note_hot_data_dirty = true;
 
     m_channel = 0;
     if (sequence->getChannelManagementType() == CHANNEL_MANUAL)
@@ -148,15 +163,72 @@ Track::~Track()
 
 void Track::action( Action::SingleTrackAction* actionObj)
 {
+    const unsigned int generation = m_edit_generation;
+    
     actionObj->setParentTrack(this, new TrackVisitor(this));
     m_sequence->addToUndoStack( actionObj );
     actionObj->perform();
     
+    int fromTick, toTick;
+    if (actionObj->getEditedNoteTicks(this, &fromTick, &toTick)) markEdited(generation, fromTick, toTick);
+    else                                                          markEdited();
+    
+    m_sequence->trimUndoStack();
+    
     ASSERT(m_sequence->invariant());
 }
 
 // ----------------------------------------------------------------------------------------------------------
 
+void Track::markEdited(const unsigned int since, const int fromTick, const int toTick)
+{
+    markEdited();
+    
+    EditedNoteTicks& edit = m_edited_note_ticks[m_edited_note_ticks_next];
+    edit.m_since      = since;
+    edit.m_generation = m_edit_generation;
+    edit.m_from_tick  = fromTick;
+    edit.m_to_tick    = toTick;
+    
+    m_edited_note_ticks_next = (m_edited_note_ticks_next + 1) % EDITED_NOTE_TICKS_HISTORY;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+bool Track::getEditedNoteTicks(const unsigned int since, int* fromTick, int* toTick) const
+{
+    *fromTick = 0;
+    *toTick   = -1;
+    
+    // go back through the last edits; they must follow each other, or an edit of unknown range happened
+    unsigned int generation = m_edit_generation;
+    for (int n=1; n<=EDITED_NOTE_TICKS_HISTORY and generation != since; n++)
+    {
+        const EditedNoteTicks& edit = m_edited_note_ticks[(m_edited_note_ticks_next - n + EDITED_NOTE_TICKS_HISTORY) %
+                                                          EDITED_NOTE_TICKS_HISTORY];
+        if (edit.m_generation != generation) return false;
+        
+        if (edit.m_to_tick >= edit.m_from_tick)
+        {
+            if (*toTick < *fromTick)
+            {
+                *fromTick = edit.m_from_tick;
+                *toTick   = edit.m_to_tick;
+            }
+            else
+            {
+                *fromTick = std::min(*fromTick, edit.m_from_tick);
+                *toTick   = std::max(*toTick,   edit.m_to_tick);
+            }
+        }
+        generation = edit.m_since;
+    }
+    
+    return generation == since;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
 GraphicalTrack* Track::getGraphics()
 {
     return getMainFrame()->getCurrentGraphicalSequence()->getGraphicsFor(this);
@@ -182,6 +254,8 @@ const GraphicalTrack* Track::getGraphics() const
 
 bool Track::addNote(Note* note, bool check_for_overlapping_notes)
 {
+    m_edit_generation++;
+    
     // if we're importing, just push it to the end, we know they're in time order
     if (m_sequence->isImportMode())
     {
@@ -260,11 +334,21 @@ void Track::addControlEvent( ControllerEvent* evt, wxFloat64* previousValue )
     ptr_vector<ControllerEvent>* vector;
 
     if (previousValue != NULL) *previousValue = -1;
+    
+    m_edit_generation++;
 
     // tempo events
-    if (evt->getController() == PSEUDO_CONTROLLER_TEMPO) vector = &m_sequence->m_tempo_events;
+    if (evt->getController() == PSEUDO_CONTROLLER_TEMPO)
+    {
+        vector = &m_sequence->m_tempo_events;
+        m_sequence->markTempoEdited();
+    }
     // controller and pitch bend events
-    else vector = &m_control_events;
+    else
+    {
+        vector = &m_control_events;
+        markControlLaneDirty(evt->getController());
+    }
 
     // don't bother checking order if we're importing, we know its in time order and all
     // FIXME - what about 'addControlEvent_import' ??
@@ -277,29 +361,29 @@ void Track::addControlEvent( ControllerEvent* evt, wxFloat64* previousValue )
     ASSERT_E(evt->getController(),<,205);
     ASSERT_E(evt->getValue(),<,128);
 
-    const int eventAmount=vector->size();
-    for (int n=0; n<eventAmount; n++)
+    // binary search for the first event at or after the tick of the new event
+    int from = 0, to = vector->size();
+    while (from < to)
     {
-        if ( (*vector)[n].getTick() == evt->getTick())
+        const int middle = (from + to)/2;
+        if ((*vector)[middle].getTick() < evt->getTick()) from = middle + 1;
+        else                                               to = middle;
+    }
+    
+    // if there is already an event of same type at same time, remove it first
+    const int eventAmount = vector->size();
+    for (int n=from; n<eventAmount and (*vector)[n].getTick() == evt->getTick(); n++)
+    {
+        if ((*vector)[n].getController() == evt->getController())
         {
-            // if there is already an even of same type at same time, remove it first
-            if ((*vector)[n].getController() == evt->getController() )
-            {
-                if (previousValue != NULL) *previousValue = (*vector)[n].getValue();
-                vector->erase(n);
-            }
-            vector->add( evt, n );
-            return;
+            if (previousValue != NULL) *previousValue = (*vector)[n].getValue();
+            vector->erase(n);
+            break;
         }
-        else if ( (*vector)[n].getTick() > evt->getTick() )
-        {
-            vector->add( evt, n );
-            return;
-        }//endif
-
-    }//next
+    }
 
-    vector->push_back( evt );
+    if (from < vector->size()) vector->add( evt, from );
+    else                       vector->push_back( evt );
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -308,6 +392,7 @@ void Track::addControlEvent_import(const int x, const wxFloat64 value, const int
 {
     ASSERT(m_sequence->isImportMode()); // not to be used when not importing
     m_control_events.push_back(new ControllerEvent(controller, x, value) );
+    m_control_lanes_dirty = true;
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -330,6 +415,7 @@ void Track::setNoteEnd_import(const int tick, const int noteID)
     ASSERT_E(noteID,>=,0);
 
     m_notes[noteID].setEndTick(tick);
+    m_edit_generation++;
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -349,7 +435,7 @@ void Track::removeNote(const int id)
     }
 
     m_notes.erase(id);
-
+    m_edit_generation++;
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -387,6 +473,7 @@ void Track::removeMarkedNotes()
 
     m_notes.removeMarked();
     m_note_off.removeMarked();
+    m_edit_generation++;
 
 #ifdef _MORE_DEBUG_CHECKS
     if (m_notes.size() != m_note_off.size())
@@ -407,6 +494,7 @@ int getNoteTick(Note* note)
 void Track::reorderNoteVector()
 {
     m_notes.insertionSort(getNoteTick);
+    m_edit_generation++;
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -426,6 +514,7 @@ void Track::reorderNoteOffVector()
 void Track::reorderControlVector()
 {
     m_control_events.insertionSort();
+    m_control_lanes_dirty = true;
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -623,20 +712,129 @@ int Track::getControllerEventAmount(const int controller) const
     }
     else
     {
-        int occurrences = 0;
+        return getControllerLane(controller).size();
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+namespace
+{
+    bool isEventBeforeTick(const ControllerEvent* evt, const int tick)
+    {
+        return evt->getTick() < tick;
+    }
+    
+    bool isEventBefore(const ControllerEvent* a, const ControllerEvent* b)
+    {
+        return a->getTick() < b->getTick();
+    }
+}
 
-        const int count = m_control_events.size();
-        for (int n=0; n<count; n++)
+void Track::buildControlLanes() const
+{
+    m_control_lanes.clear();
+    
+    const int count = m_control_events.size();
+    for (int n=0; n<count; n++)
+    {
+        ControllerEvent* evt = const_cast<ControllerEvent*>(m_control_events.getConst(n));
+        m_control_lanes[evt->getController()].push_back(evt);
+    }
+    
+    // the merged vector is normally sorted already, in which case this costs nothing more than a check
+    for (std::map<int, std::vector<ControllerEvent*> >::iterator it = m_control_lanes.begin();
+         it != m_control_lanes.end(); it++)
+    {
+        std::stable_sort(it->second.begin(), it->second.end(), isEventBefore);
+    }
+    
+    m_control_lanes_dirty = false;
+    m_dirty_control_lanes.clear();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void Track::updateControlLanes() const
+{
+    if (m_control_lanes_dirty)
+    {
+        buildControlLanes();
+        return;
+    }
+    if (m_dirty_control_lanes.empty()) return;
+    
+    // gather again the events of the dirty controllers only; the other lanes are left as they are
+    const int dirtyAmount = m_dirty_control_lanes.size();
+    for (int n=0; n<dirtyAmount; n++) m_control_lanes.erase(m_dirty_control_lanes[n]);
+    
+    const int count = m_control_events.size();
+    for (int n=0; n<count; n++)
+    {
+        ControllerEvent* evt = const_cast<ControllerEvent*>(m_control_events.getConst(n));
+        if (std::find(m_dirty_control_lanes.begin(), m_dirty_control_lanes.end(), evt->getController()) !=
+            m_dirty_control_lanes.end())
         {
-            if (m_control_events[n].getController() == controller) occurrences++;
+            m_control_lanes[evt->getController()].push_back(evt);
         }
+    }
+    
+    for (int n=0; n<dirtyAmount; n++)
+    {
+        std::map<int, std::vector<ControllerEvent*> >::iterator it = m_control_lanes.find(m_dirty_control_lanes[n]);
+        if (it != m_control_lanes.end()) std::stable_sort(it->second.begin(), it->second.end(), isEventBefore);
+    }
+    
+    m_dirty_control_lanes.clear();
+}
+
+// ----------------------------------------------------------------------------------------------------------
 
-        return occurrences;
+void Track::markControlLaneDirty(const int controller)
+{
+    if (m_control_lanes_dirty) return;
+    
+    if (std::find(m_dirty_control_lanes.begin(), m_dirty_control_lanes.end(), controller) ==
+        m_dirty_control_lanes.end())
+    {
+        m_dirty_control_lanes.push_back(controller);
     }
 }
 
 // ----------------------------------------------------------------------------------------------------------
 
+const std::vector<ControllerEvent*>& Track::getControllerLane(const int controller) const
+{
+    updateControlLanes();
+    
+    static const std::vector<ControllerEvent*> empty;
+    
+    std::map<int, std::vector<ControllerEvent*> >::const_iterator it = m_control_lanes.find(controller);
+    if (it == m_control_lanes.end()) return empty;
+    return it->second;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+const NoteHotData& Track::getNoteHotData() const
+{
+    if (m_note_hot_data_dirty or m_note_hot_data_generation != m_edit_generation)
+    {
+        m_note_hot_data.build(m_notes);
+        m_note_hot_data_generation = m_edit_generation;
+        m_note_hot_data_selection_generation = m_selection_generation;
+        m_note_hot_data_dirty = false;
+    }
+    else if (m_note_hot_data_selection_generation != m_selection_generation)
+    {
+        m_note_hot_data.updateSelection(m_notes);
+        m_note_hot_data_selection_generation = m_selection_generation;
+    }
+    return m_note_hot_data;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
 ControllerEvent* Track::getControllerEvent(const int id, const int controllerTypeID)
 {
     ASSERT_E(id,>=,0);
@@ -696,6 +894,10 @@ void Track::selectNote(const int id, const bool selected, bool ignoreModifiers)
 {
     ASSERT(id != SELECTED_NOTES); // not supported in this function
 
+    // selection is drawn from caches too (e.g. the score analysis); this does not change the
+    // contents of the track, so caches of the notes alone need not be rebuilt
+    m_selection_generation++;
+
     if (not ignoreModifiers and not Display::isSelectMorePressed() and
         not Display::isSelectLessPressed())
     {
@@ -1344,16 +1546,61 @@ int getActiveMin(bool have_a, int a, bool have_b, int b, bool have_c, int c)
 
 ControllerEvent* Track::getControllerEventAt(int tick, int idController)
 {
-    const int eventAmount = m_control_events.size();
-    for (int n=0; n<eventAmount; n++)
+    const std::vector<ControllerEvent*>& lane = getControllerLane(idController);
+    
+    std::vector<ControllerEvent*>::const_iterator it = std::lower_bound(lane.begin(), lane.end(), tick,
+                                                                        isEventBeforeTick);
+    if (it != lane.end() and (*it)->getTick() == tick) return *it;
+    return NULL;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+int Track::firstNoteOffEndingAtOrAfter(const int tick) const
+{
+    int from = 0, to = m_note_off.size(); // answer is in [from, to]
+    while (from < to)
+    {
+        const int middle = (from + to)/2;
+        if (m_note_off.getConst(middle)->getEndTick() < tick) from = middle + 1;
+        else                                                  to   = middle;
+    }
+    return from;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void Track::getControlEventsToPlay(const int fromTick, std::vector<const ControllerEvent*>& out) const
+{
+    // for each controller, the last value set before 'fromTick' is "chased", i.e. played at the start,
+    // unless another value is set exactly at 'fromTick'
+    updateControlLanes();
+    
+    for (std::map<int, std::vector<ControllerEvent*> >::const_iterator it = m_control_lanes.begin();
+         it != m_control_lanes.end(); it++)
     {
-        if (m_control_events[n].getController() == idController and
-            m_control_events[n].getTick() == tick)
+        const std::vector<ControllerEvent*>& lane = it->second;
+        const int next = std::lower_bound(lane.begin(), lane.end(), fromTick, isEventBeforeTick) - lane.begin();
+        
+        if (next > 0 and (next == (int)lane.size() or lane[next]->getTick() != fromTick))
         {
-            return m_control_events.get(n);
+            out.push_back(lane[next - 1]);
         }
     }
-    return NULL;
+    
+    // lanes are visited by controller, so e.g. bank select comes before the instrument change at the same tick
+    std::stable_sort(out.begin(), out.end(), isEventBefore);
+    
+    int first = 0, to = m_control_events.size(); // first event at or after 'fromTick', in [first, to]
+    while (first < to)
+    {
+        const int middle = (first + to)/2;
+        if (m_control_events.getConst(middle)->getTick() < fromTick) first = middle + 1;
+        else                                                          to    = middle;
+    }
+    
+    const int count = m_control_events.size();
+    for (int n=first; n<count; n++) out.push_back(m_control_events.getConst(n));
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -1392,24 +1639,25 @@ int Track::addMidiEvents(jdksmidi::MIDITrack* midiTrack,
     int firstNoteStartTick = -1;
     int selectedNoteAmount = 0;
 
-    for (int n=0; n<m_notes.size(); n++)
+    const NoteHotData& hot = getNoteHotData();
+    const int hotAmount = hot.size();
+
+    int emptyNoteAmount = 0;
+    for (int n=0; n<hotAmount; n++)
     {
-        if (m_notes[n].getLength() <= 1)
-        {
-            fprintf(stderr, "EMPTY NOTE\n");
-        }
+        emptyNoteAmount += (hot.m_end[n] - hot.m_start[n] <= 1);
     }
+    if (emptyNoteAmount > 0) fprintf(stderr, "%i EMPTY NOTE(S)\n", emptyNoteAmount);
 
     if (selectionOnly)
     {
-        const int noteAmount = m_notes.size();
-        for (int n=0; n<noteAmount; n++)
+        for (int n=0; n<hotAmount; n++)
         {
-            if (m_notes[n].isSelected())
+            if (hot.m_selected[n])
             {
-                if (m_notes[n].getTick() < firstNoteStartTick or firstNoteStartTick==-1)
+                if (hot.m_start[n] < firstNoteStartTick or firstNoteStartTick==-1)
                 {
-                    firstNoteStartTick = m_notes[n].getTick();
+                    firstNoteStartTick = hot.m_start[n];
                 }
                 selectedNoteAmount++;
             }
@@ -1562,13 +1810,19 @@ int Track::addMidiEvents(jdksmidi::MIDITrack* midiTrack,
      *
      */
 
-    int note_on_id     = 0;
-    int note_off_id    = 0;
+    // all vectors are sorted, so events before the area we play are skipped with a binary search instead of
+    // being walked one by one; this keeps starting playback late in a long song cheap
+    int note_on_id  = std::lower_bound(hot.m_start.begin(), hot.m_start.end(), firstNoteStartTick) -
+                      hot.m_start.begin();
+    int note_off_id = firstNoteOffEndingAtOrAfter(firstNoteStartTick);
     int control_evt_id = 0;
 
     const int noteOnAmount     = m_notes.size();
     const int noteOffAmount    = m_note_off.size();
-    const int controllerAmount = m_control_events.size();
+
+    std::vector<const ControllerEvent*> controlEvents;
+    if (not selectionOnly) getControlEventsToPlay(firstNoteStartTick, controlEvents);
+    const int controllerAmount = controlEvents.size();
 
     // find track end
     int last_event_tick = 0;
@@ -1589,7 +1843,7 @@ int Track::addMidiEvents(jdksmidi::MIDITrack* midiTrack,
         // if we only want to play what's selected, skip unselected notes
         if (selectionOnly)
         {
-            while (note_on_id < noteOnAmount   and not m_notes[note_on_id].isSelected())
+            while (note_on_id < noteOnAmount   and not hot.m_selected[note_on_id])
             {
                 note_on_id++;
             }
@@ -1603,14 +1857,14 @@ int Track::addMidiEvents(jdksmidi::MIDITrack* midiTrack,
         bool have_tick_off = (note_off_id < noteOffAmount);
 
         const int tick_on  = have_tick_on   ?
-                              m_notes[note_on_id].getTick() - firstNoteStartTick   :  -1;
+                              hot.m_start[note_on_id] - firstNoteStartTick   :  -1;
         const int tick_off = have_tick_off ?
                               m_note_off[note_off_id].getEndTick() - firstNoteStartTick :  -1;
         
         // ignore control events when only playing selection
         bool have_tick_control = (control_evt_id < controllerAmount and not selectionOnly);
         const int tick_control = have_tick_control ?
-                                  m_control_events[control_evt_id].getTick() - firstNoteStartTick : -1;
+                                  controlEvents[control_evt_id]->getTick() - firstNoteStartTick : -1;
 
         if (not have_tick_control and not have_tick_off and not have_tick_on)
         {
@@ -1627,7 +1881,7 @@ int Track::addMidiEvents(jdksmidi::MIDITrack* midiTrack,
         //  ------------------------ add note on event ------------------------
         if (activeMin == 2)
         {
-            const int time = m_notes[note_on_id].getTick() - firstNoteStartTick;
+            const int time = hot.m_start[note_on_id] - firstNoteStartTick;
             if (time >= 0 and (time + firstNoteStartTick) <= lastTickInSong)
             {
                 ASSERT_E(time, >=, debug_curr_time); debug_curr_time = time;
@@ -1636,17 +1890,17 @@ int Track::addMidiEvents(jdksmidi::MIDITrack* midiTrack,
                 
                 if (m_editor_mode[DRUM])
                 {
-                    m.SetNoteOn(channel, m_notes[note_on_id].getPitchID(), computeNoteVolume(note_on_id));
+                    m.SetNoteOn(channel, hot.m_pitch[note_on_id], computeNoteVolume(note_on_id));
                 }
                 else
                 {
-                    m.SetNoteOn(channel, 131-m_notes[note_on_id].getPitchID(), computeNoteVolume(note_on_id));
+                    m.SetNoteOn(channel, 131-hot.m_pitch[note_on_id], computeNoteVolume(note_on_id));
                 }
 
                 // find track end
-                if (m_notes[note_on_id].getEndTick() > last_event_tick)
+                if (hot.m_end[note_on_id] > last_event_tick)
                 {
-                    last_event_tick = m_notes[note_on_id].getEndTick();
+                    last_event_tick = hot.m_end[note_on_id];
                 }
 
                 if (not midiTrack->PutEvent( m ))
@@ -1690,71 +1944,21 @@ int Track::addMidiEvents(jdksmidi::MIDITrack* midiTrack,
         //  ------------------------ add control change event ------------------------
         else if (activeMin == 1)
         {
-            const int controllerID = m_control_events[control_evt_id].getController();
+            const ControllerEvent* evt = controlEvents[control_evt_id];
+            const int controllerID = evt->getController();
 
-            int time = m_control_events[control_evt_id].getTick() - firstNoteStartTick;
+            int time = evt->getTick() - firstNoteStartTick;
 
             // find track end
             if (time > last_event_tick) last_event_tick = time;
 
-            // controller changes happens before the area we play
-            // but perhaps it still is affecting the area we want to play - check for that.
-            bool doAddControlEvent = true;
-            if (time < 0)
-            {
-                if (control_evt_id+1 < controllerAmount)
-                {
-                    doAddControlEvent = false;
-                    int checkEventID = control_evt_id+1;
-
-                    // check if there are other controller events of the same type before the area we play.
-                    while (true)
-                    {
-
-                        if ((m_control_events[checkEventID].getTick() - firstNoteStartTick)<1  and
-                            m_control_events[checkEventID].getController() == controllerID)
-                        {
-                            // the current event has no effect, there is another one later, disregard it.
-                            doAddControlEvent = false;
-                            break;
-                        }
-
-                        if ((m_control_events[checkEventID].getTick() - firstNoteStartTick)>0  and
-                           m_control_events[checkEventID].getController() == controllerID)
-                        {
-                            // there is another event, but it's later so current event is still relevant.
-                            doAddControlEvent = true;
-                            time = 0;
-                            break;
-                        }
-
-                        checkEventID++;
-                        if (not (checkEventID < controllerAmount ))
-                        {
-                            // we reaached the end, there are no other events of the same type
-                            // this one still affects playback of the area that we're playing.
-                            doAddControlEvent = true;
-                            time = 0;
-                            break;
-                        }
-                    }//wend
-                }
-                else
-                {
-                    // there are no other events in track. add it.
-                    doAddControlEvent = true;
-                    time = 0;
-                }
-            }
-            else
-            {
-                doAddControlEvent = true;
-            }
+            // controller changes that happened before the area we play, but still affect it
+            if (time < 0) time = 0;
             
             // pitch bend
             if (controllerID == PSEUDO_CONTROLLER_PITCH_BEND)
             {
-                if (doAddControlEvent and (time + firstNoteStartTick) <= lastTickInSong)
+                if ((time + firstNoteStartTick) <= lastTickInSong)
                 {
                     ASSERT_E(time, >=, debug_curr_time); debug_curr_time = time;
                     m.SetTime( time );
@@ -1762,7 +1966,7 @@ int Track::addMidiEvents(jdksmidi::MIDITrack* midiTrack,
                     if (DEBUG_NOTE_ORDER) printf("[DEBUG_NOTE_ORDER] %i (pitch bend)\n", time);
  
                     /** In range [-8192, 8191] */
-                    const int pitchBendVal = m_control_events[control_evt_id].getPitchBendValue();
+                    const int pitchBendVal = evt->getPitchBendValue();
 
                     m.SetPitchBend(channel, pitchBendVal);
 
@@ -1772,11 +1976,11 @@ int Track::addMidiEvents(jdksmidi::MIDITrack* midiTrack,
             }
             else if (controllerID == PSEUDO_CONTROLLER_INSTRUMENT_CHANGE)
             {
-                if (doAddControlEvent and (time + firstNoteStartTick) <= lastTickInSong)
+                if ((time + firstNoteStartTick) <= lastTickInSong)
                 {
                     ASSERT_E(time, >=, debug_curr_time); debug_curr_time = time;
                     m.SetTime( time );
-                    m.SetProgramChange(channel, (int)round(m_control_events[control_evt_id].getValue()));
+                    m.SetProgramChange(channel, (int)round(evt->getValue()));
 
                     if (DEBUG_NOTE_ORDER) printf("[DEBUG_NOTE_ORDER] %i (program change)\n", time);
 
@@ -1790,7 +1994,7 @@ int Track::addMidiEvents(jdksmidi::MIDITrack* midiTrack,
             }
             else if (controllerID == 0 /* bank select */)
             {
-                if (doAddControlEvent and (time + firstNoteStartTick) <= lastTickInSong)
+                if ((time + firstNoteStartTick) <= lastTickInSong)
                 {
                     ASSERT_E(time, >=, debug_curr_time); debug_curr_time = time;
                     m.SetTime( time );
@@ -1809,7 +2013,7 @@ int Track::addMidiEvents(jdksmidi::MIDITrack* midiTrack,
                     m.SetTime( time );
                     m.SetControlChange(channel,
                                        32, // for bank select, force writing the LSB
-                                       127 - (int)round(m_control_events[control_evt_id].getValue()) );
+                                       127 - (int)round(evt->getValue()) );
 
                     if (not midiTrack->PutEvent( m ))
                     {
@@ -1823,7 +2027,7 @@ int Track::addMidiEvents(jdksmidi::MIDITrack* midiTrack,
             // other controller
             else if (controllerID < 128)
             {
-                if (doAddControlEvent and (time + firstNoteStartTick) <= lastTickInSong)
+                if ((time + firstNoteStartTick) <= lastTickInSong)
                 {
                     ASSERT_E(time, >=, debug_curr_time); debug_curr_time = time;
                     m.SetTime( time );
@@ -1833,7 +2037,7 @@ int Track::addMidiEvents(jdksmidi::MIDITrack* midiTrack,
                     // FIXME: also write fine values
                     m.SetControlChange(channel,
                                        controllerID,
-                                       127 - (int)round(m_control_events[control_evt_id].getValue()) );
+                                       127 - (int)round(evt->getValue()) );
 
                     if (not midiTrack->PutEvent( m ))
                     {
@@ -1947,6 +2151,7 @@ bool Track::readFromFile(irr::io::IrrXMLReader* xml, GraphicalSequence* gseq)
     m_notes.clearAndDeleteAll();
     m_note_off.clearWithoutDeleting(); // have already been deleted by previous command
     m_control_events.clearAndDeleteAll();
+    m_control_lanes_dirty = true;
 
     // parse XML file
     do
@@ -2316,6 +2521,7 @@ bool Track::readFromFile(irr::io::IrrXMLReader* xml, GraphicalSequence* gseq)
                     {
                         // controller successfully loaded, add to controllers vector
                         m_control_events.push_back( temp );
+                        m_control_lanes_dirty = true;
                     }
                 }
 
@@ -32,9 +32,13 @@ namespace jdksmidi { class MIDITrack; }
 #include "Midi/InstrumentChoice.h"
 #include "Midi/MagneticGrid.h"
 #include "Midi/Note.h"
+#include "Midi/NoteHotData.h"
 
 #include "ptr_vector.h"
 
+#include <map>
+#include <vector>
+
 namespace AriaMaestosa
 {
     
@@ -110,9 +114,50 @@ namespace AriaMaestosa
         /** Same contents as 'm_notes', but sorted according to the end of the notes */
         ptr_vector<Note, REF> m_note_off;
         
-        /** Holds all controller events from this track */
+        /** Holds all controller events from this track, of all controllers, sorted in time order */
         ptr_vector<ControllerEvent> m_control_events;
         
+        /**
+          * Same contents as 'm_control_events', split by controller (each lane sorted by tick), so that
+          * the events of one controller can be counted and searched without going through all others.
+          * Rebuilt from 'm_control_events' when stale (see updateControlLanes).
+          */
+        mutable std::map<int, std::vector<ControllerEvent*> > m_control_lanes;
+        
+        /** Set when the events of any controller may have changed, so that all lanes must be rebuilt */
+        mutable bool m_control_lanes_dirty;
+        
+        /** Controllers whose lane must be rebuilt, for when the events of only some controllers changed */
+        mutable std::vector<int> m_dirty_control_lanes;
+        
+        void buildControlLanes() const;
+        
+        /** Rebuilds all lanes, or only those of 'm_dirty_control_lanes', as needed */
+        void updateControlLanes() const;
+        
+        /** Marks the lane of the given controller as to be rebuilt */
+        void markControlLaneDirty(const int controller);
+        
+        /** @return the index in 'm_note_off' of the first note ending at or after the given tick */
+        int  firstNoteOffEndingAtOrAfter(const int tick) const;
+        
+        /**
+          * @brief Get the controller events to play when starting playback at the given tick : those after
+          *        it, preceded by the value each controller has at that point
+          */
+        void getControlEventsToPlay(const int fromTick, std::vector<const ControllerEvent*>& out) const;
+        
+        /**
+          * Start, end, pitch, volume and selection of the notes in 'm_notes', as parallel arrays for the
+          * scans that go through many notes. Rebuilt when the edit generation moved since it was built,
+          * or when 'm_note_hot_data_dirty' is set; only the selection is refreshed when just the
+          * selection generation moved.
+          */
+        mutable NoteHotData m_note_hot_data;
+        mutable unsigned int m_note_hot_data_generation;
+        mutable unsigned int m_note_hot_data_selection_generation;
+        mutable bool m_note_hot_data_dirty;
+        
         int m_track_id;
         
         /** Only used if in manual channel management mode */
@@ -177,6 +222,27 @@ namespace AriaMaestosa
 
         unsigned short m_default_volume;
 
+        /** Incremented every time the contents of this track are modified */
+        unsigned int m_edit_generation;
+        
+        /** Incremented every time notes are selected or deselected through selectNote */
+        unsigned int m_selection_generation;
+        
+        /** The ticks covered by the notes changed by one edit, see getEditedNoteTicks */
+        struct EditedNoteTicks
+        {
+            /** Edit generation before and after the edit */
+            unsigned int m_since, m_generation;
+            int m_from_tick, m_to_tick;
+        };
+        
+        /** Amount of edits 'm_edited_note_ticks' remembers */
+        static const int EDITED_NOTE_TICKS_HISTORY = 8;
+        
+        /** The last edits whose ticks are known, used as a ring (the next one goes at 'm_edited_note_ticks_next') */
+        EditedNoteTicks m_edited_note_ticks[EDITED_NOTE_TICKS_HISTORY];
+        int m_edited_note_ticks_next;
+
     public:
         
         DECLARE_MAGIC_NUMBER();
@@ -206,15 +272,30 @@ namespace AriaMaestosa
                 m_track = other.m_track;
             }
             
+            /** Since callers may modify the notes, the track's note hot data is rebuilt afterwards */
             ptr_vector<Note>&            getNotesVector()
             {
+                m_track->m_note_hot_data_dirty = true;
                 ASSERT( MAGIC_NUMBER_OK() );
                 ASSERT( MAGIC_NUMBER_OK_FOR(*m_track) );
                 ASSERT( MAGIC_NUMBER_OK_FOR(m_track->m_notes) );
                 return m_track->m_notes;
             }
             ptr_vector<Note, REF>&       getNoteOffVector()      { return m_track->m_note_off;       }
-            ptr_vector<ControllerEvent>& getControlEventVector() { return m_track->m_control_events; }
+            
+            /** Since callers may modify the events, the track's controller lanes are rebuilt afterwards */
+            ptr_vector<ControllerEvent>& getControlEventVector()
+            {
+                m_track->m_control_lanes_dirty = true;
+                return m_track->m_control_events;
+            }
+            
+            /** For callers that only modify the events of 'controller'; only its lane is rebuilt afterwards */
+            ptr_vector<ControllerEvent>& getControlEventVector(const int controller)
+            {
+                m_track->markControlLaneDirty(controller);
+                return m_track->m_control_events;
+            }
             
             LEAK_CHECK();
         };
@@ -255,6 +336,41 @@ namespace AriaMaestosa
         
         int getId() const { return m_track_id; }
         
+        /**
+          * @brief  Get a counter that changes every time the contents of this track are modified.
+          *         Caches derived from the notes or events of this track can compare it against the
+          *         value they were built with to know whether they are stale.
+          * @note   Selecting notes with selectNote does not change it, see getSelectionGeneration
+          */
+        unsigned int getEditGeneration() const { return m_edit_generation; }
+        
+        /**
+          * @brief  Get a counter that changes every time notes are selected or deselected with selectNote.
+          *         Only caches that also remember which notes are selected need to look at it.
+          */
+        unsigned int getSelectionGeneration() const { return m_selection_generation; }
+        
+        /**
+          * @brief Notify that the contents of this track were modified outside of the methods that
+          *        already do so (e.g. when undoing an action)
+          */
+        void markEdited() { m_edit_generation++; }
+        
+        /**
+          * @brief Notify that the contents of this track were modified by an edit that only changed notes
+          *        within ticks [fromTick, toTick] (an empty range if no note changed)
+          * @param since  The edit generation before the edit began
+          */
+        void markEdited(const unsigned int since, const int fromTick, const int toTick);
+        
+        /**
+          * @brief  Get the ticks covered by the notes that changed since edit generation 'since', for
+          *         caches that can then update only this range
+          * @return false if this is not known (e.g. the edits are too old, or didn't tell their range).
+          *         When no note changed, 'toTick' is smaller than 'fromTick'.
+          */
+        bool getEditedNoteTicks(const unsigned int since, int* fromTick, int* toTick) const;
+        
         /**
           * @brief set notes while importing files.
           * @note when not importing, use edit actions instead.
@@ -423,13 +539,26 @@ namespace AriaMaestosa
         int getControllerEventAmount(const bool isLyrics=false, const bool isTempo=false) const;
         
         /**
-         * @return            the amount of ALL types of controller, not only of specified type
+         * @return            the amount of events of the given controller
          * @param controller  which controller to count the events of
          */
         int getControllerEventAmount(const int controller) const;
         
         ControllerEvent* getControllerEventAt(int tick, int idController);
         
+        /**
+          * @brief get the events of one controller (not tempo or lyrics), sorted by tick
+          * @note  the returned vector is only valid until the controller events of this track are modified
+          */
+        const std::vector<ControllerEvent*>& getControllerLane(const int controller) const;
+        
+        /**
+          * @brief get the start, end, pitch, volume and selection of all notes, in parallel arrays
+          *        (with the same indices as the notes)
+          * @note  the returned object is only valid until the notes of this track are modified
+          */
+        const NoteHotData& getNoteHotData() const;
+        
         /**
           * @brief get a controller event object
           * @param id of the control event to retrieve (from 0 to count-1)
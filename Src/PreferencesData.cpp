@@ -242,6 +242,52 @@ void PreferencesData::fillSettingsVector()
     Setting* playthrough = new Setting(fromCString(SETTING_ID_PLAYTHROUGH), _("Enable playthrough when recording by default"),
                                        SETTING_BOOL, SETTING_CATEGORY_AUDIO, wxT("1") );
     m_settings.push_back( playthrough );
+    
+    // ---- record on first note
+    Setting* recordOnFirstNote = new Setting(fromCString(SETTING_ID_RECORD_ON_FIRST_NOTE),
+                                             _("Wait for the first note played to start recording"),
+                                             SETTING_BOOL, SETTING_CATEGORY_AUDIO, wxT("0") );
+    m_settings.push_back( recordOnFirstNote );
+    
+    // ---- count-in (not used when waiting for the first note, which then starts the recording)
+    //I18N: In preferences
+    Setting* countIn = new Setting(fromCString(SETTING_ID_COUNT_IN), _("Count-in before recording"),
+                                   SETTING_ENUM, SETTING_CATEGORY_AUDIO, wxT("0") );
+    countIn->addChoice(_("None"));       // 0
+    countIn->addChoice(_("1 measure"));  // 1
+    countIn->addChoice(_("2 measures")); // 2
+    m_settings.push_back( countIn );
+
+    // ---- metronome sounds (keep in sync with the drum key tables in Metronome.cpp)
+    //I18N: In preferences
+    Setting* metronomeSound = new Setting(fromCString(SETTING_ID_METRONOME_SOUND), _("Metronome sound"),
+                                          SETTING_ENUM, SETTING_CATEGORY_AUDIO, wxT("0") );
+    metronomeSound->addChoice(_("Side Stick"));      // 0
+    metronomeSound->addChoice(_("Sticks"));          // 1
+    metronomeSound->addChoice(_("Cowbell"));         // 2
+    metronomeSound->addChoice(_("Claves"));          // 3
+    metronomeSound->addChoice(_("High Wood Block")); // 4
+    m_settings.push_back( metronomeSound );
+
+    //I18N: In preferences
+    Setting* downbeatSound = new Setting(fromCString(SETTING_ID_METRONOME_DOWNBEAT_SOUND),
+                                         _("Metronome sound on the first beat of measures"),
+                                         SETTING_ENUM, SETTING_CATEGORY_AUDIO, wxT("1") );
+    downbeatSound->addChoice(_("None"));            // 0
+    downbeatSound->addChoice(_("Triangle"));        // 1
+    downbeatSound->addChoice(_("Cowbell"));         // 2
+    downbeatSound->addChoice(_("High Wood Block")); // 3
+    m_settings.push_back( downbeatSound );
+
+    //I18N: In preferences
+    Setting* halfBeatSound = new Setting(fromCString(SETTING_ID_METRONOME_HALF_BEAT_SOUND),
+                                         _("Metronome sound on half beats"),
+                                         SETTING_ENUM, SETTING_CATEGORY_AUDIO, wxT("0") );
+    halfBeatSound->addChoice(_("None"));           // 0
+    halfBeatSound->addChoice(_("Closed Hi-Hat"));  // 1
+    halfBeatSound->addChoice(_("Side Stick"));     // 2
+    halfBeatSound->addChoice(_("Low Wood Block")); // 3
+    m_settings.push_back( halfBeatSound );
 
     // ---- check for new version
     Setting* newversion = new Setting(fromCString(SETTING_ID_CHECK_NEW_VERSION), _("Check online for new versions"),
@@ -323,6 +369,11 @@ void PreferencesData::fillSettingsVector()
                                      SETTING_STRING, SETTING_CATEGORY_HIDDEN, wxT("") );
     m_settings.push_back(recentFiles); 
     
+    Setting* undoBudget = new Setting(fromCString(SETTING_ID_UNDO_MEMORY_BUDGET),
+                                      wxT("Memory used for undo information (MB)"),
+                                      SETTING_INT, SETTING_CATEGORY_HIDDEN, wxT("64") );
+    m_settings.push_back(undoBudget);
+    
     
 
     Setting* output = new Setting(fromCString(SETTING_ID_MIDI_OUTPUT), wxT(""),
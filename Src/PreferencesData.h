@@ -80,6 +80,12 @@ static const wxString SYSTEM_BANK = _("System soundbank");
 #endif
     
     EXTERN const char* SETTING_ID_PLAYTHROUGH      DEFAULT("playthrough");
+    EXTERN const char* SETTING_ID_RECORD_ON_FIRST_NOTE  DEFAULT("recordOnFirstNote");
+    EXTERN const char* SETTING_ID_COUNT_IN         DEFAULT("countIn");
+
+    EXTERN const char* SETTING_ID_METRONOME_SOUND            DEFAULT("metronomeSound");
+    EXTERN const char* SETTING_ID_METRONOME_DOWNBEAT_SOUND   DEFAULT("metronomeDownbeatSound");
+    EXTERN const char* SETTING_ID_METRONOME_HALF_BEAT_SOUND  DEFAULT("metronomeHalfBeatSound");
 
     EXTERN const char* SETTING_ID_MARGIN_LEFT      DEFAULT("marginLeft");
     EXTERN const char* SETTING_ID_MARGIN_RIGHT     DEFAULT("marginRight");
@@ -103,6 +109,9 @@ static const wxString SYSTEM_BANK = _("System soundbank");
     
     EXTERN const char* SETTING_ID_RECENT_FILES     DEFAULT("recentFiles");
     
+    /** in megabytes */
+    EXTERN const char* SETTING_ID_UNDO_MEMORY_BUDGET DEFAULT("undoMemoryBudget");
+    
     EXTERN const char* SETTING_ID_CHECK_NEW_VERSION DEFAULT("checkForNewVersion");
     
     EXTERN const char* SETTING_ID_REMEMBER_WINDOW_POS DEFAULT("rememberWindowLocation");
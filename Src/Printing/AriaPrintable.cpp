@@ -23,12 +23,22 @@
 #include "Printing/AbstractPrintableSequence.h"
 #include "Printing/RenderRoutines.h"
 
+#include <algorithm>
 #include <iostream>
 #include <wx/dcmemory.h>
 #include <wx/print.h>
 #include <wx/printdlg.h>
 #include <wx/graphics.h>
 #include <wx/dcprint.h>
+#include <wx/filename.h>
+
+#if defined(HAVE_CAIRO) && wxCHECK_VERSION(2,9,1) && wxUSE_GRAPHICS_CONTEXT && wxUSE_CAIRO
+#define ARIA_VECTOR_EXPORT 1
+#include <wx/dcgraph.h>
+#include <cairo.h>
+#include <cairo-pdf.h>
+#include <cairo-svg.h>
+#endif
 
 using namespace AriaMaestosa;
 
@@ -116,6 +126,7 @@ AriaPrintable::AriaPrintable(wxString title, bool* success) :
 AriaPrintable::~AriaPrintable()
 {
     m_current_printable = NULL;
+    RenderRoutines::releaseGlyphCache();
 }
 
 // -------------------------------------------------------------------------------------------------------------
@@ -195,6 +206,102 @@ wxPrinterError AriaPrintable::print()
 
 // -------------------------------------------------------------------------------------------------------------
 
+bool AriaPrintable::exportToFile(const wxString& path)
+{
+    ASSERT( MAGIC_NUMBER_OK() );
+    ASSERT(m_seq->isLayoutCalculated());
+    
+#ifdef ARIA_VECTOR_EXPORT
+    wxFileName fileName(path);
+    const wxString extension = fileName.GetExt().Lower();
+    const bool pdf = (extension == wxT("pdf"));
+    if (not pdf and extension != wxT("svg"))
+    {
+        std::cerr << "[AriaPrintable] ERROR: cannot export to '" << path.mb_str() << "', unknown format\n";
+        return false;
+    }
+    
+    // cairo surfaces are measured in points (1/72 inch)
+    const double points_per_mm = 72.0/25.4;
+    const wxSize paper   = m_printer_manager->getPaperSizeMM();
+    const wxRect margins = m_printer_manager->getMarginsRectMM();
+    const double page_w  = paper.GetWidth()*points_per_mm;
+    const double page_h  = paper.GetHeight()*points_per_mm;
+    
+    // fit the print units inside the margins, centered, like wxEasyPrintWrapper does
+    const int unit_w = getUnitWidth();
+    const int unit_h = getUnitHeight();
+    const double scale = std::min(margins.GetWidth()*points_per_mm/unit_w,
+                                  margins.GetHeight()*points_per_mm/unit_h);
+    const double origin_x = margins.GetX()*points_per_mm + (margins.GetWidth()*points_per_mm  - unit_w*scale)/2.0;
+    const double origin_y = margins.GetY()*points_per_mm + (margins.GetHeight()*points_per_mm - unit_h*scale)/2.0;
+    
+    const int pageCount = m_seq->getPageAmount();
+    
+    cairo_surface_t* surface = NULL;
+    if (pdf)
+    {
+        surface = cairo_pdf_surface_create(path.utf8_str(), page_w, page_h);
+    }
+    
+    bool success = true;
+    for (int page=1; page<=pageCount and success; page++)
+    {
+        if (not pdf)
+        {
+            wxFileName pageFile(fileName);
+            if (page > 1) pageFile.SetName(fileName.GetName() + wxString::Format(wxT("-%i"), page));
+            surface = cairo_svg_surface_create(pageFile.GetFullPath().utf8_str(), page_w, page_h);
+        }
+        
+        if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS)
+        {
+            std::cerr << "[AriaPrintable] ERROR: could not create output surface for page " << page << "\n";
+            success = false;
+            break;
+        }
+        
+        cairo_t* cr = cairo_create(surface);
+        wxGraphicsContext* gc = wxGraphicsRenderer::GetCairoRenderer()->CreateContextFromNativeContext(cr);
+        wxGCDC* dc = new wxGCDC(gc);
+        dc->SetDeviceOrigin(origin_x, origin_y);
+        dc->SetUserScale(scale, scale);
+        
+        printPage(page, *dc, gc, 0, 0, unit_w, unit_h);
+        
+        delete dc; // also deletes gc
+        cairo_destroy(cr);
+        
+        if (pdf)
+        {
+            // the page is written out as soon as it is finished
+            cairo_surface_show_page(surface);
+        }
+        else
+        {
+            cairo_surface_finish(surface);
+            success = (cairo_surface_status(surface) == CAIRO_STATUS_SUCCESS);
+            cairo_surface_destroy(surface);
+            surface = NULL;
+        }
+    }
+    
+    if (surface != NULL)
+    {
+        cairo_surface_finish(surface);
+        success = success and (cairo_surface_status(surface) == CAIRO_STATUS_SUCCESS);
+        cairo_surface_destroy(surface);
+    }
+    
+    return success;
+#else
+    std::cerr << "[AriaPrintable] ERROR: vector export is not available in this build\n";
+    return false;
+#endif
+}
+
+// -------------------------------------------------------------------------------------------------------------
+
 AriaPrintable* AriaPrintable::getCurrentPrintable()
 {
     ASSERT(m_current_printable != NULL);
@@ -320,10 +427,7 @@ void AriaPrintable::printPage(const int pageNum, wxDC& dc, wxGraphicsContext* gc
     
     // ---- get usable area (some area at the top is reserved to the title) 
     const float notation_area_h  = getUsableAreaHeight(pageNum);
-    const float notation_area_y0 = y0 + MARGIN_UNDER_PAGE_HEADER +
-                                   (pageNum == 1 ?
-                                    m_title_font_height + m_subtitle_font_height :
-                                    m_subtitle_font_height);
+    const float notation_area_y0 = getNotationAreaY0(pageNum, y0);
 
     ASSERT(notation_area_h > 0);
     ASSERT(h > 0);
@@ -332,10 +436,6 @@ void AriaPrintable::printPage(const int pageNum, wxDC& dc, wxGraphicsContext* gc
 
     dc.SetFont( m_normal_font );
     m_seq->printLinesInArea(dc, gc, pageNum-1, notation_area_y0, notation_area_h, h, x0, x1);
-    
-#if wxCHECK_VERSION(2,9,1) && wxUSE_GRAPHICS_CONTEXT
-    delete gc;
-#endif
 }
     
 // -------------------------------------------------------------------------------------------------------------
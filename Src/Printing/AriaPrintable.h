@@ -129,6 +129,19 @@ namespace AriaMaestosa
           */ 
         wxPrinterError print();
         
+        /**
+          * @brief Renders the sequence straight to a vector file, without the platform print system
+          *
+          * The format is picked from the extension : ".pdf" writes a single multi-page document,
+          * ".svg" writes one file per page ("name.svg", "name-2.svg", ...). Pages are drawn with the
+          * current page setup and written one at a time, so memory use does not grow with the
+          * number of pages. No dialog is shown.
+          *
+          * @pre  the 'calculateLayout' method of the printable sequence has been called
+          * @return whether the file(s) could be written; always false on builds without cairo
+          */
+        bool exportToFile(const wxString& path);
+        
         /** 
           * @return the number of units used horizontally in the coordinate system set-up for
           * the kind of paper that is selected.
@@ -181,6 +194,18 @@ namespace AriaMaestosa
             return (pageNumber == 1 ? m_usable_area_height_page_1 : m_usable_area_height);
         }
         
+        /**
+          * @return the Y coordinate where notation starts on the given page (i.e. under the page header)
+          * @param y0  Y coordinate of the top of the page
+          */
+        float getNotationAreaY0(const int pageNumber, const int y0) const
+        {
+            ASSERT(pageNumber >= 1);
+            return y0 + MARGIN_UNDER_PAGE_HEADER + (pageNumber == 1 ?
+                                                    m_title_font_height + m_subtitle_font_height :
+                                                    m_subtitle_font_height);
+        }
+        
         /**
          * Called (by wxEasyPrintWrapper) when it is time to print a page.
          *
@@ -188,6 +213,8 @@ namespace AriaMaestosa
          * @param dc           The wxDC onto which stuff to print is to be rendered
          * @param x0           x origin coordinate from which drawing can occur
          * @param y0           y origin coordinate from which drawing can occur
+         * @note Must be called from the main thread, one page at a time: the printables keep per-line
+         *       state while drawing, and RenderRoutines caches glyphs and bitmaps in statics.
          */
         virtual void printPage(const int pageNum, wxDC& dc,
                                wxGraphicsContext* gc,
@@ -31,19 +31,77 @@ using namespace AriaMaestosa::RenderRoutines;
 #if wxCHECK_VERSION(2,9,1) && wxUSE_GRAPHICS_CONTEXT
 #include <wx/graphics.h>
 
+static void buildTreble(wxGraphicsPath& path);
+static void buildBass(wxGraphicsPath& path);
+static void buildQuarter(wxGraphicsPath& path);
+static void buildEighth(wxGraphicsPath& path);
+static void buildSixteenth(wxGraphicsPath& path);
+static void buildFlag(wxGraphicsPath& path);
+
+namespace
+{
+    enum Glyph
+    {
+        GLYPH_TREBLE,
+        GLYPH_BASS,
+        GLYPH_QUARTER_REST,
+        GLYPH_EIGHTH_REST,
+        GLYPH_SIXTEENTH_REST,
+        GLYPH_FLAG,
+        GLYPH_COUNT
+    };
+    
+    /**
+      * Outlines of the glyphs, built once in glyph units (as if drawn at x = 0, y = 0, scale = 1) and
+      * then drawn through a transform. Paths belong to the renderer they were created with.
+      */
+    struct GlyphCache
+    {
+        wxGraphicsRenderer* m_renderer;
+        wxGraphicsPath      m_paths[GLYPH_COUNT];
+    };
+    
+    GlyphCache* glyph_cache = NULL;
+    
+    /** Fills the given glyph with the current brush, its origin at (x, y), stretched by the given factors */
+    void drawGlyph(wxGraphicsContext& painter, const Glyph glyph, const float x, const float y,
+                   const float scale_x, const float scale_y)
+    {
+        wxGraphicsRenderer* renderer = painter.GetRenderer();
+        if (glyph_cache == NULL or glyph_cache->m_renderer != renderer)
+        {
+            typedef void (*GlyphBuilder)(wxGraphicsPath& path);
+            const GlyphBuilder builders[GLYPH_COUNT] = { buildTreble, buildBass, buildQuarter, buildEighth,
+                                                         buildSixteenth, buildFlag };
+            
+            delete glyph_cache;
+            glyph_cache = new GlyphCache();
+            glyph_cache->m_renderer = renderer;
+            for (int n=0; n<GLYPH_COUNT; n++)
+            {
+                glyph_cache->m_paths[n] = renderer->CreatePath();
+                builders[n](glyph_cache->m_paths[n]);
+            }
+        }
+        
+        painter.PushState();
+        painter.Translate(x, y);
+        painter.Scale(scale_x, scale_y);
+        painter.FillPath(glyph_cache->m_paths[glyph]);
+        painter.PopState();
+    }
+}
+
 /**
  * Based on TuxGuitar render routines, released under GNU GPL
  * (c) Julian Gabriel Casadesus and others
  */
-void AriaMaestosa::RenderRoutines::paintTreble(wxGraphicsContext& painter, int x, int B_y, int E_y)
+static void buildTreble(wxGraphicsPath& path)
 {
-    wxGraphicsPath path = painter.CreatePath();
-    
     // B : (x + (1.2321913f * scale)),(y + (2.1369102f * scale))
     // E : (x + (1.578771f * scale)),(y + (3.8828878f * scale))
     
-    float scale = (E_y - B_y)/1.95; // 1.95 = approximate distance from B to E
-    float y = B_y - (2.14f * scale); // 2.14 = approximate coordinate of B
+    const float x = 0.0f, y = 0.0f, scale = 1.0f;
     
     path.MoveToPoint((x + (0.9706216f * scale)),(y + (-0.9855771f * scale)));
     path.AddCurveToPoint((x + (0.99023926f * scale)),(y + (-0.99538594f * scale)),
@@ -315,24 +373,25 @@ void AriaMaestosa::RenderRoutines::paintTreble(wxGraphicsContext& painter, int x
     path.AddCurveToPoint((x + (1.5591533f * scale)),(y + (2.6829367f * scale)),
                          (x + (1.4676039f * scale)),(y + (2.6371622f * scale)),
                          (x + (1.3924028f * scale)),(y + (2.617545f * scale)));
+}
+
+void AriaMaestosa::RenderRoutines::paintTreble(wxGraphicsContext& painter, int x, int B_y, int E_y)
+{
+    float scale = (E_y - B_y)/1.95; // 1.95 = approximate distance from B to E
+    float y = B_y - (2.14f * scale); // 2.14 = approximate coordinate of B
     
     painter.SetPen( *wxBLACK_PEN );
     painter.SetBrush( *wxBLACK_BRUSH );
-    painter.FillPath(path);
+    drawGlyph(painter, GLYPH_TREBLE, x, y, scale, scale);
 }
 
 /**
  * Based on TuxGuitar render routines, released under GNU GPL
  * (c) Julian Gabriel Casadesus and others
  */
-void AriaMaestosa::RenderRoutines::paintBass(wxGraphicsContext& painter, int x, int score_top, int E_y)
+static void buildBass(wxGraphicsPath& path)
 {
-    //float scale = 75.0f;   
-
-    float scale = (E_y - score_top)/1.25; // 1.25 = approximate distance from top to E
-    float y = score_top - 0.17f*scale; // topmost y at 0.17
-
-    wxGraphicsPath path = painter.CreatePath();
+    const float x = 0.0f, y = 0.0f, scale = 1.0f;
     
     path.MoveToPoint((x + (0.71937084f * scale)),(y + (0.16147426f * scale)));
     path.AddCurveToPoint((x + (0.75454587f * scale)),(y + (0.15827677f * scale)),
@@ -451,10 +510,16 @@ void AriaMaestosa::RenderRoutines::paintBass(wxGraphicsContext& painter, int x,
     
     //painter.SetBrush( *wxRED_BRUSH );
     //painter.DrawRectangle((x + (2.1167896f * scale)),(y + (1.2966768f * scale)), 5, 5);
+}
+
+void AriaMaestosa::RenderRoutines::paintBass(wxGraphicsContext& painter, int x, int score_top, int E_y)
+{
+    float scale = (E_y - score_top)/1.25; // 1.25 = approximate distance from top to E
+    float y = score_top - 0.17f*scale; // topmost y at 0.17
     
     painter.SetPen( *wxBLACK_PEN );
     painter.SetBrush( *wxBLACK_BRUSH );
-    painter.FillPath(path);
+    drawGlyph(painter, GLYPH_BASS, x, y, scale, scale);
 }
 
 /**
@@ -542,12 +607,10 @@ const float HEIGHT_SIZE = 6.26f;
  * Based on TuxGuitar render routines, released under GNU GPL
  * (c) Julian Gabriel Casadesus and others
  */
-void paintEighth(wxGraphicsContext& painter, float x, float y, float scale)
+static void buildEighth(wxGraphicsPath& path)
 {
-    painter.SetPen( *wxBLACK_PEN );
-    painter.SetBrush( *wxBLACK_BRUSH );
+    const float x = 0.0f, y = 0.0f, scale = 1.0f;
     
-    wxGraphicsPath path = painter.CreatePath();
     path.MoveToPoint((x + (1.6779978f * scale)),(y + (0.070901394f * scale)));
     path.AddCurveToPoint((x + (2.1979408f * scale)),(y + (0.0f * scale)),(x + (2.6469831f * scale)),(y + (0.14180231f * scale)),(x + (3.0014887f * scale)),(y + (0.47267532f * scale)));
     path.AddCurveToPoint((x + (3.214193f * scale)),(y + (0.7090125f * scale)),(x + (3.3087273f * scale)),(y + (0.89808273f * scale)),(x + (3.450531f * scale)),(y + (1.4652932f * scale)));
@@ -570,8 +633,13 @@ void paintEighth(wxGraphicsContext& painter, float x, float y, float scale)
     path.AddCurveToPoint((x + (1.914336f * scale)),(y + (3.5923336f * scale)),(x + (1.7725322f * scale)),(y + (3.5687f * scale)),(x + (1.394393f * scale)),(y + (3.3796299f * scale)));
     path.AddCurveToPoint((x + (0.3545066f * scale)),(y + (2.88332f * scale)),(x + (0.0f * scale)),(y + (1.6779974f * scale)),(x + (0.5908443f * scale)),(y + (0.7799146f * scale)));
     path.AddCurveToPoint((x + (0.85081583f * scale)),(y + (0.4254074f * scale)),(x + (1.2525895f * scale)),(y + (0.14180231f * scale)),(x + (1.6779978f * scale)),(y + (0.070901394f * scale)));
-    
-    painter.FillPath(path);
+}
+
+void paintEighth(wxGraphicsContext& painter, float x, float y, float scale)
+{
+    painter.SetPen( *wxBLACK_PEN );
+    painter.SetBrush( *wxBLACK_BRUSH );
+    drawGlyph(painter, GLYPH_EIGHTH_REST, x, y, scale, scale);
 }
 
 const float QUARTER_SIZE = 6.4f;
@@ -580,12 +648,10 @@ const float QUARTER_SIZE = 6.4f;
  * Based on TuxGuitar render routines, released under GNU GPL
  * (c) Julian Gabriel Casadesus and others
  */
-void paintQuarter(wxGraphicsContext& painter, float x, float y, float scale)
+static void buildQuarter(wxGraphicsPath& path)
 {
-    painter.SetPen( *wxBLACK_PEN );
-    painter.SetBrush( *wxBLACK_BRUSH );
+    const float x = 0.0f, y = 0.0f, scale = 1.0f;
     
-    wxGraphicsPath path = painter.CreatePath();
     
     path.MoveToPoint((x + (2.1034088f * scale)),(y + (0.047267675f * scale)));
     path.AddCurveToPoint((x + (2.1979485f * scale)),(y + (0.0f * scale)),(x + (2.2924728f * scale)),(y + (0.0f * scale)),(x + (2.387024f * scale)),(y + (0.023633957f * scale)));
@@ -620,7 +686,13 @@ void paintQuarter(wxGraphicsContext& painter, float x, float y, float scale)
     path.AddCurveToPoint((x + (3.0723915f * scale)),(y + (1.8434343f * scale)),(x + (2.7887878f * scale)),(y + (1.4889283f * scale)),(x + (2.505188f * scale)),(y + (1.1344206f * scale)));
     path.AddCurveToPoint((x + (2.2215881f * scale)),(y + (0.8035486f * scale)),(x + (1.9616127f * scale)),(y + (0.49630952f * scale)),(x + (1.9379692f * scale)),(y + (0.44904137f * scale)));
     path.AddCurveToPoint((x + (1.8670654f * scale)),(y + (0.30723906f * scale)),(x + (1.9379692f * scale)),(y + (0.11816859f * scale)),(x + (2.1034088f * scale)),(y + (0.047267675f * scale)));
-    painter.FillPath(path);
+}
+
+void paintQuarter(wxGraphicsContext& painter, float x, float y, float scale)
+{
+    painter.SetPen( *wxBLACK_PEN );
+    painter.SetBrush( *wxBLACK_BRUSH );
+    drawGlyph(painter, GLYPH_QUARTER_REST, x, y, scale, scale);
 }
 
 const int SIXTEENTH_SIZE = 8.0f;
@@ -629,12 +701,10 @@ const int SIXTEENTH_SIZE = 8.0f;
  * Based on TuxGuitar render routines, released under GNU GPL
  * (c) Julian Gabriel Casadesus and others
  */
-void paintSixteenth(wxGraphicsContext& painter, float x, float y,float scale)
+static void buildSixteenth(wxGraphicsPath& path)
 {
-    painter.SetPen( *wxBLACK_PEN );
-    painter.SetBrush( *wxBLACK_BRUSH );
+    const float x = 0.0f, y = 0.0f, scale = 1.0f;
     
-    wxGraphicsPath path = painter.CreatePath();
     
     path.MoveToPoint((x + (3.5214243f * scale)),(y + (0.070901394f * scale)));
     path.AddCurveToPoint((x + (4.041381f * scale)),(y + (0.0f * scale)),(x + (4.490409f * scale)),(y + (0.14180231f * scale)),(x + (4.8449125f * scale)),(y + (0.4726758f * scale)));
@@ -670,7 +740,13 @@ void paintSixteenth(wxGraphicsContext& painter, float x, float y,float scale)
     path.AddCurveToPoint((x + (3.757759f * scale)),(y + (3.5923338f * scale)),(x + (3.6159725f * scale)),(y + (3.5687003f * scale)),(x + (3.2378254f * scale)),(y + (3.3796296f * scale)));
     path.AddCurveToPoint((x + (2.197935f * scale)),(y + (2.8833203f * scale)),(x + (1.8434324f * scale)),(y + (1.6779971f * scale)),(x + (2.43427f * scale)),(y + (0.77991486f * scale)));
     path.AddCurveToPoint((x + (2.69425f * scale)),(y + (0.4254074f * scale)),(x + (3.096015f * scale)),(y + (0.14180231f * scale)),(x + (3.5214243f * scale)),(y + (0.070901394f * scale)));
-    painter.FillPath(path);
+}
+
+void paintSixteenth(wxGraphicsContext& painter, float x, float y, float scale)
+{
+    painter.SetPen( *wxBLACK_PEN );
+    painter.SetBrush( *wxBLACK_BRUSH );
+    drawGlyph(painter, GLYPH_SIXTEENTH_REST, x, y, scale, scale);
 }
 
 /**
@@ -733,6 +809,65 @@ void paintThirtySecond(wxGraphicsContext& painter, float x, float y, float scale
     painter.FillPath(path);
 }
 
+/**
+ * Based on TuxGuitar render routines, released under GNU GPL
+ * (c) Julian Gabriel Casadesus and others
+ */
+static void buildFlag(wxGraphicsPath& path)
+{
+    const float x = 0.0f, y = 0.0f, scale = 1.0f;
+    const int orient = -1;
+    
+    path.MoveToPoint(( x + (0.64375f * scale) ),( y + ((0.00625f * scale) * -orient) ));
+    path.AddCurveToPoint(( x + (0.659375f * scale) ),( y + ((0.0f * scale) * -orient) ),
+                         ( x + (0.69375f * scale) ),( y + ((0.00625f * scale) * -orient) ),
+                         ( x + (0.70625f * scale) ),( y + ((0.0125f * scale) * -orient) ));
+    path.AddCurveToPoint(( x + (0.725f * scale) ),( y + ((0.025f * scale) * -orient) ),
+                         ( x + (0.73125f * scale) ),( y + ((0.03125f * scale) * -orient) ),
+                         ( x + (0.75f * scale) ),( y + ((0.065625f * scale) * -orient) ));
+    path.AddCurveToPoint(( x + (0.815625f * scale) ),( y + ((0.1875f * scale) * -orient) ),
+                         ( x + (0.86875f * scale) ),( y + ((0.3375f * scale) * -orient) ),
+                         ( x + (0.890625f * scale) ),( y + ((0.4625f * scale) * -orient) ));
+    path.AddCurveToPoint(( x + (0.934375f * scale) ),( y + ((0.70937496f * scale) * -orient) ),
+                         ( x + (0.903125f * scale) ),( y + ((0.890625f * scale) * -orient) ),
+                         ( x + (0.778125f * scale) ),( y + ((1.096875f * scale) * -orient) ));
+    path.AddCurveToPoint(( x + (0.721875f * scale) ),( y + ((1.19375f * scale) * -orient) ),
+                         ( x + (0.653125f * scale) ),( y + ((1.28125f * scale) * -orient) ),
+                         ( x + (0.5f * scale) ),( y + ((1.453125f * scale) * -orient) ));
+    path.AddCurveToPoint(( x + (0.340625f * scale) ),( y + ((1.6375f * scale) * -orient) ),
+                         ( x + (0.290625f * scale) ),( y + ((1.703125f * scale) * -orient) ),
+                         ( x + (0.228125f * scale) ),( y + ((1.790625f * scale) * -orient) ));
+    path.AddCurveToPoint(( x + (0.165625f * scale) ),( y + ((1.8875f * scale) * -orient) ),
+                         ( x + (0.121875f * scale) ),( y + ((1.978125f * scale) * -orient) ),
+                         ( x + (0.09375f * scale) ),( y + ((2.06875f * scale) * -orient) ));
+    path.AddCurveToPoint(( x + (0.078125f * scale) ),( y + ((2.125f * scale) * -orient) ),
+                         ( x + (0.065625f * scale) ),( y + ((2.209375f * scale) * -orient) ),
+                         ( x + (0.065625f * scale) ),( y + ((2.25625f * scale) * -orient) ));
+    path.AddLineToPoint( x + (0.065625f * scale) ,( y + ((2.271875f * scale) * -orient) ));
+    path.AddLineToPoint(( x + (0.034375f * scale) ),( y + ((2.271875f * scale) * -orient) ));
+    path.AddLineToPoint(( x + (0.0f * scale) ),( y + ((2.271875f * scale) * -orient) ));
+    path.AddLineToPoint(( x + (0.0f * scale) ),( y + ((1.88125f * scale) * -orient) ));
+    path.AddLineToPoint(( x + (0.0f * scale) ),( y + ((1.490625f * scale) * -orient) ));
+    path.AddLineToPoint(( x + (0.034375f * scale) ),( y + ((1.490625f * scale) * -orient) ));
+    path.AddLineToPoint(( x + (0.06875f * scale) ),( y + ((1.490625f * scale) * -orient) ));
+    path.AddLineToPoint(( x + (0.15f * scale) ),( y + ((1.434375f * scale) * -orient) ));
+    path.AddCurveToPoint(( x + (0.38125f * scale) ),( y + ((1.28125f * scale) * -orient) ),
+                         ( x + (0.521875f * scale) ),( y + ((1.15625f * scale) * -orient) ),
+                         ( x + (0.621875f * scale) ),( y + ((1.021875f * scale) * -orient) ));
+    path.AddCurveToPoint(( x + (0.74375f * scale) ),( y + ((0.85625f * scale) * -orient) ),
+                         ( x + (0.778125f * scale) ),( y + ((0.71874994f * scale) * -orient) ),
+                         ( x + (0.74375f * scale) ),( y + ((0.5124999f * scale) * -orient) ));
+    path.AddCurveToPoint(( x + (0.721875f * scale) ),( y + ((0.38125f * scale) * -orient) ),
+                         ( x + (0.66875f * scale) ),( y + ((0.246875f * scale) * -orient) ),
+                         ( x + (0.6f * scale) ),( y + ((0.128125f * scale) * -orient) ));
+    path.AddCurveToPoint(( x + (0.584375f * scale) ),( y + ((0.10625f * scale) * -orient) ),
+                         ( x + (0.58125f * scale) ),( y + ((0.096875f * scale) * -orient) ),
+                         ( x + (0.58125f * scale) ),( y + ((0.0875f * scale) * -orient) ));
+    path.AddCurveToPoint(( x + (0.58125f * scale) ),( y + ((0.05f * scale) * -orient) ),
+                         ( x + (0.60625f * scale) ),( y + ((0.01875f * scale) * -orient) ),
+                         ( x + (0.64375f * scale) ),( y + ((0.00625f * scale) * -orient) ));
+}
+
 void AriaMaestosa::RenderRoutines::drawSilence(wxGraphicsContext& dc, const Range<int> x, const int y,
                                                const int levelHeight, const int type, const bool triplet,
                                                const bool dotted)
@@ -861,62 +996,9 @@ void AriaMaestosa::RenderRoutines::drawFlag(wxDC* dc, wxGraphicsContext* gc, con
     gc->SetPen(  *wxTRANSPARENT_PEN  );
     gc->SetBrush( *wxBLACK_BRUSH );
     
-    wxGraphicsPath path = gc->CreatePath();
-    
+    // the cached glyph is built for orient = -1, the other orientation flips it vertically
     const float scale = 65.0f;
-    const float x = flag_x_origin + 3;
-    const float y = flag_y + orient*scale*2.2f;
-    
-    path.MoveToPoint(( x + (0.64375f * scale) ),( y + ((0.00625f * scale) * -orient) ));
-    path.AddCurveToPoint(( x + (0.659375f * scale) ),( y + ((0.0f * scale) * -orient) ),
-                         ( x + (0.69375f * scale) ),( y + ((0.00625f * scale) * -orient) ),
-                         ( x + (0.70625f * scale) ),( y + ((0.0125f * scale) * -orient) ));
-    path.AddCurveToPoint(( x + (0.725f * scale) ),( y + ((0.025f * scale) * -orient) ),
-                         ( x + (0.73125f * scale) ),( y + ((0.03125f * scale) * -orient) ),
-                         ( x + (0.75f * scale) ),( y + ((0.065625f * scale) * -orient) ));
-    path.AddCurveToPoint(( x + (0.815625f * scale) ),( y + ((0.1875f * scale) * -orient) ),
-                         ( x + (0.86875f * scale) ),( y + ((0.3375f * scale) * -orient) ),
-                         ( x + (0.890625f * scale) ),( y + ((0.4625f * scale) * -orient) ));
-    path.AddCurveToPoint(( x + (0.934375f * scale) ),( y + ((0.70937496f * scale) * -orient) ),
-                         ( x + (0.903125f * scale) ),( y + ((0.890625f * scale) * -orient) ),
-                         ( x + (0.778125f * scale) ),( y + ((1.096875f * scale) * -orient) ));
-    path.AddCurveToPoint(( x + (0.721875f * scale) ),( y + ((1.19375f * scale) * -orient) ),
-                         ( x + (0.653125f * scale) ),( y + ((1.28125f * scale) * -orient) ),
-                         ( x + (0.5f * scale) ),( y + ((1.453125f * scale) * -orient) ));
-    path.AddCurveToPoint(( x + (0.340625f * scale) ),( y + ((1.6375f * scale) * -orient) ),
-                         ( x + (0.290625f * scale) ),( y + ((1.703125f * scale) * -orient) ),
-                         ( x + (0.228125f * scale) ),( y + ((1.790625f * scale) * -orient) ));
-    path.AddCurveToPoint(( x + (0.165625f * scale) ),( y + ((1.8875f * scale) * -orient) ),
-                         ( x + (0.121875f * scale) ),( y + ((1.978125f * scale) * -orient) ),
-                         ( x + (0.09375f * scale) ),( y + ((2.06875f * scale) * -orient) ));
-    path.AddCurveToPoint(( x + (0.078125f * scale) ),( y + ((2.125f * scale) * -orient) ),
-                         ( x + (0.065625f * scale) ),( y + ((2.209375f * scale) * -orient) ),
-                         ( x + (0.065625f * scale) ),( y + ((2.25625f * scale) * -orient) ));
-    path.AddLineToPoint( x + (0.065625f * scale) ,( y + ((2.271875f * scale) * -orient) ));
-    path.AddLineToPoint(( x + (0.034375f * scale) ),( y + ((2.271875f * scale) * -orient) ));
-    path.AddLineToPoint(( x + (0.0f * scale) ),( y + ((2.271875f * scale) * -orient) ));
-    path.AddLineToPoint(( x + (0.0f * scale) ),( y + ((1.88125f * scale) * -orient) ));
-    path.AddLineToPoint(( x + (0.0f * scale) ),( y + ((1.490625f * scale) * -orient) ));
-    path.AddLineToPoint(( x + (0.034375f * scale) ),( y + ((1.490625f * scale) * -orient) ));
-    path.AddLineToPoint(( x + (0.06875f * scale) ),( y + ((1.490625f * scale) * -orient) ));
-    path.AddLineToPoint(( x + (0.15f * scale) ),( y + ((1.434375f * scale) * -orient) ));
-    path.AddCurveToPoint(( x + (0.38125f * scale) ),( y + ((1.28125f * scale) * -orient) ),
-                         ( x + (0.521875f * scale) ),( y + ((1.15625f * scale) * -orient) ),
-                         ( x + (0.621875f * scale) ),( y + ((1.021875f * scale) * -orient) ));
-    path.AddCurveToPoint(( x + (0.74375f * scale) ),( y + ((0.85625f * scale) * -orient) ),
-                         ( x + (0.778125f * scale) ),( y + ((0.71874994f * scale) * -orient) ),
-                         ( x + (0.74375f * scale) ),( y + ((0.5124999f * scale) * -orient) ));
-    path.AddCurveToPoint(( x + (0.721875f * scale) ),( y + ((0.38125f * scale) * -orient) ),
-                         ( x + (0.66875f * scale) ),( y + ((0.246875f * scale) * -orient) ),
-                         ( x + (0.6f * scale) ),( y + ((0.128125f * scale) * -orient) ));
-    path.AddCurveToPoint(( x + (0.584375f * scale) ),( y + ((0.10625f * scale) * -orient) ),
-                         ( x + (0.58125f * scale) ),( y + ((0.096875f * scale) * -orient) ),
-                         ( x + (0.58125f * scale) ),( y + ((0.0875f * scale) * -orient) ));
-    path.AddCurveToPoint(( x + (0.58125f * scale) ),( y + ((0.05f * scale) * -orient) ),
-                         ( x + (0.60625f * scale) ),( y + ((0.01875f * scale) * -orient) ),
-                         ( x + (0.64375f * scale) ),( y + ((0.00625f * scale) * -orient) ));
-    
-    gc->FillPath(path);
+    drawGlyph(*gc, GLYPH_FLAG, flag_x_origin + 3, flag_y + orient*scale*2.2f, scale, -orient*scale);
 #else
     wxPoint points[] =
     {
@@ -1090,18 +1172,29 @@ void AriaMaestosa::RenderRoutines::drawSilence(wxDC* dc, const Range<int> x, con
 
 void AriaMaestosa::RenderRoutines::drawNoteHead(wxDC& dc, const wxPoint headCenter, const bool hollowHead)
 {
+    // the outline of the head does not depend on where it is drawn, only calculate it once
+    static float offset_x[25], offset_y[25];
+    static bool offsets_calculated = false;
+    
+    if (not offsets_calculated)
+    {
+        for (int n=0; n<25; n++)
+        {
+            const float angle = n/25.0*6.283185f /* 2*PI */;
+            
+            // FIXME - instead of always substracting to radius, just make it smaller...
+            offset_x[n] = (HEAD_RADIUS-5)*cos(angle);
+            offset_y[n] = (HEAD_RADIUS - 14)*sin(angle) - HEAD_RADIUS*(-0.5f + fabsf( (n-12.5f)/12.5f ))/2.0f;
+        }
+        offsets_calculated = true;
+    }
+    
     const int cx = headCenter.x + (hollowHead ? -2 : 0); // FIXME: the -2 is a hack for the head to blend in the stem
     const int cy = headCenter.y;
     wxPoint points[25];
     for (int n=0; n<25; n++)
     {
-        const float angle = n/25.0*6.283185f /* 2*PI */;
-        
-        // FIXME - instead of always substracting to radius, just make it smaller...
-        const int px = cx + (HEAD_RADIUS-5)*cos(angle);
-        const int py = cy + (HEAD_RADIUS - 14)*sin(angle) - HEAD_RADIUS*(-0.5f + fabsf( (n-12.5f)/12.5f ))/2.0f;
-        
-        points[n] = wxPoint( px, py );
+        points[n] = wxPoint( cx + offset_x[n], cy + offset_y[n] );
     }
     
     if (hollowHead) dc.DrawSpline(25, points);
@@ -1159,6 +1252,16 @@ void AriaMaestosa::RenderRoutines::renderArc(wxGraphicsContext& dc, const int ce
 
 // -------------------------------------------------------------------------------------------------------
 
+void AriaMaestosa::RenderRoutines::releaseGlyphCache()
+{
+#if wxCHECK_VERSION(2,9,1) && wxUSE_GRAPHICS_CONTEXT
+    delete glyph_cache;
+    glyph_cache = NULL;
+#endif
+}
+
+// -------------------------------------------------------------------------------------------------------
+
 wxBitmap AriaMaestosa::RenderRoutines::getScaledBitmap(const wxString& fileName, float scale)
 {
     wxImage tempImage(getResourcePrefix() + wxT("score") + wxFileName::GetPathSeparator() + fileName,
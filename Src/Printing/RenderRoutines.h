@@ -79,6 +79,12 @@ namespace AriaMaestosa
         void paintBass(wxGraphicsContext& painter, int x, int score_top, int E_y);
 #endif
         
+        /**
+          * @brief frees the outlines of clefs, rests and flags, which are built the first time they
+          *        are drawn and then reused for every symbol
+          */
+        void releaseGlyphCache();
+        
         /**
          * @brief  loads an image from file and scales it
          * @return the scaled image
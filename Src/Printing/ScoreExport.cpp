@@ -0,0 +1,188 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "Printing/ScoreExport.h"
+
+#include "AriaCore.h"
+#include "GUI/GraphicalSequence.h"
+#include "GUI/GraphicalTrack.h"
+#include "IO/AriaFileWriter.h"
+#include "IO/IOUtils.h"
+#include "IO/MidiFileReader.h"
+#include "Midi/Sequence.h"
+#include "Midi/Track.h"
+#include "Printing/AriaPrintable.h"
+#include "Printing/KeyrollPrintableSequence.h"
+#include "Printing/SymbolPrinter/SymbolPrintableSequence.h"
+
+#include <wx/filefn.h>
+
+#include <iostream>
+#include <set>
+#include <vector>
+
+using namespace AriaMaestosa;
+
+namespace AriaMaestosa
+{
+    /** Makes the sequence being exported current while there is no main frame */
+    class ExportSequenceProvider : public ICurrentSequenceProvider
+    {
+        GraphicalSequence* m_gseq;
+        
+    public:
+        
+        ExportSequenceProvider(GraphicalSequence* gseq)
+        {
+            m_gseq = gseq;
+        }
+        
+        virtual Sequence* getCurrentSequence()
+        {
+            return m_gseq->getModel();
+        }
+        
+        virtual GraphicalSequence* getCurrentGraphicalSequence()
+        {
+            return m_gseq;
+        }
+    };
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+bool AriaMaestosa::exportScore(GraphicalSequence* gseq, const wxString& path)
+{
+    Sequence* seq = gseq->getModel();
+    
+    std::vector< std::pair<GraphicalTrack*, NotationType> > symbolTracks;
+    std::vector< std::pair<GraphicalTrack*, NotationType> > keyrollTracks;
+    
+    const int trackAmount = seq->getTrackAmount();
+    for (int n=0; n<trackAmount; n++)
+    {
+        Track* track = seq->getTrack(n);
+        if (track->isNotationTypeEnabled(SCORE))
+        {
+            symbolTracks.push_back( std::pair<GraphicalTrack*, NotationType>(gseq->getGraphicsFor(track), SCORE) );
+        }
+        if (track->isNotationTypeEnabled(GUITAR))
+        {
+            symbolTracks.push_back( std::pair<GraphicalTrack*, NotationType>(gseq->getGraphicsFor(track), GUITAR) );
+        }
+        if (track->isNotationTypeEnabled(KEYBOARD))
+        {
+            keyrollTracks.push_back( std::pair<GraphicalTrack*, NotationType>(gseq->getGraphicsFor(track), KEYBOARD) );
+        }
+    }
+    
+    std::vector< std::pair<GraphicalTrack*, NotationType> >& whatToPrint =
+        (symbolTracks.empty() ? keyrollTracks : symbolTracks);
+    
+    if (whatToPrint.empty())
+    {
+        std::cerr << "[exportScore] ERROR: no printable track\n";
+        return false;
+    }
+    
+    // the printable sequence must outlive the AriaPrintable
+    OwnerPtr<AbstractPrintableSequence> printableSeq;
+    
+    bool success = false;
+    AriaPrintable printable(AbstractPrintableSequence::getTitle(seq), &success);
+    if (not success) return false;
+    
+    if (not symbolTracks.empty())
+    {
+        printableSeq = new SymbolPrintableSequence(seq);
+    }
+    else
+    {
+        // same defaults as the keyroll print options dialog
+        std::vector<wxColour> colors(whatToPrint.size(), wxColour(150,150,150));
+        printableSeq = new KeyrollPrintableSequence(seq, 0.7f, 0.0f, false, colors);
+    }
+    
+    printable.setSequence(printableSeq);
+    printable.showTrackNames(trackAmount > 1);
+    
+    const int count = whatToPrint.size();
+    for (int n=0; n<count; n++)
+    {
+        if (not printableSeq->addTrack(whatToPrint[n].first, whatToPrint[n].second))
+        {
+            std::cerr << "[exportScore] ERROR: track '" << whatToPrint[n].first->getTrack()->getName().mb_str()
+                      << "' cannot be printed\n";
+            return false;
+        }
+    }
+    
+    printableSeq->calculateLayout();
+    return printable.exportToFile(path);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+bool AriaMaestosa::exportScoreFile(const wxString& songPath, const wxString& path)
+{
+    // checked here, the loaders would report it in a message box
+    if (not wxFileExists(songPath))
+    {
+        std::cerr << "[exportScore] ERROR: cannot open '" << songPath.mb_str() << "'\n";
+        return false;
+    }
+    
+    OwnerPtr<GraphicalSequence> gseq( new GraphicalSequence(new Sequence(NULL, NULL, NULL, NULL, false)) );
+    gseq->getModel()->setFilepath(songPath);
+    
+    ExportSequenceProvider provider(gseq);
+    AriaMaestosa::setCurrentSequenceProvider(&provider);
+    
+    bool loaded = false;
+    if (songPath.Lower().EndsWith(wxT(".aria")))
+    {
+        loaded = AriaMaestosa::loadAriaFile(gseq, songPath);
+    }
+    else if (songPath.Lower().EndsWith(wxT(".mid")) or songPath.Lower().EndsWith(wxT(".midi")))
+    {
+        std::set<wxString> warnings;
+        loaded = AriaMaestosa::loadMidiFile(gseq, songPath, warnings);
+        
+        for (std::set<wxString>::iterator it = warnings.begin(); it != warnings.end(); it++)
+        {
+            std::cerr << "[exportScore] warning: " << (*it).utf8_str() << "\n";
+        }
+    }
+    else
+    {
+        std::cerr << "[exportScore] ERROR: '" << songPath.mb_str() << "' is neither a .aria nor a .mid file\n";
+    }
+    
+    bool success = false;
+    if (loaded)
+    {
+        gseq->getModel()->setSequenceFilename( extractTitle(songPath) );
+        success = exportScore(gseq, path);
+    }
+    else
+    {
+        std::cerr << "[exportScore] ERROR: loading '" << songPath.mb_str() << "' failed\n";
+    }
+    
+    AriaMaestosa::setCurrentSequenceProvider(NULL);
+    return success;
+}
@@ -0,0 +1,50 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef __SCORE_EXPORT_H__
+#define __SCORE_EXPORT_H__
+
+class wxString;
+
+namespace AriaMaestosa
+{
+    class GraphicalSequence;
+    
+    /**
+      * @brief Lays out the given sequence and writes it to a PDF or SVG file, without any dialog
+      *
+      * All tracks are exported with the notations currently enabled on them; score and tablature
+      * take precedence over keyroll, since both cannot be mixed in the same printout. The current
+      * page setup is used.
+      *
+      * @return whether the export succeeded
+      * @ingroup printing
+      */
+    bool exportScore(GraphicalSequence* gseq, const wxString& path);
+    
+    /**
+      * @brief Loads a .aria or .mid file and exports it like 'exportScore', without any window
+      *
+      * Used by the --export-score command-line option; errors are reported on stderr.
+      *
+      * @return whether the file could be loaded and exported
+      * @ingroup printing
+      */
+    bool exportScoreFile(const wxString& songPath, const wxString& path);
+}
+
+#endif
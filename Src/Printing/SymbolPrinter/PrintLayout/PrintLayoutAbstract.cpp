@@ -30,6 +30,7 @@
 #include "Printing/SymbolPrinter/SymbolPrintableSequence.h"
 
 #include "AriaCore.h"
+#include "WorkerPool.h"
 
 #include <iostream>
 #include <cmath>
@@ -160,21 +161,32 @@ void PrintLayoutAbstract::findSimilarMeasures()
     const Sequence* seq = m_sequence->getSequence();
     const int measureAmount = seq->getMeasureData()->getMeasureAmount();
 
+    // first occurences of each distinct measure, by content hash. A measure only needs to be
+    // fully compared with the (usually single) earlier measure that has the same hash
+    std::map< unsigned int, std::vector<int> > firstOccurences;
+    
     for (int measure=0; measure<measureAmount; measure++)
     {
-        // check current measure against all previous m_measures to see if it is not a repetition
-        for (int checkMeasure=0; checkMeasure<measure; checkMeasure++)
+        ASSERT_E(measure,<,(int)m_measures.size());
+        PrintLayoutMeasure& current = m_measures[measure];
+        current.calculateContentHash();
+        if (not current.hasNotes()) continue;
+        
+        std::vector<int>& candidates = firstOccurences[current.getContentHash()];
+        
+        bool found = false;
+        const int candidateAmount = candidates.size();
+        for (int n=0; n<candidateAmount; n++)
         {
-            ASSERT_E(measure,<,(int)m_measures.size());
-            ASSERT_E(checkMeasure,<,(int)m_measures.size());
-            const bool isSameAs = m_measures[measure].calculateIfMeasureIsSameAs(m_measures[checkMeasure]);
-            //std::cout << "measure " << (measure+1) << " is same as " << (checkMeasure+1) << " ? " << isSameAs << std::endl;
-            
-            if (!isSameAs) continue;
-            m_measures[measure].firstSimilarMeasure = checkMeasure;
-            m_measures[checkMeasure].similarMeasuresFoundLater.push_back(measure);
-            break;
-        }//next
+            if (current.calculateIfMeasureIsSameAs(m_measures[candidates[n]]))
+            {
+                current.setFirstSimilarMeasure(m_measures[candidates[n]]);
+                found = true;
+                break;
+            }
+        }
+        
+        if (not found) candidates.push_back(measure);
     }//next
 }
 #endif
@@ -301,82 +313,82 @@ void PrintLayoutAbstract::createLayoutElements(std::vector<LayoutElement>& layou
 
 // -----------------------------------------------------------------------------------------------------
     
-void PrintLayoutAbstract::calculateRelativeLengths(std::vector<LayoutElement>& layoutElements)
+void PrintLayoutAbstract::calculateRelativeLength(LayoutElement& element)
 {
-    std::cout << "\n====\ncalculateRelativeLengths\n====\n";
-
-    // calculate approximative width of each element
-    const int layoutElementsAmount = layoutElements.size();
-    for (int n=0; n<layoutElementsAmount; n++)
-    {
-        if ((n & 3) == 0) // only update progress one element out of 4
-        {
-            WaitWindow::setProgress( 35 + n*25/layoutElementsAmount );
-        }
-        
+    if (element.getType() != SINGLE_MEASURE and element.getType() != EMPTY_MEASURE) return;
+    
+    // determine a list of all ticks on which a note starts.
+    // then we can determine where within this measure should this note be drawn
+    
+    // Ask all editors to add their symbols to the list
+    PrintLayoutMeasure& meas = m_measures[element.m_measure];
+    RelativePlacementManager& ticks_relative_position = meas.getTicksPlacementManager();
+    
+    const int trackAmount = meas.getTrackRefAmount();
+    
 #if BE_VERBOSE
-        std::cout << "= layout element " << n << " =\n";
+    std::cout << "  -> collecting ticks from " << trackAmount << " tracks\n";
 #endif
+    
+    for (int i=0; i<trackAmount; i++)
+    {
+        MeasureTrackReference& track_ref = meas.getWritableTrackRef(i);
+        EditorPrintable* editorPrintable = m_sequence->getEditorPrintableFor( track_ref.getTrack()->getTrack() );
+        ASSERT( editorPrintable != NULL );
         
-        //layoutElements[n].width_in_print_units = LAYOUT_ELEMENT_MIN_WIDTH;
+        editorPrintable->addUsedTicks(meas, i, track_ref, ticks_relative_position);
+    }
+    
+    ticks_relative_position.calculateRelativePlacement();
+    
+    element.width_in_print_units = ticks_relative_position.getWidth();
 
-        if (layoutElements[n].getType() == SINGLE_MEASURE or layoutElements[n].getType() == EMPTY_MEASURE)
-        {     
-            layoutElements[n].width_in_print_units = LAYOUT_ELEMENT_MIN_WIDTH;
-            
-            // determine a list of all ticks on which a note starts.
-            // then we can determine where within this measure should this note be drawn
-            
-            std::vector<int> all_ticks_vector;
-            
-            // Ask all editors to add their symbols to the list
-            PrintLayoutMeasure& meas = m_measures[layoutElements[n].m_measure];
-            RelativePlacementManager& ticks_relative_position = meas.getTicksPlacementManager();
-            
-            const int trackAmount = meas.getTrackRefAmount();
-            
+    if (element.width_in_print_units < LAYOUT_ELEMENT_MIN_WIDTH)
+    {
+        element.width_in_print_units = LAYOUT_ELEMENT_MIN_WIDTH;
+    }
+    
 #if BE_VERBOSE
-            std::cout << "  -> collecting ticks from " << trackAmount << " tracks\n";
+    std::cout << "  -> Layout element is " << element.width_in_print_units << " unit(s) wide" << std::endl;
 #endif
-            
-            for (int i=0; i<trackAmount; i++)
-            {
-                MeasureTrackReference& track_ref = meas.getWritableTrackRef(i);
-                EditorPrintable* editorPrintable = m_sequence->getEditorPrintableFor( track_ref.getTrack()->getTrack() );
-                ASSERT( editorPrintable != NULL );
-                
-                editorPrintable->addUsedTicks(meas, i, track_ref, ticks_relative_position);
-            }
-            
-            ticks_relative_position.calculateRelativePlacement();
-            
-            /*
-            layoutElements[n].width_in_units = ticks_relative_position.getUnitCount();
-            if (layoutElements[n].width_in_units < MIN_UNIT_WIDTH)
-            {
-                layoutElements[n].width_in_units = MIN_UNIT_WIDTH;
-            }*/
-            
-            layoutElements[n].width_in_print_units = ticks_relative_position.getWidth();
+}
 
-            if (layoutElements[n].width_in_print_units < LAYOUT_ELEMENT_MIN_WIDTH)
-            {
-                layoutElements[n].width_in_print_units = LAYOUT_ELEMENT_MIN_WIDTH;
-            }
-            
-#if BE_VERBOSE
-            std::cout << "  -> Layout element " << n << " is " << layoutElements[n].width_in_print_units
-                      << " unit(s) wide" << std::endl;
-#endif
+// -----------------------------------------------------------------------------------------------------
+
+namespace AriaMaestosa
+{
+    /** Calculates the relative length of one layout element per task */
+    class RelativeLengthTask : public IParallelTask
+    {
+        PrintLayoutAbstract* m_layout;
+        std::vector<LayoutElement>& m_elements;
+        
+    public:
+        
+        RelativeLengthTask(PrintLayoutAbstract* layout, std::vector<LayoutElement>& elements) :
+            m_layout(layout), m_elements(elements)
+        {
         }
-        /*
-        else if (layoutElements[n].getType() == REPEATED_RIFF)
+        
+        virtual void runTask(const int id)
         {
-            layoutElements[n].width_in_print_units = LAYOUT_ELEMENT_MIN_WIDTH;
-        }*/
+            m_layout->calculateRelativeLength(m_elements[id]);
+        }
+    };
+}
+
+void PrintLayoutAbstract::calculateRelativeLengths(std::vector<LayoutElement>& layoutElements)
+{
+    std::cout << "\n====\ncalculateRelativeLengths\n====\n";
 
-        //std::cout << "$$ setting charwidth for element " << n << " : " << layoutElements[n].width_in_units << std::endl;
-    } // end for elements
+    // each element is a different measure, with its own RelativePlacementManager, and editor
+    // printables only read their (already set-up) data, so measures are laid out in parallel
+    WaitWindow::setProgress( 35 );
+    
+    RelativeLengthTask task(this, layoutElements);
+    WorkerPool::getInstance()->run(&task, layoutElements.size());
+    
+    WaitWindow::setProgress( 60 );
 }
 
 // -----------------------------------------------------------------------------------------------------
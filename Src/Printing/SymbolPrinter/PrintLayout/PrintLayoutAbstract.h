@@ -63,9 +63,17 @@ namespace AriaMaestosa
           */
         void layInLinesAndPages(std::vector<LayoutElement>& layoutElements, ptr_vector<LayoutPage>& layoutPages);
         
-        /** The main goal of this method is to set the 'width_in_print_units' member of each LayoutElement */
+        /**
+          * The main goal of this method is to set the 'width_in_print_units' member of each LayoutElement.
+          * Measures are processed concurrently on the WorkerPool.
+          */
         void calculateRelativeLengths(std::vector<LayoutElement>& layoutElements);
         
+        friend class RelativeLengthTask;
+        
+        /** Sets the 'width_in_print_units' of a single element; may run on any thread */
+        void calculateRelativeLength(LayoutElement& element);
+        
         /**
           * Populates the 'layoutElements' vector with elements that represent the current sequence.
           *
@@ -73,7 +81,10 @@ namespace AriaMaestosa
           */
         void createLayoutElements(std::vector<LayoutElement>& layoutElements);
         
-        /** fills fields containing info about similar measures withing the PrintLayoutMeasure objects */
+        /**
+          * Fills fields containing info about similar measures withing the PrintLayoutMeasure objects.
+          * Measures are grouped by content hash, so only measures with the same hash are compared.
+          */
         //void findSimilarMeasures();
         
         /** utility method invoked by 'layInLinesAndPages' when a line is complete */
@@ -23,6 +23,9 @@
 
 #include "Printing/SymbolPrinter/PrintLayout/PrintLayoutAbstract.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace AriaMaestosa
 {
     const PrintLayoutMeasure NULL_MEASURE(-1, NULL);
@@ -42,6 +45,9 @@ PrintLayoutMeasure::PrintLayoutMeasure(const int measID, Sequence* seq) :
     //cutApart             = false;
     m_measure_id         = measID;
     m_contains_something = false;
+    //m_has_notes          = false;
+    //m_content_hash       = 0;
+    //m_first_similar_measure = -1;
     
     if (measID != -1)
     {
@@ -51,106 +57,94 @@ PrintLayoutMeasure::PrintLayoutMeasure(const int measID, Sequence* seq) :
 }
 
 // -------------------------------------------------------------------------------------------
+// repetition detection; off until the repeated measure layout elements are back (see LayoutElementType)
 #if 0
-bool PrintLayoutMeasure::calculateIfMeasureIsSameAs(PrintLayoutMeasure& checkMeasure)
+namespace AriaMaestosa
 {
-    
-    const int trackRefAmount = m_track_refs.size();
-    int total_note_amount = 0;
-    
-    for (int tref=0; tref<trackRefAmount; tref++)
+    /** A note of a measure, with ticks relative to the start of the measure */
+    struct RelativeNote
     {
-        const int my_first_note  = m_track_refs[tref].getFirstNote();
-        const int my_last_note   = m_track_refs[tref].getLastNote();
-        const int his_first_note = checkMeasure.m_track_refs[tref].getFirstNote();
-        const int his_last_note  = checkMeasure.m_track_refs[tref].getLastNote();
+        int m_start, m_end, m_pitch;
         
-        ASSERT( m_track_refs.size() == checkMeasure.m_track_refs.size() );
-        ASSERT_E( tref,<,(int)m_track_refs.size() );
-        ASSERT( m_track_refs[tref].getTrack() == checkMeasure.m_track_refs[tref].getTrack() );
-        Track* track = m_track_refs[tref].getTrack();
-        
-        // if these 2 measures don't even have the same number of notes, they're definitely not the same
-        if ( (his_last_note - his_first_note + 1) != (my_last_note - my_first_note + 1) )
+        bool operator<(const RelativeNote& other) const
         {
-            return false;
+            if (m_start != other.m_start) return m_start < other.m_start;
+            if (m_end   != other.m_end)   return m_end   < other.m_end;
+            return m_pitch < other.m_pitch;
         }
         
-        
-        const int noteAmount = (his_last_note - his_first_note);
-        total_note_amount += noteAmount;
-        
-        // don't count empty measures as repetitions 
-        if (noteAmount<1)
+        bool operator==(const RelativeNote& other) const
         {
-            // when comparing a multiple-track line, don't stop on empty measures, for other tracks may not be empty
-            // for multi-track lines, variable 'total_note_amount' will be checked at the end to verify measure is not empty
-            if (trackRefAmount>1) continue;
-            return false;
+            return m_start == other.m_start and m_end == other.m_end and m_pitch == other.m_pitch;
         }
+    };
+    
+    /** Gets the notes referenced by 'ref', sorted so that their original order does not matter */
+    void getRelativeNotes(const MeasureTrackReference& ref, const int firstTick, std::vector<RelativeNote>& out)
+    {
+        out.clear();
+        if (ref.getFirstNote() == -1 or ref.getLastNote() == -1) return;
         
-        /*
-         if we get till there, the 2 measures have the same amount of notes.
-         to know whether they are truly identitcal, we need to compare note by note
-         we will match each notes from the first measure to the identical one in the second.
-         If ever one note failes to be matched, then the 2 measures are different.
-         */
-        int noteMatched_this[noteAmount];
-        int noteMatched_other[noteAmount];
-        for (int n=0; n<noteAmount; n++)
+        const Track* track = ref.getConstTrack()->getTrack();
+        for (int n=ref.getFirstNote(); n<=ref.getLastNote(); n++)
         {
-            noteMatched_this[n] = false;
-            noteMatched_other[n] = false;
+            RelativeNote note;
+            note.m_start = track->getNoteStartInMidiTicks(n) - firstTick;
+            note.m_end   = track->getNoteEndInMidiTicks(n)   - firstTick;
+            note.m_pitch = track->getNotePitchID(n);
+            out.push_back(note);
         }
+        std::sort(out.begin(), out.end());
+    }
+}
+
+// -------------------------------------------------------------------------------------------
+
+void PrintLayoutMeasure::calculateContentHash()
+{
+    // FNV-1a over the sorted notes of each track
+    m_content_hash = 2166136261u;
+    m_has_notes    = false;
+    
+    std::vector<RelativeNote> notes;
+    const int trackRefAmount = m_track_refs.size();
+    for (int tref=0; tref<trackRefAmount; tref++)
+    {
+        getRelativeNotes(m_track_refs[tref], m_first_tick, notes);
         
-        for (int checkNote_this=0; checkNote_this<=noteAmount; checkNote_this++)
+        const int noteAmount = notes.size();
+        m_content_hash = (m_content_hash ^ (unsigned int)noteAmount) * 16777619u;
+        for (int n=0; n<noteAmount; n++)
         {
-            for (int checkNote_other=0; checkNote_other<=noteAmount; checkNote_other++)
-            {
-                if (noteMatched_other[checkNote_other]) continue; // this note was already matched
-                
-                // check start tick matches
-                if (track->getNoteStartInMidiTicks(his_first_note + checkNote_other) - checkMeasure.getFirstTick() !=
-                   track->getNoteStartInMidiTicks(my_first_note + checkNote_this) - getFirstTick())
-                {
-                    // they dont match, check the next one
-                    continue;
-                }
-                
-                // check end tick matches
-                if (track->getNoteEndInMidiTicks(his_first_note + checkNote_other) - checkMeasure.getFirstTick() !=
-                   track->getNoteEndInMidiTicks(my_first_note + checkNote_this) - getFirstTick())
-                {
-                    // they dont match, check the next one
-                    continue;
-                }
-                
-                // check pitch matches
-                if (track->getNotePitchID(his_first_note + checkNote_other) !=
-                   track->getNotePitchID(my_first_note + checkNote_this))
-                {
-                    // they dont match, check the next one
-                    continue;
-                }
-                
-                noteMatched_this[checkNote_this] = true;
-                noteMatched_other[checkNote_other] = true;
-                
-                
-            }//next note
-            
-            // we couldn't find a note in the other measure that matches this one
-            if (noteMatched_this[checkNote_this] == false)
-            {
-                // std::cout << "  not the same cause couldn't find a note in the other measure that matches this one\n";
-                return false;
-            }
-            
-        }//next note
-        
-    } // next track reference
+            m_content_hash = (m_content_hash ^ (unsigned int)notes[n].m_start) * 16777619u;
+            m_content_hash = (m_content_hash ^ (unsigned int)notes[n].m_end)   * 16777619u;
+            m_content_hash = (m_content_hash ^ (unsigned int)notes[n].m_pitch) * 16777619u;
+        }
+        if (noteAmount > 0) m_has_notes = true;
+    }
+}
+
+// -------------------------------------------------------------------------------------------
+
+bool PrintLayoutMeasure::calculateIfMeasureIsSameAs(const PrintLayoutMeasure& checkMeasure) const
+{
+    // don't count empty measures as repetitions
+    if (not m_has_notes or not checkMeasure.m_has_notes) return false;
+    if (m_content_hash != checkMeasure.m_content_hash) return false;
+    
+    const int trackRefAmount = m_track_refs.size();
+    if (trackRefAmount != (int)checkMeasure.m_track_refs.size()) return false;
     
-    if (total_note_amount == 0) return false; // don't count empty measures as repeitions
+    // equal hashes are very likely, but not certainly, the same contents
+    std::vector<RelativeNote> mine, his;
+    for (int tref=0; tref<trackRefAmount; tref++)
+    {
+        ASSERT( m_track_refs[tref].getConstTrack() == checkMeasure.m_track_refs[tref].getConstTrack() );
+        
+        getRelativeNotes(m_track_refs[tref], m_first_tick, mine);
+        getRelativeNotes(checkMeasure.m_track_refs[tref], checkMeasure.m_first_tick, his);
+        if (mine != his) return false;
+    }
     return true;
 }
 #endif
@@ -297,96 +291,59 @@ int PrintLayoutMeasure::addTrackReference(const int firstNote, GraphicalTrack* g
 }
     
 // -------------------------------------------------------------------------------------------
-
 #if 0
-bool PrintLayoutMeasure::findConsecutiveRepetition(ptr_vector<PrintLayoutMeasure>& measures, const int measureAmount,
+int PrintLayoutMeasure::getSimilarityClass() const
+{
+    if (m_first_similar_measure != -1) return m_first_similar_measure;
+    if (m_has_notes) return m_measure_id;
+    return -1;
+}
+
+// -------------------------------------------------------------------------------------------
+
+bool PrintLayoutMeasure::findConsecutiveRepetition(const ptr_vector<PrintLayoutMeasure>& measures,
+                                                   const int measureAmount,
                                                    int& firstMeasureThatRepeats /*out*/, int& lastMeasureThatRepeats /*out*/,
-                                                   int& firstMeasureRepeated /*out*/, int& lastMeasureRepeated /*out*/)
+                                                   int& firstMeasureRepeated /*out*/, int& lastMeasureRepeated /*out*/) const
 {
+    if (m_first_similar_measure == -1) return false;
+    
+    // the repeated section can start at the first occurence of this measure, or at any later
+    // occurence that still comes before this measure
+    std::vector<int> candidates;
+    candidates.push_back(m_first_similar_measure);
     
-    // check if it works with first measure occurence of similar measures
-    if (m_measure_id+1<measureAmount and
-        measures[m_measure_id+1].firstSimilarMeasure == measures[m_measure_id].firstSimilarMeasure+1 )
+    const std::vector<int>& later = measures[m_first_similar_measure].m_similar_measures_found_later;
+    const int laterAmount = later.size();
+    for (int n=0; n<laterAmount and later[n] < m_measure_id; n++)
     {
-        int amount = 0;
-        
-        for (int iter=1; iter<measureAmount; iter++)
-        {
-            if (m_measure_id+iter<measureAmount and
-                measures[m_measure_id+iter].firstSimilarMeasure == measures[m_measure_id].firstSimilarMeasure+iter )
-            {
-                amount++;
-            }
-            else
-            {
-                break;
-            }
-        }//next
-        
-        firstMeasureThatRepeats = m_measure_id;
-        lastMeasureThatRepeats  = m_measure_id + amount;
-        firstMeasureRepeated    = measures[m_measure_id].firstSimilarMeasure;
-        lastMeasureRepeated     = measures[m_measure_id].firstSimilarMeasure + amount;
-        return true;
+        candidates.push_back(later[n]);
     }
-    // check if it works with a later occurence of a similar measure
-    else
+    
+    const int candidateAmount = candidates.size();
+    for (int c=0; c<candidateAmount; c++)
     {
-        const int first_measure =  measures[m_measure_id].firstSimilarMeasure;
+        const int checkFromMeasure = candidates[c];
         
-        const int similarMeasuresAmount = measures[ first_measure ].similarMeasuresFoundLater.size();
-        for (int laterOccurence=0; laterOccurence<similarMeasuresAmount; laterOccurence++)
+        // measures are identical when they belong to the same similarity class
+        int amount = 0;
+        while (checkFromMeasure + amount < m_measure_id and m_measure_id + amount < measureAmount)
         {
-            const int checkFromMeasure = measures[ first_measure ].similarMeasuresFoundLater[laterOccurence];
-            //std::cout << "        < lvl 2, testing measure " << checkFromMeasure << std::endl;
-            //if (checkFromMeasure+1<id and measures[checkFromMeasure+1].firstSimilarMeasure ==
-            //   measures[checkFromMeasure].firstSimilarMeasure+1 )
-            //{
-            int amount = 0;
-            
-            // check if there is a consecutive repetition with measures from this area
-            
-            for (int iter=0; iter</*id-checkFromMeasure*/measureAmount; iter++)
-            {
-                if (not(checkFromMeasure+iter < m_measure_id and
-                        checkFromMeasure+iter < measureAmount and m_measure_id+iter < measureAmount)) continue;
-                
-                // check if they are identical
-                
-                if ( // they are identical because they both are repetitions of the same one
-                    (measures[checkFromMeasure+iter].firstSimilarMeasure == measures[m_measure_id+iter].firstSimilarMeasure and
-                     measures[checkFromMeasure+iter].firstSimilarMeasure != -1)
-                    or
-                    // they are identical because the second is a repetition of the first
-                    (checkFromMeasure+iter == measures[m_measure_id+iter].firstSimilarMeasure)
-                    )
-                {
-                    //std::cout << "            //" << (checkFromMeasure+iter+1) << " is same as " << (id+iter+1) << std::endl;
-                    amount++;
-                }
-                else
-                {
-                    //std::cout << "            //but " << (checkFromMeasure+iter+1) << " is NOT same as " << (id+iter+1) << " (" << measures[checkFromMeasure+iter].firstSimilarMeasure+1 << " != " << measures[id+iter].firstSimilarMeasure+1 << ")" << std::endl;
-                    break;
-                }
-            }//next
-             //std::cout << "        > amount=" << amount << std::endl;
-            
-            if (amount < getRepetitionMinimalLength()) continue;
-            //std::cout << "measure " << id+1  << " is a level 2 repetition" << std::endl;
-            
-            firstMeasureThatRepeats = m_measure_id;
-            lastMeasureThatRepeats  = m_measure_id + amount-1;
-            firstMeasureRepeated    = checkFromMeasure;
-            lastMeasureRepeated     = checkFromMeasure + amount-1;
-            return true;
-            
-            //}
-        }//next
+            const int checkClass = measures[checkFromMeasure + amount].getSimilarityClass();
+            if (checkClass == -1 or checkClass != measures[m_measure_id + amount].getSimilarityClass()) break;
+            amount++;
+        }
+        
+        if (amount < getRepetitionMinimalLength()) continue;
         
-        // if we get there, it never works
-        return false;
+        firstMeasureThatRepeats = m_measure_id;
+        lastMeasureThatRepeats  = m_measure_id + amount - 1;
+        firstMeasureRepeated    = checkFromMeasure;
+        lastMeasureRepeated     = checkFromMeasure + amount - 1;
+        return true;
     }
+    
+    return false;
 }
 #endif
     
@@ -22,6 +22,8 @@
 #include "Printing/SymbolPrinter/PrintLayout/RelativePlacementManager.h"
 #include "ptr_vector.h"
 
+#include <vector>
+
 namespace AriaMaestosa
 {
     class PrintLayoutMeasure;
@@ -82,6 +84,20 @@ namespace AriaMaestosa
         
         Sequence* m_sequence;
         
+#if 0
+        /** whether any track has a note that starts in this measure; set by 'calculateContentHash' */
+        bool m_has_notes;
+        
+        /** hash of the notes of all tracks, relative to the start of the measure */
+        unsigned int m_content_hash;
+        
+        /** earlier measure this one is identical to, or -1 */
+        int m_first_similar_measure;
+        
+        /** later measures that are identical to this one (only filled for first occurences) */
+        std::vector<int> m_similar_measures_found_later;
+#endif
+        
     public:
         
         PrintLayoutMeasure(const int measID, Sequence* seq);
@@ -95,6 +111,45 @@ namespace AriaMaestosa
           */
         int  addTrackReference(const int firstNote, GraphicalTrack* track);
         
+#if 0
+        /** Computes the content hash; call once all track references were added */
+        void calculateContentHash();
+        
+        unsigned int getContentHash() const { return m_content_hash; }
+        bool         hasNotes      () const { return m_has_notes;    }
+        
+        /**
+          * @return whether both measures contain the same notes, at the same positions within the measure
+          *         (empty measures are never considered the same)
+          * @pre    'calculateContentHash' was called on both measures
+          */
+        bool calculateIfMeasureIsSameAs(const PrintLayoutMeasure& checkMeasure) const;
+        
+        int  getFirstSimilarMeasure() const { return m_first_similar_measure; }
+        
+        /** @brief Records that this measure repeats 'measure', and that 'measure' is repeated by this one */
+        void setFirstSimilarMeasure(PrintLayoutMeasure& measure)
+        {
+            m_first_similar_measure = measure.m_measure_id;
+            measure.m_similar_measures_found_later.push_back(m_measure_id);
+        }
+        
+        /**
+          * @return the ID of the first measure identical to this one (possibly this one), or -1 for
+          *         measures that have no notes
+          */
+        int  getSimilarityClass() const;
+        
+        /**
+          * @brief Finds if this measure starts a section (of at least 'getRepetitionMinimalLength' measures)
+          *        that repeats an earlier section
+          * @pre   similar measures were found (see PrintLayoutAbstract::findSimilarMeasures)
+          */
+        bool findConsecutiveRepetition(const ptr_vector<PrintLayoutMeasure>& measures, const int measureAmount,
+                                       int& firstMeasureThatRepeats /*out*/, int& lastMeasureThatRepeats /*out*/,
+                                       int& firstMeasureRepeated /*out*/, int& lastMeasureRepeated /*out*/) const;
+#endif
+        
         int  getFirstTick     () const { return m_first_tick;             }
         int  getLastTick      () const { return m_last_tick;              }
 
@@ -27,6 +27,8 @@
 #include "Printing/RenderRoutines.h"
 #include "Printing/SymbolPrinter/EditorPrintable.h"
 
+#include <wx/stopwatch.h>
+
 #if 0
 #pragma mark Private
 #endif
@@ -39,176 +41,128 @@ const int SIDE_MARGIN_WIDTH = 60;
 
 // ----------------------------------------------------------------------------------------------------------------
 
-int RelativePlacementManager::getInterestingTick(const int tick, const int id_from, const int id_to)
+void RelativePlacementManager::buildInterestingTicks()
 {
-    if (id_to < id_from)
-    {
-        m_all_interesting_ticks.insert( m_all_interesting_ticks.begin()+id_from, InterestingTick(tick) );
-        return id_from;
-    }
-    else
+    // stable, so that symbols on the same tick keep the order they were added in
+    std::stable_sort(m_symbols.begin(), m_symbols.end());
+    
+    m_all_interesting_ticks.clear();
+    
+    const int symbolAmount = m_symbols.size();
+    for (int n=0; n<symbolAmount; n++)
     {
-        // perform binary search to find the interesting tick (or to find where to insert it, if it doesn't exist)
-        const int pivot_id = (id_from + id_to)/2;
-        const int pivot_tick = m_all_interesting_ticks[pivot_id].m_tick;
-        
-        if (tick == pivot_tick)
-        {
-            return pivot_id;
-        }
-        else if (tick < pivot_tick)
-        {
-            return getInterestingTick(tick, id_from, pivot_id - 1);
-        }
-        else //if (tick > pivot_tick) // [implicit]
+        if (m_all_interesting_ticks.empty() or m_all_interesting_ticks.back().m_tick != m_symbols[n].m_tick)
         {
-            return getInterestingTick(tick, pivot_id + 1, id_to);
+            m_all_interesting_ticks.push_back( InterestingTick(m_symbols[n].m_tick, n) );
         }
+        m_all_interesting_ticks.back().m_symbol_count++;
     }
 }
 
 // ----------------------------------------------------------------------------------------------------------------
 
-int RelativePlacementManager::getInterestingTickNoAdd(const int tick, const int id_from, const int id_to) const
+int RelativePlacementManager::findInterestingTick(const int tick) const
 {
-    if (id_to < id_from)
-    {
-        return -1;
-    }
-    else
-    {
-        // perform binary search to find the interesting tick
-        const int pivot_id = (id_from + id_to)/2;
-        const int pivot_tick = m_all_interesting_ticks[pivot_id].m_tick;
-        
-        if (tick == pivot_tick)
-        {
-            return pivot_id;
-        }
-        else if (tick < pivot_tick)
-        {
-            return getInterestingTickNoAdd(tick, id_from, pivot_id - 1);
-        }
-        else //if (tick > pivot_tick) // [implicit]
-        {
-            return getInterestingTickNoAdd(tick, pivot_id + 1, id_to);
-        }
-    }
+    std::vector<InterestingTick>::const_iterator it = std::lower_bound(m_all_interesting_ticks.begin(),
+                                                                       m_all_interesting_ticks.end(), tick);
+    if (it == m_all_interesting_ticks.end() or it->m_tick != tick) return -1;
+    return it - m_all_interesting_ticks.begin();
 }
 
 #ifndef NDEBUG
 UNIT_TEST( TestAddingAndFindingInterestingTicks )
 {
-    //throw std::logic_error("C'est normal que ça échoue!!");
     RelativePlacementManager testObj(20);
     
     require( testObj.m_all_interesting_ticks.size() == 0, "RelativePlacementManager is initially empty" );
     
-    // ---- add 15
-    int id_added = testObj.getInterestingTick( 15, 0, testObj.m_all_interesting_ticks.size()-1 );
-    
-    // __print__
-    //for (int n=0; n<test.m_all_interesting_ticks.size(); n++) std::cout << test.m_all_interesting_ticks[n].tick << "  ";
-    //std::cout << "\n";
-    // _________
-    
-    require( testObj.m_all_interesting_ticks.size() == 1, "An element was added when we wanted to obtained it and it wasn't already there" );
-    require( id_added == 0, "The returned ID is correct for the first added item" );
-    require( testObj.m_all_interesting_ticks[0].m_tick == 15, "First added item was correctly added" );
-    
-    int id_obtained = testObj.getInterestingTick( 15, 0, testObj.m_all_interesting_ticks.size()-1 );
-    
-    // __print__
-    //for (int n=0; n<test.m_all_interesting_ticks.size(); n++) std::cout << test.m_all_interesting_ticks[n].tick << "  ";
-    //std::cout << "\n";
-    // _________
-    
-    require( testObj.m_all_interesting_ticks.size() == 1, "No element was added when we wanted to obtained one that already exists" );
-    require( id_obtained == 0, "The returned ID is correct for searching a single item" );
-    
-    // ---- add 17
-    id_added = testObj.getInterestingTick( 17, 0, testObj.m_all_interesting_ticks.size()-1 );
-    
-    // __print__
-    //for (int n=0; n<test.m_all_interesting_ticks.size(); n++) std::cout << test.m_all_interesting_ticks[n].tick << "  ";
-    //std::cout << "\n";
-    // _________
-    
-    require( testObj.m_all_interesting_ticks.size() == 2, "An second element was added when we wanted to obtained it and it wasn't already there" );
-    require( id_added == 1, "The returned ID is correct for the second added item" );
-    require( testObj.m_all_interesting_ticks[1].m_tick == 17, "Second added item was correctly added" );
-    
-    id_obtained = testObj.getInterestingTick( 15, 0, testObj.m_all_interesting_ticks.size()-1 );
-    require( testObj.m_all_interesting_ticks.size() == 2, "No element was added when we wanted to obtained one that already exists" );
-    require( id_obtained == 0, "The returned ID is correct for searching a single item" );
-    
-    id_obtained = testObj.getInterestingTick( 17, 0, testObj.m_all_interesting_ticks.size()-1 );
-    require( testObj.m_all_interesting_ticks.size() == 2, "No element was added when we wanted to obtained one that already exists" );
-    require( id_obtained == 1, "The returned ID is correct for searching a single item" );
-    
-    // ---- add 13
-    id_added = testObj.getInterestingTick( 13, 0, testObj.m_all_interesting_ticks.size()-1 );
-    
-    // __print__
-    //for (int n=0; n<test.m_all_interesting_ticks.size(); n++) std::cout << test.m_all_interesting_ticks[n].tick << "  ";
-    //std::cout << "\n";
-    // _________
-    
-    require( testObj.m_all_interesting_ticks.size() == 3, "A third element was added when we wanted to obtained it and it wasn't already there" );
-    require( id_added == 0, "The returned ID is correct for the third added item" );
-    require( testObj.m_all_interesting_ticks[0].m_tick == 13, "third added item was correctly added" );
-    
-    // ---- add 14
-    id_added = testObj.getInterestingTick( 14, 0, testObj.m_all_interesting_ticks.size()-1 );
-    
-    // __print__
-    //for (int n=0; n<test.m_all_interesting_ticks.size(); n++) std::cout << test.m_all_interesting_ticks[n].tick << "  ";
-    //std::cout << "\n";
-    // _________
-    
-    require( testObj.m_all_interesting_ticks.size() == 4, "A fourth element was added when we wanted to obtained it and it wasn't already there" );
-    require( id_added == 1, "The returned ID is correct for the fourth added item" );
-    require( testObj.m_all_interesting_ticks[0].m_tick == 13, "fourth added item was correctly added" );
-    require( testObj.m_all_interesting_ticks[1].m_tick == 14, "fourth added item was correctly added" );
-    require( testObj.m_all_interesting_ticks[2].m_tick == 15, "fourth added item was correctly added" );
-    require( testObj.m_all_interesting_ticks[3].m_tick == 17, "fourth added item was correctly added" );
+    // add symbols out of order, some on the same tick
+    testObj.addSymbol(15, 16, 100, 0);
+    testObj.addSymbol(17, 18, 100, 0);
+    testObj.addSymbol(15, 17, 120, 1);
+    testObj.addSymbol(13, 14, 100, 0);
+    testObj.addSymbol(14, 15, 100, 0);
+    testObj.addSymbol(16, 17, 100, 1);
+    
+    require( testObj.m_symbols.size() == 6, "All symbols were added" );
+    
+    testObj.buildInterestingTicks();
+    
+    require( testObj.m_all_interesting_ticks.size() == 5, "One interesting tick was created per distinct tick" );
+    require( testObj.m_all_interesting_ticks[0].m_tick == 13, "Interesting ticks are ordered" );
+    require( testObj.m_all_interesting_ticks[1].m_tick == 14, "Interesting ticks are ordered" );
+    require( testObj.m_all_interesting_ticks[2].m_tick == 15, "Interesting ticks are ordered" );
+    require( testObj.m_all_interesting_ticks[3].m_tick == 16, "Interesting ticks are ordered" );
+    require( testObj.m_all_interesting_ticks[4].m_tick == 17, "Interesting ticks are ordered" );
+    
+    const RelativePlacementManager::InterestingTick& tick15 = testObj.m_all_interesting_ticks[2];
+    require( tick15.m_symbol_count == 2, "Symbols on the same tick were coalesced" );
+    require( testObj.m_symbols[tick15.m_first_symbol].m_track_ID == 0, "Symbols on the same tick keep their order" );
+    require( testObj.m_symbols[tick15.m_first_symbol + 1].m_track_ID == 1, "Symbols on the same tick keep their order" );
+    
+    require( testObj.findInterestingTick(13) == 0, "The returned ID is correct" );
+    require( testObj.findInterestingTick(16) == 3, "The returned ID is correct" );
+    require( testObj.findInterestingTick(17) == 4, "The returned ID is correct" );
+    require( testObj.findInterestingTick(12) == -1, "Ticks without symbols are not found" );
+    require( testObj.findInterestingTick(18) == -1, "Ticks without symbols are not found" );
+    
+    // building again must not duplicate anything
+    testObj.buildInterestingTicks();
+    require( testObj.m_all_interesting_ticks.size() == 5, "Building interesting ticks twice gives the same result" );
+    require( testObj.m_all_interesting_ticks[2].m_symbol_count == 2, "Building interesting ticks twice gives the same result" );
+}
 
-    // ---- add 16
-    id_added = testObj.getInterestingTick( 16, 0, testObj.m_all_interesting_ticks.size()-1 );
+UNIT_TEST( BenchmarkRelativePlacement )
+{
+    // what the layout pass does for a long score : one manager per measure, filled track by track
+    const int MEASURE_COUNT   = 2000;
+    const int TRACK_COUNT     = 8;
+    const int STEPS           = 16;
+    const int TICKS_PER_STEP  = 240;
+    const int MEASURE_LENGTH  = STEPS*TICKS_PER_STEP;
     
-    // __print__
-    //for (int n=0; n<test.m_all_interesting_ticks.size(); n++) std::cout << test.m_all_interesting_ticks[n].tick << "  ";
-    //std::cout << "\n";
-    // _________
+    wxStopWatch timer;
+    int symbolCount = 0;
     
-    require( testObj.m_all_interesting_ticks.size() == 5, "A fifth element was added when we wanted to obtained it and it wasn't already there" );
-    require( id_added == 3, "The returned ID is correct for the fifth added item" );
-    require( testObj.m_all_interesting_ticks[0].m_tick == 13, "fifth added item was correctly added" );
-    require( testObj.m_all_interesting_ticks[1].m_tick == 14, "fifth added item was correctly added" );
-    require( testObj.m_all_interesting_ticks[2].m_tick == 15, "fifth added item was correctly added" );
-    require( testObj.m_all_interesting_ticks[3].m_tick == 16, "fifth added item was correctly added" );
-    require( testObj.m_all_interesting_ticks[4].m_tick == 17, "fifth added item was correctly added" );
-
+    for (int measure=0; measure<MEASURE_COUNT; measure++)
+    {
+        RelativePlacementManager testObj(MEASURE_LENGTH);
+        for (int track=0; track<TRACK_COUNT; track++)
+        {
+            // each track has its own rhythm (1/16th, 1/8th, 1/4th, ...)
+            const int step = TICKS_PER_STEP << (track % 4);
+            for (int tick=0; tick<MEASURE_LENGTH; tick += step)
+            {
+                testObj.addSymbol(tick, tick + step, 100, track);
+                symbolCount++;
+            }
+        }
+        testObj.calculateRelativePlacement();
+        
+        require( testObj.getWidth() > 0, "The measure was given a width" );
+        require( (int)testObj.m_all_interesting_ticks.size() == STEPS, "One interesting tick per distinct tick" );
+        for (int n=1; n<STEPS; n++)
+        {
+            require( testObj.m_all_interesting_ticks[n].m_position >= testObj.m_all_interesting_ticks[n-1].m_end_position,
+                     "Symbols don't overlap" );
+        }
+    }
+    
+    std::cout << "[BenchmarkRelativePlacement] " << MEASURE_COUNT << " measures (" << symbolCount
+              << " symbols) laid out in " << timer.Time() << " ms\n";
 }
 #endif
 
 // ----------------------------------------------------------------------------------------------------------------
 
-int RelativePlacementManager::getNextTick(const int fromTick)
+int RelativePlacementManager::getNextTick(const int interestingTickID) const
 {
-    const int tickAmount = m_all_interesting_ticks.size();
-    for (int n=0; n<tickAmount; n++)
+    if (interestingTickID + 1 < (int)m_all_interesting_ticks.size())
     {
-        // Assert that it's sorted
-        ASSERT(n == 0 or m_all_interesting_ticks[n].m_tick >= m_all_interesting_ticks[n-1].m_tick);
-        
-        if (m_all_interesting_ticks[n].m_tick > fromTick)
-        {
-            return m_all_interesting_ticks[n].m_tick;
-        }
+        return m_all_interesting_ticks[interestingTickID + 1].m_tick;
     }
     
-    // No other symbol found in this measure, in this track. Return the end
+    // No other symbol found in this measure. Return the end
     return m_end_of_measure_tick;
 }
 
@@ -246,26 +200,21 @@ UNIT_TEST( TestFindingNextTick )
     //  \             ø============  /
      
     // add 1
-    testObj.getInterestingTick( 1, 0, testObj.m_all_interesting_ticks.size()-1 );
     testObj.addSymbol(1 /* from */, 3 /* to */, 1 /* symbol size */, 0 /* track ID */);
     testObj.addSymbol(1 /* from */, 5 /* to */, 1 /* symbol size */, 1 /* track ID */);
     
     // add 3
-    testObj.getInterestingTick( 3, 0, testObj.m_all_interesting_ticks.size()-1 );
     testObj.addSymbol(3 /* from */, 5 /* to */, 1 /* symbol size */, 0 /* track ID */);
     testObj.addSymbol(3 /* from */, 5 /* to */, 1 /* symbol size */, 0 /* track ID */);
 
     // add 5
-    testObj.getInterestingTick( 5, 0, testObj.m_all_interesting_ticks.size()-1 );
     testObj.addSymbol(5 /* from */, 7 /* to */, 1 /* symbol size */, 0 /* track ID */);
     testObj.addSymbol(5 /* from */, 9 /* to */, 1 /* symbol size */, 1 /* track ID */);
 
     // add 7
-    testObj.getInterestingTick( 7, 0, testObj.m_all_interesting_ticks.size()-1 );
     testObj.addSymbol(7 /* from */, 9 /* to */, 1 /* symbol size */, 0 /* track ID */);
 
     // add 9
-    testObj.getInterestingTick( 9, 0, testObj.m_all_interesting_ticks.size()-1 );
     
     // ---- perform tests in track 0
     int next_tick = testObj.getNextTickInTrack(1 /* from */, 0 /* track ID */);
@@ -295,28 +244,21 @@ int RelativePlacementManager::findShortestSymbolLength() const
 {
     int shortest = -1;
     
-    const int tickAmount = m_all_interesting_ticks.size();
-
-    for (int n=0; n<tickAmount; n++)
+    const int symbolAmount = m_symbols.size();
+    for (int sym=0; sym<symbolAmount; sym++)
     {
-        const InterestingTick& currTick = m_all_interesting_ticks[n];
+        const Symbol& currSym = m_symbols[sym];
+        const int newAttempt = currSym.m_end_tick - currSym.m_tick;
         
-        const int symbolAmount = currTick.m_all_symbols_on_that_tick.size();
-        for (int sym=0; sym<symbolAmount; sym++)
+        if (newAttempt <= 0)
         {
-            const Symbol& currSym = currTick.m_all_symbols_on_that_tick[sym];
-            const int newAttempt = currSym.m_end_tick - currTick.m_tick;
-            
-            if (newAttempt <= 0)
-            {
-                std::cerr << "Warning, RelativePlacementManager::findShortestSymbolLength() found a note of length " << newAttempt << ", that's kinda weird!\n"; 
-                continue;
-            }
-            
-            if (newAttempt < shortest or shortest == -1)
-            {
-                shortest = newAttempt;
-            }
+            std::cerr << "Warning, RelativePlacementManager::findShortestSymbolLength() found a note of length " << newAttempt << ", that's kinda weird!\n"; 
+            continue;
+        }
+        
+        if (newAttempt < shortest or shortest == -1)
+        {
+            shortest = newAttempt;
         }
     }
     
@@ -342,13 +284,7 @@ void RelativePlacementManager::addSymbol(int tickFrom, int tickTo, int symbolWid
     ASSERT_E(tickFrom, <=, tickTo);
     //ASSERT (tickTo <= m_end_of_measure_tick);
     
-    const int interestingTickID = getInterestingTick( tickFrom, 0, m_all_interesting_ticks.size()-1 );
-    ASSERT_E( interestingTickID, >=, 0 );
-    ASSERT_E( interestingTickID, <, (int)m_all_interesting_ticks.size() );
-    ASSERT_E( m_all_interesting_ticks[interestingTickID].m_tick, ==, tickFrom );
-    
-    m_all_interesting_ticks[interestingTickID].m_all_symbols_on_that_tick.push_back(
-                        Symbol(tickTo, symbolWidth, trackID) );
+    m_symbols.push_back( Symbol(tickFrom, tickTo, symbolWidth, trackID) );
 }
 
 // ----------------------------------------------------------------------------------------------------------------
@@ -417,6 +353,8 @@ void RelativePlacementManager::calculateRelativePlacement()
     //  Track 1 |ø===|ø===|ø===|ø===|   But  |ø=======|ø===|ø===|  (first note must be larger, since its extra
     //  Track 2 |ø===|====|====|====|        |ø=======|ø========|   space is not granted by the other track)
         
+    buildInterestingTicks();
+    
     const int tickAmount = m_all_interesting_ticks.size();
 
     if (tickAmount == 0) return;
@@ -437,20 +375,19 @@ void RelativePlacementManager::calculateRelativePlacement()
         int spaceNeededToFitAllSymbols = 0;
         int spaceNeededAfterSymbolForProportions = 0;
         
-        const int symbolAmount = currTick.m_all_symbols_on_that_tick.size();
+        const int symbolAmount = currTick.m_symbol_count;
         ASSERT_E(symbolAmount, >, 0);
         
+        const int nextTickInAnyTrack = getNextTick(n);
+        
 #if RPM_CHATTY
         std::cout << "    {\n";
 #endif
         for (int sym=0; sym<symbolAmount; sym++)
         {
-            Symbol& currSym = currTick.m_all_symbols_on_that_tick[sym];
+            Symbol& currSym = m_symbols[currTick.m_first_symbol + sym];
             
             currSym.fromUnit = n;
-            
-            //const int nextTickInTrack = getNextTickInTrack(currTick.tick, currSym.trackID);
-            const int nextTickInAnyTrack = getNextTick(currTick.m_tick);
 
             // 2 cases : either the needed space for this symbol is implicitely granted by symbols
             // on other lines (see above), either it's not
@@ -579,7 +516,7 @@ void RelativePlacementManager::calculateRelativePlacement()
 
 Range<float> RelativePlacementManager::getSymbolRelativeArea(int tick) const
 {    
-    int id = getInterestingTickNoAdd( tick, 0, m_all_interesting_ticks.size()-1 );
+    int id = findInterestingTick( tick );
     
     if (id == -1)
     {
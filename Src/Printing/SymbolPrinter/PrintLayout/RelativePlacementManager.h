@@ -25,6 +25,7 @@
 // For unit tests
 utest TestAddingAndFindingInterestingTicks;
 utest TestFindingNextTick;
+utest BenchmarkRelativePlacement;
 
 namespace AriaMaestosa
 {
@@ -38,6 +39,7 @@ class RelativePlacementManager
     // For unit tests
     friend utest ::TestAddingAndFindingInterestingTicks;
     friend utest ::TestFindingNextTick;
+    friend utest ::BenchmarkRelativePlacement;
     
     /** Last tick of the measure (A RelativePlacementManager object represents a single measure) */
     int m_end_of_measure_tick;
@@ -46,6 +48,7 @@ class RelativePlacementManager
     
     struct Symbol
     {
+        int m_tick;
         int m_width_in_print_units;
         int m_track_ID;
         int m_end_tick;
@@ -55,8 +58,9 @@ class RelativePlacementManager
         int fromUnit;
         float neededAdditionalProportion;
         
-        Symbol (const int tick_to, const int widthInPrintUnits, const int trackID)
+        Symbol (const int tick_from, const int tick_to, const int widthInPrintUnits, const int trackID)
         {
+            m_tick = tick_from;
             m_end_tick = tick_to;
             m_width_in_print_units = widthInPrintUnits;
             m_track_ID = trackID;
@@ -65,12 +69,20 @@ class RelativePlacementManager
             fromUnit = -1;
             neededAdditionalProportion = -1;
         }
+        
+        bool operator<(const Symbol& other) const { return m_tick < other.m_tick; }
     };
     
+    /** All symbols of the measure, in the order they were added until 'buildInterestingTicks' sorts them */
+    std::vector<Symbol> m_symbols;
+    
     struct InterestingTick
     {
         int m_tick;
-        std::vector<Symbol> m_all_symbols_on_that_tick;
+        
+        /** the symbols on that tick are m_symbols[m_first_symbol] to m_symbols[m_first_symbol + m_symbol_count - 1] */
+        int m_first_symbol;
+        int m_symbol_count;
         
         /** unset intially, is set later during calculations.
           * represents the total proportion this unit needs to receive */
@@ -82,47 +94,35 @@ class RelativePlacementManager
         
         float m_end_position;
         
-        InterestingTick (const int tick)
+        InterestingTick (const int tick, const int firstSymbol)
         {
-            m_tick = tick;
+            m_tick         = tick;
+            m_first_symbol = firstSymbol;
+            m_symbol_count = 0;
         }
         
-        /** Returns whether this object contains a symbol on the given track */
-        bool hasSymbolInTrack(const int trackID)
-        {
-            const int sym_amount = m_all_symbols_on_that_tick.size();
-            for (int n=0; n<sym_amount; n++)
-            {
-                if (m_all_symbols_on_that_tick[n].m_track_ID == trackID) return true;
-            }
-            return false;
-        }
+        bool operator<(const int tick) const { return m_tick < tick; }
     };
     
+    /** Built from 'm_symbols' by 'buildInterestingTicks', ordered by tick */
     std::vector<InterestingTick> m_all_interesting_ticks;
     
     /**
-      * @param tick     The midi tick for which we want to find the associated 'InterestingTick' object
-      * @param id_from  ID of the element of the 'm_all_interesting_ticks' vector at which to start searching
-      * @param id_to    ID of the element of the 'm_all_interesting_ticks' vector at which to search ends
+      * @brief Sorts the symbols by tick, and creates one 'InterestingTick' per distinct tick
       *
-      * @postcondition  If no 'InterestingTick' object exists for that tick, one is created. The vector remains ordered.
-      *
-      * @return         The id of the associated interesting tick
+      * Adding symbols only appends them, so that building a measure is O(n log n) in total
+      * instead of inserting ticks in the middle of a vector for each symbol.
       */
-    int getInterestingTick(const int tick, const int id_from, const int id_to);
+    void buildInterestingTicks();
     
     /**
      * @param tick     The midi tick for which we want to find the associated 'InterestingTick' object
-     * @param id_from  ID of the element of the 'm_all_interesting_ticks' vector at which to start searching
-     * @param id_to    ID of the element of the 'm_all_interesting_ticks' vector at which to search ends
      *
-     * precondition    All interesting ticks must have been created prior to call this, as this variant will
-     *                 NOT insert a new tick of none exists yet.
+     * precondition    'buildInterestingTicks' must have been called.
      *
      * @return         The id of the associated interesting tick, or -1 if none
      */
-    int getInterestingTickNoAdd(const int tick, const int id_from, const int id_to) const;
+    int findInterestingTick(const int tick) const;
 
     /**
       * @return          Length (in ticks) of the shortest symbol in this measure
@@ -130,18 +130,11 @@ class RelativePlacementManager
     int findShortestSymbolLength() const;
     
     /**
-     * Finds the start tick of the next symbol, in any track, starting from a base tick
+     * Finds the start tick of the next symbol, in any track, after the given interesting tick
      *
      * @return  The tick of this symbol, if found, the last tick of the measure otherwise
      */
-    int getNextTick(const int from_tick);
-    
-    /**
-      * Finds the start tick of the next symbol in a given track, starting from a base tick
-      *
-      * @return  The tick of this symbol, if found, the last tick of the measure otherwise
-      */
-    //int getNextTickInTrack(const int from_tick, const int trackID);
+    int getNextTick(const int interestingTickID) const;
     
 public:
     
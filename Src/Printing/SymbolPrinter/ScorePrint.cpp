@@ -312,19 +312,16 @@ namespace AriaMaestosa
     
     // -------------------------------------------------------------------------------------------------------
 
-    // leave a pointer to the dc for the callback
-    // FIXME: find cleaner way than globals
-    wxDC* global_dc = NULL;
-    
+    /** What the renderSilence callback draws with; one per call, so that lines can be drawn concurrently */
+    struct SilenceRenderContext
+    {
+        PrintXConverter* m_converter;
+        wxDC* m_dc;
 #if wxCHECK_VERSION(2,9,1) && wxUSE_GRAPHICS_CONTEXT
-    wxGraphicsContext* gc = NULL;
+        wxGraphicsContext* m_gc;
 #endif
-    
-    ScorePrintable* g_printable = NULL;
-    
-    // leave height of lines for the renderSilence callback
-    // FIXME: find cleaner way than globals
-    int g_line_height=5;
+        int m_line_height;
+    };
     
     // -------------------------------------------------------------------------------------------------------
     
@@ -332,23 +329,22 @@ namespace AriaMaestosa
                                const int silences_y, const bool triplet, const bool dotted,
                                const int dot_delta_x, const int dot_delta_y, void* userdata)
     {
-        ASSERT( global_dc != NULL);
-        
-        PrintXConverter* converter = (PrintXConverter*)userdata;
+        SilenceRenderContext* context = (SilenceRenderContext*)userdata;
+        ASSERT( context->m_dc != NULL);
         
-        const Range<int> x = converter->tickToX(tick);
+        const Range<int> x = context->m_converter->tickToX(tick);
         
         // silences in gathered rests, for instance, will not be found by tickToX
         if (x.from < 0 or x.to < 0) return;
         
-        //global_dc->SetPen(*wxRED_PEN);
-        //global_dc->SetBrush(*wxTRANSPARENT_BRUSH);
-        //global_dc->DrawRectangle(x.from, silences_y-20, x.to - x.from, 420);
+        //context->m_dc->SetPen(*wxRED_PEN);
+        //context->m_dc->SetBrush(*wxTRANSPARENT_BRUSH);
+        //context->m_dc->DrawRectangle(x.from, silences_y-20, x.to - x.from, 420);
         
 #if wxCHECK_VERSION(2,9,1) && wxUSE_GRAPHICS_CONTEXT
-        RenderRoutines::drawSilence(*gc, x, silences_y, g_line_height, type, triplet, dotted);
+        RenderRoutines::drawSilence(*context->m_gc, x, silences_y, context->m_line_height, type, triplet, dotted);
 #else
-        RenderRoutines::drawSilence(global_dc, x, silences_y, g_line_height, type, triplet, dotted);
+        RenderRoutines::drawSilence(context->m_dc, x, silences_y, context->m_line_height, type, triplet, dotted);
 #endif
     }
     
@@ -361,9 +357,6 @@ namespace AriaMaestosa
     
     ScorePrintable::ScorePrintable(Track* track) : EditorPrintable(track)
     {
-        // std::cout << " *** setting global g_printable" << std::endl;
-        g_printable = this;
-        
         m_g_clef_y_from        = -1;
         m_g_clef_y_to          = -1;
         m_f_clef_y_from        = -1;
@@ -440,14 +433,10 @@ namespace AriaMaestosa
                   << measureFromTick << ", to " << measureToTick << "\n{\n";
 #endif
         
-        GraphicalTrack* gtrack = trackRef.getTrack();
-        ScoreEditor* scoreEditor = gtrack->getScoreEditor();
+        ASSERT(trackRef.getTrack()->getTrack() == m_track);
         
-        ASSERT(gtrack->getTrack() == m_track);
-        
-        ScoreMidiConverter* converter = scoreEditor->getScoreMidiConverter();
-        converter->updateConversionData();
-        converter->resetAccidentalsForNewRender();
+        // this may be called for many measures at once from worker threads; it must only read the
+        // analysers, which were filled (and put in time order) by 'earlySetup'
         
         // ---- notes
         for (int clef=0; clef<2; clef++)
@@ -471,24 +460,12 @@ namespace AriaMaestosa
             ASSERT( current_analyser != NULL );
             
             const int noteAmount = current_analyser->m_note_render_info.size();
-                        
-            // find shortest note
-            int shortest = -1;
-            for (int n=0; n<noteAmount; n++)
-            {
-                const int tick = current_analyser->m_note_render_info[n].getTick();
-                if (tick < measureFromTick or tick >= measureToTick) continue;
-                
-                if (current_analyser->m_note_render_info[n].getTickLength() < shortest or shortest == -1)
-                {
-                    shortest = current_analyser->m_note_render_info[n].getTickLength();
-                }
-            }
+            const int firstNote  = current_analyser->findFirstNoteFrom(measureFromTick);
             
-            for (int n=0; n<noteAmount; n++)
+            for (int n=firstNote; n<noteAmount; n++)
             {
                 const int tick = current_analyser->m_note_render_info[n].getTick();
-                if (tick < measureFromTick or tick >= measureToTick) continue;
+                if (tick >= measureToTick) break;
                 
                 const int tickTo = tick + current_analyser->m_note_render_info[n].getTickLength();
                 ASSERT_E(tick, <=, tickTo);
@@ -667,7 +644,6 @@ namespace AriaMaestosa
         ScoreData* scoreData = dynamic_cast<ScoreData*>(currentTrack.editor_data.raw_ptr);
         
         calculateVerticalMeasurements(trackCoords, scoreData);
-        g_printable = this;
         
         // draw track name
         int score_area_from_y = (m_g_clef ? m_g_clef_y_from : m_f_clef_y_from);
@@ -841,18 +817,16 @@ namespace AriaMaestosa
             if (n == 0 and not m_g_clef) continue;
             if (n == 1 and not m_f_clef) continue;
             
-            // analyse notes. this analysis will be used to determine is some things go out of the track
-            // verticall, and will be thrown away after [FIXME] (it will be analysed again when it's time to render)
+            // use the analysed notes to determine is some things go out of the track verticall
             ScoreAnalyser* analyser = NULL;
-            if      (n == 0) analyser = g_clef_analyser;
-            else if (n == 1) analyser = f_clef_analyser;
+            if      (n == 0) analyser = m_g_clef_analysed;
+            else if (n == 1) analyser = m_f_clef_analysed;
             else             ASSERT(false);
             
             ASSERT(analyser != NULL);
 
             OwnerPtr<ScoreAnalyser> lineAnalyser;
             lineAnalyser = analyser->getSubset(fromTick, toTick);
-            lineAnalyser->analyseNoteInfo();
             
             const int noteAmount = lineAnalyser->m_note_render_info.size();
             for (int i=0; i<noteAmount; i++)
@@ -1181,6 +1155,22 @@ namespace AriaMaestosa
             m_silences_ticks.insert(m_silences_ticks.end(), g_clef_silences.begin(), g_clef_silences.end());
         }
         
+        // ---- Analyse the whole track once; lines then only take their subset. Each clef spreads
+        //      its measures over all cores, so there is no need to also run both clefs at once
+        if (LOGGING) std::cout << "[ScorePrintable] early setup : analysing score\n";
+        if (m_g_clef)
+        {
+            m_g_clef_analysed = g_clef_analyser->getEmptyCopy();
+            m_g_clef_analysed->m_note_render_info = g_clef_analyser->m_note_render_info;
+            m_g_clef_analysed->analyseNoteInfoByMeasure();
+        }
+        if (m_f_clef)
+        {
+            m_f_clef_analysed = f_clef_analyser->getEmptyCopy();
+            m_f_clef_analysed->m_note_render_info = f_clef_analyser->m_note_render_info;
+            m_f_clef_analysed->analyseNoteInfoByMeasure();
+        }
+        
         /*
         printf("    %i notes in G clef (analyzer %x), %i in F clef (analyzer %x), this = %x\n",
                (int)g_clef_analyser->m_note_render_info.size(), (unsigned int)(void*)g_clef_analyser,
@@ -1639,20 +1629,19 @@ namespace AriaMaestosa
         OwnerPtr<ScoreAnalyser> lineAnalyser;
         lineAnalyser = analyser.getSubset(fromTick, toTick);
         
-        
-        g_printable = this;
-        
         // ---- render silences
         if (LOGGING) std::cout << "[ScorePrintable] rendering silences\n";
         
         const int first_measure = line.getFirstMeasure();
         const int last_measure  = line.getLastMeasure();
         
-        global_dc = &dc;
-        
+        SilenceRenderContext silenceContext;
+        silenceContext.m_converter   = m_x_converter;
+        silenceContext.m_dc          = &dc;
 #if wxCHECK_VERSION(2,9,1) && wxUSE_GRAPHICS_CONTEXT
-        gc = grctx;
+        silenceContext.m_gc          = grctx;
 #endif
+        silenceContext.m_line_height = m_line_height;
         
         #if wxCHECK_VERSION(2,9,1) && wxUSE_GRAPHICS_CONTEXT
         grctx->PushState();
@@ -1662,16 +1651,14 @@ namespace AriaMaestosa
         if (f_clef)
         {
             const int silences_y = LEVEL_TO_Y(m_middle_c_level + 4);
-            g_line_height = m_line_height;
             SilenceAnalyser::findSilences(track->getSequence(), &renderSilenceCallback, lineAnalyser,
-                                          first_measure, last_measure, silences_y, m_x_converter);
+                                          first_measure, last_measure, silences_y, &silenceContext);
         }
         else
         {
             const int silences_y = LEVEL_TO_Y(m_middle_c_level - 8);
-            g_line_height = m_line_height;
             SilenceAnalyser::findSilences(track->getSequence(), &renderSilenceCallback, lineAnalyser,
-                                          first_measure, last_measure, silences_y, m_x_converter);
+                                          first_measure, last_measure, silences_y, &silenceContext);
         }
         
         #if wxCHECK_VERSION(2,9,1) && wxUSE_GRAPHICS_CONTEXT
@@ -1681,8 +1668,9 @@ namespace AriaMaestosa
         // ------------------ second part : intelligent drawing of the rest -----------------
         if (LOGGING) std::cout << "[ScorePrintable] analyzing score\n";
         
-        // analyse notes to know how to build the score
-        lineAnalyser->analyseNoteInfo();
+        // the notes were analysed in earlySetup; take those of this line
+        const ScoreAnalyser* analysed = (f_clef ? (ScoreAnalyser*)m_f_clef_analysed : (ScoreAnalyser*)m_g_clef_analysed);
+        lineAnalyser = analysed->getSubset(fromTick, toTick);
         
         if (LOGGING) std::cout << "[ScorePrintable] rendering note ornaments\n";
         // now that score was analysed, draw the remaining note bits
@@ -56,6 +56,10 @@ namespace AriaMaestosa
         OwnerPtr<ScoreAnalyser> g_clef_analyser;
         OwnerPtr<ScoreAnalyser> f_clef_analyser;
         
+        /** The notes of 'g_clef_analyser' and 'f_clef_analyser' once analysed, done once for the whole track */
+        OwnerPtr<ScoreAnalyser> m_g_clef_analysed;
+        OwnerPtr<ScoreAnalyser> m_f_clef_analysed;
+        
         std::vector< SilenceAnalyser::SilenceInfo > m_silences_ticks;
         
         PrintXConverter* m_x_converter;
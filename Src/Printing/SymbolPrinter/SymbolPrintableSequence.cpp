@@ -85,10 +85,45 @@ void SymbolPrintableSequence::calculateLayout()
     m_abstract_layout_manager = new PrintLayoutAbstract(this);
     m_abstract_layout_manager->addLayoutInformation(m_tracks, layoutPages /* out */);
     
-    // prepare it for when we're ready to print
+    AbstractPrintableSequence::calculateLayout();
+    
+    // compute coordinates of all pages once, for the area 'AriaPrintable::printPage' will give us;
+    // printing or previewing a page then only draws it
     m_numeric_layout_manager = new PrintLayoutNumeric();
+    m_page_placements.clear();
     
-    AbstractPrintableSequence::calculateLayout();
+    AriaPrintable* printable = AriaPrintable::getCurrentPrintable();
+    const int pageAmount = layoutPages.size();
+    for (int p=0; p<pageAmount; p++)
+    {
+        PagePlacement placement;
+        placement.m_notation_area_y0 = printable->getNotationAreaY0(p + 1, 0);
+        placement.m_notation_area_h  = printable->getUsableAreaHeight(p + 1);
+        placement.m_page_height      = printable->getUnitHeight();
+        placement.m_x0               = 0;
+        placement.m_x1               = printable->getUnitWidth();
+        placePage(p, placement);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------
+
+void SymbolPrintableSequence::placePage(const int pageID, const PagePlacement& placement)
+{
+    if ((int)m_page_placements.size() <= pageID)
+    {
+        PagePlacement unplaced;
+        unplaced.m_notation_area_y0 = -1;
+        unplaced.m_notation_area_h  = -1;
+        unplaced.m_page_height = unplaced.m_x0 = unplaced.m_x1 = -1;
+        m_page_placements.resize(pageID + 1, unplaced);
+    }
+    if (m_page_placements[pageID] == placement) return;
+    
+    m_numeric_layout_manager->placeLinesInPage(getPage(pageID), placement.m_notation_area_y0,
+                                               placement.m_notation_area_h, placement.m_page_height,
+                                               placement.m_x0, placement.m_x1);
+    m_page_placements[pageID] = placement;
 }
 
 // -----------------------------------------------------------------------------------------------------------------
@@ -127,9 +162,14 @@ void SymbolPrintableSequence::printLinesInArea(wxDC& dc, wxGraphicsContext* grct
 
     LayoutPage& page = getPage(pageID);
     
-    // ---- Give each track an area on the page
-    m_numeric_layout_manager->placeLinesInPage(page, notation_area_y0, notation_area_h,
-                                               pageHeight, x0, x1);
+    // ---- Give each track an area on the page (normally already done by 'calculateLayout')
+    PagePlacement placement;
+    placement.m_notation_area_y0 = notation_area_y0;
+    placement.m_notation_area_h  = notation_area_h;
+    placement.m_page_height      = pageHeight;
+    placement.m_x0               = x0;
+    placement.m_x1               = x1;
+    placePage(pageID, placement);
     
     // ---- Draw the tracks
     const wxFont regularFont = getPrintFont();
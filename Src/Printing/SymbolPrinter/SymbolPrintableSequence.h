@@ -51,6 +51,27 @@ namespace AriaMaestosa
         
         void printLine(LayoutLine& line, wxDC& dc, wxGraphicsContext* grctx);
         
+        /** The area each page was last placed in by 'placePage' */
+        struct PagePlacement
+        {
+            float m_notation_area_y0, m_notation_area_h;
+            int   m_page_height, m_x0, m_x1;
+            
+            bool operator==(const PagePlacement& other) const
+            {
+                return m_notation_area_y0 == other.m_notation_area_y0 and
+                       m_notation_area_h  == other.m_notation_area_h  and
+                       m_page_height == other.m_page_height and m_x0 == other.m_x0 and m_x1 == other.m_x1;
+            }
+        };
+        std::vector<PagePlacement> m_page_placements;
+        
+        /**
+          * Gives print coordinates to the lines of a page (see PrintLayoutNumeric), unless they
+          * were already calculated for the same area
+          */
+        void placePage(const int pageID, const PagePlacement& placement);
+        
         /** Whether at least one track with guitar view was added */
         bool m_is_guitar_editor_used;
         
@@ -77,8 +98,9 @@ namespace AriaMaestosa
         SymbolPrintableSequence(Sequence* parent);
         
         /**
-          * @brief Prepare the abstract layout for this sequence.
-          * Divides sequence in pages, decides contents of each line, etc.
+          * @brief Prepare the layout for this sequence.
+          * Divides sequence in pages, decides contents of each line, etc. then gives lines
+          * their print coordinates, so that pages can later be drawn in any order.
           * Must be called before actually printing.
           */
         virtual void calculateLayout();
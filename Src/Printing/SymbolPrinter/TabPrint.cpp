@@ -154,11 +154,11 @@ void TablaturePrintable::addUsedTicks(const PrintLayoutMeasure& measure,  const
         
         // ---- notes
         const int noteAmount = m_analyser->getNoteCount();
-        for (int n=0; n<noteAmount; n++)
+        for (int n=m_analyser->findFirstNoteFrom(firstTickInMeasure); n<noteAmount; n++)
         {
             const int tick   = m_analyser->getStartTick(n);
             
-            if (tick < firstTickInMeasure or tick >= lastTickInMeasure) continue;
+            if (tick >= lastTickInMeasure) break;
             
             const int tickTo = m_analyser->getEndTick(n);
             //const int fret   = m_analyser->getNoteFretConst(n);
@@ -226,6 +226,28 @@ wxPrintData wxEasyPrintWrapper::getPrintData()
 
 // ----------------------------------------------------------------------------------------------------------
 
+wxSize wxEasyPrintWrapper::getPaperSizeMM() const
+{
+    wxSize paperSize = m_page_setup.GetPaperSize();
+    const int large_side = std::max(paperSize.GetWidth(), paperSize.GetHeight());
+    const int small_side = std::min(paperSize.GetWidth(), paperSize.GetHeight());
+    
+    if (m_orient == wxPORTRAIT) return wxSize(small_side, large_side);
+    else                        return wxSize(large_side, small_side);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+wxRect wxEasyPrintWrapper::getMarginsRectMM() const
+{
+    const wxSize paperSize = getPaperSizeMM();
+    return wxRect(m_left_margin, m_top_margin,
+                  paperSize.GetWidth()  - m_left_margin - m_right_margin,
+                  paperSize.GetHeight() - m_top_margin  - m_bottom_margin);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
 PageSetupSummary wxEasyPrintWrapper::getPageSetupSummary() const
 {
     PageSetupSummary out;
@@ -346,6 +368,7 @@ bool wxEasyPrintWrapper::OnPrintPage(int pageNum)
     }
     wxGCDC* gcdc = new wxGCDC(gc);
     m_print_callback->printPage(pageNum, *gcdc, gc, x0, y0, x1, y1);
+    delete gcdc; // also deletes gc
 #else
     m_print_callback->printPage(pageNum, dc, NULL, x0, y0, x1, y1);
 #endif
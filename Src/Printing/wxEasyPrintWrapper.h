@@ -137,6 +137,12 @@ namespace AriaMaestosa
             return m_unit_height;
         }
 
+        /** @return size of the selected paper in millimeters, as oriented in the page setup */
+        wxSize getPaperSizeMM() const;
+        
+        /** @return the area inside the margins of the paper, in millimeters */
+        wxRect getMarginsRectMM() const;
+        
         /** 
          * Perform print setup (paper size, orientation, etc...), with our without dialog.
          * @postcondition sets m_unit_width and m_unit_height in AriaPrintable, as well
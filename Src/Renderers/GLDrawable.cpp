@@ -18,6 +18,7 @@
 
 #include "Renderers/Drawable.h"
 #include "Renderers/ImageBase.h"
+#include "Renderers/GLTextureAtlas.h"
 #include "Utils.h"
 #include <iostream>
 
@@ -53,20 +54,24 @@ void Drawable::render()
     // in these cases, the image will be upside down so we need to flip it
     if (m_image->textureHeight < 0) do_yflip = not m_y_flip;
     
-    glBindTexture(GL_TEXTURE_2D, m_image->getID()[0] );
+    ASSERT(m_image->getID() != NULL);
+    TextureAtlas::bindTexture( m_image->getID()[0] );
+    
+    const float x0 = m_image->tex_coord_x0, x1 = m_image->tex_coord_x;
+    const float y0 = m_image->tex_coord_y0, y1 = m_image->tex_coord_y;
     
     glBegin(GL_QUADS);
     
-    glTexCoord2f(m_x_flip? m_image->tex_coord_x : 0, do_yflip? 0 : m_image->tex_coord_y);
+    glTexCoord2f(m_x_flip? x1 : x0, do_yflip? y0 : y1);
     glVertex2f( -m_hotspot_x*10.0, -m_hotspot_y*10.0 );
     
-    glTexCoord2f(m_x_flip? 0 : m_image->tex_coord_x, do_yflip? 0 : m_image->tex_coord_y);
+    glTexCoord2f(m_x_flip? x0 : x1, do_yflip? y0 : y1);
     glVertex2f( (m_image->width-m_hotspot_x)*10.0, -m_hotspot_y*10.0 );
     
-    glTexCoord2f(m_x_flip? 0 : m_image->tex_coord_x, do_yflip? m_image->tex_coord_y : 0);
+    glTexCoord2f(m_x_flip? x0 : x1, do_yflip? y1 : y0);
     glVertex2f( (m_image->width-m_hotspot_x)*10.0, (m_image->height-m_hotspot_y)*10.0 );
     
-    glTexCoord2f(m_x_flip? m_image->tex_coord_x : 0, do_yflip? m_image->tex_coord_y : 0);
+    glTexCoord2f(m_x_flip? x1 : x0, do_yflip? y1 : y0);
     glVertex2f( -m_hotspot_x*10.0, (m_image->height-m_hotspot_y)*10.0 );
     
     glEnd();
@@ -21,6 +21,7 @@
  */
 
 #include "Renderers/ImageBase.h"
+#include "Renderers/GLTextureAtlas.h"
 #include "Utils.h"
 
 #include <iostream>
@@ -54,7 +55,7 @@ namespace AriaMaestosa
             return NULL;
         }
         
-        glBindTexture( GL_TEXTURE_2D, *ID );
+        TextureAtlas::bindTexture( *ID );
         
         err = glGetError();
         if (err != GL_NO_ERROR)
@@ -222,7 +223,16 @@ namespace AriaMaestosa
 
     Image::Image()
     {
-        
+        ID = NULL;
+        m_owns_texture = false;
+        width  = 0;
+        height = 0;
+        textureWidth  = 0;
+        textureHeight = 0;
+        tex_coord_x0 = 0;
+        tex_coord_y0 = 0;
+        tex_coord_x  = 0;
+        tex_coord_y  = 0;
     }
     
     // -------------------------------------------------------------------------------------------------------
@@ -236,6 +246,28 @@ namespace AriaMaestosa
     
     void Image::load(wxString path)
     {
+        tex_coord_x0 = 0;
+        tex_coord_y0 = 0;
+
+        if (TextureAtlas::isPacking())
+        {
+            // texture coordinates are only known once the atlas is packed
+            ID = NULL;
+            m_owns_texture = false;
+            textureWidth  = 0;
+            textureHeight = 0;
+            tex_coord_x   = 0;
+            tex_coord_y   = 0;
+
+            wxImage pixels;
+            if (TextureAtlas::loadScaled(path, pixels, &width, &height))
+            {
+                TextureAtlas::add(this, pixels);
+            }
+            return;
+        }
+
+        m_owns_texture = true;
         ID=loadImage(path, &width, &height, &textureWidth, &textureHeight);
         
         tex_coord_x = (float)width/(float)textureWidth;
@@ -244,6 +276,22 @@ namespace AriaMaestosa
     
     // -------------------------------------------------------------------------------------------------------
 
+    void Image::setTexture(GLuint* id, const int textureWidth, const int textureHeight,
+                           const float x0, const float y0, const float x1, const float y1)
+    {
+        ASSERT(not m_owns_texture);
+
+        ID = id;
+        this->textureWidth  = textureWidth;
+        this->textureHeight = textureHeight;
+        tex_coord_x0 = x0;
+        tex_coord_y0 = y0;
+        tex_coord_x  = x1;
+        tex_coord_y  = y1;
+    }
+
+    // -------------------------------------------------------------------------------------------------------
+
     GLuint* Image::getID()
     {
         return ID;
@@ -253,7 +301,12 @@ namespace AriaMaestosa
 
     Image::~Image()
     {
-        glDeleteTextures (1, ID);
+        if (m_owns_texture and ID != NULL)
+        {
+            TextureAtlas::forgetTexture(ID[0]);
+            glDeleteTextures (1, ID);
+            delete[] ID;
+        }
     }
     
     // -------------------------------------------------------------------------------------------------------
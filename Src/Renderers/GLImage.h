@@ -29,9 +29,13 @@ namespace AriaMaestosa {
 class Image
 {
     GLuint* ID;
+
+    /** false when the texture is shared with other images (see TextureAtlas) */
+    bool m_owns_texture;
 public:
     LEAK_CHECK();
     
+    /** size in unscaled pixels, whatever the resolution of the texture */
     int width, height;
     
     Image();
@@ -40,11 +44,19 @@ public:
     void load(wxString path);
     
     int textureWidth, textureHeight;
+
+    /** part of the texture covered by this image, from (tex_coord_x0, tex_coord_y0) to (tex_coord_x, tex_coord_y) */
+    float tex_coord_x0;
+    float tex_coord_y0;
     float tex_coord_x;
     float tex_coord_y;
 
     GLuint* getID();
 
+    /** Makes this image a region of a texture it does not own; used by TextureAtlas */
+    void setTexture(GLuint* id, const int textureWidth, const int textureHeight,
+                    const float x0, const float y0, const float x1, const float y1);
+
 };
 
 
@@ -19,6 +19,7 @@
 #include "Utils.h"
 
 #include "Renderers/GLPane.h"
+#include "Renderers/GLTextureAtlas.h"
 #include "AriaCore.h"
 
 #include "OpenGL.h"
@@ -116,7 +117,9 @@ void GLPane::initOpenGLFor2D()
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA);
 
-    glViewport(0, 0, GetSize().x, GetSize().y);
+    // on hi-DPI displays the viewport is in physical pixels, while we keep drawing in logical pixels
+    const float scale = getScaleFactor();
+    glViewport(0, 0, (int)(GetSize().x*scale), (int)(GetSize().y*scale));
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
 
@@ -129,6 +132,17 @@ void GLPane::initOpenGLFor2D()
 
 // -------------------------------------------------------------------------------------------------------
 
+float GLPane::getScaleFactor()
+{
+#if wxCHECK_VERSION(2,9,5)
+    return GetContentScaleFactor();
+#else
+    return 1.0f;
+#endif
+}
+
+// -------------------------------------------------------------------------------------------------------
+
 int GLPane::getWidth()
 {
 
@@ -158,6 +172,7 @@ bool GLPane::prepareFrame()
 
 void GLPane::beginFrame()
 {
+    TextureAtlas::forgetBinding();
     initOpenGLFor2D();
     glClear(GL_COLOR_BUFFER_BIT);
 }
@@ -51,6 +51,9 @@ namespace AriaMaestosa
         int getWidth();
         int getHeight();
 
+        /** @return physical pixels per logical pixel (e.g. 2 on "retina" displays) */
+        float getScaleFactor();
+
         // OpenGL stuff
         void setCurrent();
         void swapBuffers();
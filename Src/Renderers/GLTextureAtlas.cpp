@@ -0,0 +1,363 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef RENDERER_OPENGL
+
+#include "Renderers/GLTextureAtlas.h"
+#include "Renderers/ImageBase.h"
+#include "IO/IOUtils.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <wx/filename.h>
+#include <wx/image.h>
+#include <wx/intl.h>
+#include <wx/msgdlg.h>
+#include <wx/string.h>
+
+namespace AriaMaestosa
+{
+    namespace TextureAtlas
+    {
+        /** empty pixels left around each image, so that filtering never picks up a neighbour */
+        const int PADDING = 1;
+
+        struct PendingImage
+        {
+            Image* m_image;
+            int m_width, m_height;
+
+            /** RGBA pixels, bottom row first like all our textures */
+            std::vector<GLubyte> m_pixels;
+
+            /** position in the atlas, set by layoutShelves */
+            int m_x, m_y;
+        };
+
+        bool  packing      = false;
+        float scale_factor = 1.0f;
+
+        std::vector<PendingImage*> pending;
+
+        /** one entry per atlas texture created by pack() */
+        std::vector<GLuint*> pages;
+
+        bool   binding_known = false;
+        GLuint bound_texture = 0;
+
+        // ----------------------------------------------------------------------------------------------
+
+        int nextPowerOfTwo(const int value)
+        {
+            int out = 1;
+            while (out < value) out *= 2;
+            return out;
+        }
+
+        bool isTallerThan(const PendingImage* a, const PendingImage* b)
+        {
+            return a->m_height > b->m_height;
+        }
+
+        /**
+          * Places images (sorted by decreasing height) on horizontal shelves of the given width
+          * @return the height used
+          */
+        int layoutShelves(std::vector<PendingImage*>& images, const int width)
+        {
+            int x = 0, y = 0, shelfHeight = 0;
+
+            const int count = images.size();
+            for (int n=0; n<count; n++)
+            {
+                PendingImage* image = images[n];
+                if (x > 0 and x + image->m_width + PADDING > width)
+                {
+                    x = 0;
+                    y += shelfHeight;
+                    shelfHeight = 0;
+                }
+                image->m_x = x;
+                image->m_y = y;
+                x += image->m_width + PADDING;
+                shelfHeight = std::max(shelfHeight, image->m_height + PADDING);
+            }
+            return y + shelfHeight;
+        }
+
+        /** Uploads the given (already placed) images into a new texture and points them to it */
+        void createPage(const std::vector<PendingImage*>& images, const int width, const int height)
+        {
+            std::vector<GLubyte> pixels(width*height*4, 0);
+
+            const int count = images.size();
+            for (int n=0; n<count; n++)
+            {
+                const PendingImage* image = images[n];
+                for (int y=0; y<image->m_height; y++)
+                {
+                    std::copy(image->m_pixels.begin() + y*image->m_width*4,
+                              image->m_pixels.begin() + (y + 1)*image->m_width*4,
+                              pixels.begin() + ((image->m_y + y)*width + image->m_x)*4);
+                }
+            }
+
+            GLuint* id = new GLuint[1];
+            glGenTextures(1, id);
+            bindTexture(*id);
+
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexImage2D(GL_TEXTURE_2D, 0, 4, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+
+            GLenum err = glGetError();
+            if (err != GL_NO_ERROR)
+            {
+                fprintf(stderr, "[TextureAtlas] Failed to create %ix%i texture, error %i (%s)\n",
+                        width, height, err, gluErrorString(err));
+                wxMessageBox( _("Failed to load resource image") + wxString::FromUTF8(" (glTexImage2D)") );
+                ASSERT(false);
+            }
+
+            // images are stored at the resolution of the display, so unless the scale factor is
+            // fractional, texels map one to one to pixels
+            const GLint filter = (scale_factor == std::floor(scale_factor) ? GL_NEAREST : GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+
+            pages.push_back(id);
+
+            for (int n=0; n<count; n++)
+            {
+                const PendingImage* image = images[n];
+                image->m_image->setTexture(id, width, height,
+                                           (float)image->m_x / width,
+                                           (float)image->m_y / height,
+                                           (float)(image->m_x + image->m_width)  / width,
+                                           (float)(image->m_y + image->m_height) / height);
+            }
+        }
+
+        // ----------------------------------------------------------------------------------------------
+
+        void beginPacking(const float scaleFactor)
+        {
+            ASSERT(not packing);
+            packing      = true;
+            scale_factor = std::max(1.0f, scaleFactor);
+        }
+
+        // ----------------------------------------------------------------------------------------------
+
+        bool isPacking()
+        {
+            return packing;
+        }
+
+        // ----------------------------------------------------------------------------------------------
+
+        float getScaleFactor()
+        {
+            return scale_factor;
+        }
+
+        // ----------------------------------------------------------------------------------------------
+
+        bool loadScaled(const wxString& path, wxImage& out, int* logicalWidth, int* logicalHeight)
+        {
+            wxString fullPath   = getResourcePrefix() + path;
+            int      sourceScale = 1;
+
+            if (scale_factor > 1.0f)
+            {
+                wxFileName hiDPI(fullPath);
+                hiDPI.SetName(hiDPI.GetName() + wxT("@2x"));
+                if (hiDPI.FileExists())
+                {
+                    fullPath    = hiDPI.GetFullPath();
+                    sourceScale = 2;
+                }
+            }
+
+            if (not wxFileExists(fullPath) or not out.LoadFile(fullPath))
+            {
+                fprintf(stderr, "WARNING: ***** failed to load image '%s'\n", (const char*)fullPath.mb_str());
+                wxMessageBox( _("Failed to load resource image") + wxString::FromUTF8(" (new wxImage)") );
+                ASSERT(false);
+                return false;
+            }
+
+            *logicalWidth  = out.GetWidth()  / sourceScale;
+            *logicalHeight = out.GetHeight() / sourceScale;
+
+            // masks don't survive resampling, alpha does
+            if (out.HasMask() and not out.HasAlpha()) out.InitAlpha();
+
+            const int width  = (int)std::ceil(*logicalWidth  * scale_factor);
+            const int height = (int)std::ceil(*logicalHeight * scale_factor);
+            if (width != out.GetWidth() or height != out.GetHeight())
+            {
+#if wxCHECK_VERSION(2,9,2)
+                out.Rescale(width, height, wxIMAGE_QUALITY_BICUBIC);
+#else
+                out.Rescale(width, height, wxIMAGE_QUALITY_HIGH);
+#endif
+            }
+            return true;
+        }
+
+        // ----------------------------------------------------------------------------------------------
+
+        void add(Image* image, const wxImage& pixels)
+        {
+            ASSERT(packing);
+
+            PendingImage* entry = new PendingImage();
+            entry->m_image  = image;
+            entry->m_width  = pixels.GetWidth();
+            entry->m_height = pixels.GetHeight();
+            entry->m_x      = 0;
+            entry->m_y      = 0;
+            entry->m_pixels.resize(entry->m_width*entry->m_height*4);
+
+            const unsigned char* rgb   = pixels.GetData();
+            const unsigned char* alpha = (pixels.HasAlpha() ? pixels.GetAlpha() : NULL);
+
+            for (int y=0; y<entry->m_height; y++)
+            {
+                // flip rows, like all our textures
+                const int srcRow = entry->m_height - 1 - y;
+                for (int x=0; x<entry->m_width; x++)
+                {
+                    const int src  = srcRow*entry->m_width + x;
+                    GLubyte*  dest = &entry->m_pixels[(y*entry->m_width + x)*4];
+
+                    dest[0] = rgb[src*3 + 0];
+                    dest[1] = rgb[src*3 + 1];
+                    dest[2] = rgb[src*3 + 2];
+                    dest[3] = (alpha != NULL ? alpha[src] : 255);
+                }
+            }
+
+            pending.push_back(entry);
+        }
+
+        // ----------------------------------------------------------------------------------------------
+
+        void pack()
+        {
+            ASSERT(packing);
+            packing = false;
+
+            GLint maxSize = 1024;
+            glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+
+            std::vector<PendingImage*> remaining = pending;
+            std::stable_sort(remaining.begin(), remaining.end(), isTallerThan);
+
+            while (not remaining.empty())
+            {
+                // grow the atlas until it is about square
+                int widest = 0;
+                for (unsigned int n=0; n<remaining.size(); n++)
+                {
+                    widest = std::max(widest, remaining[n]->m_width + PADDING);
+                }
+                int width = std::min((int)maxSize, nextPowerOfTwo(std::max(256, widest)));
+                int height = layoutShelves(remaining, width);
+                while (height > width and width < maxSize)
+                {
+                    width *= 2;
+                    height = layoutShelves(remaining, width);
+                }
+
+                // whatever does not fit goes to the next page
+                std::vector<PendingImage*> page;
+                std::vector<PendingImage*> overflow;
+                const int count = remaining.size();
+                for (int n=0; n<count; n++)
+                {
+                    if (remaining[n]->m_y + remaining[n]->m_height <= maxSize or page.empty())
+                    {
+                        page.push_back(remaining[n]);
+                    }
+                    else
+                    {
+                        overflow.push_back(remaining[n]);
+                    }
+                }
+
+                height = 0;
+                for (unsigned int n=0; n<page.size(); n++)
+                {
+                    height = std::max(height, page[n]->m_y + page[n]->m_height);
+                }
+
+                createPage(page, width, nextPowerOfTwo(height));
+                remaining.swap(overflow);
+            }
+
+            for (unsigned int n=0; n<pending.size(); n++) delete pending[n];
+            pending.clear();
+        }
+
+        // ----------------------------------------------------------------------------------------------
+
+        void release()
+        {
+            for (unsigned int n=0; n<pages.size(); n++)
+            {
+                forgetTexture(pages[n][0]);
+                glDeleteTextures(1, pages[n]);
+                delete[] pages[n];
+            }
+            pages.clear();
+        }
+
+        // ----------------------------------------------------------------------------------------------
+
+        void bindTexture(const GLuint id)
+        {
+            if (binding_known and bound_texture == id) return;
+
+            glBindTexture(GL_TEXTURE_2D, id);
+            bound_texture = id;
+            binding_known = true;
+        }
+
+        // ----------------------------------------------------------------------------------------------
+
+        void forgetTexture(const GLuint id)
+        {
+            if (bound_texture == id) binding_known = false;
+        }
+
+        // ----------------------------------------------------------------------------------------------
+
+        void forgetBinding()
+        {
+            binding_known = false;
+        }
+
+    }
+}
+
+#endif
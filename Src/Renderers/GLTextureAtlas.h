@@ -0,0 +1,89 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef RENDERER_OPENGL
+
+#ifndef __GL_TEXTURE_ATLAS_H__
+#define __GL_TEXTURE_ATLAS_H__
+
+#include "OpenGL.h"
+
+class wxImage;
+class wxString;
+
+namespace AriaMaestosa
+{
+    class Image;
+
+    /**
+      * @brief OpenGL render backend : packs the skin images into as few textures as possible
+      *
+      * Between beginPacking() and pack(), every Image that gets loaded is queued here instead of
+      * receiving its own texture; pack() then uploads them all side by side in a single texture
+      * (more only if they don't fit in the largest texture the GL supports). Images are stored at
+      * the scale factor of the display, so they stay sharp on hi-DPI screens while their size,
+      * as seen by the rest of the code, is unchanged.
+      *
+      * All texture binds also go through here, so that binding the texture that is already bound
+      * costs nothing.
+      *
+      * @ingroup renderers
+      */
+    namespace TextureAtlas
+    {
+        /** Starts queuing newly loaded images, to be stored at the given scale factor */
+        void beginPacking(const float scaleFactor);
+
+        bool isPacking();
+
+        /** @return the scale factor images and text are rendered at (1 on regular displays) */
+        float getScaleFactor();
+
+        /**
+          * @brief Loads a resource image at the current scale factor
+          *
+          * When the display is scaled and a "name@2x.ext" variant of the file exists, that one is
+          * used; the image is then resampled to the scale factor if needed.
+          *
+          * @param[out] logicalWidth   size of the image in unscaled pixels
+          * @param[out] logicalHeight  size of the image in unscaled pixels
+          * @return whether the image could be loaded
+          */
+        bool loadScaled(const wxString& path, wxImage& out, int* logicalWidth, int* logicalHeight);
+
+        /** Queues an image loaded with loadScaled; it gets its texture when pack() is called */
+        void add(Image* image, const wxImage& pixels);
+
+        /** Uploads all queued images and stops packing */
+        void pack();
+
+        /** Deletes the atlas texture(s); images that were packed can no longer be drawn */
+        void release();
+
+        /** Binds the given 2D texture, unless it already is */
+        void bindTexture(const GLuint id);
+
+        /** Must be called before deleting a texture, since its name may be reused later */
+        void forgetTexture(const GLuint id);
+
+        /** Call when something outside our control may have changed the bound texture */
+        void forgetBinding();
+    }
+
+}
+
+#endif
+#endif
@@ -34,6 +34,7 @@
 
 #include "AriaCore.h"
 #include "PreferencesData.h"
+#include "Renderers/GLTextureAtlas.h"
 
 namespace AriaMaestosa
 {
@@ -43,7 +44,7 @@ GLuint* loadImage(wxImage* img)
 	GLuint* ID = new GLuint[1];
 	glGenTextures( 1, ID );
 
-	glBindTexture( GL_TEXTURE_2D, *ID );
+	TextureAtlas::bindTexture( *ID );
 
 
 	glPixelStorei(GL_UNPACK_ALIGNMENT,   1   );
@@ -118,6 +119,7 @@ TextGLDrawable::TextGLDrawable(TextTexture* image_arg)
 
     m_w = -1;
     m_h = -1;
+    m_scale = 1.0f;
 
     if (image_arg != NULL) setImage(image_arg);
     else                   m_image = NULL;
@@ -263,6 +265,7 @@ unsigned int* TextTexture::getID()
 
 TextTexture::~TextTexture()
 {
+    TextureAtlas::forgetTexture(ID[0]);
     glDeleteTextures (1, (GLuint*)ID);
     delete[] ID;
 }
@@ -287,7 +290,7 @@ void wxGLString::bind()
 {
     if (not m_consolidated) consolidate(Display::renderDC);
 
-    glBindTexture(GL_TEXTURE_2D, m_image->getID()[0] );
+    TextureAtlas::bindTexture( m_image->getID()[0] );
 }
 
 void wxGLString::calculateSize(wxDC* dc, const bool ignore_font /* when from array */)
@@ -321,8 +324,13 @@ void wxGLString::consolidate(wxDC* dc)
         multiLine = true;
     }
 
-    const int power_of_2_w = std::max(32, (int)pow( 2, (int)ceil((float)log(m_w)/log(2.0)) ));
-    const int power_of_2_h = std::max(32, (int)pow( 2, (int)ceil((float)log(m_h)/log(2.0)) ));
+    // render at the resolution of the display; layout stays in unscaled pixels
+    m_scale = TextureAtlas::getScaleFactor();
+    const int scaled_w = (int)ceil(m_w*m_scale);
+    const int scaled_h = (int)ceil(m_h*m_scale);
+
+    const int power_of_2_w = std::max(32, (int)pow( 2, (int)ceil((float)log(scaled_w)/log(2.0)) ));
+    const int power_of_2_h = std::max(32, (int)pow( 2, (int)ceil((float)log(scaled_h)/log(2.0)) ));
 
     wxBitmap bmp(power_of_2_w, power_of_2_h);
     ASSERT(bmp.IsOk());
@@ -332,6 +340,7 @@ void wxGLString::consolidate(wxDC* dc)
 
         temp_dc.SetBrush(*wxWHITE_BRUSH);
         temp_dc.Clear();
+        temp_dc.SetUserScale(m_scale, m_scale);
 
         if (m_font.IsOk()) temp_dc.SetFont(m_font);
         else               temp_dc.SetFont(wxSystemSettings::GetFont(wxSYS_SYSTEM_FONT));
@@ -359,8 +368,8 @@ void wxGLString::consolidate(wxDC* dc)
 
     TextGLDrawable::texw = power_of_2_w;
     TextGLDrawable::texh = power_of_2_h;
-    TextGLDrawable::tex_coord_x2 = (float)m_w / (float)power_of_2_w;
-    TextGLDrawable::tex_coord_y2 = 1-(float)m_h / (float)power_of_2_h;
+    TextGLDrawable::tex_coord_x2 = (float)scaled_w / (float)power_of_2_w;
+    TextGLDrawable::tex_coord_y2 = 1-(float)scaled_h / (float)power_of_2_h;
     TextGLDrawable::tex_coord_y1 = 1;
 
     TextGLDrawable::setImage(img);
@@ -496,8 +505,8 @@ void wxGLNumberRenderer::renderNumber(const char* s, int x, int y)
 
         ASSERT( charid != -1 );
 
-        TextGLDrawable::tex_coord_x1 = (float)number_location[charid] / (float)full_string_w;
-        TextGLDrawable::tex_coord_x2 = (float)(number_location[charid+1]-space_w) / (float)full_string_w;
+        TextGLDrawable::tex_coord_x1 = number_location[charid]*m_scale / (float)full_string_w;
+        TextGLDrawable::tex_coord_x2 = (number_location[charid+1]-space_w)*m_scale / (float)full_string_w;
 
         const int char_width = number_location[charid+1] - number_location[charid] - space_w;
         m_w = char_width;
@@ -539,7 +548,7 @@ void wxGLStringArray::bind()
 {
     if (not consolidated) consolidate(Display::renderDC);
 
-    glBindTexture(GL_TEXTURE_2D, img->getID()[0] );
+    TextureAtlas::bindTexture( img->getID()[0] );
 }
 
 void wxGLStringArray::addStrings(const wxString strings_arg[], int amount)
@@ -591,8 +600,13 @@ void wxGLStringArray::consolidate(wxDC* dc)
         column_amount ++;
     }
 
-    const int power_of_2_w = pow( 2, (int)ceil((float)log(longest_string*column_amount)/log(2.0)) );
-    const int power_of_2_h = pow( 2, (int)ceil((float)log(y/column_amount)/log(2.0)) );
+    const float scale = TextureAtlas::getScaleFactor();
+
+    const int power_of_2_w = pow( 2, (int)ceil((float)log(longest_string*column_amount*scale)/log(2.0)) );
+    const int power_of_2_h = pow( 2, (int)ceil((float)log(y*scale/column_amount)/log(2.0)) );
+
+    // layout is done in unscaled pixels
+    const float logical_h = power_of_2_h/scale;
 
     //std::cout << "bitmap size : " <<  power_of_2_w << ", " << power_of_2_h << " // " << column_amount << " columns" << std::endl;
 
@@ -604,6 +618,7 @@ void wxGLStringArray::consolidate(wxDC* dc)
 
         temp_dc.SetBrush(*wxWHITE_BRUSH);
         temp_dc.Clear();
+        temp_dc.SetUserScale(scale, scale);
 
         y = 0;
         x = 0;
@@ -615,13 +630,14 @@ void wxGLStringArray::consolidate(wxDC* dc)
             if (strings[n].getModel()->getValue().IsEmpty()) continue;
             strings[n].consolidateFromArray(&temp_dc, x, y);
 
-            strings[n].tex_coord_x1 = (float)x/(float)power_of_2_w;
-            strings[n].tex_coord_y1 = 1.0 - (float)y/(float)power_of_2_h;
-            strings[n].tex_coord_x2 = (float)(x+strings[n].m_w)/(float)power_of_2_w;
-            strings[n].tex_coord_y2 = 1.0 - (float)(y+strings[n].m_h)/(float)power_of_2_h;
+            strings[n].m_scale = scale;
+            strings[n].tex_coord_x1 = x*scale/(float)power_of_2_w;
+            strings[n].tex_coord_y1 = 1.0 - y*scale/(float)power_of_2_h;
+            strings[n].tex_coord_x2 = (x+strings[n].m_w)*scale/(float)power_of_2_w;
+            strings[n].tex_coord_y2 = 1.0 - (y+strings[n].m_h)*scale/(float)power_of_2_h;
 
             y += strings[n].m_h;
-            if (y > power_of_2_h - average_string_height*2) // check if we need to switch to next column
+            if (y > logical_h - average_string_height*2) // check if we need to switch to next column
             {
                 y = 0;
                 x += longest_string;
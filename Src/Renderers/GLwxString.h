@@ -72,8 +72,13 @@ namespace AriaMaestosa
 
         float tex_coord_x1, tex_coord_y1;
         float tex_coord_x2, tex_coord_y2;
+
+        /** m_w and m_h are in unscaled pixels, texw and texh in texture pixels */
         int m_w, m_h, texw, texh;
 
+        /** texture pixels per unscaled pixel, i.e. the scale factor of the display text was rendered for */
+        float m_scale;
+
         int m_max_width;
 
         TextGLDrawable(TextTexture* image=(TextTexture*)0);
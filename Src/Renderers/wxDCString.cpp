@@ -10,10 +10,18 @@
 #include "AriaCore.h"
 #include "PreferencesData.h"
 #include "Renderers/RenderAPI.h"
+#include "Renderers/wxRasterBuffer.h"
 
 namespace AriaMaestosa
 {
     
+    /** draws text into the software frame buffer, in the current color */
+    void drawText(const wxString& text, const wxFont& font, const int x, const int y)
+    {
+        const wxRasterMask& mask = wxRasterBuffer::getTextMask(text, font);
+        wxRasterBuffer::getCurrent()->drawMask(mask, x, y, dcstring_get_color());
+    }
+    
 #if 0
 #pragma mark -
 #pragma mark wxDCString
@@ -92,8 +100,8 @@ namespace AriaMaestosa
         ASSERT_E(m_h, <, 90000);
         ASSERT(m_consolidated);
         
-        if (m_font.IsOk()) Display::renderDC->SetFont(m_font);
-        else               Display::renderDC->SetFont(wxSystemSettings::GetFont(wxSYS_SYSTEM_FONT));
+        const wxFont font = (m_font.IsOk() ? m_font : wxSystemSettings::GetFont(wxSYS_SYSTEM_FONT));
+        Display::renderDC->SetFont(font);
         
         if (m_max_width != -1 and getWidth() > m_max_width)
         {
@@ -105,7 +113,7 @@ namespace AriaMaestosa
                 {
                     shortened = shortened.Truncate(shortened.size()-1);
                 }
-                Display::renderDC->DrawText(shortened, x, y - m_h);
+                drawText(shortened, font, x, y - m_h);
             }
             else // wrap
             {
@@ -118,14 +126,14 @@ namespace AriaMaestosa
                 while ( tkz.HasMoreTokens() )
                 {
                     wxString token = tkz.GetNextToken();
-                    Display::renderDC->DrawText(token, x, my_y);
+                    drawText(token, font, x, my_y);
                     my_y += m_h;
                 }
             }
         }
         else
         {
-            Display::renderDC->DrawText(m_model->getValue(), x, y - m_h);
+            drawText(m_model->getValue(), font, x, y - m_h);
         }
     }
     
@@ -163,8 +171,7 @@ namespace AriaMaestosa
         ASSERT_E(m_h, >, -1);
         ASSERT_E(m_h, <, 90000);
 
-        Display::renderDC->SetFont( getNumberFont() );
-        Display::renderDC->DrawText(s, x, y - m_h);
+        drawText(s, getNumberFont(), x, y - m_h);
     }
     
     void wxDCNumberRenderer::renderNumber(int i, int x, int y)
@@ -17,6 +17,9 @@ namespace AriaMaestosa
     
     class wxDCStringArray;
     
+    /** @return the color text is currently drawn in, packed as by wxRasterBuffer::pack */
+    unsigned int dcstring_get_color();
+    
     /**
      * @brief   wxWidgets render backend : text renderer
      * @ingroup renderers
@@ -18,6 +18,7 @@
 
 #include "Renderers/Drawable.h"
 #include "Renderers/ImageBase.h"
+#include "Renderers/wxRasterBuffer.h"
 #include "Utils.h"
 #include <iostream>
 #include <list>
@@ -46,10 +47,10 @@ namespace AriaMaestosa
         AriaRender::ImageState m_state;
         bool m_x_flip, m_y_flip;
         int m_angle;
-        wxBitmap m_bitmap;
+        wxImage m_image;
         
-        ImageCache(AriaRender::ImageState state, bool x_flip, bool y_flip, int angle, wxBitmap bmp) :
-            m_bitmap(bmp)
+        ImageCache(AriaRender::ImageState state, bool x_flip, bool y_flip, int angle, const wxImage& img) :
+            m_image(img)
         {
             m_state = state;
             m_x_flip = x_flip;
@@ -74,6 +75,8 @@ using namespace AriaMaestosa;
 
 void Drawable::render()
 {
+    wxRasterBuffer* target = wxRasterBuffer::getCurrent();
+    
     if (m_x_flip or m_y_flip or m_x_scale != 1 or m_y_scale != 1 or m_angle != 0)
     {
         int hotspotX_mod = m_hotspot_x;
@@ -103,10 +106,10 @@ void Drawable::render()
                     const int max_x = m_x - hotspotX_mod + new_w - m_image->width;
                     for (int x = m_x - hotspotX_mod; x <= max_x; x += m_image->width)
                     {
-                        Display::renderDC->DrawBitmap( it->m_bitmap, x, m_y - hotspotY_mod, true);
+                        target->drawImage( it->m_image, x, m_y - hotspotY_mod);
                     }
                     
-                    Display::renderDC->DrawBitmap( it->m_bitmap, max_x, m_y - hotspotY_mod, true);
+                    target->drawImage( it->m_image, max_x, m_y - hotspotY_mod);
                 }
                 else if (m_y_scale != 1)
                 {
@@ -118,13 +121,13 @@ void Drawable::render()
                     const int max_y = m_y - hotspotY_mod + new_h - m_image->height;
                     for (int y = m_y - hotspotY_mod; y <= max_y; y += m_image->height)
                     {
-                        Display::renderDC->DrawBitmap( it->m_bitmap, m_x - hotspotX_mod, y, true);
+                        target->drawImage( it->m_image, m_x - hotspotX_mod, y);
                     }
-                    Display::renderDC->DrawBitmap( it->m_bitmap, m_x - hotspotX_mod, max_y, true);
+                    target->drawImage( it->m_image, m_x - hotspotX_mod, max_y);
                 }
                 else
                 {
-                    Display::renderDC->DrawBitmap(it->m_bitmap, m_x - hotspotX_mod, m_y - hotspotY_mod, true);
+                    target->drawImage(it->m_image, m_x - hotspotX_mod, m_y - hotspotY_mod);
                 }
                 
                 return;
@@ -132,7 +135,7 @@ void Drawable::render()
         }
 
         // Image not found in cache
-        wxImage modimage = m_image->getBitmapForState(g_state)->ConvertToImage();
+        wxImage modimage = *m_image->getImageForState(g_state);
 
         if (m_x_flip) modimage = modimage.Mirror();
         if (m_y_flip) modimage = modimage.Mirror(false);
@@ -142,8 +145,11 @@ void Drawable::render()
             modimage = modimage.Rotate90();
         }
 
-        wxBitmap modbitmap(modimage);
-        cache.push_front( ImageCache(g_state, m_x_flip, m_y_flip, m_angle, modbitmap) );
+        cache.push_front( ImageCache(g_state, m_x_flip, m_y_flip, m_angle, modimage) );
+        
+        // the raster buffer only keeps a pointer to the image until the end of the frame, so draw the
+        // cached copy rather than the local one
+        const wxImage& cached = cache.front().m_image;
 
         if (m_x_scale != 1)
         {
@@ -155,9 +161,9 @@ void Drawable::render()
             const int max_x = m_x - hotspotX_mod + new_w - m_image->width;
             for (int x = m_x - hotspotX_mod; x < max_x; x += m_image->width)
             {
-                Display::renderDC->DrawBitmap( modbitmap, x, m_y - hotspotY_mod, true);
+                target->drawImage( cached, x, m_y - hotspotY_mod);
             }
-            Display::renderDC->DrawBitmap( modbitmap, max_x, m_y - hotspotY_mod, true);
+            target->drawImage( cached, max_x, m_y - hotspotY_mod);
         }
         else if (m_y_scale != 1)
         {
@@ -169,19 +175,18 @@ void Drawable::render()
             const int max_y = m_y - hotspotY_mod + new_h - m_image->height;
             for (int y = m_y - hotspotY_mod; y < max_y; y += m_image->height)
             {
-                Display::renderDC->DrawBitmap( modbitmap, m_x - hotspotX_mod, y, true);
+                target->drawImage( cached, m_x - hotspotX_mod, y);
             }
-            Display::renderDC->DrawBitmap( modbitmap, m_x - hotspotX_mod, max_y, true);
+            target->drawImage( cached, m_x - hotspotX_mod, max_y);
         }
         else
         {
-            Display::renderDC -> DrawBitmap( modbitmap, m_x - hotspotX_mod, m_y - hotspotY_mod, true);
+            target->drawImage( cached, m_x - hotspotX_mod, m_y - hotspotY_mod);
         }
     }
     else
     {
-        Display::renderDC -> DrawBitmap( *m_image->getBitmapForState(g_state),
-                                         m_x - m_hotspot_x, m_y - m_hotspot_y, true);
+        target->drawImage( *m_image->getImageForState(g_state), m_x - m_hotspot_x, m_y - m_hotspot_y );
     }
 
 }
@@ -0,0 +1,613 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef RENDERER_WXWIDGETS
+
+#include "Renderers/wxRasterBuffer.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+
+#include <wx/dc.h>
+#include <wx/dcmemory.h>
+#include <wx/font.h>
+#include <wx/image.h>
+#include <wx/rawbmp.h>
+#include <wx/string.h>
+
+using namespace AriaMaestosa;
+
+namespace AriaMaestosa
+{
+    wxRasterBuffer* g_current_raster = NULL;
+
+    /** beyond this amount of cached text masks, the cache is emptied and starts over */
+    const unsigned int TEXT_MASK_CACHE_SIZE = 4096;
+
+    std::map<wxString, wxRasterMask> g_text_masks;
+
+    /** bands smaller than this are not worth the synchronisation overhead */
+    const int MIN_BAND_HEIGHT = 32;
+
+    /**
+      * Blends 'src' over 'dest', with 'alpha' in [0, 256]. Red and blue are blended together in
+      * one multiplication, since 8 bits of headroom separate them in the packed pixel.
+      */
+    inline unsigned int blendPixel(const unsigned int dest, const unsigned int src, const unsigned int alpha)
+    {
+        const unsigned int inv = 256 - alpha;
+        const unsigned int rb  = (((src & 0xFF00FF)*alpha + (dest & 0xFF00FF)*inv) >> 8) & 0xFF00FF;
+        const unsigned int g   = (((src & 0x00FF00)*alpha + (dest & 0x00FF00)*inv) >> 8) & 0x00FF00;
+        return rb | g;
+    }
+
+    /** maps an alpha in [0, 255] to [0, 256], so that 255 means fully opaque in blendPixel */
+    inline unsigned int expandAlpha(const int alpha)
+    {
+        return alpha + (alpha >> 7);
+    }
+
+    void fillSpan(unsigned int* dest, const int count, const unsigned int color, const int alpha)
+    {
+        if (alpha >= 255)
+        {
+            std::fill(dest, dest + count, color);
+            return;
+        }
+        if (alpha <= 0) return;
+
+        // the source term is the same for every pixel of the span
+        const unsigned int a      = expandAlpha(alpha);
+        const unsigned int inv    = 256 - a;
+        const unsigned int src_rb = (color & 0xFF00FF)*a;
+        const unsigned int src_g  = (color & 0x00FF00)*a;
+
+        for (int n=0; n<count; n++)
+        {
+            const unsigned int d = dest[n];
+            dest[n] = (((src_rb + (d & 0xFF00FF)*inv) >> 8) & 0xFF00FF) |
+                      (((src_g  + (d & 0x00FF00)*inv) >> 8) & 0x00FF00);
+        }
+    }
+
+    class RasterBandTask : public IParallelTask
+    {
+        wxRasterBuffer* m_buffer;
+        int m_band_height;
+
+    public:
+
+        RasterBandTask(wxRasterBuffer* buffer, const int bandHeight)
+        {
+            m_buffer      = buffer;
+            m_band_height = bandHeight;
+        }
+
+        virtual void runTask(const int id)
+        {
+            m_buffer->renderBand(id*m_band_height, (id + 1)*m_band_height);
+        }
+    };
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+wxRasterBuffer::wxRasterBuffer()
+{
+    m_width  = 0;
+    m_height = 0;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+wxRasterBuffer* wxRasterBuffer::getCurrent()
+{
+    return g_current_raster;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void wxRasterBuffer::setCurrent(wxRasterBuffer* buffer)
+{
+    g_current_raster = buffer;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void wxRasterBuffer::beginFrame(const int width, const int height, const unsigned int clearColor)
+{
+    if (width != m_width or height != m_height)
+    {
+        m_width  = std::max(0, width);
+        m_height = std::max(0, height);
+        m_pixels.resize(m_width*m_height);
+    }
+
+    // masks recorded in the previous frame are no longer referenced, so now is a safe time to trim
+    if (g_text_masks.size() >= TEXT_MASK_CACHE_SIZE) g_text_masks.clear();
+
+    // clear() keeps the capacity, so after the first frames recording no longer allocates
+    m_commands.clear();
+    m_points.clear();
+
+    Command& cmd = record(COMMAND_CLEAR);
+    cmd.m_color = clearColor;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+wxRasterBuffer::Command& wxRasterBuffer::record(const CommandType type)
+{
+    m_commands.push_back( Command() );
+    Command& cmd = m_commands[m_commands.size() - 1];
+    cmd.m_type  = type;
+    cmd.m_image = NULL;
+    cmd.m_mask  = NULL;
+    return cmd;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void wxRasterBuffer::finishFrame(const wxRect& area)
+{
+    m_area = area;
+    m_area.Intersect( wxRect(0, 0, m_width, m_height) );
+    if (m_area.IsEmpty()) return;
+
+    // twice as many bands as threads, so that a thread done early with a cheap band (say, the empty
+    // area below the last track) can take another one
+    WorkerPool* pool = WorkerPool::getInstance();
+    const int bandCount  = std::max(1, std::min(pool->getThreadCount()*2, m_area.height / MIN_BAND_HEIGHT));
+    const int bandHeight = (m_area.height + bandCount - 1) / bandCount;
+
+    RasterBandTask task(this, bandHeight);
+    pool->run(&task, bandCount);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void wxRasterBuffer::renderBand(const int y1, const int y2)
+{
+    wxRasterContext ctx;
+    ctx.m_band_x1 = m_area.x;
+    ctx.m_band_x2 = m_area.x + m_area.width;
+    ctx.m_band_y1 = m_area.y + y1;
+    ctx.m_band_y2 = std::min(m_area.y + m_area.height, m_area.y + y2);
+    if (ctx.m_band_y1 >= ctx.m_band_y2) return;
+    setContextClip(ctx, 0, 0, m_width, m_height);
+
+    const int count = m_commands.size();
+    for (int n=0; n<count; n++)
+    {
+        const Command& cmd = m_commands[n];
+        switch (cmd.m_type)
+        {
+            case COMMAND_CLEAR:
+                rasterRect(ctx, 0, 0, m_width, m_height, cmd.m_color, 255);
+                break;
+            case COMMAND_RECT:
+                rasterRect(ctx, cmd.m_x1, cmd.m_y1, cmd.m_x2, cmd.m_y2, cmd.m_color, cmd.m_alpha);
+                break;
+            case COMMAND_LINE:
+                rasterLine(ctx, cmd);
+                break;
+            case COMMAND_POLYGON:
+                rasterPolygon(ctx, cmd);
+                break;
+            case COMMAND_IMAGE:
+                rasterImage(ctx, *cmd.m_image, cmd.m_x1, cmd.m_y1);
+                break;
+            case COMMAND_MASK:
+                rasterMask(ctx, *cmd.m_mask, cmd.m_x1, cmd.m_y1, cmd.m_color);
+                break;
+            case COMMAND_CLIP:
+                setContextClip(ctx, cmd.m_x1, cmd.m_y1, cmd.m_x2, cmd.m_y2);
+                break;
+            case COMMAND_RESET_CLIP:
+                setContextClip(ctx, 0, 0, m_width, m_height);
+                break;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void wxRasterBuffer::setContextClip(wxRasterContext& ctx, const int x1, const int y1, const int x2, const int y2)
+{
+    ctx.m_clip_x1 = std::max(ctx.m_band_x1, x1);
+    ctx.m_clip_y1 = std::max(ctx.m_band_y1, y1);
+    ctx.m_clip_x2 = std::min(ctx.m_band_x2, x2);
+    ctx.m_clip_y2 = std::min(ctx.m_band_y2, y2);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void wxRasterBuffer::setClip(const int x, const int y, const int width, const int height)
+{
+    Command& cmd = record(COMMAND_CLIP);
+    cmd.m_x1 = x;
+    cmd.m_y1 = y;
+    cmd.m_x2 = x + width;
+    cmd.m_y2 = y + height;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void wxRasterBuffer::resetClip()
+{
+    record(COMMAND_RESET_CLIP);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void wxRasterBuffer::fillRect(int x1, int y1, int x2, int y2, const unsigned int color, const int alpha)
+{
+    if (x1 > x2) std::swap(x1, x2);
+    if (y1 > y2) std::swap(y1, y2);
+
+    // don't bother recording what can't be visible
+    if (x2 <= 0 or y2 <= 0 or x1 >= m_width or y1 >= m_height or alpha <= 0) return;
+
+    Command& cmd = record(COMMAND_RECT);
+    cmd.m_x1    = x1;
+    cmd.m_y1    = y1;
+    cmd.m_x2    = x2;
+    cmd.m_y2    = y2;
+    cmd.m_color = color;
+    cmd.m_alpha = alpha;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void wxRasterBuffer::line(const int x1, const int y1, const int x2, const int y2, const int width,
+                          const unsigned int color, const int alpha)
+{
+    const int w    = std::max(1, width);
+    const int half = w/2;
+
+    // horizontal and vertical lines, by far the most common, are plain rectangles
+    if (y1 == y2)
+    {
+        if (x1 <= x2) fillRect(x1,     y1 - half, x2,     y1 - half + w, color, alpha);
+        else          fillRect(x2 + 1, y1 - half, x1 + 1, y1 - half + w, color, alpha);
+        return;
+    }
+    if (x1 == x2)
+    {
+        if (y1 <= y2) fillRect(x1 - half, y1,     x1 - half + w, y2,     color, alpha);
+        else          fillRect(x1 - half, y2 + 1, x1 - half + w, y1 + 1, color, alpha);
+        return;
+    }
+
+    Command& cmd = record(COMMAND_LINE);
+    cmd.m_x1    = x1;
+    cmd.m_y1    = y1;
+    cmd.m_x2    = x2;
+    cmd.m_y2    = y2;
+    cmd.m_size  = w;
+    cmd.m_color = color;
+    cmd.m_alpha = alpha;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void wxRasterBuffer::fillConvexPolygon(const int* xs, const int* ys, const int count,
+                                       const unsigned int color, const int alpha)
+{
+    Command& cmd = record(COMMAND_POLYGON);
+    cmd.m_size        = count;
+    cmd.m_first_point = m_points.size();
+    cmd.m_color       = color;
+    cmd.m_alpha       = alpha;
+
+    for (int n=0; n<count; n++)
+    {
+        m_points.push_back(xs[n]);
+        m_points.push_back(ys[n]);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void wxRasterBuffer::drawImage(const wxImage& image, const int x, const int y)
+{
+    Command& cmd = record(COMMAND_IMAGE);
+    cmd.m_x1    = x;
+    cmd.m_y1    = y;
+    cmd.m_image = &image;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void wxRasterBuffer::drawMask(const wxRasterMask& mask, const int x, const int y, const unsigned int color)
+{
+    Command& cmd = record(COMMAND_MASK);
+    cmd.m_x1    = x;
+    cmd.m_y1    = y;
+    cmd.m_color = color;
+    cmd.m_mask  = &mask;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void wxRasterBuffer::rasterRect(wxRasterContext& ctx, int x1, int y1, int x2, int y2,
+                                const unsigned int color, const int alpha)
+{
+    x1 = std::max(x1, ctx.m_clip_x1);
+    y1 = std::max(y1, ctx.m_clip_y1);
+    x2 = std::min(x2, ctx.m_clip_x2);
+    y2 = std::min(y2, ctx.m_clip_y2);
+    if (x1 >= x2 or y1 >= y2) return;
+
+    unsigned int* row = &m_pixels[y1*m_width + x1];
+    for (int y=y1; y<y2; y++)
+    {
+        fillSpan(row, x2 - x1, color, alpha);
+        row += m_width;
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void wxRasterBuffer::rasterLine(wxRasterContext& ctx, const Command& cmd)
+{
+    const int w    = cmd.m_size;
+    const int half = w/2;
+
+    // the whole line is outside this band
+    if (std::max(cmd.m_y1, cmd.m_y2) + w < ctx.m_clip_y1 or std::min(cmd.m_y1, cmd.m_y2) - w >= ctx.m_clip_y2)
+    {
+        return;
+    }
+
+    // Bresenham, stamping a w x w square at each step
+    const int dx = std::abs(cmd.m_x2 - cmd.m_x1);
+    const int dy = std::abs(cmd.m_y2 - cmd.m_y1);
+    const int sx = (cmd.m_x1 < cmd.m_x2 ? 1 : -1);
+    const int sy = (cmd.m_y1 < cmd.m_y2 ? 1 : -1);
+    int err = dx - dy;
+
+    int x = cmd.m_x1;
+    int y = cmd.m_y1;
+    while (x != cmd.m_x2 or y != cmd.m_y2)
+    {
+        rasterRect(ctx, x - half, y - half, x - half + w, y - half + w, cmd.m_color, cmd.m_alpha);
+
+        const int e2 = err*2;
+        if (e2 > -dy) { err -= dy; x += sx; }
+        if (e2 <  dx) { err += dx; y += sy; }
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void wxRasterBuffer::rasterPolygon(wxRasterContext& ctx, const Command& cmd)
+{
+    const int  count  = cmd.m_size;
+    const int* points = &m_points[cmd.m_first_point];
+
+    int miny = points[1];
+    int maxy = points[1];
+    for (int n=1; n<count; n++)
+    {
+        miny = std::min(miny, points[n*2 + 1]);
+        maxy = std::max(maxy, points[n*2 + 1]);
+    }
+    miny = std::max(miny, ctx.m_clip_y1);
+    maxy = std::min(maxy, ctx.m_clip_y2 - 1);
+
+    for (int y=miny; y<=maxy; y++)
+    {
+        // sample at the center of the pixel row
+        const float yc = y + 0.5f;
+        float xmin =  1e9f;
+        float xmax = -1e9f;
+
+        for (int n=0; n<count; n++)
+        {
+            const int next = (n + 1) % count;
+            const float xa = points[n*2];
+            const float ya = points[n*2 + 1];
+            const float xb = points[next*2];
+            const float yb = points[next*2 + 1];
+            if (ya == yb) continue;
+            if (yc < std::min(ya, yb) or yc >= std::max(ya, yb)) continue;
+
+            const float x = xa + (yc - ya)*(xb - xa)/(yb - ya);
+            xmin = std::min(xmin, x);
+            xmax = std::max(xmax, x);
+        }
+        if (xmin > xmax) continue;
+
+        const int from = std::max(ctx.m_clip_x1, (int)ceilf(xmin - 0.5f));
+        const int to   = std::min(ctx.m_clip_x2, (int)ceilf(xmax - 0.5f));
+        if (from < to) fillSpan(&m_pixels[y*m_width + from], to - from, cmd.m_color, cmd.m_alpha);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void wxRasterBuffer::rasterImage(wxRasterContext& ctx, const wxImage& image, const int x, const int y)
+{
+    const int w = image.GetWidth();
+    const int h = image.GetHeight();
+
+    const int from_x = std::max(x, ctx.m_clip_x1);
+    const int from_y = std::max(y, ctx.m_clip_y1);
+    const int to_x   = std::min(x + w, ctx.m_clip_x2);
+    const int to_y   = std::min(y + h, ctx.m_clip_y2);
+    if (from_x >= to_x or from_y >= to_y) return;
+
+    const unsigned char* rgb   = image.GetData();
+    const unsigned char* alpha = (image.HasAlpha() ? image.GetAlpha() : NULL);
+
+    const bool hasMask = image.HasMask();
+    const unsigned int maskColor = (hasMask ? pack(image.GetMaskRed(), image.GetMaskGreen(), image.GetMaskBlue()) : 0);
+
+    for (int py=from_y; py<to_y; py++)
+    {
+        unsigned int* dest = &m_pixels[py*m_width];
+        const int srcRow = (py - y)*w;
+
+        for (int px=from_x; px<to_x; px++)
+        {
+            const int src = srcRow + (px - x);
+            const unsigned char* c = rgb + src*3;
+            const unsigned int color = pack(c[0], c[1], c[2]);
+
+            if (alpha != NULL)
+            {
+                const int a = alpha[src];
+                if      (a == 255) dest[px] = color;
+                else if (a != 0)   dest[px] = blendPixel(dest[px], color, expandAlpha(a));
+            }
+            else if (not hasMask or color != maskColor)
+            {
+                dest[px] = color;
+            }
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void wxRasterBuffer::rasterMask(wxRasterContext& ctx, const wxRasterMask& mask, const int x, const int y,
+                                const unsigned int color)
+{
+    const int from_x = std::max(x, ctx.m_clip_x1);
+    const int from_y = std::max(y, ctx.m_clip_y1);
+    const int to_x   = std::min(x + mask.m_width,  ctx.m_clip_x2);
+    const int to_y   = std::min(y + mask.m_height, ctx.m_clip_y2);
+    if (from_x >= to_x or from_y >= to_y) return;
+
+    for (int py=from_y; py<to_y; py++)
+    {
+        unsigned int* dest = &m_pixels[py*m_width];
+        const unsigned char* coverage = &mask.m_coverage[(py - y)*mask.m_width];
+
+        for (int px=from_x; px<to_x; px++)
+        {
+            const int a = coverage[px - x];
+            if      (a == 255) dest[px] = color;
+            else if (a != 0)   dest[px] = blendPixel(dest[px], color, expandAlpha(a));
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void wxRasterBuffer::blitTo(wxDC& dc, const wxRect& updateBox)
+{
+    wxRect box = updateBox;
+    box.Intersect( wxRect(0, 0, m_width, m_height) );
+    if (box.IsEmpty()) return;
+
+    if (not m_bitmap.IsOk() or m_bitmap.GetWidth() != m_width or m_bitmap.GetHeight() != m_height)
+    {
+        m_bitmap.Create(m_width, m_height, 24);
+    }
+
+    {
+        wxNativePixelData data(m_bitmap, box.GetPosition(), box.GetSize());
+        if (not data)
+        {
+            // no direct access to the bitmap on this platform, go through a wxImage instead
+            wxImage image(box.width, box.height, false);
+            unsigned char* out = image.GetData();
+            for (int y=box.y; y<box.y + box.height; y++)
+            {
+                const unsigned int* src = &m_pixels[y*m_width + box.x];
+                for (int x=0; x<box.width; x++)
+                {
+                    *out++ = (src[x] >> 16) & 0xFF;
+                    *out++ = (src[x] >> 8)  & 0xFF;
+                    *out++ =  src[x]        & 0xFF;
+                }
+            }
+            dc.DrawBitmap(wxBitmap(image), box.x, box.y, false);
+            return;
+        }
+
+        wxNativePixelData::Iterator row(data);
+        for (int y=box.y; y<box.y + box.height; y++)
+        {
+            wxNativePixelData::Iterator p = row;
+            const unsigned int* src = &m_pixels[y*m_width + box.x];
+            for (int x=0; x<box.width; x++, ++p)
+            {
+                p.Red()   = (src[x] >> 16) & 0xFF;
+                p.Green() = (src[x] >> 8)  & 0xFF;
+                p.Blue()  =  src[x]        & 0xFF;
+            }
+            row.OffsetY(data, 1);
+        }
+    } // the pixel data must be released before the bitmap can be selected in a DC
+
+    wxMemoryDC memDC(m_bitmap);
+    dc.Blit(box.x, box.y, box.width, box.height, &memDC, box.x, box.y);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+const wxRasterMask& wxRasterBuffer::getTextMask(const wxString& text, const wxFont& font)
+{
+    const wxString key = font.GetNativeFontInfoDesc() + wxT("|") + text;
+
+    std::map<wxString, wxRasterMask>::iterator it = g_text_masks.find(key);
+    if (it != g_text_masks.end()) return it->second;
+
+    // (the cache is only ever trimmed in beginFrame, since recorded commands point into it)
+    wxRasterMask& mask = g_text_masks[key];
+
+    wxMemoryDC memDC;
+    wxBitmap measureBitmap(1, 1, 24);
+    memDC.SelectObject(measureBitmap);
+    memDC.SetFont(font);
+
+    wxCoord w, h;
+    memDC.GetTextExtent(text, &w, &h);
+    mask.m_width  = std::max(1, (int)w);
+    mask.m_height = std::max(1, (int)h);
+
+    // draw the text white on black; the resulting brightness is the coverage
+    wxBitmap textBitmap(mask.m_width, mask.m_height, 24);
+    memDC.SelectObject(textBitmap);
+    memDC.SetBackground(*wxBLACK_BRUSH);
+    memDC.Clear();
+    memDC.SetTextForeground(*wxWHITE);
+    memDC.SetBackgroundMode(wxTRANSPARENT);
+    memDC.DrawText(text, 0, 0);
+    memDC.SelectObject(wxNullBitmap);
+
+    const wxImage image = textBitmap.ConvertToImage();
+    const unsigned char* data = image.GetData();
+    const int pixelCount = mask.m_width*mask.m_height;
+
+    mask.m_coverage.resize(pixelCount);
+    for (int n=0; n<pixelCount; n++)
+    {
+        mask.m_coverage[n] = (data[n*3] + data[n*3 + 1] + data[n*3 + 2]) / 3;
+    }
+
+    return mask;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,213 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef RENDERER_WXWIDGETS
+
+#ifndef __WX_RASTER_BUFFER_H__
+#define __WX_RASTER_BUFFER_H__
+
+#include "Utils.h"
+#include <vector>
+#include <wx/bitmap.h>
+
+class wxDC;
+class wxFont;
+class wxImage;
+class wxString;
+
+namespace AriaMaestosa
+{
+
+    /**
+      * @brief   wxWidgets render backend : coverage mask of a piece of text, ready to be drawn in any color
+      * @ingroup renderers
+      */
+    struct wxRasterMask
+    {
+        int m_width;
+        int m_height;
+
+        /** one byte per pixel, 0 for transparent up to 255 for fully covered */
+        std::vector<unsigned char> m_coverage;
+    };
+
+    /**
+      * @brief   wxWidgets render backend : per-thread raster state
+      *
+      * Each thread drawing into a wxRasterBuffer owns a rectangular band of it, and keeps its own
+      * clipping rectangle (always contained in its band), so threads never touch the same pixels.
+      * @ingroup renderers
+      */
+    struct wxRasterContext
+    {
+        int m_band_x1, m_band_y1, m_band_x2, m_band_y2;
+
+        /** current clipping rectangle, x2/y2 excluded */
+        int m_clip_x1, m_clip_y1, m_clip_x2, m_clip_y2;
+    };
+
+    /**
+      * @brief   wxWidgets render backend : software frame buffer
+      *
+      * Instead of issuing one wxDC call (with pen and brush changes) per primitive, the software
+      * renderer rasterizes a whole frame into this 32-bit buffer, and then copies it to the screen
+      * in a single blit. Pixels are packed as 0x00RRGGBB; alpha blending is done two channels at a
+      * time on the packed value.
+      *
+      * Drawing calls made during a frame are only recorded. finishFrame() then splits the buffer in
+      * horizontal bands, and replays the recorded calls for each band on the worker pool, every
+      * thread with its own wxRasterContext. Since a band only ever receives the calls in their
+      * original order, the result is identical to drawing everything on a single thread.
+      *
+      * @ingroup renderers
+      */
+    class wxRasterBuffer
+    {
+        enum CommandType
+        {
+            COMMAND_CLEAR,
+            COMMAND_RECT,
+            COMMAND_LINE,
+            COMMAND_POLYGON,
+            COMMAND_IMAGE,
+            COMMAND_MASK,
+            COMMAND_CLIP,
+            COMMAND_RESET_CLIP
+        };
+
+        struct Command
+        {
+            CommandType m_type;
+            int m_x1, m_y1, m_x2, m_y2;
+
+            /** line width, or number of points of a polygon */
+            int m_size;
+
+            /** index of the first point of a polygon in m_points */
+            int m_first_point;
+
+            unsigned int m_color;
+            int m_alpha;
+
+            const wxImage*      m_image;
+            const wxRasterMask* m_mask;
+        };
+
+        std::vector<unsigned int> m_pixels;
+        int m_width;
+        int m_height;
+
+        std::vector<Command> m_commands;
+
+        /** polygon coordinates, stored as x,y pairs */
+        std::vector<int> m_points;
+
+        /** bitmap the buffer is copied into before being blitted, kept between frames */
+        wxBitmap m_bitmap;
+
+        /** part of the buffer being rasterized by finishFrame */
+        wxRect m_area;
+
+        Command& record(const CommandType type);
+
+        void rasterRect   (wxRasterContext& ctx, int x1, int y1, int x2, int y2,
+                           const unsigned int color, const int alpha);
+        void rasterLine   (wxRasterContext& ctx, const Command& cmd);
+        void rasterPolygon(wxRasterContext& ctx, const Command& cmd);
+        void rasterImage  (wxRasterContext& ctx, const wxImage& image, const int x, const int y);
+        void rasterMask   (wxRasterContext& ctx, const wxRasterMask& mask, const int x, const int y,
+                           const unsigned int color);
+
+        void setContextClip(wxRasterContext& ctx, const int x1, const int y1, const int x2, const int y2);
+
+    public:
+        LEAK_CHECK();
+
+        wxRasterBuffer();
+
+        /** @brief the buffer all AriaRender calls currently draw into */
+        static wxRasterBuffer* getCurrent();
+        static void setCurrent(wxRasterBuffer* buffer);
+
+        /**
+          * @brief Starts recording a new frame
+          * Resizes the buffer if needed, and schedules clearing it to the given color.
+          */
+        void beginFrame(const int width, const int height, const unsigned int clearColor);
+
+        /**
+          * @brief Rasterizes everything recorded since beginFrame, using all available cores
+          * @param area  only this part of the buffer is updated; the rest keeps the previous frame
+          */
+        void finishFrame(const wxRect& area);
+
+        /** Replays the recorded calls for rows [y1, y2[ of the area only; used by finishFrame */
+        void renderBand(const int y1, const int y2);
+
+        int getWidth () const { return m_width;  }
+        int getHeight() const { return m_height; }
+
+        static unsigned int pack(const unsigned char r, const unsigned char g, const unsigned char b)
+        {
+            return (r << 16) | (g << 8) | b;
+        }
+
+        void setClip(const int x, const int y, const int width, const int height);
+        void resetClip();
+
+        /** Fills [x1, x2[ x [y1, y2[ */
+        void fillRect(int x1, int y1, int x2, int y2, const unsigned int color, const int alpha);
+
+        /** Draws a line from (x1, y1) up to, but excluding, (x2, y2), like wxDC::DrawLine */
+        void line(const int x1, const int y1, const int x2, const int y2, const int width,
+                  const unsigned int color, const int alpha);
+
+        /** Fills a convex polygon; pixels whose center lies inside it are filled */
+        void fillConvexPolygon(const int* xs, const int* ys, const int count,
+                               const unsigned int color, const int alpha);
+
+        /**
+          * Draws a wxImage (honouring its alpha channel or mask, if any) with its top-left corner at x,y.
+          * The image is not copied, it must stay alive until the end of the frame.
+          */
+        void drawImage(const wxImage& image, const int x, const int y);
+
+        /**
+          * Draws a coverage mask in the given color with its top-left corner at x,y.
+          * The mask is not copied, it must stay alive until the end of the frame.
+          */
+        void drawMask(const wxRasterMask& mask, const int x, const int y, const unsigned int color);
+
+        /**
+          * @brief  Copies the buffer to the given DC
+          * @param  dc          the DC to blit to
+          * @param  updateBox   only this part of the buffer is copied (e.g. the update region of a paint event)
+          */
+        void blitTo(wxDC& dc, const wxRect& updateBox);
+
+        /**
+          * @brief  Get the coverage mask of the given text in the given font
+          *
+          * Masks are cached, so the (slow) text rendering of wxWidgets only happens the first time
+          * a given string is drawn. Masks stay valid at least until the next call to beginFrame.
+          */
+        static const wxRasterMask& getTextMask(const wxString& text, const wxFont& font);
+    };
+
+}
+
+#endif
+#endif
@@ -23,6 +23,10 @@
 #include "PreferencesData.h"
 #include "Renderers/RenderAPI.h"
 #include "Renderers/Drawable.h"
+#include "Renderers/wxRasterBuffer.h"
+
+#include <algorithm>
+#include <cmath>
 
 namespace AriaMaestosa
 {
@@ -117,27 +121,13 @@ void setImageState(const ImageState imgst)
     current_state = imgst;
     drawable_set_state(current_state);
 }
-    
-void updatePen()
-{
-    Display::renderDC -> SetPen( wxPen( wxColour( rc, gc, bc, ac ), lineWidth_i ) );
-}
-void updateBrush()
-{
-    Display::renderDC -> SetBrush( wxBrush( wxColour( rc, gc, bc, ac )) );
-}
-void updateFontColor()
-{
-    Display::renderDC -> SetTextForeground( wxColour( rc, gc, bc, ac ) );
-}
 
-void disablePen()
-{
-    Display::renderDC -> SetPen( *wxTRANSPARENT_PEN );
-}
-void disableBrush()
+/** the packed color all primitives are currently drawn with */
+unsigned int current_color = 0xFFFFFF;
+
+inline wxRasterBuffer* target()
 {
-    Display::renderDC -> SetBrush( *wxTRANSPARENT_BRUSH );
+    return wxRasterBuffer::getCurrent();
 }
 
 void color(const float r, const float g, const float b)
@@ -145,43 +135,27 @@ void color(const float r, const float g, const float b)
     rc = (unsigned char)(r*255);
     gc = (unsigned char)(g*255);
     bc = (unsigned char)(b*255);
-
-    if (mode_primitives)
-    {
-        ac = 255;
-        updatePen();
-        updateBrush();
-    }
-    else
-        updateFontColor();
+    ac = 255;
+    current_color = wxRasterBuffer::pack(rc, gc, bc);
 }
 
 void color(const float r, const float g, const float b, const float a)
 {
-
     rc = (unsigned char)(r*255);
     gc = (unsigned char)(g*255);
     bc = (unsigned char)(b*255);
     ac = (unsigned char)(a*255);
-
-    if (mode_primitives)
-    {
-        updatePen();
-        updateBrush();
-    }
-    else
-        updateFontColor();
+    current_color = wxRasterBuffer::pack(rc, gc, bc);
 }
 
 void line(const int x1, const int y1, const int x2, const int y2)
 {
-    Display::renderDC -> DrawLine( x1, y1, x2, y2 );
+    target()->line(x1, y1, x2, y2, lineWidth_i, current_color, ac);
 }
 
 void lineWidth(const int n)
 {
     lineWidth_i = n;
-    updatePen();
 }
 
 void lineSmooth(const bool enabled)
@@ -191,12 +165,11 @@ void lineSmooth(const bool enabled)
 
 void point(const int x, const int y)
 {
-    if (pointSize_i == 1) Display::renderDC -> DrawPoint( x, y );
+    if (pointSize_i == 1) target()->fillRect(x, y, x+1, y+1, current_color, ac);
     else
     {
-        disablePen();
-        Display::renderDC -> DrawRectangle( x-pointSize_i/2, y-pointSize_i/2, pointSize_i, pointSize_i );
-        updatePen();
+        target()->fillRect(x-pointSize_i/2, y-pointSize_i/2,
+                           x-pointSize_i/2+pointSize_i, y-pointSize_i/2+pointSize_i, current_color, ac);
     }
 }
 
@@ -207,77 +180,83 @@ void pointSize(const int n)
 
 void rect(const int x1, const int y1, const int x2, const int y2)
 {
-    disablePen();
-    Display::renderDC -> DrawRectangle( x1, y1, x2-x1, y2-y1 );
-    updatePen();
+    target()->fillRect(x1, y1, x2, y2, current_color, ac);
 }
 
 void bordered_rect_no_start(const int x1, const int y1, const int x2, const int y2)
 {
-    disablePen();
-    Display::renderDC -> DrawRectangle( x1, y1, x2-x1+1, y2-y1+1 );
-
-    Display::renderDC -> SetPen( *wxBLACK_PEN );
+    wxRasterBuffer* buffer = target();
+    buffer->fillRect(x1, y1, x2+1, y2+1, current_color, ac);
 
 	// right line
-    Display::renderDC -> DrawLine( x2+1, y1, x2+1, y2+1 );
+    buffer->line(x2+1, y1, x2+1, y2+1, 1, 0, 255);
 
 	// top line
-    Display::renderDC -> DrawLine( x1, y1-1, x2+1, y1-1 );
+    buffer->line(x1, y1-1, x2+1, y1-1, 1, 0, 255);
 	
 	// bottom line
-    Display::renderDC -> DrawLine( x1, y2+1, x2+1, y2+1 );
-
-    updatePen();
+    buffer->line(x1, y2+1, x2+1, y2+1, 1, 0, 255);
 }
 
 void bordered_rect(const int x1, const int y1, const int x2, const int y2)
 {
+    wxRasterBuffer* buffer = target();
+    buffer->fillRect(x1, y1, x2+1, y2+1, current_color, ac);
 
-    disablePen();
-    Display::renderDC -> DrawRectangle( x1, y1, x2-x1+1, y2-y1+1 );
-
-    Display::renderDC -> SetPen( *wxBLACK_PEN );
-    Display::renderDC -> DrawLine( x1, y1, x1, y2+1 );
-    Display::renderDC -> DrawLine( x2+1, y1, x2+1, y2+1 );
+    buffer->line(x1, y1, x1, y2+1, 1, 0, 255);
+    buffer->line(x2+1, y1, x2+1, y2+1, 1, 0, 255);
 
-    Display::renderDC -> DrawLine( x1+1, y1-1, x2+1, y1-1 );
-    Display::renderDC -> DrawLine( x1+1, y2+1, x2+1, y2+1 );
+    buffer->line(x1+1, y1-1, x2+1, y1-1, 1, 0, 255);
+    buffer->line(x1+1, y2+1, x2+1, y2+1, 1, 0, 255);
+}
 
-    updatePen();
+/** outline of the rectangle covered by wxDC::DrawRectangle(x1, y1, x2-x1, y2-y1) */
+void outline(const int x1, const int y1, const int x2, const int y2, const int width,
+             const unsigned int color, const int alpha)
+{
+    wxRasterBuffer* buffer = target();
+    buffer->fillRect(x1, y1,            x2, y1 + width, color, alpha);
+    buffer->fillRect(x1, y2 - width,    x2, y2,         color, alpha);
+    buffer->fillRect(x1, y1 + width,    x1 + width, y2 - width, color, alpha);
+    buffer->fillRect(x2 - width, y1 + width, x2, y2 - width, color, alpha);
 }
 
 void hollow_rect(const int x1, const int y1, const int x2, const int y2)
 {
-    disableBrush();
-    Display::renderDC -> DrawRectangle( x1, y1, x2-x1, y2-y1 );
-    updateBrush();
+    outline(std::min(x1, x2), std::min(y1, y2), std::max(x1, x2), std::max(y1, y2),
+            lineWidth_i, current_color, ac);
 }
     
 void select_rect(const int x1, const int y1, const int x2, const int y2)
 {
-    Display::renderDC -> SetPen( *wxBLACK_PEN );
-    disableBrush();
-    Display::renderDC -> DrawRectangle( x1, y1, x2-x1, y2-y1 );
-    updateBrush();
-    updatePen();
+    outline(std::min(x1, x2), std::min(y1, y2), std::max(x1, x2), std::max(y1, y2), 1, 0, 255);
 }
 
 void triangle(const int x1, const int y1, const int x2, const int y2, const int x3, const int y3)
 {
-    disablePen();
-    wxPoint array[] = { wxPoint(x1, y1), wxPoint(x2, y2), wxPoint(x3, y3) };
-    Display::renderDC -> DrawPolygon( 3, array );
-    updatePen();
+    const int xs[] = { x1, x2, x3 };
+    const int ys[] = { y1, y2, y3 };
+    target()->fillConvexPolygon(xs, ys, 3, current_color, ac);
 }
 
 void arc(int center_x, int center_y, int radius_x, int radius_y, bool show_above)
 {
-    Display::renderDC -> SetPen( wxPen( wxColour( rc, gc, bc, ac ), 1 ) );
-    disableBrush();
-    Display::renderDC -> DrawEllipticArc( center_x - radius_x, center_y - radius_y, radius_x*2, radius_y*2, 0, (show_above ? 180 : -180) );
-    updateBrush();
-    updatePen();
+    // approximate the half ellipse with segments short enough to look smooth
+    const int steps = std::max(4, (radius_x + radius_y)*2);
+    const float direction = (show_above ? -1.0f : 1.0f);
+    
+    int prev_x = center_x + radius_x;
+    int prev_y = center_y;
+    for (int n=1; n<=steps; n++)
+    {
+        const float angle = M_PI * n / steps;
+        const int x = center_x + (int)roundf(cosf(angle)*radius_x);
+        const int y = center_y + (int)roundf(sinf(angle)*radius_y*direction);
+        
+        target()->line(prev_x, prev_y, x, y, 1, current_color, ac);
+        prev_x = x;
+        prev_y = y;
+    }
 }
 
 void quad(const int x1, const int y1,
@@ -285,25 +264,27 @@ void quad(const int x1, const int y1,
           const int x3, const int y3,
           const int x4, const int y4)
 {
-    disablePen();
-    wxPoint array[] = { wxPoint(x1, y1), wxPoint(x2, y2), wxPoint(x3, y3), wxPoint(x4, y4) };
-    Display::renderDC -> DrawPolygon( 4, array );
-    updatePen();
+    const int xs[] = { x1, x2, x3, x4 };
+    const int ys[] = { y1, y2, y3, y4 };
+    target()->fillConvexPolygon(xs, ys, 4, current_color, ac);
 }
 
-//wxDCClipper* dc_clipper = NULL;
-
 void beginScissors(const int x, const int y, const int width, const int height)
 {
-    //Display::renderDC -> DestroyClippingRegion();
-    Display::renderDC -> SetClippingRegion( wxPoint(x, y), wxSize(width, height));
+    target()->setClip(x, y, width, height);
 }
 
 void endScissors()
 {
-    Display::renderDC -> DestroyClippingRegion();
+    target()->resetClip();
 }
 
 }
+
+unsigned int dcstring_get_color()
+{
+    return AriaRender::current_color;
+}
+
 }
 #endif
@@ -87,14 +87,21 @@ bool wxRenderPane::prepareFrame()
 
 void wxRenderPane::beginFrame()
 {
-    Display::renderDC -> SetBackground( *wxBLACK_BRUSH );
-    Display::renderDC -> Clear();
+    const wxSize size = GetClientSize();
+    m_raster.beginFrame(size.x, size.y, wxRasterBuffer::pack(0, 0, 0));
+    wxRasterBuffer::setCurrent(&m_raster);
 }
 
 // ----------------------------------------------------------------------------------------------------------
 
 void wxRenderPane::endFrame()
 {
+    // only rasterize and copy what the paint event asked for (e.g. the playback cursor strip)
+    wxRect box = GetUpdateRegion().GetBox();
+    if (box.IsEmpty()) box = wxRect(0, 0, m_raster.getWidth(), m_raster.getHeight());
+    
+    m_raster.finishFrame(box);
+    m_raster.blitTo(*Display::renderDC, box);
 }
 
 // ----------------------------------------------------------------------------------------------------------
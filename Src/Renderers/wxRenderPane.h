@@ -20,6 +20,7 @@
 #define __WX_RENDER_PANE_H__
 
 #include "Utils.h"
+#include "Renderers/wxRasterBuffer.h"
 #include <wx/panel.h>
 
 class wxSizeEvent;
@@ -35,6 +36,8 @@ namespace AriaMaestosa
      */
     class wxRenderPane : public wxPanel
     {
+        /** frames are rasterized in software into this buffer, then blitted to the screen in endFrame */
+        wxRasterBuffer m_raster;
 
     public:
         LEAK_CHECK();
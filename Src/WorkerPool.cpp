@@ -0,0 +1,185 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "WorkerPool.h"
+#include "UnitTest.h"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+namespace AriaMaestosa
+{
+    /** no point in having more threads than this, the work we split is never that big */
+    const int MAX_WORKER_THREADS = 16;
+
+    class WorkerThread : public wxThread
+    {
+        WorkerPool* m_pool;
+
+    public:
+
+        WorkerThread(WorkerPool* pool) : wxThread(wxTHREAD_JOINABLE)
+        {
+            m_pool = pool;
+        }
+
+        ExitCode Entry()
+        {
+            m_pool->m_mutex.Lock();
+            while (true)
+            {
+                while (not m_pool->m_quit and m_pool->m_next_task >= m_pool->m_task_count)
+                {
+                    m_pool->m_work_available.Wait();
+                }
+                if (m_pool->m_quit) break;
+
+                m_pool->work();
+            }
+            m_pool->m_mutex.Unlock();
+            return 0;
+        }
+    };
+
+}
+
+using namespace AriaMaestosa;
+
+DEFINE_SINGLETON( WorkerPool );
+
+// ----------------------------------------------------------------------------------------------------------
+
+WorkerPool::WorkerPool() : m_work_available(m_mutex), m_work_done(m_mutex)
+{
+    m_task       = NULL;
+    m_task_count = 0;
+    m_next_task  = 0;
+    m_pending    = 0;
+    m_quit       = false;
+
+    const int threadCount = std::min(MAX_WORKER_THREADS, wxThread::GetCPUCount()) - 1;
+    for (int n=0; n<threadCount; n++)
+    {
+        WorkerThread* thread = new WorkerThread(this);
+        if (thread->Create() != wxTHREAD_NO_ERROR or thread->Run() != wxTHREAD_NO_ERROR)
+        {
+            std::cerr << "[WorkerPool] failed to start worker thread" << std::endl;
+            delete thread;
+            break;
+        }
+        m_threads.push_back(thread);
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+WorkerPool::~WorkerPool()
+{
+    m_mutex.Lock();
+    m_quit = true;
+    m_work_available.Broadcast();
+    m_mutex.Unlock();
+
+    const int count = m_threads.size();
+    for (int n=0; n<count; n++)
+    {
+        m_threads[n].Wait();
+    }
+    m_threads.clearAndDeleteAll();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void WorkerPool::work()
+{
+    while (m_next_task < m_task_count)
+    {
+        const int id = m_next_task++;
+        IParallelTask* task = m_task;
+
+        m_mutex.Unlock();
+        task->runTask(id);
+        m_mutex.Lock();
+
+        m_pending--;
+        if (m_pending == 0) m_work_done.Broadcast();
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
+void WorkerPool::run(IParallelTask* task, const int taskCount)
+{
+    if (taskCount <= 0) return;
+
+    // m_task is only ever set by the main thread, so it can safely be read here without locking
+    if (m_threads.size() == 0 or taskCount == 1 or not wxThread::IsMain() or m_task != NULL)
+    {
+        for (int n=0; n<taskCount; n++) task->runTask(n);
+        return;
+    }
+
+    m_mutex.Lock();
+    m_task       = task;
+    m_task_count = taskCount;
+    m_next_task  = 0;
+    m_pending    = taskCount;
+    m_work_available.Broadcast();
+
+    work();
+    while (m_pending > 0) m_work_done.Wait();
+
+    m_task       = NULL;
+    m_task_count = 0;
+    m_next_task  = 0;
+    m_mutex.Unlock();
+}
+
+// ----------------------------------------------------------------------------------------------------------
+// ----------------------------------------------------------------------------------------------------------
+
+namespace TestWorkerPool
+{
+    class CountingTask : public IParallelTask
+    {
+    public:
+        std::vector<int> m_runs;
+
+        CountingTask(const int count) : m_runs(count, 0) {}
+
+        virtual void runTask(const int id)
+        {
+            // every task only ever touches its own slot, so no locking is needed
+            m_runs[id]++;
+        }
+    };
+}
+using namespace TestWorkerPool;
+
+UNIT_TEST( TestEveryTaskRunsOnce )
+{
+    for (int count=0; count<200; count += 13)
+    {
+        CountingTask task(count);
+        WorkerPool::getInstance()->run(&task, count);
+
+        for (int n=0; n<count; n++)
+        {
+            require_e(task.m_runs[n], ==, 1, "each task was run exactly once");
+        }
+    }
+}
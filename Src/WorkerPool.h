@@ -0,0 +1,86 @@
+/*
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __WORKER_POOL_H__
+#define __WORKER_POOL_H__
+
+#include "ptr_vector.h"
+#include "Singleton.h"
+#include "Utils.h"
+
+#include <wx/thread.h>
+
+namespace AriaMaestosa
+{
+    class WorkerThread;
+
+    /**
+      * @brief Work that can be split in independent tasks, numbered from 0
+      */
+    class IParallelTask
+    {
+    public:
+        virtual ~IParallelTask() {}
+
+        /** Performs task 'id'. May be called from any thread, concurrently with other tasks. */
+        virtual void runTask(const int id) = 0;
+    };
+
+    /**
+      * @brief A fixed set of threads (one per core) that run IParallelTasks
+      *
+      * The calling thread takes part in the work, and run() only returns once every task is done.
+      * Only the main thread fans out to the worker threads; calls made from any other thread, or
+      * while a run is already in progress, simply run all tasks in order on the calling thread.
+      */
+    class WorkerPool : public Singleton<WorkerPool>
+    {
+        friend class WorkerThread;
+
+        ptr_vector<WorkerThread> m_threads;
+
+        wxMutex     m_mutex;
+        wxCondition m_work_available;
+        wxCondition m_work_done;
+
+        IParallelTask* m_task;
+        int  m_task_count;
+        int  m_next_task;
+
+        /** amount of tasks of the current run that are not finished yet */
+        int  m_pending;
+
+        bool m_quit;
+
+        /** Called with m_mutex locked; runs tasks until there is none left to start */
+        void work();
+
+    public:
+        LEAK_CHECK();
+
+        WorkerPool();
+        ~WorkerPool();
+
+        /** @return amount of threads that can work at the same time, including the caller */
+        int getThreadCount() const { return m_threads.size() + 1; }
+
+        /** Runs tasks 0 to taskCount-1 of 'task', and returns when they are all done */
+        void run(IParallelTask* task, const int taskCount);
+    };
+
+}
+
+#endif
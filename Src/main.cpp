@@ -28,6 +28,7 @@
 #include "Midi/Players/PlatformMidiManager.h"
 #include "Midi/KeyPresets.h"
 #include "PreferencesData.h"
+#include "Printing/ScoreExport.h"
 #include "languages.h"
 #include "UnitTest.h"
 #include "Utils.h"
@@ -138,31 +139,8 @@ public:
 // ------------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------------
 
-void wxWidgetApp::activateRenderLoop(bool on)
-{
-    if (on and not m_render_loop_on)
-    {
-        Connect( wxID_ANY, wxEVT_IDLE, wxIdleEventHandler(wxWidgetApp::onIdle) );
-        m_render_loop_on = true;
-    }
-
-    else if (not on and m_render_loop_on)
-    {
-        Disconnect( wxEVT_IDLE, wxIdleEventHandler(wxWidgetApp::onIdle) );
-        m_render_loop_on = false;
-    }
-}
-
-// ------------------------------------------------------------------------------------------------------
-
 void wxWidgetApp::onIdle(wxIdleEvent& evt)
 {
-    if (m_render_loop_on)
-    {
-        frame->getMainPane()->playbackRenderLoop();
-        evt.RequestMore();
-    }
-    
     PlatformMidiManager* pmm = PlatformMidiManager::get();
     if (pmm->isRecording())
     {
@@ -192,9 +170,11 @@ bool wxWidgetApp::OnInit()
     wxLogVerbose( wxT("wxWidgetsApp::OnInit (enter)") );
     std::cout << "[main] wxWidgetsApp::OnInit (enter)" << std::endl;
 
-    m_render_loop_on = false;
     appName = GetAppName();
     
+    // "--export-score out.pdf file.aria" : export the given file without any window, then quit
+    wxString exportPath;
+    
     for (int n=0; n<argc; n++)
     {
         if (wxString(argv[n]) == wxT("--utest"))
@@ -207,6 +187,10 @@ bool wxWidgetApp::OnInit()
             UnitTestCase::showMenu();
             exit(0);
         }
+        else if (wxString(argv[n]) == wxT("--export-score") and n + 1 < argc)
+        {
+            exportPath = cleanPath(wxString(argv[n + 1]));
+        }
         else if (wxString(argv[n]) == wxT("--verbose"))
         {
             wxLog::SetLogLevel(wxLOG_Info);
@@ -220,6 +204,30 @@ bool wxWidgetApp::OnInit()
     
     m_single_instance_checker = NULL;
     
+    if (not exportPath.IsEmpty())
+    {
+        wxString songPath;
+        for (int n=1; n<argc and songPath.IsEmpty(); n++)
+        {
+            const wxString arg(argv[n]);
+            if (arg == wxT("--export-score")) n++; // skip the export path as well
+            else if (not arg.StartsWith(wxT("--"))) songPath = cleanPath(arg);
+        }
+        
+        if (songPath.IsEmpty())
+        {
+            std::cerr << "[main] --export-score needs a .aria or .mid file to export" << std::endl;
+            m_export_status = 1;
+        }
+        else
+        {
+            m_export_status = (exportScoreFile(songPath, exportPath) ? 0 : 1);
+        }
+        
+        // OnRun returns m_export_status instead of entering the main loop
+        return true;
+    }
+    
 #ifndef __WXMAC__
     m_single_instance_checker = new wxSingleInstanceChecker(appName + wxGetUserId(), wxT("/tmp/"));
     
@@ -279,7 +287,7 @@ bool wxWidgetApp::OnInit()
     }
     
     frame->init(filesToOpen, argc>1);
-
+    
     wxLogVerbose( wxT("[main] init main frame 2") );
 
     frame->updateHorizontalScrollbar(0);
@@ -296,6 +304,16 @@ bool wxWidgetApp::OnInit()
     
 // ------------------------------------------------------------------------------------------------------
 
+int wxWidgetApp::OnRun()
+{
+    // a command-line export already ran from OnInit, there is no window to run a main loop for
+    if (m_export_status != -1) return m_export_status;
+    
+    return wxApp::OnRun();
+}
+
+// ------------------------------------------------------------------------------------------------------
+
 int wxWidgetApp::OnExit()
 {
     wxLogVerbose( wxT("wxWidgetsApp::OnExit") );
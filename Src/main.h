@@ -45,25 +45,23 @@ namespace AriaMaestosa
     public:
         MainFrame* frame;
         PreferencesData*  prefs;
-
-        bool m_render_loop_on;
         
         
-        wxWidgetApp() { frame = NULL; }
+        wxWidgetApp() { frame = NULL; m_single_instance_checker = NULL; m_IPC_server = NULL; m_export_status = -1; }
         
         
         /** implement callback from wxApp */
         bool OnInit();
         
+        /** implement callback from wxApp */
+        virtual int  OnRun();
+        
         /** implement callback from wxApp */
         virtual int  OnExit();
         
         /** implement callback from wxApp */
         void MacOpenFile(const wxString &fileName);
         
-        /** call to activate or deactivate the render loop (which is based on idle events) */
-        void activateRenderLoop(bool on);
-        
         /** callback : called on idle */
         void onIdle(wxIdleEvent& evt);
         
@@ -87,6 +85,9 @@ namespace AriaMaestosa
         wxSingleInstanceChecker* m_single_instance_checker;
         AppIPCServer* m_IPC_server;
         
+        /** exit code of a --export-score run, -1 when the application was started normally */
+        int m_export_status;
+        
         bool handleSingleInstance();
         
     };
@@ -22,6 +22,7 @@
 #ifndef _ptr_vector_
 #define _ptr_vector_
 
+#include <algorithm>
 #include <vector>
 #include <iostream>
 
@@ -207,7 +208,21 @@ namespace AriaMaestosa
             
             contentsVector.erase(contentsVector.begin()+ID);
         }
-        
+
+        /** delete and remove the objects in range [from, to[ from the vector, shifting the rest only once */
+        void erase(const int from, const int to)
+        {
+            ASSERT( MAGIC_NUMBER_OK() );
+            ASSERT( not m_performing_deletion );
+            ASSERT_E(from,>,-1);
+            ASSERT_E(from,<=,to);
+            ASSERT_E((unsigned int)to,<=,contentsVector.size());
+
+            for (int n=from; n<to; n++) delete contentsVector[n];
+
+            contentsVector.erase(contentsVector.begin()+from, contentsVector.begin()+to);
+        }
+
         /** remove (but do not delete) an object from the vector. */
         void remove(const int ID)
         {
@@ -368,19 +383,9 @@ namespace AriaMaestosa
             ASSERT( MAGIC_NUMBER_OK() );
             ASSERT( not m_performing_deletion );
 
-            int vectorSize = contentsVector.size();
-            for (int n=0; n<vectorSize; n++)
-            {
-                
-                if ( contentsVector[n] == 0 )
-                {
-                    contentsVector.erase(contentsVector.begin()+n);
-                    vectorSize = contentsVector.size();
-                    n -= 2;
-                    if (n < -1) n=-1;
-                }
-            }//next
-            
+            // single pass, keeping the order of the remaining objects
+            contentsVector.erase(std::remove(contentsVector.begin(), contentsVector.end(), (TYPE*)0),
+                                 contentsVector.end());
         }
         // ------------------------------------------------------------------------
         